@@ -0,0 +1,1056 @@
+// Benchmarks for every public vector2 / vector3 operation, for float and double.
+//
+// Each operation is measured two ways:
+//   <type>/<op>/latency             one call on register resident operands
+//   <type>/<op>/throughput/<n>      the call applied over arrays of n elements, n from
+//                                   L1 sized (64) to DRAM sized (2M)
+// followed by the batch APIs (SIMD backends at every level the CPU supports, and the
+// SoA containers). Use --benchmark_filter to select, and
+// --benchmark_out=<file> --benchmark_out_format=json for machine readable output.
+
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "vector2.hpp"
+#include "vector3.hpp"
+#include "vector4.hpp"
+#include "vector_aabb.hpp"
+#include "vector_angle.hpp"
+#include "vector_codec.hpp"
+#include "vector3_parallel.hpp"
+#include "vector3_simd.hpp"
+#include "vector_expr.hpp"
+#include "vector_grid.hpp"
+#include "vector_half.hpp"
+#include "vector_bvh.hpp"
+#include "vector_kdtree.hpp"
+#include "vector_memory.hpp"
+#include "vector_order.hpp"
+#include "vector_predicates.hpp"
+#include "vector_ray_packet.hpp"
+#include "vector_reduce.hpp"
+#include "vector_soa.hpp"
+#include "vector_text.hpp"
+#include "vector_transform.hpp"
+
+/* Inputs */
+
+template <typename T>
+inline T bench_value(std::uint32_t& seed)      // Deterministic values in [-1, 1), never exactly zero
+{
+    seed = seed * 1664525u + 1013904223u;
+    return T(int(seed >> 8) - (1 << 23) + 1) / T(1 << 23) + T(1) / T(1 << 20);
+}
+
+template <typename V> struct bench_traits;
+
+template <typename T>
+struct bench_traits<vector2<T>>
+{
+    using scalar = T;
+    static constexpr bool is_vector3 = false;
+    static std::string name() { return sizeof(T) == 4 ? "vector2<float>" : "vector2<double>"; }
+    static vector2<T> make(std::uint32_t& s) { const T x = bench_value<T>(s); return vector2<T>(x, bench_value<T>(s)); }
+};
+
+template <typename T>
+struct bench_traits<vector3<T>>
+{
+    using scalar = T;
+    static constexpr bool is_vector3 = true;
+    static std::string name() { return sizeof(T) == 4 ? "vector3<float>" : "vector3<double>"; }
+    static vector3<T> make(std::uint32_t& s)
+    {
+        const T x = bench_value<T>(s);
+        const T y = bench_value<T>(s);
+        return vector3<T>(x, y, bench_value<T>(s));
+    }
+};
+
+template <typename T>
+struct bench_traits<vector4<T>>
+{
+    using scalar = T;
+    static constexpr bool is_vector3 = false;
+    static std::string name() { return sizeof(T) == 4 ? "vector4<float>" : "vector4<double>"; }
+    static vector4<T> make(std::uint32_t& s)
+    {
+        const T x = bench_value<T>(s);
+        const T y = bench_value<T>(s);
+        const T z = bench_value<T>(s);
+        return vector4<T>(x, y, z, bench_value<T>(s));
+    }
+};
+
+template <typename V>
+std::vector<V> bench_array(std::size_t n, std::uint32_t seed)
+{
+    std::vector<V> v(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v[i] = bench_traits<V>::make(seed);
+    return v;
+}
+
+template <typename R>
+using bench_storage = typename std::conditional<std::is_same<R, bool>::value, unsigned char, R>::type;
+
+/* Drivers */
+
+template <typename V, typename Op>
+void bench_latency(benchmark::State& state, Op op)
+{
+    std::uint32_t seed = 1;
+    V a = bench_traits<V>::make(seed);
+    V b = bench_traits<V>::make(seed);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        auto r = op(a, b);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+template <typename V, typename Op>
+void bench_throughput(benchmark::State& state, Op op)
+{
+    using R = bench_storage<decltype(op(V(), V()))>;
+    const std::size_t n = std::size_t(state.range(0));
+    const std::vector<V> a = bench_array<V>(n, 1);
+    const std::vector<V> b = bench_array<V>(n, 2);
+    std::vector<R> out(n);
+
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = R(op(a[i], b[i]));
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(std::int64_t(state.iterations()) * std::int64_t(n));
+    state.SetBytesProcessed(std::int64_t(state.iterations()) * std::int64_t(n * (2 * sizeof(V) + sizeof(R))));
+}
+
+template <typename V, typename Op>
+void bench_op(const char* op_name, Op op)
+{
+    const std::string base = bench_traits<V>::name() + "/" + op_name;
+    benchmark::RegisterBenchmark((base + "/latency").c_str(), [op](benchmark::State& s) { bench_latency<V>(s, op); });
+    benchmark::RegisterBenchmark((base + "/throughput").c_str(), [op](benchmark::State& s) { bench_throughput<V>(s, op); })
+        ->RangeMultiplier(8)->Range(64, 1 << 21);
+}
+
+/* Per type operation list */
+
+template <typename V>
+void register_vector_ops()
+{
+    bench_op<V>("is_zero",          [](const V& a, const V&) { return a.is_zero(); });
+    bench_op<V>("is_almost_zero",   [](const V& a, const V&) { return a.is_almost_zero(); });
+    bench_op<V>("is_any_zero",      [](const V& a, const V&) { return a.is_any_zero(); });
+    bench_op<V>("operator==",       [](const V& a, const V& b) { return a == b; });
+    bench_op<V>("operator!=",       [](const V& a, const V& b) { return a != b; });
+
+    bench_op<V>("operator+=",       [](V a, const V& b) { a += b; return a; });
+    bench_op<V>("operator+=scalar", [](V a, const V& b) { a += b.x; return a; });
+    bench_op<V>("operator-=",       [](V a, const V& b) { a -= b; return a; });
+    bench_op<V>("operator-=scalar", [](V a, const V& b) { a -= b.x; return a; });
+    bench_op<V>("operator*=",       [](V a, const V& b) { a *= b; return a; });
+    bench_op<V>("operator*=scalar", [](V a, const V& b) { a *= b.x; return a; });
+    bench_op<V>("operator/=",       [](V a, const V& b) { a /= b; return a; });
+    bench_op<V>("operator/=scalar", [](V a, const V& b) { a /= b.x; return a; });
+
+    bench_op<V>("operator-unary",   [](const V& a, const V&) { return -a; });
+    bench_op<V>("operator+",        [](const V& a, const V& b) { return a + b; });
+    bench_op<V>("operator-",        [](const V& a, const V& b) { return a - b; });
+    bench_op<V>("operator*",        [](const V& a, const V& b) { return a * b; });
+    bench_op<V>("operator*scalar",  [](const V& a, const V& b) { return a * b.x; });
+    bench_op<V>("scalar*operator",  [](const V& a, const V& b) { return b.x * a; });
+    bench_op<V>("operator/",        [](const V& a, const V& b) { return a / b; });
+    bench_op<V>("operator/scalar",  [](const V& a, const V& b) { return a / b.x; });
+
+    bench_op<V>("lengthsqr",        [](const V& a, const V&) { return a.lengthsqr(); });
+    bench_op<V>("length",           [](const V& a, const V&) { return a.length(); });
+    bench_op<V>("normalize_this",   [](V a, const V&) { a.normalize_this(); return a; });
+    bench_op<V>("normalize",        [](const V& a, const V&) { return a.normalize(); });
+    bench_op<V>("normalize_fast",   [](const V& a, const V&) { return a.normalize_fast(); });
+    bench_op<V>("normalize_safe",   [](const V& a, const V&) { return a.normalize_safe(); });
+    bench_op<V>("distance",         [](const V& a, const V& b) { return a.distance(b); });
+    bench_op<V>("dot",              [](const V& a, const V& b) { return a.dot(b); });
+    bench_op<V>("lengthsqr_fma",    [](const V& a, const V&) { return a.lengthsqr_fma(); });
+    bench_op<V>("distance_fma",     [](const V& a, const V& b) { return a.distance_fma(b); });
+    bench_op<V>("dot_fma",          [](const V& a, const V& b) { return a.dot_fma(b); });
+    bench_op<V>("madd",             [](const V& a, const V& b) { return madd(a, b, b); });
+    bench_op<V>("lerp",             [](const V& a, const V& b) { return lerp(a, b, b.x); });
+
+    bench_op<V>("is_perpendicular", [](const V& a, const V& b) { return a.is_perpendicular(b); });
+    bench_op<V>("is_opposite",      [](const V& a, const V& b) { return a.is_opposite(b); });
+    bench_op<V>("opposite_this",    [](V a, const V&) { a.opposite_this(); return a; });
+    bench_op<V>("opposite",         [](const V& a, const V&) { return a.opposite(); });
+    bench_op<V>("is_collinear",     [](const V& a, const V& b) { return a.is_collinear(b); });
+    bench_op<V>("collinear_this",   [](V a, const V& b) { a.collinear_this(b.x); return a; });
+    bench_op<V>("collinear",        [](const V& a, const V& b) { return a.collinear(b.x); });
+    bench_op<V>("is_anticollinear", [](const V& a, const V& b) { return a.is_anticollinear(b); });
+    bench_op<V>("anticollinear_this", [](V a, const V& b) { a.anticollinear_this(b.x); return a; });
+    bench_op<V>("anticollinear",    [](const V& a, const V& b) { return a.anticollinear(b.x); });
+
+    if constexpr (bench_traits<V>::is_vector3)
+    {
+        bench_op<V>("xy.lengthsqr",       [](const V& a, const V&) { return a.xy().lengthsqr(); });
+        bench_op<V>("xz.lengthsqr",       [](const V& a, const V&) { return a.xz().lengthsqr(); });
+        bench_op<V>("yz.lengthsqr",       [](const V& a, const V&) { return a.yz().lengthsqr(); });
+        bench_op<V>("xy.length",          [](const V& a, const V&) { return a.xy().length(); });
+        bench_op<V>("xz.length",          [](const V& a, const V&) { return a.xz().length(); });
+        bench_op<V>("yz.length",          [](const V& a, const V&) { return a.yz().length(); });
+        bench_op<V>("xz.distance",        [](const V& a, const V& b) { return a.xz().distance(b.xz()); });
+        bench_op<V>("zyx",                [](const V& a, const V&) { return a.zyx(); });
+        bench_op<V>("set_xz",             [](V a, const V& b) { a.set_xz(b.zx()); return a; });
+        bench_op<V>("cross",              [](const V& a, const V& b) { return a.cross(b); });
+        bench_op<V>("cross_fma",          [](const V& a, const V& b) { return a.cross_fma(b); });
+        bench_op<V>("perpendicular_this", [](V a, const V& b) { a.perpendicular_this(b); return a; });
+        bench_op<V>("perpendicular",      [](V a, const V& b) { return a.perpendicular(b); });
+        bench_op<V>("angle",              [](const V& a, const V& b) { return angle(a, b); });
+        bench_op<V>("rotate",             [](const V& a, const V& b) { return rotate(a, b, b.x); });
+        bench_op<V>("slerp",              [](const V& a, const V& b) { return slerp(a, b, b.x); });
+        bench_op<V>("to_spherical",       [](const V& a, const V&) { return to_spherical(a); });
+        bench_op<V>("from_spherical",     [](const V& a, const V&) { return from_spherical(a); });
+    }
+}
+
+/* Batch APIs */
+
+inline const char* simd_level_name(simd_level l)
+{
+    switch (l)
+    {
+    case simd_level::scalar: return "scalar";
+    case simd_level::sse41:  return "sse41";
+    case simd_level::avx2:   return "avx2";
+    case simd_level::avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+template <typename T, typename Op>
+void bench_batch(const std::string& name, simd_level level, Op op)
+{
+    benchmark::RegisterBenchmark(name.c_str(), [level, op](benchmark::State& state)
+    {
+        const std::size_t n = std::size_t(state.range(0));
+        const std::vector<vector3<T>> a = bench_array<vector3<T>>(n, 1);
+        const std::vector<vector3<T>> b = bench_array<vector3<T>>(n, 2);
+        std::vector<vector3<T>> out(n);
+        std::vector<T> s(n);
+
+        set_simd_level(level);
+        for (auto _ : state)
+        {
+            op(a, b, out, s);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::DoNotOptimize(s.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(std::int64_t(state.iterations()) * std::int64_t(n));
+    })->RangeMultiplier(8)->Range(64, 1 << 21);
+}
+
+template <typename T>
+void register_batch_ops()
+{
+    using A = std::vector<vector3<T>>;
+    using S = std::vector<T>;
+    const std::string type = bench_traits<vector3<T>>::name();
+
+    for (int l = 0; l <= int(detect_simd_level()); ++l)
+    {
+        const simd_level level = simd_level(l);
+        const std::string base = "batch/" + type + "/" + simd_level_name(level) + "/";
+
+        bench_batch<T>(base + "add",            level, [](const A& a, const A& b, A& o, S&) { batch_add(a, b, o); });
+        bench_batch<T>(base + "sub",            level, [](const A& a, const A& b, A& o, S&) { batch_sub(a, b, o); });
+        bench_batch<T>(base + "mul",            level, [](const A& a, const A& b, A& o, S&) { batch_mul(a, b, o); });
+        bench_batch<T>(base + "scale",          level, [](const A& a, const A&, A& o, S&) { batch_scale(a, T(2), o); });
+        bench_batch<T>(base + "dot",            level, [](const A& a, const A& b, A&, S& s) { batch_dot(a, b, s); });
+        bench_batch<T>(base + "cross",          level, [](const A& a, const A& b, A& o, S&) { batch_cross(a, b, o); });
+        bench_batch<T>(base + "normalize",      level, [](const A& a, const A&, A& o, S&) { batch_normalize(a, o); });
+        bench_batch<T>(base + "normalize_fast", level, [](const A& a, const A&, A& o, S&) { batch_normalize_fast(a, o); });
+        bench_batch<T>(base + "normalize_safe", level, [](const A& a, const A&, A& o, S&) { batch_normalize_safe(a, o); });
+        bench_batch<T>(base + "length",         level, [](const A& a, const A&, A&, S& s) { batch_length(a, s); });
+        bench_batch<T>(base + "madd",           level, [](const A& a, const A& b, A& o, S&) { batch_madd(a, b, o, o); });
+        bench_batch<T>(base + "madd_scale",     level, [](const A& a, const A&, A& o, S&) { batch_madd(a, T(0.5), o, o); });
+        bench_batch<T>(base + "lerp",           level, [](const A& a, const A& b, A& o, S&) { batch_lerp(a, b, T(0.25), o); });
+        bench_batch<T>(base + "dot_fma",        level, [](const A& a, const A& b, A&, S& s) { batch_dot_fma(a, b, s); });
+        bench_batch<T>(base + "cross_fma",      level, [](const A& a, const A& b, A& o, S&) { batch_cross_fma(a, b, o); });
+    }
+}
+
+template <typename T>
+const std::vector<quaternion<T>>& bench_rotations()     // One per element of the largest batch array
+{
+    static const std::vector<quaternion<T>> q = []
+    {
+        const std::vector<vector3<T>> axis = bench_array<vector3<T>>(1 << 21, 3);
+        std::vector<quaternion<T>> r(axis.size());
+        for (std::size_t i = 0; i < r.size(); ++i)
+            r[i] = quaternion<T>::from_axis_angle(axis[i].normalize(), T(4) * axis[i].x);
+        return r;
+    }();
+    return q;
+}
+
+template <typename T>
+const std::vector<dual_quaternion<T>>& bench_motions()      // Rigid motions, one per element of the largest batch array
+{
+    static const std::vector<dual_quaternion<T>> d = []
+    {
+        const std::vector<quaternion<T>>& q = bench_rotations<T>();
+        const std::vector<vector3<T>> t = bench_array<vector3<T>>(q.size(), 4);
+        std::vector<dual_quaternion<T>> r;
+        r.reserve(q.size());
+        for (std::size_t i = 0; i < q.size(); ++i)
+            r.emplace_back(q[i], t[i]);
+        return r;
+    }();
+    return d;
+}
+
+template <typename T>
+void register_transform_ops()       // Items are vectors transformed
+{
+    using A = std::vector<vector3<T>>;
+    using S = std::vector<T>;
+    using Q = quaternion<T>;
+    using D = dual_quaternion<T>;
+    const std::string type = bench_traits<vector3<T>>::name();
+    const matrix4<T> m = matrix4<T>::translation(vector3<T>(T(1), T(2), T(3))) * matrix4<T>::rotation(vector3<T>(T(0), T(0.6), T(0.8)), T(0.5));
+    const matrix3<T> n = normal_matrix(m);
+    const std::span<const Q> q = bench_rotations<T>();      // Built here, outside the timed loops
+    const std::span<const D> d = bench_motions<T>();
+
+    bench_batch<T>("transform/" + type + "/points_loop", detect_simd_level(), [m](const A& a, const A&, A& o, S&)
+    {
+        for (std::size_t i = 0; i < a.size(); ++i)
+            o[i] = m.transform_point(a[i]);
+    });
+    bench_batch<T>("transform/" + type + "/rotate_each_loop", detect_simd_level(), [q](const A& a, const A&, A& o, S&)
+    {
+        for (std::size_t i = 0; i < a.size(); ++i)
+            o[i] = q[i].rotate(a[i]);
+    });
+
+    for (int l = 0; l <= int(detect_simd_level()); ++l)
+    {
+        const simd_level level = simd_level(l);
+        const std::string base = "transform/" + type + "/" + simd_level_name(level) + "/";
+
+        bench_batch<T>(base + "points",      level, [m](const A& a, const A&, A& o, S&) { batch_transform_points(m, a, o); });
+        bench_batch<T>(base + "normals",     level, [n](const A& a, const A&, A& o, S&) { batch_transform_normals(n, a, o); });
+        bench_batch<T>(base + "rotate",      level, [q](const A& a, const A&, A& o, S&) { batch_rotate(q[0], a, o); });
+        bench_batch<T>(base + "rotate_each", level, [q](const A& a, const A&, A& o, S&) { batch_rotate(q.first(a.size()), a, o); });
+        bench_batch<T>(base + "dual_each",   level, [d](const A& a, const A&, A& o, S&) { batch_transform_points(d.first(a.size()), a, o); });
+    }
+    bench_batch<T>("transform/" + type + "/points_parallel", detect_simd_level(), [m](const A& a, const A&, A& o, S&) { batch_transform_points(m, a, o, &parallel_pool()); });
+}
+
+template <typename T>
+void register_parallel_ops()        // On the default pool, every hardware thread
+{
+    using A = std::vector<vector3<T>>;
+    using S = std::vector<T>;
+    const simd_level level = detect_simd_level();
+    const std::string base = "parallel/" + bench_traits<vector3<T>>::name() + "/";
+
+    bench_batch<T>(base + "normalize", level, [](const A& a, const A&, A& o, S&) { parallel_normalize(a, o); });
+    bench_batch<T>(base + "transform", level, [](const A& a, const A&, A& o, S&) { parallel_transform(a, o, [](const vector3<T>& v) { return v.normalize_safe(); }); });
+    bench_batch<T>(base + "dot_sum",   level, [](const A& a, const A& b, A&, S& s) { s[0] = parallel_dot_sum(a, b); });
+    bench_batch<T>(base + "bounds",    level, [](const A& a, const A&, A& o, S&) { o[0] = parallel_bounds(a).first; });
+    bench_batch<T>(base + "centroid",  level, [](const A& a, const A&, A& o, S&) { o[0] = parallel_centroid(a); });
+}
+
+template <typename T>
+void register_reduce_ops()          // Naive operator+= loop against the compensated reductions
+{
+    using A = std::vector<vector3<T>>;
+    using S = std::vector<T>;
+    const simd_level level = detect_simd_level();
+    const std::string base = "reduce/" + bench_traits<vector3<T>>::name() + "/";
+
+    bench_batch<T>(base + "sum_naive",     level, [](const A& a, const A&, A& o, S&) { vector3<T> r(T(0)); for (const vector3<T>& v : a) r += v; o[0] = r; });
+    bench_batch<T>(base + "sum",           level, [](const A& a, const A&, A& o, S&) { o[0] = reduce_sum(a); });
+    bench_batch<T>(base + "sum_parallel",  level, [](const A& a, const A&, A& o, S&) { o[0] = reduce_sum(a, &parallel_pool()); });
+    bench_batch<T>(base + "weighted_sum",  level, [](const A& a, const A&, A& o, S& s) { o[0] = reduce_weighted_sum(a, s); });
+    bench_batch<T>(base + "dot",           level, [](const A& a, const A& b, A&, S& s) { s[0] = reduce_dot(a, b); });
+    bench_batch<T>(base + "covariance",    level, [](const A& a, const A&, A&, S& s) { s[0] = reduce_covariance(a)[0][0]; });
+}
+
+template <typename T, typename Op>
+void bench_soa(const std::string& name, Op op)
+{
+    benchmark::RegisterBenchmark(name.c_str(), [op](benchmark::State& state)
+    {
+        const std::size_t n = std::size_t(state.range(0));
+        const std::vector<vector3<T>> aos_a = bench_array<vector3<T>>(n, 1);
+        const std::vector<vector3<T>> aos_b = bench_array<vector3<T>>(n, 2);
+        vector3_soa<T> a(aos_a.data(), n);
+        const vector3_soa<T> b(aos_b.data(), n);
+        vector3_soa<T> o(n);
+        std::vector<T> s(n);
+
+        for (auto _ : state)
+        {
+            op(a, b, o, s);
+            benchmark::DoNotOptimize(o.x_ptr());
+            benchmark::DoNotOptimize(s.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(std::int64_t(state.iterations()) * std::int64_t(n));
+    })->RangeMultiplier(8)->Range(64, 1 << 21);
+}
+
+template <typename T>
+void register_soa_ops()
+{
+    using A = vector3_soa<T>;
+    using S = std::vector<T>;
+    const std::string base = "soa/" + bench_traits<vector3<T>>::name() + "/";
+
+    bench_soa<T>(base + "operator+=",     [](A& a, const A& b, A&, S&) { a += b; });
+    bench_soa<T>(base + "operator*=",     [](A& a, const A&, A&, S&) { a *= T(1); });
+    bench_soa<T>(base + "dot",            [](A& a, const A& b, A&, S& s) { dot(a, b, s.data()); });
+    bench_soa<T>(base + "cross",          [](A& a, const A& b, A& o, S&) { cross(a, b, o); });
+    bench_soa<T>(base + "distance",       [](A& a, const A& b, A&, S& s) { distance(a, b, s.data()); });
+    bench_soa<T>(base + "lengthsqr",      [](A& a, const A&, A&, S& s) { a.lengthsqr(s.data()); });
+    bench_soa<T>(base + "length",         [](A& a, const A&, A&, S& s) { a.length(s.data()); });
+    bench_soa<T>(base + "normalize_this", [](A& a, const A&, A&, S&) { a.normalize_this(); });
+
+    // a + b * s - a * b, eager temporaries against one fused expression pass
+    bench_soa<T>(base + "expr_eager",     [](A& a, const A& b, A& o, S&) { o = a + b * T(0.5) - a * b; });
+    bench_soa<T>(base + "expr_fused",     [](A& a, const A& b, A& o, S&) { assign(o, lazy(a) + lazy(b) * T(0.5) - lazy(a) * lazy(b)); });
+}
+
+template <typename Op>
+void bench_codec(const std::string& name, Op op)
+{
+    benchmark::RegisterBenchmark(name.c_str(), [op](benchmark::State& state)
+    {
+        const std::size_t n = std::size_t(state.range(0));
+        std::vector<vector3<float>> a = bench_array<vector3<float>>(n, 1);
+        for (vector3<float>& v : a)
+            v.normalize_safe_this();
+        std::vector<vector3<float>> out(n);
+        std::vector<vector_oct32> oct(n);
+        std::vector<vector3_q16> q(n);
+        const vector3_quantizer qz(vector3<float>(-1.0f), vector3<float>(1.0f));
+        batch_oct_encode(a, oct);
+        batch_quantize(qz, a, q);
+
+        set_simd_level(detect_simd_level());
+        for (auto _ : state)
+        {
+            op(a, oct, q, qz, out);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::DoNotOptimize(oct.data());
+            benchmark::DoNotOptimize(q.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(std::int64_t(state.iterations()) * std::int64_t(n));
+    })->RangeMultiplier(8)->Range(64, 1 << 21);
+}
+
+void register_codec_ops()
+{
+    using A = std::vector<vector3<float>>;
+    using O = std::vector<vector_oct32>;
+    using Q = std::vector<vector3_q16>;
+    using Z = vector3_quantizer;
+
+    bench_codec("codec/oct32_encode", [](const A& a, O& o, Q&, const Z&, A&) { batch_oct_encode(a, o); });
+    bench_codec("codec/oct32_decode", [](const A&, O& o, Q&, const Z&, A& out) { batch_oct_decode(o, out); });
+    bench_codec("codec/quantize",     [](const A& a, O&, Q& q, const Z& z, A&) { batch_quantize(z, a, q); });
+    bench_codec("codec/dequantize",   [](const A&, O&, Q& q, const Z& z, A& out) { batch_dequantize(z, q, out); });
+    bench_codec("codec/delta_encode", [](const A&, O&, Q& q, const Z&, A&) { std::vector<std::uint8_t> b; delta_encode(q, b); benchmark::DoNotOptimize(b.data()); });
+}
+
+template <typename Op>
+void bench_predicate(const std::string& name, simd_level level, bool degenerate, Op op)
+{
+    benchmark::RegisterBenchmark(name.c_str(), [level, degenerate, op](benchmark::State& state)
+    {
+        const std::size_t n = std::size_t(state.range(0));
+        const std::vector<vector3<double>> a = bench_array<vector3<double>>(n, 11);      // Seeds 1 .. 4 give correlated
+        const std::vector<vector3<double>> b = bench_array<vector3<double>>(n, 47);      // points, with a sixth of the
+        const std::vector<vector3<double>> c = bench_array<vector3<double>>(n, 97);      // orient3d cases near degenerate
+        std::vector<vector3<double>> d = bench_array<vector3<double>>(n, 173);
+        if (degenerate)         // On the line a b, so every case needs the exact arithmetic
+            for (std::size_t i = 0; i < n; ++i)
+                d[i] = a[i] + (b[i] - a[i]) * 0.375;
+        std::vector<vector2<double>> a2(n), b2(n), c2(n), d2(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            a2[i] = vector2<double>(a[i].x, a[i].y);
+            b2[i] = vector2<double>(b[i].x, b[i].y);
+            c2[i] = degenerate ? vector2<double>(d[i].x, d[i].y) : vector2<double>(c[i].x, c[i].y);
+            d2[i] = vector2<double>(d[i].x, d[i].y);
+        }
+        std::vector<std::uint64_t> mask((n + 63) / 64);
+
+        set_simd_level(level);
+        for (auto _ : state)
+        {
+            op(a, b, c, d, a2, b2, c2, d2, mask);
+            benchmark::DoNotOptimize(mask.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(std::int64_t(state.iterations()) * std::int64_t(n));
+    })->RangeMultiplier(16)->Range(64, 1 << 20);
+}
+
+void register_predicate_ops()       // Items are predicates evaluated, double inputs
+{
+    using P = std::vector<vector3<double>>;
+    using Q = std::vector<vector2<double>>;
+    using M = std::vector<std::uint64_t>;
+
+    bench_predicate("predicates/orient3d_loop", detect_simd_level(), false, [](const P& a, const P& b, const P& c, const P& d, const Q&, const Q&, const Q&, const Q&, M& m)
+    {
+        for (std::size_t i = 0; i < a.size(); ++i)
+            m[i / 64] |= std::uint64_t(orient3d(a[i], b[i], c[i], d[i]) > 0.0) << (i % 64);
+    });
+    for (int l = 0; l <= int(detect_simd_level()); ++l)
+    {
+        const simd_level level = simd_level(l);
+        const std::string base = std::string("predicates/") + simd_level_name(level) + "/";
+
+        bench_predicate(base + "orient2d",     level, false, [](const P&, const P&, const P&, const P&, const Q& a, const Q& b, const Q& c, const Q&, M& m) { batch_orient2d(a, b, c, m); });
+        bench_predicate(base + "orient3d",     level, false, [](const P& a, const P& b, const P& c, const P& d, const Q&, const Q&, const Q&, const Q&, M& m) { batch_orient3d(a, b, c, d, m); });
+        bench_predicate(base + "orient3d_eps", level, false, [](const P& a, const P& b, const P& c, const P& d, const Q&, const Q&, const Q&, const Q&, M& m) { batch_orient3d_eps(a, b, c, d, 1e-12, m); });
+        bench_predicate(base + "incircle",     level, false, [](const P&, const P&, const P&, const P&, const Q& a, const Q& b, const Q& c, const Q& d, M& m) { batch_incircle(a, b, c, d, m); });
+    }
+    bench_predicate("predicates/orient2d_degenerate", detect_simd_level(), true, [](const P&, const P&, const P&, const P&, const Q& a, const Q& b, const Q& c, const Q&, M& m) { batch_orient2d(a, b, c, m); });
+    bench_predicate("predicates/orient3d_degenerate", detect_simd_level(), true, [](const P& a, const P& b, const P& c, const P& d, const Q&, const Q&, const Q&, const Q&, M& m) { batch_orient3d(a, b, c, d, m); });
+}
+
+constexpr std::size_t bench_rays = 64;      // Rays per ray benchmark, a multiple of every packet width
+
+template <typename T, typename Op>
+void bench_ray(const std::string& name, simd_level level, Op op)
+{
+    benchmark::RegisterBenchmark(name.c_str(), [level, op](benchmark::State& state)
+    {
+        const std::size_t n = std::size_t(state.range(0));
+        const std::vector<vector3<T>> c = bench_array<vector3<T>>(n, 11);          // Small triangles scattered in the unit cube
+        const std::vector<vector3<T>> e = bench_array<vector3<T>>(2 * n, 47);
+        std::vector<vector3<T>> v(3 * n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            v[3 * i] = c[i];
+            v[3 * i + 1] = c[i] + e[2 * i] * T(0.1);
+            v[3 * i + 2] = c[i] + e[2 * i + 1] * T(0.1);
+        }
+        const triangle_soa<T> tris(v.data(), n);
+        const std::vector<vector3<T>> o = bench_array<vector3<T>>(bench_rays, 97);
+        const std::vector<vector3<T>> d = bench_array<vector3<T>>(bench_rays, 173);
+        std::vector<ray<T>> rays;
+        for (std::size_t i = 0; i < bench_rays; ++i)
+            rays.emplace_back(o[i] * T(2), d[i] - o[i]);        // Through the cube, some hit and some miss
+        std::vector<ray_hit<T>> hits(bench_rays);
+
+        set_simd_level(level);
+        for (auto _ : state)
+        {
+            op(v, tris, rays, hits);
+            benchmark::DoNotOptimize(hits.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(std::int64_t(state.iterations()) * std::int64_t(n * bench_rays));
+    })->RangeMultiplier(8)->Range(64, 1 << 15);
+}
+
+template <typename T>
+void register_ray_ops()             // Items are ray triangle tests, bench_rays rays against every triangle
+{
+    using V = std::vector<vector3<T>>;
+    using R = std::vector<ray<T>>;
+    using H = std::vector<ray_hit<T>>;
+    constexpr int W = 16 / sizeof(T);       // The packet width of the baseline SSE2 build
+    const std::string type = sizeof(T) == 4 ? "float" : "double";
+
+    bench_ray<T>("ray/" + type + "/closest_loop", detect_simd_level(), [](const V& v, const triangle_soa<T>&, const R& rays, H& hits)
+    {
+        for (std::size_t r = 0; r < rays.size(); ++r)
+        {
+            ray_hit<T> h{ ray_miss, std::numeric_limits<T>::infinity(), T(0), T(0) };
+            for (std::size_t i = 0; i < v.size() / 3; ++i)
+            {
+                T t, u, w;
+                if (intersect_triangle(rays[r], v[3 * i], v[3 * i + 1], v[3 * i + 2], t, u, w) && t < h.t)
+                    h = ray_hit<T>{ std::uint32_t(i), t, u, w };
+            }
+            hits[r] = h;
+        }
+    });
+    bench_ray<T>("ray/" + type + "/closest_packet", detect_simd_level(), [](const V&, const triangle_soa<T>& tris, const R& rays, H& hits)
+    {
+        for (std::size_t r = 0; r < rays.size(); r += W)
+            closest_hit(ray_packet<T, W>(rays.data() + r), tris, hits.data() + r);
+    });
+    for (int l = 0; l <= int(detect_simd_level()); ++l)
+    {
+        const simd_level level = simd_level(l);
+        const std::string base = "ray/" + type + "/" + simd_level_name(level) + "/";
+
+        bench_ray<T>(base + "closest", level, [](const V&, const triangle_soa<T>& tris, const R& rays, H& hits)
+        {
+            batch_closest_hit(std::span<const ray<T>>(rays), tris, std::span<ray_hit<T>>(hits));
+        });
+        bench_ray<T>(base + "any", level, [](const V&, const triangle_soa<T>& tris, const R& rays, H& hits)
+        {
+            for (std::size_t r = 0; r < rays.size(); ++r)
+                hits[r].index = any_hit(rays[r], tris);
+        });
+    }
+    bench_ray<T>("ray/" + type + "/closest_parallel", detect_simd_level(), [](const V&, const triangle_soa<T>& tris, const R& rays, H& hits)
+    {
+        batch_closest_hit(std::span<const ray<T>>(rays), tris, std::span<ray_hit<T>>(hits), &parallel_pool());
+    });
+}
+
+constexpr std::size_t bench_frame = 16;     // Scratch buffers per frame in the memory benchmarks
+
+template <typename Op>
+void bench_memory(const std::string& name, Op op)
+{
+    benchmark::RegisterBenchmark(name.c_str(), [op](benchmark::State& state)
+    {
+        const std::size_t n = std::size_t(state.range(0));
+        for (auto _ : state)
+            op(n);
+        state.SetItemsProcessed(std::int64_t(state.iterations()) * std::int64_t(bench_frame));
+    })->RangeMultiplier(16)->Range(64, 1 << 16);
+}
+
+void register_memory_ops()          // Items are scratch buffers of n vector3<float>, bench_frame per frame
+{
+    using V = vector3<float>;
+    const auto touch = [](V* p, std::size_t n)
+    {
+        p[0] = V(1.0f, 2.0f, 3.0f);
+        p[n - 1] = p[0];
+        benchmark::DoNotOptimize(p);
+    };
+
+    bench_memory("memory/std_vector", [touch](std::size_t n)
+    {
+        for (std::size_t i = 0; i < bench_frame; ++i)
+        {
+            std::vector<V> b(n);
+            touch(b.data(), n);
+        }
+    });
+    bench_memory("memory/heap_buffer", [touch](std::size_t n)
+    {
+        for (std::size_t i = 0; i < bench_frame; ++i)
+        {
+            vector_buffer<V> b(n);
+            touch(b.data(), n);
+        }
+    });
+    bench_memory("memory/arena_buffer", [touch](std::size_t n)
+    {
+        vector_arena& arena = thread_arena();
+        {
+            std::vector<vector_buffer<V>> frame;        // All alive until the end of the frame
+            frame.reserve(bench_frame);
+            for (std::size_t i = 0; i < bench_frame; ++i)
+            {
+                frame.emplace_back(n, &arena);
+                touch(frame.back().data(), n);
+            }
+        }
+        arena.reset();
+    });
+    bench_memory("memory/pool_buffer", [touch](std::size_t n)
+    {
+        static vector_pool pool((1 << 16) * sizeof(V), bench_frame);
+        for (std::size_t i = 0; i < bench_frame; ++i)
+        {
+            vector_buffer<V> b(n, &pool);
+            touch(b.data(), n);
+        }
+    });
+}
+
+template <typename T, typename Op>
+void bench_aabb(const std::string& name, simd_level level, Op op)
+{
+    benchmark::RegisterBenchmark(name.c_str(), [level, op](benchmark::State& state)
+    {
+        const std::size_t n = std::size_t(state.range(0));
+        const std::vector<vector3<T>> p = bench_array<vector3<T>>(n, 11);
+        const std::vector<vector3<T>> e = bench_array<vector3<T>>(n, 47);
+        const T scale = T(0.5) / std::cbrt(T(n));        // A few overlaps per box at every size
+        std::vector<aabb3<T>> boxes(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const vector3<T> h(std::abs(e[i].x) * scale, std::abs(e[i].y) * scale, std::abs(e[i].z) * scale);
+            boxes[i] = aabb3<T>(p[i] - h, p[i] + h);
+        }
+        std::vector<std::uint64_t> mask((n + 63) / 64);
+        std::vector<aabb_pair> pairs;
+
+        set_simd_level(level);
+        for (auto _ : state)
+        {
+            pairs.clear();
+            op(p, boxes, mask, pairs);
+            benchmark::DoNotOptimize(mask.data());
+            benchmark::DoNotOptimize(pairs.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(std::int64_t(state.iterations()) * std::int64_t(n));
+    })->RangeMultiplier(16)->Range(64, 1 << 20);
+}
+
+template <typename T>
+void register_aabb_ops()            // Items are points or boxes
+{
+    using P = std::vector<vector3<T>>;
+    using B = std::vector<aabb3<T>>;
+    using M = std::vector<std::uint64_t>;
+    using S = std::vector<aabb_pair>;
+    const std::string type = sizeof(T) == 4 ? "float" : "double";
+    static const aabb3<T> query(vector3<T>(T(-0.25)), vector3<T>(T(0.5)));
+
+    bench_aabb<T>("aabb/" + type + "/bounds_loop", detect_simd_level(), [](const P& p, const B&, M&, S&)
+    {
+        aabb3<T> b;
+        for (const vector3<T>& a : p)
+            b.expand(a);
+        benchmark::DoNotOptimize(b);
+    });
+    for (int l = 0; l <= int(detect_simd_level()); ++l)
+    {
+        const simd_level level = simd_level(l);
+        const std::string base = "aabb/" + type + "/" + simd_level_name(level) + "/";
+
+        bench_aabb<T>(base + "bounds", level, [](const P& p, const B&, M&, S&)
+        {
+            aabb3<T> b = batch_bounds(std::span<const vector3<T>>(p));
+            benchmark::DoNotOptimize(b);
+        });
+        bench_aabb<T>(base + "overlaps", level, [](const P&, const B& b, M& m, S&) { batch_overlaps(query, std::span<const aabb3<T>>(b), std::span<std::uint64_t>(m)); });
+        bench_aabb<T>(base + "contains", level, [](const P& p, const B&, M& m, S&) { batch_contains(query, std::span<const vector3<T>>(p), std::span<std::uint64_t>(m)); });
+        bench_aabb<T>(base + "sweep_and_prune", level, [](const P&, const B& b, M&, S& s) { sweep_and_prune(std::span<const aabb3<T>>(b), s); });
+    }
+    bench_aabb<T>("aabb/" + type + "/bounds_parallel", detect_simd_level(), [](const P& p, const B&, M&, S&)
+    {
+        aabb3<T> b = batch_bounds(std::span<const vector3<T>>(p), &parallel_pool());
+        benchmark::DoNotOptimize(b);
+    });
+    bench_aabb<T>("aabb/" + type + "/sweep_and_prune_parallel", detect_simd_level(), [](const P&, const B& b, M&, S& s) { sweep_and_prune(std::span<const aabb3<T>>(b), s, &parallel_pool()); });
+}
+
+template <typename T, typename Op>
+void bench_angle(const std::string& name, simd_level level, Op op)
+{
+    benchmark::RegisterBenchmark(name.c_str(), [level, op](benchmark::State& state)
+    {
+        const std::size_t n = std::size_t(state.range(0));
+        std::vector<vector3<T>> a = bench_array<vector3<T>>(n, 1);
+        std::vector<vector3<T>> b = bench_array<vector3<T>>(n, 2);
+        std::vector<T> x(n), y(n);
+        std::uint32_t seed = 5;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            a[i] = a[i].normalize();
+            b[i] = b[i].normalize();
+            x[i] = T(4) * bench_value<T>(seed);     // Angles of about a turn
+            y[i] = bench_value<T>(seed);
+        }
+        std::vector<vector3<T>> out(n);
+        std::vector<T> s(n), c(n);
+
+        set_simd_level(level);
+        for (auto _ : state)
+        {
+            op(a, b, x, y, out, s, c);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::DoNotOptimize(s.data());
+            benchmark::DoNotOptimize(c.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(std::int64_t(state.iterations()) * std::int64_t(n));
+    })->RangeMultiplier(8)->Range(64, 1 << 21);
+}
+
+template <typename T>
+void register_angle_ops()           // Items are vectors or scalars; the _loop forms call the std functions per element
+{
+    using A = std::vector<vector3<T>>;
+    using S = std::vector<T>;
+    const std::string type = sizeof(T) == 4 ? "float" : "double";
+
+    bench_angle<T>("angle/" + type + "/sin_cos_loop", detect_simd_level(), [](const A&, const A&, const S& x, const S&, A&, S& s, S& c)
+    {
+        for (std::size_t i = 0; i < x.size(); ++i)
+        {
+            s[i] = std::sin(x[i]);
+            c[i] = std::cos(x[i]);
+        }
+    });
+    bench_angle<T>("angle/" + type + "/angle_loop", detect_simd_level(), [](const A& a, const A& b, const S&, const S&, A&, S& s, S&)
+    {
+        for (std::size_t i = 0; i < a.size(); ++i)
+            s[i] = angle(a[i], b[i]);
+    });
+    bench_angle<T>("angle/" + type + "/slerp_loop", detect_simd_level(), [](const A& a, const A& b, const S&, const S&, A& o, S&, S&)
+    {
+        for (std::size_t i = 0; i < a.size(); ++i)
+            o[i] = slerp(a[i], b[i], T(0.25));
+    });
+    for (int l = 0; l <= int(detect_simd_level()); ++l)
+    {
+        const simd_level level = simd_level(l);
+        const std::string base = "angle/" + type + "/" + simd_level_name(level) + "/";
+
+        bench_angle<T>(base + "sin_cos",        level, [](const A&, const A&, const S& x, const S&, A&, S& s, S& c) { batch_sin_cos(std::span<const T>(x), s, c); });
+        bench_angle<T>(base + "atan2",          level, [](const A&, const A&, const S& x, const S& y, A&, S& s, S&) { batch_atan2(std::span<const T>(y), std::span<const T>(x), s); });
+        bench_angle<T>(base + "acos",           level, [](const A&, const A&, const S&, const S& y, A&, S& s, S&) { batch_acos(std::span<const T>(y), s); });
+        bench_angle<T>(base + "angle",          level, [](const A& a, const A& b, const S&, const S&, A&, S& s, S&) { batch_angle(std::span<const vector3<T>>(a), std::span<const vector3<T>>(b), s); });
+        bench_angle<T>(base + "rotate",         level, [](const A& a, const A& b, const S& x, const S&, A& o, S&, S&) { batch_rotate(std::span<const vector3<T>>(a), std::span<const vector3<T>>(b), std::span<const T>(x), o); });
+        bench_angle<T>(base + "slerp",          level, [](const A& a, const A& b, const S&, const S&, A& o, S&, S&) { batch_slerp(std::span<const vector3<T>>(a), std::span<const vector3<T>>(b), T(0.25), o); });
+        bench_angle<T>(base + "to_spherical",   level, [](const A& a, const A&, const S&, const S&, A& o, S&, S&) { batch_to_spherical(std::span<const vector3<T>>(a), o); });
+        bench_angle<T>(base + "from_spherical", level, [](const A& a, const A&, const S&, const S&, A& o, S&, S&) { batch_from_spherical(std::span<const vector3<T>>(a), o); });
+    }
+}
+
+template <typename S, typename Op>
+void bench_half(const std::string& name, Op op)
+{
+    benchmark::RegisterBenchmark(name.c_str(), [op](benchmark::State& state)
+    {
+        const std::size_t n = std::size_t(state.range(0));
+        std::vector<vector3<float>> a = bench_array<vector3<float>>(n, 1);
+        std::vector<vector3<S>> h(n), out(n);
+        std::vector<float> d(n);
+        batch_convert(std::span<const vector3<float>>(a), std::span<vector3<S>>(h));
+
+        set_simd_level(detect_simd_level());
+        for (auto _ : state)
+        {
+            op(a, h, out, d);
+            benchmark::DoNotOptimize(a.data());
+            benchmark::DoNotOptimize(out.data());
+            benchmark::DoNotOptimize(d.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(std::int64_t(state.iterations()) * std::int64_t(n));
+    })->RangeMultiplier(8)->Range(64, 1 << 21);
+}
+
+template <typename S>
+void register_half_ops(const std::string& type)
+{
+    using A = std::vector<vector3<float>>;
+    using H = std::vector<vector3<S>>;
+    using D = std::vector<float>;
+    const std::string base = "half/" + type + "/";
+
+    bench_half<S>(base + "to_float",   [](A& a, H& h, H&, D&) { batch_convert(std::span<const vector3<S>>(h), std::span<vector3<float>>(a)); });
+    bench_half<S>(base + "from_float", [](A& a, H&, H& o, D&) { batch_convert(std::span<const vector3<float>>(a), std::span<vector3<S>>(o)); });
+    bench_half<S>(base + "add",        [](A&, H& h, H& o, D&) { batch_add(h, h, o); });
+    bench_half<S>(base + "dot",        [](A&, H& h, H&, D& d) { batch_dot(h, h, d); });
+    bench_half<S>(base + "accumulate", [](A& a, H& h, H&, D&) { batch_accumulate(a, h, 1e-3f); });
+}
+
+template <typename Tree, typename Op>
+void bench_spatial(const std::string& name, Op op)
+{
+    benchmark::RegisterBenchmark(name.c_str(), [op](benchmark::State& state)
+    {
+        using T = typename decltype(Tree::points)::value_type::value_type;
+        const std::size_t n = std::size_t(state.range(0));
+        const std::vector<vector3<T>> p = bench_array<vector3<T>>(n, 1);
+        const std::vector<vector3<T>> q = bench_array<vector3<T>>(1024, 2);
+        Tree tree(p);
+        std::vector<vector_neighbor<T>> out(q.size() * 8);
+
+        std::size_t items = 0;
+        for (auto _ : state)
+        {
+            items += op(p, q, tree, out);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(std::int64_t(items));
+    })->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+}
+
+template <typename Tree>
+void register_spatial_ops(const std::string& type)      // Items are points built or queries answered
+{
+    using T = typename decltype(Tree::points)::value_type::value_type;
+    using P = std::vector<vector3<T>>;
+    using O = std::vector<vector_neighbor<T>>;
+    const std::string base = "spatial/" + type + "/" + bench_traits<vector3<T>>::name() + "/";
+
+    bench_spatial<Tree>(base + "build",          [](const P& p, const P&, Tree& t, O&) { t.build(p); return p.size(); });
+    bench_spatial<Tree>(base + "build_parallel", [](const P& p, const P&, Tree& t, O&) { t.build(p, spatial_leaf_size, &parallel_pool()); return p.size(); });
+    bench_spatial<Tree>(base + "knn8",           [](const P&, const P& q, Tree& t, O& o) { t.knn(q, 8, o); return q.size(); });
+    bench_spatial<Tree>(base + "knn8_parallel",  [](const P&, const P& q, Tree& t, O& o) { t.knn(q, 8, o, &parallel_pool()); return q.size(); });
+}
+
+template <std::size_t N, typename Op>
+void bench_grid(const std::string& name, Op op)
+{
+    benchmark::RegisterBenchmark(name.c_str(), [op](benchmark::State& state)
+    {
+        const std::size_t n = std::size_t(state.range(0));
+        std::vector<vector<N, float>> p = bench_array<vector<N, float>>(n, 1);
+        const float r = N == 3 ? std::cbrt(60.0f / (3.14159f * float(n))) : std::sqrt(120.0f / (3.14159f * float(n)));     // About 30 neighbours per point
+        vector_grid<N, float> grid(r);
+        grid.assign(p);
+        std::vector<grid_pair<float>> out;
+
+        for (auto _ : state)
+        {
+            op(p, grid, r, out);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(std::int64_t(state.iterations()) * std::int64_t(n));
+    })->RangeMultiplier(8)->Range(1 << 12, 1 << 18);
+}
+
+template <std::size_t N>
+void register_grid_ops()            // Items are points
+{
+    using P = std::vector<vector<N, float>>;
+    using G = vector_grid<N, float>;
+    using O = std::vector<grid_pair<float>>;
+    const std::string base = "grid/" + bench_traits<vector<N, float>>::name() + "/";
+
+    bench_grid<N>(base + "assign",          [](P& p, G& g, float, O&) { g.assign(p); });
+    bench_grid<N>(base + "move",            [](P& p, G& g, float r, O&) { for (std::uint32_t i = 0; i < p.size(); ++i) { p[i].x += (i & 1 ? 0.1f : -0.1f) * r; g.move(i, p[i]); } });
+    bench_grid<N>(base + "pairs",           [](P&, G& g, float r, O& o) { o.clear(); g.pairs(r, o); });
+    bench_grid<N>(base + "pairs_parallel",  [](P&, G& g, float r, O& o) { o.clear(); g.pairs(r, o, &parallel_pool()); });
+}
+
+template <std::size_t N, typename Op>
+void bench_order(const std::string& name, Op op)
+{
+    benchmark::RegisterBenchmark(name.c_str(), [op](benchmark::State& state)
+    {
+        const std::size_t n = std::size_t(state.range(0));
+        const std::vector<vector<N, float>> p = bench_array<vector<N, float>>(n, 1);
+        std::vector<std::uint64_t> keys(n);
+
+        for (auto _ : state)
+        {
+            op(p, keys);
+            benchmark::DoNotOptimize(keys.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(std::int64_t(state.iterations()) * std::int64_t(n));
+    })->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+}
+
+template <std::size_t N>
+void register_order_ops()           // Items are points
+{
+    using P = std::vector<vector<N, float>>;
+    using K = std::vector<std::uint64_t>;
+    const std::string base = "order/" + bench_traits<vector<N, float>>::name() + "/";
+
+    bench_order<N>(base + "morton_keys",        [](const P& p, K& k) { curve_keys(std::span<const vector<N, float>>(p), std::span<std::uint64_t>(k), space_curve::morton); });
+    bench_order<N>(base + "hilbert_keys",       [](const P& p, K& k) { curve_keys(std::span<const vector<N, float>>(p), std::span<std::uint64_t>(k), space_curve::hilbert); });
+    bench_order<N>(base + "hilbert_order",      [](const P& p, K&) { benchmark::DoNotOptimize(curve_order(std::span<const vector<N, float>>(p)).data()); });
+    bench_order<N>(base + "hilbert_order_parallel", [](const P& p, K&) { benchmark::DoNotOptimize(curve_order(std::span<const vector<N, float>>(p), space_curve::hilbert, &parallel_pool()).data()); });
+}
+
+template <typename T>
+void register_text_ops()            // Bytes per second of text, one thread
+{
+    const std::string base = "text/" + bench_traits<vector3<T>>::name() + "/";
+
+    benchmark::RegisterBenchmark((base + "format").c_str(), [](benchmark::State& state)
+    {
+        const std::vector<vector3<T>> a = bench_array<vector3<T>>(std::size_t(state.range(0)), 1);
+        std::string s;
+        for (auto _ : state)
+        {
+            s.clear();
+            format_vectors(a, s);
+            benchmark::DoNotOptimize(s.data());
+        }
+        state.SetBytesProcessed(std::int64_t(state.iterations()) * std::int64_t(s.size()));
+    })->Arg(1 << 16);
+
+    benchmark::RegisterBenchmark((base + "parse").c_str(), [](benchmark::State& state)
+    {
+        std::string s;
+        format_vectors(bench_array<vector3<T>>(std::size_t(state.range(0)), 1), s);
+        std::vector<vector3<T>> out;
+        for (auto _ : state)
+        {
+            out.clear();
+            parse_vectors<3, T>(s, out);
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetBytesProcessed(std::int64_t(state.iterations()) * std::int64_t(s.size()));
+    })->Arg(1 << 16);
+}
+
+int main(int argc, char** argv)
+{
+    register_vector_ops<vector2<float>>();
+    register_vector_ops<vector2<double>>();
+    register_vector_ops<vector3<float>>();
+    register_vector_ops<vector3<double>>();
+    register_vector_ops<vector4<float>>();
+    register_vector_ops<vector4<double>>();
+    register_batch_ops<float>();
+    register_batch_ops<double>();
+    register_parallel_ops<float>();
+    register_parallel_ops<double>();
+    register_transform_ops<float>();
+    register_transform_ops<double>();
+    register_reduce_ops<float>();
+    register_reduce_ops<double>();
+    register_soa_ops<float>();
+    register_soa_ops<double>();
+    register_spatial_ops<vector3_kdtree<float>>("kdtree");
+    register_spatial_ops<vector3_kdtree<double>>("kdtree");
+    register_spatial_ops<vector3_bvh<float>>("bvh");
+    register_spatial_ops<vector3_bvh<double>>("bvh");
+    register_grid_ops<2>();
+    register_grid_ops<3>();
+    register_order_ops<2>();
+    register_order_ops<3>();
+    register_codec_ops();
+    register_predicate_ops();
+    register_ray_ops<float>();
+    register_ray_ops<double>();
+    register_memory_ops();
+    register_aabb_ops<float>();
+    register_aabb_ops<double>();
+    register_angle_ops<float>();
+    register_angle_ops<double>();
+    register_half_ops<half>("half");
+    register_half_ops<bfloat16>("bfloat16");
+    register_text_ops<float>();
+    register_text_ops<double>();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
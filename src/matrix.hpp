@@ -0,0 +1,482 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+
+#include "vector.hpp"
+
+// Square N x N matrix, N = 3 or 4, over the vector scalars. matrix3 and matrix4 are
+// aliases of this template.
+//
+// Storage is column major, N columns of vector<N, T> with the memory image of a T[N * N],
+// as OpenGL and Vulkan expect it. Vectors are columns: m * v transforms v, and
+// (a * b) * v == a * (b * v) applies b first. A matrix4 used as an affine transform
+// keeps its linear part in the upper left 3 x 3 and the translation in col[3];
+// transform_point and transform_vector take the last row as (0, 0, 0, 1), project_point
+// divides by the w it computes. Rotations are counterclockwise about their axis in a
+// right handed frame. Everything is constexpr except what needs sin and cos.
+
+template <std::size_t N, typename T>
+struct matrix
+{
+    static_assert(N == 3 || N == 4, "matrix supports 3 x 3 or 4 x 4");
+
+    using value_type = T;
+    static constexpr std::size_t dimension = N;
+
+    vector<N, T> col[N];        // Columns, element (i, j) is component i of col[j]
+
+    /* ctors */
+    matrix() = default;
+    constexpr explicit matrix(T diagonal) noexcept;                                                         // diagonal * identity
+    constexpr matrix(const vector<N, T>& c0, const vector<N, T>& c1, const vector<N, T>& c2) noexcept requires (N == 3);
+    constexpr matrix(const vector<N, T>& c0, const vector<N, T>& c1, const vector<N, T>& c2, const vector<N, T>& c3) noexcept requires (N == 4);
+    constexpr matrix(const matrix<3, T>& linear, const vector<3, T>& translation) noexcept requires (N == 4);     // Affine transform
+    template <std::size_t M> requires (N == 3 && M == 4)
+    constexpr explicit matrix(const matrix<M, T>& m) noexcept;                                                  // Upper left 3 x 3
+
+    static constexpr matrix<N, T> identity() noexcept;
+    static constexpr matrix<N, T> scaling(const vector<3, T>& s) noexcept;
+    static constexpr matrix<N, T> translation(const vector<3, T>& t) noexcept requires (N == 4);
+    static matrix<N, T>           rotation(const vector<3, T>& axis, T angle) noexcept;         // axis of unit length, angle in radians
+
+    T* ptr() const noexcept;
+
+    constexpr T&           operator()(std::size_t i, std::size_t j) noexcept;          // Row i, column j
+    constexpr const T&     operator()(std::size_t i, std::size_t j) const noexcept;
+    constexpr vector<N, T> row(std::size_t i) const noexcept;
+
+    /* Equality operators */
+
+    constexpr bool operator==(const matrix<N, T>& m) const noexcept;
+    constexpr bool operator!=(const matrix<N, T>& m) const noexcept;
+
+    /* Compound arithmetic operators */
+
+    constexpr matrix<N, T>& operator+=(const matrix<N, T>& m) noexcept;
+    constexpr matrix<N, T>& operator-=(const matrix<N, T>& m) noexcept;
+    constexpr matrix<N, T>& operator*=(const matrix<N, T>& m) noexcept;    // this = this * m
+    constexpr matrix<N, T>& operator*=(T a) noexcept;
+
+    /* Arithmetic operators */
+
+    constexpr matrix<N, T> operator-(void) const noexcept;
+    constexpr matrix<N, T> operator+(const matrix<N, T>& m) const noexcept;
+    constexpr matrix<N, T> operator-(const matrix<N, T>& m) const noexcept;
+    constexpr matrix<N, T> operator*(const matrix<N, T>& m) const noexcept;
+    constexpr vector<N, T> operator*(const vector<N, T>& v) const noexcept;
+    constexpr matrix<N, T> operator*(T a) const noexcept;
+
+    /* Other operations */
+
+    constexpr T            trace() const noexcept;
+    constexpr T            determinant() const noexcept;
+    constexpr matrix<N, T> transpose() const noexcept;
+    constexpr matrix<N, T> inverse() const noexcept;                        // Undefined for a singular matrix
+    constexpr matrix<N, T> inverse_affine() const noexcept requires (N == 4);     // Inverse of an affine transform, cheaper than inverse()
+
+    constexpr vector<3, T> transform_point(const vector<3, T>& p) const noexcept requires (N == 4);     // m * (p, 1) of an affine transform
+    constexpr vector<3, T> transform_vector(const vector<3, T>& v) const noexcept requires (N == 4);    // m * (v, 0)
+    constexpr vector<3, T> project_point(const vector<3, T>& p) const noexcept requires (N == 4);       // m * (p, 1) divided by its w
+};
+
+/* Non-member functions */
+template <std::size_t N, typename T>
+constexpr matrix<N, T> operator*(std::type_identity_t<T> a, const matrix<N, T>& m) noexcept;
+
+/* I/O operators */
+template <std::size_t N, typename T>
+std::ostream& operator<<(std::ostream& out, const matrix<N, T>& m);
+
+/* Canonical implementations */
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> transpose(const matrix<N, T>& m) noexcept;
+
+template <std::size_t N, typename T>
+constexpr T determinant(const matrix<N, T>& m) noexcept;
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> inverse(const matrix<N, T>& m) noexcept;
+
+template <typename T>
+constexpr matrix<3, T> normal_matrix(const matrix<4, T>& m) noexcept;         // Inverse transpose of the linear part, for transforming normals
+
+/* Internals */
+
+namespace matrix_detail
+{
+
+template <std::size_t N, typename T>
+constexpr T& component(vector<N, T>& v, std::size_t i) noexcept
+{
+    switch (i)
+    {
+    case 0:  return get<0>(v);
+    case 1:  return get<1>(v);
+    case 2:  return get<2>(v);
+    default: return get<N - 1>(v);
+    }
+}
+
+template <std::size_t N, typename T>
+constexpr const T& component(const vector<N, T>& v, std::size_t i) noexcept
+{
+    switch (i)
+    {
+    case 0:  return get<0>(v);
+    case 1:  return get<1>(v);
+    case 2:  return get<2>(v);
+    default: return get<N - 1>(v);
+    }
+}
+
+template <std::size_t N, typename T, typename F>
+constexpr matrix<N, T> generate(F&& f)          // Column j is f(index<j>)
+{
+    matrix<N, T> m;
+    vector_detail::for_each<N>([&](auto j) { m.col[j] = f(j); });
+    return m;
+}
+
+} // namespace matrix_detail
+
+/* ctors */
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T>::matrix(T diagonal) noexcept
+    : matrix(matrix_detail::generate<N, T>([&](auto j) {
+          return vector<N, T>(vector_detail::generate<N, T>([&](auto i) { return i == j ? diagonal : T(0); }));
+      }))
+{
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T>::matrix(const vector<N, T>& c0, const vector<N, T>& c1, const vector<N, T>& c2) noexcept requires (N == 3)
+    : col{ c0, c1, c2 }
+{
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T>::matrix(const vector<N, T>& c0, const vector<N, T>& c1, const vector<N, T>& c2, const vector<N, T>& c3) noexcept requires (N == 4)
+    : col{ c0, c1, c2, c3 }
+{
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T>::matrix(const matrix<3, T>& linear, const vector<3, T>& t) noexcept requires (N == 4)
+    : col{ vector<4, T>(linear.col[0], T(0)), vector<4, T>(linear.col[1], T(0)), vector<4, T>(linear.col[2], T(0)), vector<4, T>(t, T(1)) }
+{
+}
+
+template <std::size_t N, typename T>
+template <std::size_t M> requires (N == 3 && M == 4)
+constexpr matrix<N, T>::matrix(const matrix<M, T>& m) noexcept
+    : col{ vector<3, T>(m.col[0].x, m.col[0].y, m.col[0].z),
+           vector<3, T>(m.col[1].x, m.col[1].y, m.col[1].z),
+           vector<3, T>(m.col[2].x, m.col[2].y, m.col[2].z) }
+{
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> matrix<N, T>::identity() noexcept
+{
+    return matrix<N, T>(T(1));
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> matrix<N, T>::scaling(const vector<3, T>& s) noexcept
+{
+    matrix<N, T> m(T(1));
+    vector_detail::for_each<3>([&](auto i) { get<i>(m.col[i]) = get<i>(s); });
+    return m;
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> matrix<N, T>::translation(const vector<3, T>& t) noexcept requires (N == 4)
+{
+    matrix<N, T> m(T(1));
+    m.col[3] = vector<4, T>(t, T(1));
+    return m;
+}
+
+template <std::size_t N, typename T>
+inline matrix<N, T> matrix<N, T>::rotation(const vector<3, T>& a, T angle) noexcept
+{
+    const T c = std::cos(angle);
+    const T s = std::sin(angle);
+    const T t = T(1) - c;
+    const matrix<3, T> r(vector<3, T>(t * a.x * a.x + c,       t * a.x * a.y + s * a.z, t * a.x * a.z - s * a.y),
+                         vector<3, T>(t * a.x * a.y - s * a.z, t * a.y * a.y + c,       t * a.y * a.z + s * a.x),
+                         vector<3, T>(t * a.x * a.z + s * a.y, t * a.y * a.z - s * a.x, t * a.z * a.z + c));
+    if constexpr (N == 3)
+        return r;
+    else
+        return matrix<4, T>(r, vector<3, T>(T(0)));
+}
+
+template <std::size_t N, typename T>
+inline T* matrix<N, T>::ptr() const noexcept   // Base pointer to the N * N elements, column major
+{
+    return (T*)this;
+}
+
+template <std::size_t N, typename T>
+constexpr T& matrix<N, T>::operator()(std::size_t i, std::size_t j) noexcept
+{
+    return matrix_detail::component(col[j], i);
+}
+
+template <std::size_t N, typename T>
+constexpr const T& matrix<N, T>::operator()(std::size_t i, std::size_t j) const noexcept
+{
+    return matrix_detail::component(col[j], i);
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> matrix<N, T>::row(std::size_t i) const noexcept
+{
+    return vector<N, T>(vector_detail::generate<N, T>([&](auto j) { return matrix_detail::component(col[j], i); }));
+}
+
+/* I/O operators */
+template <std::size_t N, typename T>
+inline std::ostream& operator<<(std::ostream& out, const matrix<N, T>& m)     // Row by row
+{
+    out << "(";
+    for (std::size_t i = 0; i < N; ++i)
+        out << (i ? ", " : "") << m.row(i);
+    out << ")";
+    return out;
+}
+
+/* Equality operators */
+template <std::size_t N, typename T>
+constexpr bool matrix<N, T>::operator==(const matrix<N, T>& m) const noexcept
+{
+    return vector_detail::all<N>([&](auto j) { return col[j] == m.col[j]; });
+}
+
+template <std::size_t N, typename T>
+constexpr bool matrix<N, T>::operator!=(const matrix<N, T>& m) const noexcept
+{
+    return !((*this) == m);
+}
+
+/* Compound arithmetic operators */
+template <std::size_t N, typename T>
+constexpr matrix<N, T>& matrix<N, T>::operator+=(const matrix<N, T>& m) noexcept
+{
+    vector_detail::for_each<N>([&](auto j) { col[j] += m.col[j]; }); return *this;
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T>& matrix<N, T>::operator-=(const matrix<N, T>& m) noexcept
+{
+    vector_detail::for_each<N>([&](auto j) { col[j] -= m.col[j]; }); return *this;
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T>& matrix<N, T>::operator*=(const matrix<N, T>& m) noexcept
+{
+    return (*this) = (*this) * m;
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T>& matrix<N, T>::operator*=(T a) noexcept
+{
+    vector_detail::for_each<N>([&](auto j) { col[j] *= a; }); return *this;
+}
+
+/* Arithmetic operators */
+template <std::size_t N, typename T>
+constexpr matrix<N, T> matrix<N, T>::operator-(void) const noexcept
+{
+    return matrix_detail::generate<N, T>([&](auto j) { return -col[j]; });
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> matrix<N, T>::operator+(const matrix<N, T>& m) const noexcept
+{
+    return matrix_detail::generate<N, T>([&](auto j) { return col[j] + m.col[j]; });
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> matrix<N, T>::operator-(const matrix<N, T>& m) const noexcept
+{
+    return matrix_detail::generate<N, T>([&](auto j) { return col[j] - m.col[j]; });
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> matrix<N, T>::operator*(const matrix<N, T>& m) const noexcept
+{
+    return matrix_detail::generate<N, T>([&](auto j) { return (*this) * m.col[j]; });
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> matrix<N, T>::operator*(const vector<N, T>& v) const noexcept     // ((c0 * v.x + c1 * v.y) + c2 * v.z) + ...
+{
+    vector<N, T> r = col[0] * v.x;
+    vector_detail::for_each<N>([&](auto j) { if constexpr (j > 0) r += col[j] * get<j>(v); });
+    return r;
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> matrix<N, T>::operator*(T a) const noexcept
+{
+    return matrix_detail::generate<N, T>([&](auto j) { return col[j] * a; });
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> operator*(std::type_identity_t<T> a, const matrix<N, T>& m) noexcept
+{
+    return m * a;
+}
+
+/* Other operations */
+template <std::size_t N, typename T>
+constexpr T matrix<N, T>::trace() const noexcept
+{
+    return vector_detail::sum<N>([&](auto i) { return get<i>(col[i]); });
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> transpose(const matrix<N, T>& m) noexcept
+{
+    return matrix_detail::generate<N, T>([&](auto j) { return m.row(j); });
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> matrix<N, T>::transpose() const noexcept
+{
+    return ::transpose(*this);
+}
+
+// 4 x 4 determinant and inverse by Laplace expansion over the 2 x 2 minors of the top
+// two rows (s) and the bottom two rows (c).
+
+template <std::size_t N, typename T>
+constexpr T determinant(const matrix<N, T>& m) noexcept
+{
+    if constexpr (N == 3)
+    {
+        return dot(m.col[0], cross(m.col[1], m.col[2]));
+    }
+    else
+    {
+        const T s0 = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+        const T s1 = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+        const T s2 = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+        const T s3 = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+        const T s4 = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+        const T s5 = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+        const T c0 = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+        const T c1 = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+        const T c2 = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+        const T c3 = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+        const T c4 = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+        const T c5 = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+}
+
+template <std::size_t N, typename T>
+constexpr T matrix<N, T>::determinant() const noexcept
+{
+    return ::determinant(*this);
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> inverse(const matrix<N, T>& m) noexcept
+{
+    if constexpr (N == 3)
+    {
+        const vector<3, T> r0 = cross(m.col[1], m.col[2]);     // Rows of the adjugate
+        const vector<3, T> r1 = cross(m.col[2], m.col[0]);
+        const vector<3, T> r2 = cross(m.col[0], m.col[1]);
+        const T inv = T(1) / dot(m.col[0], r0);
+        return transpose(matrix<3, T>(r0 * inv, r1 * inv, r2 * inv));
+    }
+    else
+    {
+        const T s0 = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+        const T s1 = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+        const T s2 = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+        const T s3 = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+        const T s4 = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+        const T s5 = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+        const T c0 = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+        const T c1 = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+        const T c2 = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+        const T c3 = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+        const T c4 = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+        const T c5 = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+        const T inv = T(1) / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+        matrix<4, T> r;
+        r(0, 0) = ( m(1, 1) * c5 - m(1, 2) * c4 + m(1, 3) * c3) * inv;
+        r(0, 1) = (-m(0, 1) * c5 + m(0, 2) * c4 - m(0, 3) * c3) * inv;
+        r(0, 2) = ( m(3, 1) * s5 - m(3, 2) * s4 + m(3, 3) * s3) * inv;
+        r(0, 3) = (-m(2, 1) * s5 + m(2, 2) * s4 - m(2, 3) * s3) * inv;
+        r(1, 0) = (-m(1, 0) * c5 + m(1, 2) * c2 - m(1, 3) * c1) * inv;
+        r(1, 1) = ( m(0, 0) * c5 - m(0, 2) * c2 + m(0, 3) * c1) * inv;
+        r(1, 2) = (-m(3, 0) * s5 + m(3, 2) * s2 - m(3, 3) * s1) * inv;
+        r(1, 3) = ( m(2, 0) * s5 - m(2, 2) * s2 + m(2, 3) * s1) * inv;
+        r(2, 0) = ( m(1, 0) * c4 - m(1, 1) * c2 + m(1, 3) * c0) * inv;
+        r(2, 1) = (-m(0, 0) * c4 + m(0, 1) * c2 - m(0, 3) * c0) * inv;
+        r(2, 2) = ( m(3, 0) * s4 - m(3, 1) * s2 + m(3, 3) * s0) * inv;
+        r(2, 3) = (-m(2, 0) * s4 + m(2, 1) * s2 - m(2, 3) * s0) * inv;
+        r(3, 0) = (-m(1, 0) * c3 + m(1, 1) * c1 - m(1, 2) * c0) * inv;
+        r(3, 1) = ( m(0, 0) * c3 - m(0, 1) * c1 + m(0, 2) * c0) * inv;
+        r(3, 2) = (-m(3, 0) * s3 + m(3, 1) * s1 - m(3, 2) * s0) * inv;
+        r(3, 3) = ( m(2, 0) * s3 - m(2, 1) * s1 + m(2, 2) * s0) * inv;
+        return r;
+    }
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> matrix<N, T>::inverse() const noexcept
+{
+    return ::inverse(*this);
+}
+
+template <std::size_t N, typename T>
+constexpr matrix<N, T> matrix<N, T>::inverse_affine() const noexcept requires (N == 4)
+{
+    const matrix<3, T> l = ::inverse(matrix<3, T>(*this));
+    return matrix<4, T>(l, -(l * vector<3, T>(col[3].x, col[3].y, col[3].z)));
+}
+
+template <typename T>
+constexpr matrix<3, T> normal_matrix(const matrix<4, T>& m) noexcept
+{
+    return transpose(inverse(matrix<3, T>(m)));
+}
+
+template <std::size_t N, typename T>
+constexpr vector<3, T> matrix<N, T>::transform_point(const vector<3, T>& p) const noexcept requires (N == 4)
+{
+    return vector<3, T>(vector_detail::generate<3, T>([&](auto i) {
+        return ((get<i>(col[0]) * p.x + get<i>(col[1]) * p.y) + get<i>(col[2]) * p.z) + get<i>(col[3]);
+    }));
+}
+
+template <std::size_t N, typename T>
+constexpr vector<3, T> matrix<N, T>::transform_vector(const vector<3, T>& v) const noexcept requires (N == 4)
+{
+    return vector<3, T>(vector_detail::generate<3, T>([&](auto i) {
+        return (get<i>(col[0]) * v.x + get<i>(col[1]) * v.y) + get<i>(col[2]) * v.z;
+    }));
+}
+
+template <std::size_t N, typename T>
+constexpr vector<3, T> matrix<N, T>::project_point(const vector<3, T>& p) const noexcept requires (N == 4)
+{
+    const vector<4, T> h = (*this) * vector<4, T>(p, T(1));
+    return vector<3, T>(h.x, h.y, h.z) / h.w;
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef MATRIX3_H
+#define MATRIX3_H
+
+#include <type_traits>
+
+#include "matrix.hpp"
+#include "vector3.hpp"
+
+template <typename T>
+using matrix3 = matrix<3, T>;
+
+/* Layout guarantees relied on by ptr() and the batch transform kernels */
+
+static_assert(std::is_trivially_copyable_v<matrix3<float>> && std::is_standard_layout_v<matrix3<float>>);
+static_assert(std::is_trivially_copyable_v<matrix3<double>> && std::is_standard_layout_v<matrix3<double>>);
+static_assert(sizeof(matrix3<float>) == 9 * sizeof(float) && sizeof(matrix3<double>) == 9 * sizeof(double));
+
+#endif
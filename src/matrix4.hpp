@@ -0,0 +1,19 @@
+#ifndef MATRIX4_H
+#define MATRIX4_H
+
+#include <type_traits>
+
+#include "matrix.hpp"
+#include "matrix3.hpp"
+#include "vector4.hpp"
+
+template <typename T>
+using matrix4 = matrix<4, T>;
+
+/* Layout guarantees relied on by ptr() and the batch transform kernels */
+
+static_assert(std::is_trivially_copyable_v<matrix4<float>> && std::is_standard_layout_v<matrix4<float>>);
+static_assert(std::is_trivially_copyable_v<matrix4<double>> && std::is_standard_layout_v<matrix4<double>>);
+static_assert(sizeof(matrix4<float>) == 16 * sizeof(float) && sizeof(matrix4<double>) == 16 * sizeof(double));
+
+#endif
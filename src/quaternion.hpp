@@ -0,0 +1,457 @@
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#include "matrix3.hpp"
+#include "matrix4.hpp"
+#include "vector3.hpp"
+
+// Rotation quaternions and rigid transform dual quaternions over vector3.
+//
+// quaternion<T> is x i + y j + z k + w, stored x, y, z, w; a unit quaternion rotates
+// by q * v * conjugate(q), the same rotation as to_matrix3(). Products compose like
+// matrices: (a * b).rotate(v) == a.rotate(b.rotate(v)). dual_quaternion<T> is
+// real + eps dual with real the rotation and dual = (t, 0) * real / 2 for the
+// translation t, so transform_point(p) == real.rotate(p) + t. The rotate and
+// transform functions assume unit (normalized) quaternions.
+
+template <typename T>
+struct quaternion
+{
+    T x;
+    T y;
+    T z;
+    T w;
+
+    /* ctors */
+    quaternion() = default;
+    constexpr quaternion(T x_, T y_, T z_, T w_) noexcept;
+    constexpr quaternion(const vector3<T>& v, T w_) noexcept;
+
+    static constexpr quaternion<T> identity() noexcept;
+    static quaternion<T>           from_axis_angle(const vector3<T>& axis, T angle) noexcept;  // axis of unit length, angle in radians
+    static quaternion<T>           from_matrix(const matrix3<T>& m) noexcept;                  // m a rotation matrix
+
+    T* ptr() const noexcept;
+
+    constexpr vector3<T> vec() const noexcept;         // Vector part (x, y, z)
+
+    /* Equality operators */
+
+    constexpr bool operator==(const quaternion<T>& q) const noexcept;
+    constexpr bool operator!=(const quaternion<T>& q) const noexcept;
+
+    /* Arithmetic operators */
+
+    constexpr quaternion<T>& operator*=(const quaternion<T>& q) noexcept;      // this = this * q
+    constexpr quaternion<T>& operator*=(T a) noexcept;
+    constexpr quaternion<T>& operator+=(const quaternion<T>& q) noexcept;
+    constexpr quaternion<T>  operator-(void) const noexcept;
+    constexpr quaternion<T>  operator+(const quaternion<T>& q) const noexcept;
+    constexpr quaternion<T>  operator-(const quaternion<T>& q) const noexcept;
+    constexpr quaternion<T>  operator*(const quaternion<T>& q) const noexcept;  // Hamilton product
+    constexpr quaternion<T>  operator*(T a) const noexcept;
+
+    /* Other operations */
+
+    constexpr T             lengthsqr() const noexcept;
+    constexpr T             length() const noexcept;
+    constexpr quaternion<T> normalize() const noexcept;
+    constexpr quaternion<T> conjugate() const noexcept;
+    constexpr quaternion<T> inverse() const noexcept;
+    constexpr T             dot(const quaternion<T>& q) const noexcept;
+
+    constexpr vector3<T> rotate(const vector3<T>& v) const noexcept;           // v + w t + u x t, t = 2 u x v, u = vec()
+    constexpr matrix3<T> to_matrix3() const noexcept;
+    constexpr matrix4<T> to_matrix4() const noexcept;
+};
+
+template <typename T>
+struct dual_quaternion
+{
+    quaternion<T> real;     // Rotation
+    quaternion<T> dual;     // (t, 0) * real / 2 for the translation t
+
+    /* ctors */
+    dual_quaternion() = default;
+    constexpr dual_quaternion(const quaternion<T>& real_, const quaternion<T>& dual_) noexcept;
+    constexpr dual_quaternion(const quaternion<T>& rotation, const vector3<T>& translation) noexcept;     // Rotates, then translates
+
+    static constexpr dual_quaternion<T> identity() noexcept;
+
+    /* Equality operators */
+
+    constexpr bool operator==(const dual_quaternion<T>& d) const noexcept;
+    constexpr bool operator!=(const dual_quaternion<T>& d) const noexcept;
+
+    /* Arithmetic operators */
+
+    constexpr dual_quaternion<T> operator*(const dual_quaternion<T>& d) const noexcept;     // Applies d first
+    constexpr dual_quaternion<T> operator*(T a) const noexcept;
+    constexpr dual_quaternion<T> operator+(const dual_quaternion<T>& d) const noexcept;     // For blending, normalize after
+
+    /* Other operations */
+
+    constexpr dual_quaternion<T> normalize() const noexcept;       // Unit real part, dual part orthogonal to it
+    constexpr dual_quaternion<T> conjugate() const noexcept;       // Quaternion conjugate of both parts, the inverse of a unit dual quaternion
+    constexpr vector3<T>         translation() const noexcept;     // 2 (w_r d - w_d r + r x d), r and d the vector parts
+    constexpr vector3<T>         transform_point(const vector3<T>& p) const noexcept;   // real.rotate(p) + translation()
+    constexpr vector3<T>         transform_vector(const vector3<T>& v) const noexcept;  // real.rotate(v)
+    constexpr matrix4<T>         to_matrix4() const noexcept;
+};
+
+/* Non-member functions */
+template <typename T>
+constexpr quaternion<T> operator*(std::type_identity_t<T> a, const quaternion<T>& q) noexcept;
+
+/* I/O operators */
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const quaternion<T>& q);
+
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const dual_quaternion<T>& d);
+
+/* Canonical implementations */
+
+template <typename T>
+constexpr T dot(const quaternion<T>& a, const quaternion<T>& b) noexcept;
+
+template <typename T>
+constexpr quaternion<T> nlerp(const quaternion<T>& a, const quaternion<T>& b, T t) noexcept;    // Normalized linear blend along the shorter arc
+
+template <typename T>
+quaternion<T> slerp(const quaternion<T>& a, const quaternion<T>& b, T t) noexcept;              // Constant angular speed along the shorter arc
+
+/* Layout guarantees relied on by ptr() and the batch transform kernels */
+
+static_assert(std::is_trivially_copyable_v<quaternion<float>> && sizeof(quaternion<float>) == 4 * sizeof(float));
+static_assert(std::is_trivially_copyable_v<quaternion<double>> && sizeof(quaternion<double>) == 4 * sizeof(double));
+static_assert(std::is_trivially_copyable_v<dual_quaternion<float>> && sizeof(dual_quaternion<float>) == 8 * sizeof(float));
+static_assert(std::is_trivially_copyable_v<dual_quaternion<double>> && sizeof(dual_quaternion<double>) == 8 * sizeof(double));
+
+/* quaternion */
+
+template <typename T>
+constexpr quaternion<T>::quaternion(T x_, T y_, T z_, T w_) noexcept : x(x_), y(y_), z(z_), w(w_)
+{
+}
+
+template <typename T>
+constexpr quaternion<T>::quaternion(const vector3<T>& v, T w_) noexcept : x(v.x), y(v.y), z(v.z), w(w_)
+{
+}
+
+template <typename T>
+constexpr quaternion<T> quaternion<T>::identity() noexcept
+{
+    return quaternion<T>(T(0), T(0), T(0), T(1));
+}
+
+template <typename T>
+inline quaternion<T> quaternion<T>::from_axis_angle(const vector3<T>& axis, T angle) noexcept
+{
+    return quaternion<T>(axis * T(std::sin(angle / T(2))), T(std::cos(angle / T(2))));
+}
+
+template <typename T>
+inline quaternion<T> quaternion<T>::from_matrix(const matrix3<T>& m) noexcept     // Shepperd: divide by the largest of 4 w^2, 4 x^2, 4 y^2, 4 z^2
+{
+    const T t = m.trace();
+    if (t > m(0, 0) && t > m(1, 1) && t > m(2, 2))
+    {
+        const T s = T(2) * std::sqrt(T(1) + t);
+        return quaternion<T>((m(2, 1) - m(1, 2)) / s, (m(0, 2) - m(2, 0)) / s, (m(1, 0) - m(0, 1)) / s, s / T(4));
+    }
+    if (m(0, 0) >= m(1, 1) && m(0, 0) >= m(2, 2))
+    {
+        const T s = T(2) * std::sqrt(T(1) + m(0, 0) - m(1, 1) - m(2, 2));
+        return quaternion<T>(s / T(4), (m(0, 1) + m(1, 0)) / s, (m(0, 2) + m(2, 0)) / s, (m(2, 1) - m(1, 2)) / s);
+    }
+    if (m(1, 1) >= m(2, 2))
+    {
+        const T s = T(2) * std::sqrt(T(1) + m(1, 1) - m(0, 0) - m(2, 2));
+        return quaternion<T>((m(0, 1) + m(1, 0)) / s, s / T(4), (m(1, 2) + m(2, 1)) / s, (m(0, 2) - m(2, 0)) / s);
+    }
+    const T s = T(2) * std::sqrt(T(1) + m(2, 2) - m(0, 0) - m(1, 1));
+    return quaternion<T>((m(0, 2) + m(2, 0)) / s, (m(1, 2) + m(2, 1)) / s, s / T(4), (m(1, 0) - m(0, 1)) / s);
+}
+
+template <typename T>
+inline T* quaternion<T>::ptr() const noexcept
+{
+    return (T*)this;
+}
+
+template <typename T>
+constexpr vector3<T> quaternion<T>::vec() const noexcept
+{
+    return vector3<T>(x, y, z);
+}
+
+template <typename T>
+inline std::ostream& operator<<(std::ostream& out, const quaternion<T>& q)
+{
+    out << "(" << q.x << ", " << q.y << ", " << q.z << ", " << q.w << ")";
+    return out;
+}
+
+template <typename T>
+constexpr bool quaternion<T>::operator==(const quaternion<T>& q) const noexcept
+{
+    return x == q.x && y == q.y && z == q.z && w == q.w;
+}
+
+template <typename T>
+constexpr bool quaternion<T>::operator!=(const quaternion<T>& q) const noexcept
+{
+    return !((*this) == q);
+}
+
+template <typename T>
+constexpr quaternion<T>& quaternion<T>::operator*=(const quaternion<T>& q) noexcept
+{
+    return (*this) = (*this) * q;
+}
+
+template <typename T>
+constexpr quaternion<T>& quaternion<T>::operator*=(T a) noexcept
+{
+    x *= a; y *= a; z *= a; w *= a;
+    return *this;
+}
+
+template <typename T>
+constexpr quaternion<T>& quaternion<T>::operator+=(const quaternion<T>& q) noexcept
+{
+    x += q.x; y += q.y; z += q.z; w += q.w;
+    return *this;
+}
+
+template <typename T>
+constexpr quaternion<T> quaternion<T>::operator-(void) const noexcept
+{
+    return quaternion<T>(-x, -y, -z, -w);
+}
+
+template <typename T>
+constexpr quaternion<T> quaternion<T>::operator+(const quaternion<T>& q) const noexcept
+{
+    return quaternion<T>(x + q.x, y + q.y, z + q.z, w + q.w);
+}
+
+template <typename T>
+constexpr quaternion<T> quaternion<T>::operator-(const quaternion<T>& q) const noexcept
+{
+    return quaternion<T>(x - q.x, y - q.y, z - q.z, w - q.w);
+}
+
+template <typename T>
+constexpr quaternion<T> quaternion<T>::operator*(const quaternion<T>& q) const noexcept
+{
+    return quaternion<T>(w * q.x + x * q.w + y * q.z - z * q.y,
+                         w * q.y - x * q.z + y * q.w + z * q.x,
+                         w * q.z + x * q.y - y * q.x + z * q.w,
+                         w * q.w - x * q.x - y * q.y - z * q.z);
+}
+
+template <typename T>
+constexpr quaternion<T> quaternion<T>::operator*(T a) const noexcept
+{
+    return quaternion<T>(x * a, y * a, z * a, w * a);
+}
+
+template <typename T>
+constexpr quaternion<T> operator*(std::type_identity_t<T> a, const quaternion<T>& q) noexcept
+{
+    return q * a;
+}
+
+template <typename T>
+constexpr T dot(const quaternion<T>& a, const quaternion<T>& b) noexcept
+{
+    return ((a.x * b.x + a.y * b.y) + a.z * b.z) + a.w * b.w;
+}
+
+template <typename T>
+constexpr T quaternion<T>::dot(const quaternion<T>& q) const noexcept
+{
+    return ::dot(*this, q);
+}
+
+template <typename T>
+constexpr T quaternion<T>::lengthsqr() const noexcept
+{
+    return ::dot(*this, *this);
+}
+
+template <typename T>
+constexpr T quaternion<T>::length() const noexcept
+{
+    return vector_sqrt(lengthsqr());
+}
+
+template <typename T>
+constexpr quaternion<T> quaternion<T>::normalize() const noexcept
+{
+    return (*this) * (T(1) / length());
+}
+
+template <typename T>
+constexpr quaternion<T> quaternion<T>::conjugate() const noexcept
+{
+    return quaternion<T>(-x, -y, -z, w);
+}
+
+template <typename T>
+constexpr quaternion<T> quaternion<T>::inverse() const noexcept
+{
+    return conjugate() * (T(1) / lengthsqr());
+}
+
+template <typename T>
+constexpr vector3<T> quaternion<T>::rotate(const vector3<T>& v) const noexcept
+{
+    const vector3<T> u = vec();
+    const vector3<T> t = ::cross(u, v) * T(2);
+    return (v + t * w) + ::cross(u, t);
+}
+
+template <typename T>
+constexpr matrix3<T> quaternion<T>::to_matrix3() const noexcept
+{
+    const T xx = x * x, yy = y * y, zz = z * z;
+    const T xy = x * y, xz = x * z, yz = y * z;
+    const T wx = w * x, wy = w * y, wz = w * z;
+    return matrix3<T>(vector3<T>(T(1) - T(2) * (yy + zz), T(2) * (xy + wz), T(2) * (xz - wy)),
+                      vector3<T>(T(2) * (xy - wz), T(1) - T(2) * (xx + zz), T(2) * (yz + wx)),
+                      vector3<T>(T(2) * (xz + wy), T(2) * (yz - wx), T(1) - T(2) * (xx + yy)));
+}
+
+template <typename T>
+constexpr matrix4<T> quaternion<T>::to_matrix4() const noexcept
+{
+    return matrix4<T>(to_matrix3(), vector3<T>(T(0)));
+}
+
+template <typename T>
+constexpr quaternion<T> nlerp(const quaternion<T>& a, const quaternion<T>& b, T t) noexcept
+{
+    const quaternion<T> c = ::dot(a, b) < T(0) ? -b : b;
+    return (a * (T(1) - t) + c * t).normalize();
+}
+
+template <typename T>
+inline quaternion<T> slerp(const quaternion<T>& a, const quaternion<T>& b, T t) noexcept
+{
+    T d = ::dot(a, b);
+    const quaternion<T> c = d < T(0) ? -b : b;
+    d = std::abs(d);
+    if (d > T(1) - T(16) * std::numeric_limits<T>::epsilon())      // sin(angle) vanishes, the blend is linear
+        return nlerp(a, c, t);
+    const T angle = std::acos(d);
+    const T s = T(1) / std::sin(angle);
+    return a * (std::sin((T(1) - t) * angle) * s) + c * (std::sin(t * angle) * s);
+}
+
+/* dual_quaternion */
+
+template <typename T>
+constexpr dual_quaternion<T>::dual_quaternion(const quaternion<T>& real_, const quaternion<T>& dual_) noexcept : real(real_), dual(dual_)
+{
+}
+
+template <typename T>
+constexpr dual_quaternion<T>::dual_quaternion(const quaternion<T>& rotation, const vector3<T>& t) noexcept
+    : real(rotation), dual(quaternion<T>(t, T(0)) * rotation * T(0.5))
+{
+}
+
+template <typename T>
+constexpr dual_quaternion<T> dual_quaternion<T>::identity() noexcept
+{
+    return dual_quaternion<T>(quaternion<T>::identity(), quaternion<T>(T(0), T(0), T(0), T(0)));
+}
+
+template <typename T>
+inline std::ostream& operator<<(std::ostream& out, const dual_quaternion<T>& d)
+{
+    out << "(" << d.real << ", " << d.dual << ")";
+    return out;
+}
+
+template <typename T>
+constexpr bool dual_quaternion<T>::operator==(const dual_quaternion<T>& d) const noexcept
+{
+    return real == d.real && dual == d.dual;
+}
+
+template <typename T>
+constexpr bool dual_quaternion<T>::operator!=(const dual_quaternion<T>& d) const noexcept
+{
+    return !((*this) == d);
+}
+
+template <typename T>
+constexpr dual_quaternion<T> dual_quaternion<T>::operator*(const dual_quaternion<T>& d) const noexcept
+{
+    return dual_quaternion<T>(real * d.real, real * d.dual + dual * d.real);
+}
+
+template <typename T>
+constexpr dual_quaternion<T> dual_quaternion<T>::operator*(T a) const noexcept
+{
+    return dual_quaternion<T>(real * a, dual * a);
+}
+
+template <typename T>
+constexpr dual_quaternion<T> dual_quaternion<T>::operator+(const dual_quaternion<T>& d) const noexcept
+{
+    return dual_quaternion<T>(real + d.real, dual + d.dual);
+}
+
+template <typename T>
+constexpr dual_quaternion<T> dual_quaternion<T>::normalize() const noexcept
+{
+    const T inv = T(1) / real.length();
+    const quaternion<T> r = real * inv;
+    const quaternion<T> d = dual * inv;
+    return dual_quaternion<T>(r, d - r * ::dot(r, d));
+}
+
+template <typename T>
+constexpr dual_quaternion<T> dual_quaternion<T>::conjugate() const noexcept
+{
+    return dual_quaternion<T>(real.conjugate(), dual.conjugate());
+}
+
+template <typename T>
+constexpr vector3<T> dual_quaternion<T>::translation() const noexcept
+{
+    const vector3<T> r = real.vec();
+    const vector3<T> d = dual.vec();
+    return ((d * real.w - r * dual.w) + ::cross(r, d)) * T(2);
+}
+
+template <typename T>
+constexpr vector3<T> dual_quaternion<T>::transform_point(const vector3<T>& p) const noexcept
+{
+    return real.rotate(p) + translation();
+}
+
+template <typename T>
+constexpr vector3<T> dual_quaternion<T>::transform_vector(const vector3<T>& v) const noexcept
+{
+    return real.rotate(v);
+}
+
+template <typename T>
+constexpr matrix4<T> dual_quaternion<T>::to_matrix4() const noexcept
+{
+    return matrix4<T>(real.to_matrix3(), translation());
+}
+
+#endif
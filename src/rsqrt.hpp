@@ -0,0 +1,49 @@
+#ifndef RSQRT_H
+#define RSQRT_H
+
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define RSQRT_SSE 1
+#include <xmmintrin.h>
+#else
+#define RSQRT_SSE 0
+#endif
+
+// Fast reciprocal square root, 1 / sqrt(a) for positive normal a.
+//
+// float uses the SSE rsqrtss estimate (12 bits) refined by one Newton-Raphson step, or
+// the integer estimate refined by two steps where SSE is not available. double always
+// uses the integer estimate and two steps. In every case the relative error is below
+// 5e-6. Zero, denormal, negative, infinite and NaN arguments give unspecified results.
+// During constant evaluation float always takes the integer path.
+
+constexpr float rsqrt_fast(float a)
+{
+    const float h = 0.5f * a;
+#if RSQRT_SSE
+    if (!std::is_constant_evaluated())
+    {
+        float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(a)));
+        y = y * (1.5f - h * y * y);
+        return y;
+    }
+#endif
+    float y = std::bit_cast<float>(0x5f375a86u - (std::bit_cast<std::uint32_t>(a) >> 1));
+    y = y * (1.5f - h * y * y);
+    y = y * (1.5f - h * y * y);
+    return y;
+}
+
+constexpr double rsqrt_fast(double a)
+{
+    const double h = 0.5 * a;
+    double y = std::bit_cast<double>(0x5fe6eb50c7b537a9ull - (std::bit_cast<std::uint64_t>(a) >> 1));
+    y = y * (1.5 - h * y * y);
+    y = y * (1.5 - h * y * y);
+    return y;
+}
+
+#endif
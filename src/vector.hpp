@@ -0,0 +1,960 @@
+#ifndef VECTOR_H
+#define VECTOR_H
+
+#include <cmath>
+#include <compare>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#include "rsqrt.hpp"
+#include "vector_math.hpp"
+
+// Generic N component vector, N = 2..4, over any arithmetic-like scalar T.
+//
+// The components are plain named members (x, y, z, w) held by vector_storage, so the
+// type stays trivially copyable and standard layout with the same memory image as a
+// T[N]. Every component-wise operation is a fold over a compile time index sequence,
+// which unrolls completely and evaluates in the same order as the hand-written code
+// it replaces. vector2, vector3 and vector4 are aliases of this template.
+//
+// Swizzles name 2 to 4 components in any order: v.xz(), v.zyx(), v.wzyx(), or by
+// index v.swizzle<2, 1, 0>(), and always return a new vector, so auto s = v.xz() is a
+// plain copy. Writes go through the matching setters, v.set_xz(p) or
+// v.set_swizzle<0, 2>(p), which read p whole first (v.set_xy(v.yx()) swaps) and exist
+// only for names without a repeated component.
+// components<I>(r) views component I of every vector of a range in place, e.g. all
+// the y of a std::vector<vector3<float>>, with stride N.
+
+template <std::size_t N, typename T> struct vector;
+
+template <std::size_t N, typename T> struct vector_storage;
+
+template <typename T>
+struct vector_storage<2, T>
+{
+    T x;
+    T y;
+};
+
+template <typename T>
+struct vector_storage<3, T>
+{
+    T x;
+    T y;
+    T z;
+};
+
+template <typename T>
+struct vector_storage<4, T>
+{
+    T x;
+    T y;
+    T z;
+    T w;
+};
+
+/* Component access by index */
+
+template <std::size_t I, std::size_t N, typename T>
+constexpr T& get(vector_storage<N, T>& v) noexcept
+{
+    static_assert(I < N, "component index out of range");
+    if constexpr (I == 0) return v.x;
+    else if constexpr (I == 1) return v.y;
+    else if constexpr (I == 2) return v.z;
+    else return v.w;
+}
+
+template <std::size_t I, std::size_t N, typename T>
+constexpr const T& get(const vector_storage<N, T>& v) noexcept
+{
+    static_assert(I < N, "component index out of range");
+    if constexpr (I == 0) return v.x;
+    else if constexpr (I == 1) return v.y;
+    else if constexpr (I == 2) return v.z;
+    else return v.w;
+}
+
+namespace vector_detail
+{
+
+template <std::size_t I>
+using index = std::integral_constant<std::size_t, I>;
+
+template <std::size_t N, typename F>
+constexpr void for_each(F&& f)          // f(index<I>) for every component, in order
+{
+    [&]<std::size_t... I>(std::index_sequence<I...>) { (f(index<I>{}), ...); }(std::make_index_sequence<N>{});
+}
+
+template <std::size_t N, typename F>
+constexpr bool all(F&& f)
+{
+    return [&]<std::size_t... I>(std::index_sequence<I...>) { return (f(index<I>{}) && ...); }(std::make_index_sequence<N>{});
+}
+
+template <std::size_t N, typename F>
+constexpr bool any(F&& f)
+{
+    return [&]<std::size_t... I>(std::index_sequence<I...>) { return (f(index<I>{}) || ...); }(std::make_index_sequence<N>{});
+}
+
+template <std::size_t N, typename F>
+constexpr auto sum(F&& f)               // ((f(0) + f(1)) + f(2)) + ...
+{
+    return [&]<std::size_t... I>(std::index_sequence<I...>) { return (... + f(index<I>{})); }(std::make_index_sequence<N>{});
+}
+
+template <std::size_t N, typename T, typename F>
+constexpr vector_storage<N, T> generate(F&& f)
+{
+    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+        return vector_storage<N, T>{static_cast<T>(f(index<I>{}))...};
+    }(std::make_index_sequence<N>{});
+}
+
+/* Swizzles */
+
+template <std::size_t N, std::size_t... I>
+constexpr bool swizzle_fits = sizeof...(I) >= 2 && sizeof...(I) <= 4 && ((I < N) && ...);
+
+template <std::size_t... I>
+constexpr bool swizzle_distinct = (0u | ... | (1u << I)) == (0u + ... + (1u << I));    // No component written twice
+
+// A swizzle name such as "zyx" as one number: the component indices two bits each,
+// first letter lowest, below a leading 1 that marks the length
+constexpr std::size_t swizzle_code(const char* name) noexcept
+{
+    std::size_t n = 0;
+    while (name[n])
+        ++n;
+    std::size_t code = 1;
+    while (n-- > 0)
+        code = code * 4 + (name[n] == 'x' ? 0 : name[n] == 'y' ? 1 : name[n] == 'z' ? 2 : 3);
+    return code;
+}
+
+constexpr bool swizzle_code_fits(std::size_t code, std::size_t n) noexcept
+{
+    for (; code > 1; code >>= 2)
+        if ((code & 3) >= n)
+            return false;
+    return true;
+}
+
+constexpr bool swizzle_code_distinct(std::size_t code) noexcept
+{
+    unsigned seen = 0;
+    for (; code > 1; code >>= 2)
+    {
+        if (seen & (1u << (code & 3)))
+            return false;
+        seen |= 1u << (code & 3);
+    }
+    return true;
+}
+
+constexpr std::size_t swizzle_code_size(std::size_t code) noexcept
+{
+    return code >= 256 ? 4 : code >= 64 ? 3 : 2;
+}
+
+template <std::size_t Code, typename V>
+constexpr auto swizzle(const V& v) noexcept      // v.swizzle<I...>() with the indices of Code
+{
+    return [&]<std::size_t... K>(std::index_sequence<K...>) {
+        return v.template swizzle<((Code >> (2 * K)) & 3)...>();
+    }(std::make_index_sequence<swizzle_code_size(Code)>{});
+}
+
+template <std::size_t Code, typename V, typename S>
+constexpr void set_swizzle(V& v, const S& s) noexcept      // v.set_swizzle<I...>(s) with the indices of Code
+{
+    [&]<std::size_t... K>(std::index_sequence<K...>) {
+        v.template set_swizzle<((Code >> (2 * K)) & 3)...>(s);
+    }(std::make_index_sequence<swizzle_code_size(Code)>{});
+}
+
+} // namespace vector_detail
+
+// Every swizzle name of 2 to 4 letters from xyzw, as F(name) for each
+#define VECTOR_SWIZZLE_2(F, a) F(a##x) F(a##y) F(a##z) F(a##w)
+#define VECTOR_SWIZZLE_3(F, a) VECTOR_SWIZZLE_2(F, a##x) VECTOR_SWIZZLE_2(F, a##y) VECTOR_SWIZZLE_2(F, a##z) VECTOR_SWIZZLE_2(F, a##w)
+#define VECTOR_SWIZZLE_4(F, a) VECTOR_SWIZZLE_3(F, a##x) VECTOR_SWIZZLE_3(F, a##y) VECTOR_SWIZZLE_3(F, a##z) VECTOR_SWIZZLE_3(F, a##w)
+#define VECTOR_SWIZZLE_FROM(F, a) VECTOR_SWIZZLE_2(F, a) VECTOR_SWIZZLE_3(F, a) VECTOR_SWIZZLE_4(F, a)
+#define VECTOR_SWIZZLES(F) VECTOR_SWIZZLE_FROM(F, x) VECTOR_SWIZZLE_FROM(F, y) VECTOR_SWIZZLE_FROM(F, z) VECTOR_SWIZZLE_FROM(F, w)
+
+#define VECTOR_SWIZZLE_MEMBER(name)                                                                             \
+    constexpr auto name() const noexcept requires (vector_detail::swizzle_code_fits(vector_detail::swizzle_code(#name), N)) \
+    { return vector_detail::swizzle<vector_detail::swizzle_code(#name)>(*this); }                              \
+    constexpr void set_##name(const vector<vector_detail::swizzle_code_size(vector_detail::swizzle_code(#name)), T>& v) noexcept \
+        requires (vector_detail::swizzle_code_fits(vector_detail::swizzle_code(#name), N) && vector_detail::swizzle_code_distinct(vector_detail::swizzle_code(#name))) \
+    { vector_detail::set_swizzle<vector_detail::swizzle_code(#name)>(*this, v); }
+
+template <std::size_t N, typename T>
+struct vector : vector_storage<N, T>
+{
+    static_assert(N >= 2 && N <= 4, "vector supports 2, 3 or 4 components");
+
+    using value_type = T;
+    static constexpr std::size_t dimension = N;
+
+    /* ctors */
+    vector() = default;
+    constexpr vector(T x_, T y_) noexcept requires (N == 2);
+    constexpr vector(T x_, T y_, T z_) noexcept requires (N == 3);
+    constexpr vector(T x_, T y_, T z_, T w_) noexcept requires (N == 4);
+    constexpr vector(const vector<N - 1, T>& v, T a) noexcept requires (N > 2);     // Append a component, e.g. homogeneous coordinates
+    constexpr vector(T a) noexcept;
+    constexpr explicit vector(const vector_storage<N, T>& s) noexcept;
+
+    /* Initialization */
+    constexpr void init() noexcept;        // Initialize to zero
+
+    T* ptr() const noexcept;
+
+    constexpr void zero() noexcept;
+    constexpr bool is_zero() const noexcept;
+    constexpr bool is_almost_zero(const T tolerance = T(0.01)) const noexcept;
+    constexpr bool is_any_zero() const noexcept;
+
+    /* Equality operators */
+
+    constexpr bool operator==(const vector<N, T>& v) const noexcept;
+    constexpr bool operator!=(const vector<N, T>& v) const noexcept;
+
+    /* Compound arithmetic operators */
+
+    constexpr vector<N, T>& operator+=(const vector<N, T>& v) noexcept;
+    constexpr vector<N, T>& operator+=(const T a) noexcept;
+    constexpr vector<N, T>& operator-=(const vector<N, T>& v) noexcept;
+    constexpr vector<N, T>& operator-=(const T a) noexcept;
+    constexpr vector<N, T>& operator*=(const vector<N, T>& v) noexcept;
+    constexpr vector<N, T>& operator*=(const T a) noexcept;
+    constexpr vector<N, T>& operator/=(const vector<N, T>& v) noexcept;
+    constexpr vector<N, T>& operator/=(const T a) noexcept;
+
+    /* Unary arithmetic operators */
+
+    constexpr vector<N, T> operator-(void) const noexcept;
+
+    /* Binary arithmetic operators */
+
+    constexpr vector<N, T> operator+(const vector<N, T>& v) const noexcept;
+    constexpr vector<N, T> operator-(const vector<N, T>& v) const noexcept;
+    constexpr vector<N, T> operator*(const vector<N, T>& v) const noexcept;    // Element wise multiplication
+    constexpr vector<N, T> operator*(T a) const noexcept;
+    constexpr vector<N, T> operator/(const vector<N, T>& v) const noexcept;
+    constexpr vector<N, T> operator/(T a) const noexcept;                      // Division by scalar
+
+    /* Swizzles */
+
+    template <std::size_t... I> requires vector_detail::swizzle_fits<N, I...>
+    constexpr vector<sizeof...(I), T>       swizzle() const noexcept;      // Components I..., in that order
+    template <std::size_t... I> requires vector_detail::swizzle_fits<N, I...> && vector_detail::swizzle_distinct<I...>
+    constexpr void                          set_swizzle(const vector<sizeof...(I), T>& v) noexcept;   // Components I... = v
+
+    VECTOR_SWIZZLES(VECTOR_SWIZZLE_MEMBER)                                  // xy() ... wwww() and set_xy() ... set_wzyx(), the ones with components below N
+
+    /* Other operations */
+
+    constexpr T             lengthsqr() const noexcept;      // Squared Magnitude of a vector
+    constexpr T             length() const noexcept;         // Magnitude of a vector
+
+    [[deprecated("use xy().lengthsqr()")]] constexpr T lengthsqr_xy() const noexcept requires (N >= 3) { return xy().lengthsqr(); }
+    [[deprecated("use xz().lengthsqr()")]] constexpr T lengthsqr_xz() const noexcept requires (N >= 3) { return xz().lengthsqr(); }
+    [[deprecated("use yz().lengthsqr()")]] constexpr T lengthsqr_yz() const noexcept requires (N >= 3) { return yz().lengthsqr(); }
+    [[deprecated("use xy().length()")]]    constexpr T length_xy() const noexcept requires (N >= 3)    { return xy().length(); }
+    [[deprecated("use xz().length()")]]    constexpr T length_xz() const noexcept requires (N >= 3)    { return xz().length(); }
+    [[deprecated("use yz().length()")]]    constexpr T length_yz() const noexcept requires (N >= 3)    { return yz().length(); }
+
+    constexpr void          normalize_this() noexcept;       // Unit Vector
+    constexpr vector<N, T>  normalize() const noexcept;
+    constexpr void          normalize_fast_this() noexcept;  // Unit Vector from rsqrt_fast, relative error below 5e-6
+    constexpr vector<N, T>  normalize_fast() const noexcept;
+    constexpr void          normalize_safe_this() noexcept;  // As normalize_fast, zero length vectors stay zero instead of NaN
+    constexpr vector<N, T>  normalize_safe() const noexcept;
+    constexpr T             distance(const vector<N, T>& v) const noexcept;    // Distance to another vector
+    constexpr T             dot(const vector<N, T>& v) const noexcept;         // Dot product
+    constexpr vector<N, T>  cross(const vector<N, T>& v) const noexcept requires (N == 3);     // Cross product
+
+    // The _fma forms pin their evaluation to fused multiply-adds, so they give the same
+    // bits under any -ffp-contract setting: dot_fma rounds x * v.x and then fuses every
+    // further term into the sum, cross_fma takes each difference of products with
+    // Kahan's algorithm and stays within 1.5 ulp of the exact component even when the
+    // products cancel.
+    constexpr T             lengthsqr_fma() const noexcept;
+    constexpr T             distance_fma(const vector<N, T>& v) const noexcept;
+    constexpr T             dot_fma(const vector<N, T>& v) const noexcept;
+    constexpr vector<N, T>  cross_fma(const vector<N, T>& v) const noexcept requires (N == 3);
+
+    // The predicates without eps are exact and hold only for exactly representable
+    // cases. With eps they accept an angle error of about eps radians: sin or cos of
+    // the angle between the vectors within eps, or |this + v| within eps times the
+    // longer vector. A zero vector is perpendicular and collinear to every vector.
+    constexpr bool          is_perpendicular(const vector<N, T>& v) const noexcept;    // Check ortogonality between two vectors
+    constexpr bool          is_perpendicular(const vector<N, T>& v, T eps) const noexcept;
+    constexpr void          perpendicular_this(const vector<N, T>& v) noexcept requires (N == 3);
+    constexpr vector<N, T>  perpendicular(const vector<N, T>& v) const noexcept requires (N == 3);
+    constexpr bool          is_opposite(const vector<N, T>& v) const noexcept;
+    constexpr bool          is_opposite(const vector<N, T>& v, T eps) const noexcept;
+    constexpr void          opposite_this() noexcept;
+    constexpr vector<N, T>  opposite() const noexcept;
+    constexpr bool          is_collinear(const vector<N, T>& v) const noexcept;       // Parallel, in either direction
+    constexpr bool          is_collinear(const vector<N, T>& v, T eps) const noexcept;
+    constexpr void          collinear_this(T a) noexcept;
+    constexpr vector<N, T>  collinear(T a) const noexcept;
+    constexpr bool          is_anticollinear(const vector<N, T>& v) const noexcept;   // Parallel, pointing opposite ways
+    constexpr bool          is_anticollinear(const vector<N, T>& v, T eps) const noexcept;
+    constexpr void          anticollinear_this(T a) noexcept;
+    constexpr vector<N, T>  anticollinear(T a) const noexcept;
+
+};
+
+#undef VECTOR_SWIZZLE_MEMBER
+#undef VECTOR_SWIZZLES
+#undef VECTOR_SWIZZLE_FROM
+#undef VECTOR_SWIZZLE_4
+#undef VECTOR_SWIZZLE_3
+#undef VECTOR_SWIZZLE_2
+
+/* Strided component views */
+
+template <typename T>
+struct vector_component_iterator        // Random access over every stride-th T
+{
+    using iterator_concept  = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = std::remove_cv_t<T>;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = T&;
+
+    T*             data = nullptr;
+    std::ptrdiff_t stride = 1;
+    std::ptrdiff_t i = 0;           // Element index, so the end never points past the array
+
+    constexpr T& operator*() const noexcept                          { return data[i * stride]; }
+    constexpr T& operator[](std::ptrdiff_t k) const noexcept         { return data[(i + k) * stride]; }
+    constexpr vector_component_iterator& operator++() noexcept       { ++i; return *this; }
+    constexpr vector_component_iterator& operator--() noexcept       { --i; return *this; }
+    constexpr vector_component_iterator  operator++(int) noexcept    { auto t = *this; ++i; return t; }
+    constexpr vector_component_iterator  operator--(int) noexcept    { auto t = *this; --i; return t; }
+    constexpr vector_component_iterator& operator+=(std::ptrdiff_t k) noexcept { i += k; return *this; }
+    constexpr vector_component_iterator& operator-=(std::ptrdiff_t k) noexcept { i -= k; return *this; }
+
+    friend constexpr vector_component_iterator operator+(vector_component_iterator a, std::ptrdiff_t k) noexcept { return a += k; }
+    friend constexpr vector_component_iterator operator+(std::ptrdiff_t k, vector_component_iterator a) noexcept { return a += k; }
+    friend constexpr vector_component_iterator operator-(vector_component_iterator a, std::ptrdiff_t k) noexcept { return a -= k; }
+    friend constexpr std::ptrdiff_t operator-(const vector_component_iterator& a, const vector_component_iterator& b) noexcept { return a.i - b.i; }
+    friend constexpr bool operator==(const vector_component_iterator& a, const vector_component_iterator& b) noexcept { return a.i == b.i; }
+    friend constexpr auto operator<=>(const vector_component_iterator& a, const vector_component_iterator& b) noexcept { return a.i <=> b.i; }
+};
+
+template <typename T>
+struct vector_component_view : std::ranges::view_interface<vector_component_view<T>>     // One component of each vector, in place
+{
+    T*          data = nullptr;     // Component of the first vector
+    std::size_t stride = 1;         // In T, the vector dimension
+    std::size_t count = 0;
+
+    constexpr vector_component_iterator<T> begin() const noexcept { return { data, std::ptrdiff_t(stride), 0 }; }
+    constexpr vector_component_iterator<T> end() const noexcept   { return { data, std::ptrdiff_t(stride), std::ptrdiff_t(count) }; }
+    constexpr std::size_t size() const noexcept                   { return count; }
+    constexpr T& operator[](std::size_t i) const noexcept         { return data[i * stride]; }
+};
+
+/* Concepts */
+template <typename V>
+concept vector_value = requires { V::dimension; typename V::value_type; } &&
+                       std::is_same_v<V, vector<V::dimension, typename V::value_type>>;
+
+template <typename R>
+concept vector_range = std::ranges::contiguous_range<R> && std::ranges::sized_range<R> &&     // std::vector, std::span, std::array ... of vectors
+                       vector_value<std::ranges::range_value_t<R>>;
+
+template <std::size_t I, vector_range R> requires std::ranges::borrowed_range<R>
+constexpr auto components(R&& r) noexcept;     // components<1>(points) is every points[i].y, const when the range is
+
+/* Non-member functions */
+template <std::size_t N, typename T>
+constexpr vector<N, T> operator*(std::type_identity_t<T> a, const vector<N, T>& v) noexcept;     // Symmetric multiplication by scalar
+
+/* I/O operators */
+template <std::size_t N, typename T>
+std::ostream& operator<<(std::ostream& out, const vector<N, T>& v);
+
+template <std::size_t N, typename T>
+std::istream& operator>>(std::istream& in, vector<N, T>& v);
+
+/* Canonical implementations */
+
+template <std::size_t N, typename T>
+constexpr T distance(const vector<N, T>& lv, const vector<N, T>& rv) noexcept;
+
+template <std::size_t N, typename T>
+constexpr T dot(const vector<N, T>& lv, const vector<N, T>& rv) noexcept;              // Dot product
+
+template <typename T>
+constexpr vector<3, T> cross(const vector<3, T>& lv, const vector<3, T>& rv) noexcept;  // Cross product
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> madd(const vector<N, T>& a, const vector<N, T>& b, const vector<N, T>& c) noexcept;            // a * b + c per component, rounded once
+template <std::size_t N, typename T>
+constexpr vector<N, T> madd(const vector<N, T>& a, std::type_identity_t<T> b, const vector<N, T>& c) noexcept;
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> lerp(const vector<N, T>& a, const vector<N, T>& b, std::type_identity_t<T> t) noexcept;       // Exactly a at t = 0 and b at t = 1
+
+template <std::size_t N, typename T>
+constexpr T distance_fma(const vector<N, T>& lv, const vector<N, T>& rv) noexcept;
+
+template <std::size_t N, typename T>
+constexpr T dot_fma(const vector<N, T>& lv, const vector<N, T>& rv) noexcept;
+
+template <typename T>
+constexpr vector<3, T> cross_fma(const vector<3, T>& lv, const vector<3, T>& rv) noexcept;
+
+/* ctors */
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>::vector(T x_, T y_) noexcept requires (N == 2)
+    : vector_storage<N, T>{x_, y_}
+{
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>::vector(T x_, T y_, T z_) noexcept requires (N == 3)
+    : vector_storage<N, T>{x_, y_, z_}
+{
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>::vector(T x_, T y_, T z_, T w_) noexcept requires (N == 4)
+    : vector_storage<N, T>{x_, y_, z_, w_}
+{
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>::vector(const vector<N - 1, T>& v, T a) noexcept requires (N > 2)
+    : vector_storage<N, T>(vector_detail::generate<N, T>([&](auto i) {
+          if constexpr (i < N - 1) return get<i>(v); else return a;
+      }))
+{
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>::vector(T a) noexcept
+    : vector_storage<N, T>(vector_detail::generate<N, T>([&](auto) { return a; }))
+{
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>::vector(const vector_storage<N, T>& s) noexcept
+    : vector_storage<N, T>(s)
+{
+}
+
+/* Initialization */
+
+template <std::size_t N, typename T>
+constexpr void vector<N, T>::init() noexcept
+{
+    zero();
+}
+
+template <std::size_t N, typename T>
+inline T* vector<N, T>::ptr() const noexcept   // Base pointer to the vector
+{
+    return (T*)this;
+}
+
+/* I/O operators */
+template <std::size_t N, typename T>
+inline std::ostream& operator<<(std::ostream& out, const vector<N, T>& v)
+{
+    out << "(" << v.x;
+    vector_detail::for_each<N>([&](auto i) { if constexpr (i > 0) out << ", " << get<i>(v); });
+    out << ")";
+    return out;
+}
+
+template <std::size_t N, typename T>
+inline std::istream& operator>>(std::istream& in, vector<N, T>& v)
+{
+    vector_detail::for_each<N>([&](auto i) { in >> get<i>(v); });
+
+    return in;
+}
+
+/* Equality operators */
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::operator==(const vector<N, T>& v) const noexcept
+{
+    return vector_detail::all<N>([&](auto i) { return get<i>(*this) == get<i>(v); });
+}
+
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::operator!=(const vector<N, T>& v) const noexcept
+{
+    return !((*this) == v);
+}
+
+/* Compound arithmetic operators */
+template <std::size_t N, typename T>
+constexpr vector<N, T>& vector<N, T>::operator+=(const vector<N, T>& v) noexcept
+{
+    vector_detail::for_each<N>([&](auto i) { get<i>(*this) += get<i>(v); }); return *this;
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>& vector<N, T>::operator+=(T a) noexcept
+{
+    vector_detail::for_each<N>([&](auto i) { get<i>(*this) += a; }); return *this;
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>& vector<N, T>::operator-=(const vector<N, T>& v) noexcept
+{
+    vector_detail::for_each<N>([&](auto i) { get<i>(*this) -= get<i>(v); }); return *this;
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>& vector<N, T>::operator-=(T a) noexcept
+{
+    vector_detail::for_each<N>([&](auto i) { get<i>(*this) -= a; }); return *this;
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>& vector<N, T>::operator*=(const vector<N, T>& v) noexcept
+{
+    vector_detail::for_each<N>([&](auto i) { get<i>(*this) *= get<i>(v); }); return *this;
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>& vector<N, T>::operator*=(T a) noexcept
+{
+    vector_detail::for_each<N>([&](auto i) { get<i>(*this) *= a; }); return *this;
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>& vector<N, T>::operator/=(const vector<N, T>& v) noexcept
+{
+    vector_detail::for_each<N>([&](auto i) { get<i>(*this) /= get<i>(v); }); return *this;
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T>& vector<N, T>::operator/=(T a) noexcept
+{
+    vector_detail::for_each<N>([&](auto i) { get<i>(*this) /= a; }); return *this;
+}
+
+/* Unary arithmetic operators */
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::operator-(void) const noexcept
+{
+    return vector<N, T>(vector_detail::generate<N, T>([&](auto i) { return -get<i>(*this); }));
+}
+
+/* Binary arithmetic operators */
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::operator+(const vector<N, T>& v) const noexcept
+{
+    return vector<N, T>(vector_detail::generate<N, T>([&](auto i) { return get<i>(*this) + get<i>(v); }));
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::operator-(const vector<N, T>& v) const noexcept
+{
+    return vector<N, T>(vector_detail::generate<N, T>([&](auto i) { return get<i>(*this) - get<i>(v); }));
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::operator*(const vector<N, T>& v) const noexcept   // Element wise multiplication
+{
+    return vector<N, T>(vector_detail::generate<N, T>([&](auto i) { return get<i>(*this) * get<i>(v); }));
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::operator*(T a) const noexcept
+{
+    return vector<N, T>(vector_detail::generate<N, T>([&](auto i) { return get<i>(*this) * a; }));
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> operator*(std::type_identity_t<T> a, const vector<N, T>& v) noexcept
+{
+    return v * a;
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::operator/(const vector<N, T>& v) const noexcept   // Element wise division
+{
+    return vector<N, T>(vector_detail::generate<N, T>([&](auto i) { return get<i>(*this) / get<i>(v); }));
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::operator/(T a) const noexcept
+{
+    return vector<N, T>(vector_detail::generate<N, T>([&](auto i) { return get<i>(*this) / a; }));
+}
+
+/* Swizzles */
+template <std::size_t N, typename T>
+template <std::size_t... I> requires vector_detail::swizzle_fits<N, I...>
+constexpr vector<sizeof...(I), T> vector<N, T>::swizzle() const noexcept
+{
+    return vector<sizeof...(I), T>(vector_storage<sizeof...(I), T>{get<I>(*this)...});
+}
+
+template <std::size_t N, typename T>
+template <std::size_t... I> requires vector_detail::swizzle_fits<N, I...> && vector_detail::swizzle_distinct<I...>
+constexpr void vector<N, T>::set_swizzle(const vector<sizeof...(I), T>& v) noexcept
+{
+    const vector<sizeof...(I), T> c = v;        // v may be this vector
+    [&]<std::size_t... K>(std::index_sequence<K...>) { ((get<I>(*this) = get<K>(c)), ...); }(std::make_index_sequence<sizeof...(I)>{});
+}
+
+template <std::size_t I, vector_range R> requires std::ranges::borrowed_range<R>
+constexpr auto components(R&& r) noexcept
+{
+    using V = std::ranges::range_value_t<R>;
+    using T = std::remove_reference_t<decltype(get<I>(*std::ranges::data(r)))>;     // const T for a const range
+    auto* p = std::ranges::data(r);
+    const std::size_t n = std::size_t(std::ranges::size(r));
+    return vector_component_view<T>{ {}, n ? &get<I>(*p) : nullptr, V::dimension, n };
+}
+
+/* Other operations */
+template <std::size_t N, typename T>
+constexpr void vector<N, T>::zero() noexcept
+{
+    vector_detail::for_each<N>([&](auto i) { get<i>(*this) = T(0); });
+}
+
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::is_zero() const noexcept
+{
+    return vector_detail::all<N>([&](auto i) { return get<i>(*this) == T(0); });
+}
+
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::is_any_zero() const noexcept
+{
+    return vector_detail::any<N>([&](auto i) { return get<i>(*this) == T(0); });
+}
+
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::is_almost_zero(T tolerance) const noexcept
+{
+    return vector_detail::all<N>([&](auto i) { return get<i>(*this) > -tolerance && get<i>(*this) < tolerance; });
+}
+
+template <std::size_t N, typename T>
+constexpr T vector<N, T>::lengthsqr() const noexcept
+{
+    return ::dot(*this, *this);
+}
+
+template <std::size_t N, typename T>
+constexpr T vector<N, T>::length() const noexcept
+{
+    return vector_sqrt(lengthsqr());
+}
+
+template <std::size_t N, typename T>
+constexpr void vector<N, T>::normalize_this() noexcept
+{
+    (*this) /= length();
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::normalize() const noexcept
+{
+    return (*this) / length();
+}
+
+template <std::size_t N, typename T>
+constexpr void vector<N, T>::normalize_fast_this() noexcept
+{
+    (*this) *= rsqrt_fast(lengthsqr());
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::normalize_fast() const noexcept
+{
+    return (*this) * rsqrt_fast(lengthsqr());
+}
+
+template <std::size_t N, typename T>
+constexpr void vector<N, T>::normalize_safe_this() noexcept
+{
+    const T l = lengthsqr();
+    (*this) *= l > std::numeric_limits<T>::min() ? T(rsqrt_fast(l)) : T(0);
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::normalize_safe() const noexcept
+{
+    const T l = lengthsqr();
+    return (*this) * (l > std::numeric_limits<T>::min() ? T(rsqrt_fast(l)) : T(0));
+}
+
+template <std::size_t N, typename T>
+constexpr T distance(const vector<N, T>& lv, const vector<N, T>& rv) noexcept     // Distance between two vectors
+{
+    return (lv - rv).length();
+}
+
+template <std::size_t N, typename T>
+constexpr T vector<N, T>::distance(const vector<N, T>& v) const noexcept          // Distance between two vectors
+{
+    return ::distance(*this, v);
+}
+
+template <std::size_t N, typename T>
+constexpr T dot(const vector<N, T>& lv, const vector<N, T>& rv) noexcept          // Canonical Dot product
+{
+    return vector_detail::sum<N>([&](auto i) { return get<i>(lv) * get<i>(rv); });
+}
+
+template <std::size_t N, typename T>
+constexpr T vector<N, T>::dot(const vector<N, T>& v) const noexcept               // Dot product
+{
+    return ::dot(*this, v);
+}
+
+template <typename T>
+constexpr vector<3, T> cross(const vector<3, T>& lv, const vector<3, T>& rv) noexcept   // Canonical Cross product
+{
+    return vector<3, T>(lv.y * rv.z - lv.z * rv.y,
+                        lv.z * rv.x - lv.x * rv.z,
+                        lv.x * rv.y - lv.y * rv.x);
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::cross(const vector<N, T>& v) const noexcept requires (N == 3)    // Cross product
+{
+    return ::cross(*this, v);
+}
+
+/* Fused multiply-add forms */
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> madd(const vector<N, T>& a, const vector<N, T>& b, const vector<N, T>& c) noexcept
+{
+    return vector<N, T>(vector_detail::generate<N, T>([&](auto i) { return vector_fma(get<i>(a), get<i>(b), get<i>(c)); }));
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> madd(const vector<N, T>& a, std::type_identity_t<T> b, const vector<N, T>& c) noexcept
+{
+    return vector<N, T>(vector_detail::generate<N, T>([&](auto i) { return vector_fma(get<i>(a), b, get<i>(c)); }));
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> lerp(const vector<N, T>& a, const vector<N, T>& b, std::type_identity_t<T> t) noexcept    // t b + (a - t a)
+{
+    return vector<N, T>(vector_detail::generate<N, T>([&](auto i) { return vector_fma(t, get<i>(b), vector_fma(-t, get<i>(a), get<i>(a))); }));
+}
+
+template <std::size_t N, typename T>
+constexpr T dot_fma(const vector<N, T>& lv, const vector<N, T>& rv) noexcept
+{
+    T r = lv.x * rv.x;
+    vector_detail::for_each<N>([&](auto i) { if constexpr (i > 0) r = vector_fma(get<i>(lv), get<i>(rv), r); });
+    return r;
+}
+
+namespace vector_detail
+{
+
+template <typename T>
+constexpr T difference_of_products(T a, T b, T c, T d) noexcept     // a b - c d, Kahan
+{
+    const T w = c * d;
+    return vector_fma(a, b, -w) + vector_fma(-c, d, w);
+}
+
+} // namespace vector_detail
+
+template <typename T>
+constexpr vector<3, T> cross_fma(const vector<3, T>& lv, const vector<3, T>& rv) noexcept
+{
+    return vector<3, T>(vector_detail::difference_of_products(lv.y, rv.z, lv.z, rv.y),
+                        vector_detail::difference_of_products(lv.z, rv.x, lv.x, rv.z),
+                        vector_detail::difference_of_products(lv.x, rv.y, lv.y, rv.x));
+}
+
+template <std::size_t N, typename T>
+constexpr T distance_fma(const vector<N, T>& lv, const vector<N, T>& rv) noexcept
+{
+    return vector_sqrt((lv - rv).lengthsqr_fma());
+}
+
+template <std::size_t N, typename T>
+constexpr T vector<N, T>::lengthsqr_fma() const noexcept
+{
+    return ::dot_fma(*this, *this);
+}
+
+template <std::size_t N, typename T>
+constexpr T vector<N, T>::distance_fma(const vector<N, T>& v) const noexcept
+{
+    return ::distance_fma(*this, v);
+}
+
+template <std::size_t N, typename T>
+constexpr T vector<N, T>::dot_fma(const vector<N, T>& v) const noexcept
+{
+    return ::dot_fma(*this, v);
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::cross_fma(const vector<N, T>& v) const noexcept requires (N == 3)
+{
+    return ::cross_fma(*this, v);
+}
+
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::is_perpendicular(const vector<N, T>& v) const noexcept     // Check orthogonality between two vectors
+{
+    return dot(v) == T(0);
+}
+
+namespace vector_detail
+{
+
+// The tolerant predicates divide the vectors by their largest component first, so
+// the squares stay near 1 rather than overflowing or underflowing at extreme magnitudes
+template <std::size_t N, typename T, typename... V>
+constexpr T max_abs(const vector<N, T>& v, const V&... w) noexcept        // Over all the vectors, 1 if they are all zero
+{
+    T m = T(0);
+    auto f = [&](const vector<N, T>& u)
+    {
+        for_each<N>([&](auto i) { const T a = get<i>(u) < T(0) ? -get<i>(u) : get<i>(u); m = a > m ? a : m; });
+    };
+    f(v);
+    (f(w), ...);
+    return m > T(0) ? m : T(1);
+}
+
+} // namespace vector_detail
+
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::is_perpendicular(const vector<N, T>& v, T eps) const noexcept      // |cos| <= eps
+{
+    const vector<N, T> a = (*this) / vector_detail::max_abs(*this), b = v / vector_detail::max_abs(v);
+    const T d = a.dot(b);
+    return d * d <= eps * eps * a.lengthsqr() * b.lengthsqr();
+}
+
+template <std::size_t N, typename T>
+constexpr void vector<N, T>::perpendicular_this(const vector<N, T>& v) noexcept requires (N == 3)     // Make this vector perpendicular to another vector
+{
+    (*this) = ::cross(*this, v);
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::perpendicular(const vector<N, T>& v) const noexcept requires (N == 3)     // Perpendicular vector
+{
+    return ::cross(*this, v);
+}
+
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::is_opposite(const vector<N, T>& v) const noexcept
+{
+    return vector_detail::all<N>([&](auto i) { return get<i>(*this) == -get<i>(v); });
+}
+
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::is_opposite(const vector<N, T>& v, T eps) const noexcept     // |this + v| <= eps * max(|this|, |v|)
+{
+    const T m = vector_detail::max_abs(*this, v);
+    const vector<N, T> l = (*this) / m, r = v / m;
+    const T a = l.lengthsqr(), b = r.lengthsqr();
+    return (l + r).lengthsqr() <= eps * eps * (a > b ? a : b);
+}
+
+template <std::size_t N, typename T>
+constexpr void vector<N, T>::opposite_this() noexcept
+{
+    vector_detail::for_each<N>([&](auto i) { get<i>(*this) = -get<i>(*this); });
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::opposite() const noexcept
+{
+    return -(*this);
+}
+
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::is_collinear(const vector<N, T>& v) const noexcept    // Every 2 x 2 minor zero, x included or not
+{
+    return vector_detail::all<N>([&](auto i)
+    {
+        return vector_detail::all<N>([&](auto j) { return j <= i || get<i>(*this) * get<j>(v) == get<j>(*this) * get<i>(v); });
+    });
+}
+
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::is_collinear(const vector<N, T>& v, T eps) const noexcept    // |sin| <= eps, from the squared minors (|this x v|^2 for N == 3)
+{
+    const vector<N, T> a = (*this) / vector_detail::max_abs(*this), b = v / vector_detail::max_abs(v);
+    T s = T(0);
+    vector_detail::for_each<N>([&](auto i)
+    {
+        vector_detail::for_each<N>([&](auto j)
+        {
+            if constexpr (j > i)
+            {
+                const T m = get<i>(a) * get<j>(b) - get<j>(a) * get<i>(b);
+                s += m * m;
+            }
+        });
+    });
+    return s <= eps * eps * a.lengthsqr() * b.lengthsqr();
+}
+
+template <std::size_t N, typename T>
+constexpr void vector<N, T>::collinear_this(T a) noexcept         // With a negative a you make it anticollinear
+{
+    (*this) *= a;
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::collinear(T a) const noexcept  // With a negative a you make it anticollinear
+{
+    return (*this) * a;
+}
+
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::is_anticollinear(const vector<N, T>& v) const noexcept
+{
+    return is_collinear(v) && dot(v) < T(0);
+}
+
+template <std::size_t N, typename T>
+constexpr bool vector<N, T>::is_anticollinear(const vector<N, T>& v, T eps) const noexcept
+{
+    return is_collinear(v, eps) && dot(v) < T(0);
+}
+
+template <std::size_t N, typename T>
+constexpr void vector<N, T>::anticollinear_this(T a) noexcept         // With a negative a you make it collinear
+{
+    (*this) *= -a;
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> vector<N, T>::anticollinear(T a) const noexcept  // With a negative a you make it collinear
+{
+    return (*this) * -a;
+}
+
+#endif
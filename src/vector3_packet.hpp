@@ -0,0 +1,579 @@
+#ifndef VECTOR3_PACKET_H
+#define VECTOR3_PACKET_H
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include "vector3.hpp"
+
+#if defined(__SSE2__) || defined(__AVX__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// Packets of W vector3 held lane-parallel (x0..xW-1, y0..yW-1, z0..zW-1) in SIMD
+// registers, with the vector3 operator set applied to all lanes at once. Lanes use the
+// GCC/Clang vector extensions, so the instruction set is the one the translation unit
+// is compiled for (-msse4.1, -mavx2, -mavx512f, ...). Predicates return lane masks,
+// bit i set when lane i satisfies the test.
+
+#if !defined(__GNUC__) && !defined(__clang__)
+#error "vector3_packet requires the GCC/Clang vector extensions"
+#endif
+
+template <typename T, int W>
+struct packet_lanes
+{
+    typedef T type __attribute__((vector_size(W * sizeof(T))));
+};
+
+template <typename T, int W>
+struct packet_int_lanes    // Same size integer lanes, comparisons yield 0 / -1
+{
+    using int_type = typename std::conditional<sizeof(T) == 4, std::int32_t, std::int64_t>::type;
+    typedef int_type type __attribute__((vector_size(W * sizeof(T))));
+};
+
+using packet_mask = std::uint32_t;
+
+template <typename T, int W>
+inline packet_mask to_mask(typename packet_int_lanes<T, W>::type c)    // One bit per lane
+{
+    packet_mask m = 0;
+    for (int i = 0; i < W; ++i)
+        m |= packet_mask(c[i] != 0) << i;
+    return m;
+}
+
+template <typename T, int W>
+inline typename packet_lanes<T, W>::type packet_sqrt(typename packet_lanes<T, W>::type a)
+{
+    using lane_type = typename packet_lanes<T, W>::type;
+    constexpr bool f = sizeof(T) == 4;
+    constexpr std::size_t bytes = W * sizeof(T);
+    (void)f;
+#if defined(__AVX512F__)
+    if constexpr (bytes == 64)
+        return f ? lane_type(_mm512_maskz_sqrt_ps(__mmask16(0xffff), __m512(a)))      // Zero-masked forms avoid GCC 12
+                 : lane_type(_mm512_maskz_sqrt_pd(__mmask8(0xff), __m512d(a)));        // -Wmaybe-uninitialized noise
+#endif
+#if defined(__AVX__)
+    if constexpr (bytes == 32)
+        return f ? lane_type(_mm256_sqrt_ps(__m256(a))) : lane_type(_mm256_sqrt_pd(__m256d(a)));
+#endif
+#if defined(__SSE2__)
+    if constexpr (bytes == 16)
+        return f ? lane_type(_mm_sqrt_ps(__m128(a))) : lane_type(_mm_sqrt_pd(__m128d(a)));
+#endif
+    lane_type r;
+    for (int i = 0; i < W; ++i)
+        r[i] = std::sqrt(a[i]);
+    return r;
+}
+
+template <typename T, int W>
+struct vector3_packet
+{
+    using lane_type = typename packet_lanes<T, W>::type;
+    using int_lane_type = typename packet_int_lanes<T, W>::type;
+
+    static_assert(W <= 32, "lane masks hold at most 32 lanes");
+
+    lane_type x;
+    lane_type y;
+    lane_type z;
+
+    /* ctors */
+    vector3_packet() = default;
+    vector3_packet(lane_type x_, lane_type y_, lane_type z_);
+    vector3_packet(const vector3<T>& v);        // Broadcast to every lane
+    explicit vector3_packet(T a);
+
+    /* Initialization */
+    void init();        // Initialize to zero
+
+    /* Lane access and AoS conversion */
+    vector3<T> get(int i) const;
+    void       set(int i, const vector3<T>& v);
+
+    static vector3_packet<T, W> load(const vector3<T>* p);                      // W consecutive vectors
+    void                        store(vector3<T>* p) const;
+    static vector3_packet<T, W> gather(const vector3<T>* base, const int* idx); // base[idx[0]], ..., base[idx[W-1]]
+    void                        scatter(vector3<T>* base, const int* idx) const;
+
+    void        zero();
+    packet_mask is_zero() const;
+    packet_mask is_almost_zero(const T tolerance = T(0.01)) const;
+    packet_mask is_any_zero() const;
+
+    /* Equality operators, lane masks */
+
+    packet_mask operator==(const vector3_packet<T, W>& v) const;
+    packet_mask operator!=(const vector3_packet<T, W>& v) const;
+
+    /* Compound arithmetic operators */
+
+    vector3_packet<T, W>& operator+=(const vector3_packet<T, W>& v);
+    vector3_packet<T, W>& operator+=(const T a);
+    vector3_packet<T, W>& operator-=(const vector3_packet<T, W>& v);
+    vector3_packet<T, W>& operator-=(const T a);
+    vector3_packet<T, W>& operator*=(const vector3_packet<T, W>& v);
+    vector3_packet<T, W>& operator*=(const T a);
+    vector3_packet<T, W>& operator*=(const lane_type a);            // Per lane scalar
+    vector3_packet<T, W>& operator/=(const vector3_packet<T, W>& v);
+    vector3_packet<T, W>& operator/=(const T a);
+    vector3_packet<T, W>& operator/=(const lane_type a);            // Per lane scalar
+
+    /* Unary arithmetic operators */
+
+    vector3_packet<T, W> operator-(void) const;
+
+    /* Binary arithmetic operators */
+
+    vector3_packet<T, W> operator+(const vector3_packet<T, W>& v) const;
+    vector3_packet<T, W> operator-(const vector3_packet<T, W>& v) const;
+    vector3_packet<T, W> operator*(const vector3_packet<T, W>& v) const;   // Element wise multiplication
+    vector3_packet<T, W> operator*(T a) const;
+    vector3_packet<T, W> operator*(lane_type a) const;
+    vector3_packet<T, W> operator/(const vector3_packet<T, W>& v) const;
+    vector3_packet<T, W> operator/(T a) const;                             // Division by scalar
+    vector3_packet<T, W> operator/(lane_type a) const;
+
+    /* Other operations */
+
+    lane_type            lengthsqr() const;     // Squared Magnitude of every lane
+    lane_type            length() const;        // Magnitude of every lane
+    void                 normalize_this();      // Unit Vectors
+    vector3_packet<T, W> normalize() const;
+    lane_type            distance(const vector3_packet<T, W>& v) const;
+    lane_type            dot(const vector3_packet<T, W>& v) const;
+    vector3_packet<T, W> cross(const vector3_packet<T, W>& v) const;
+
+    packet_mask          is_perpendicular(const vector3_packet<T, W>& v) const;
+    packet_mask          is_perpendicular(const vector3_packet<T, W>& v, T eps) const;    // As vector3, per lane
+    packet_mask          is_opposite(const vector3_packet<T, W>& v) const;
+    packet_mask          is_opposite(const vector3_packet<T, W>& v, T eps) const;
+    void                 opposite_this();
+    vector3_packet<T, W> opposite() const;
+    packet_mask          is_collinear(const vector3_packet<T, W>& v) const;
+    packet_mask          is_collinear(const vector3_packet<T, W>& v, T eps) const;
+    packet_mask          is_anticollinear(const vector3_packet<T, W>& v) const;
+    packet_mask          is_anticollinear(const vector3_packet<T, W>& v, T eps) const;
+};
+
+using vector3x4f  = vector3_packet<float, 4>;
+using vector3x8f  = vector3_packet<float, 8>;
+using vector3x16f = vector3_packet<float, 16>;
+using vector3x2d  = vector3_packet<double, 2>;
+using vector3x4d  = vector3_packet<double, 4>;
+using vector3x8d  = vector3_packet<double, 8>;
+
+/* ctors */
+
+template <typename T, int W>
+inline vector3_packet<T, W>::vector3_packet(lane_type x_, lane_type y_, lane_type z_) : x(x_), y(y_), z(z_) {}
+
+template <typename T, int W>
+inline vector3_packet<T, W>::vector3_packet(const vector3<T>& v)
+{
+    x = lane_type{} + v.x;
+    y = lane_type{} + v.y;
+    z = lane_type{} + v.z;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W>::vector3_packet(T a)
+{
+    x = lane_type{} + a;
+    y = x;
+    z = x;
+}
+
+/* Initialization */
+template <typename T, int W>
+inline void vector3_packet<T, W>::init()
+{
+    x = lane_type{};
+    y = lane_type{};
+    z = lane_type{};
+}
+
+/* Lane access and AoS conversion */
+template <typename T, int W>
+inline vector3<T> vector3_packet<T, W>::get(int i) const
+{
+    return vector3<T>(x[i], y[i], z[i]);
+}
+
+template <typename T, int W>
+inline void vector3_packet<T, W>::set(int i, const vector3<T>& v)
+{
+    x[i] = v.x; y[i] = v.y; z[i] = v.z;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::load(const vector3<T>* p)
+{
+    vector3_packet<T, W> v;
+    for (int i = 0; i < W; ++i)
+    {
+        v.x[i] = p[i].x; v.y[i] = p[i].y; v.z[i] = p[i].z;
+    }
+    return v;
+}
+
+template <typename T, int W>
+inline void vector3_packet<T, W>::store(vector3<T>* p) const
+{
+    for (int i = 0; i < W; ++i)
+    {
+        p[i].x = x[i]; p[i].y = y[i]; p[i].z = z[i];
+    }
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::gather(const vector3<T>* base, const int* idx)
+{
+    vector3_packet<T, W> v;
+    for (int i = 0; i < W; ++i)
+    {
+        const vector3<T>& s = base[idx[i]];
+        v.x[i] = s.x; v.y[i] = s.y; v.z[i] = s.z;
+    }
+    return v;
+}
+
+template <typename T, int W>
+inline void vector3_packet<T, W>::scatter(vector3<T>* base, const int* idx) const
+{
+    for (int i = 0; i < W; ++i)
+    {
+        vector3<T>& d = base[idx[i]];
+        d.x = x[i]; d.y = y[i]; d.z = z[i];
+    }
+}
+
+template <typename T, int W>
+inline void vector3_packet<T, W>::zero()
+{
+    init();
+}
+
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::is_zero() const
+{
+    return to_mask<T, W>((x == 0) & (y == 0) & (z == 0));
+}
+
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::is_almost_zero(T tolerance) const
+{
+    return to_mask<T, W>((x > -tolerance) & (x < tolerance) &
+                         (y > -tolerance) & (y < tolerance) &
+                         (z > -tolerance) & (z < tolerance));
+}
+
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::is_any_zero() const
+{
+    return to_mask<T, W>((x == 0) | (y == 0) | (z == 0));
+}
+
+/* Equality operators */
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::operator==(const vector3_packet<T, W>& v) const
+{
+    return to_mask<T, W>((x == v.x) & (y == v.y) & (z == v.z));
+}
+
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::operator!=(const vector3_packet<T, W>& v) const
+{
+    return ~((*this) == v) & (W == 32 ? ~packet_mask(0) : (packet_mask(1) << W) - 1);
+}
+
+/* Compound arithmetic operators */
+template <typename T, int W>
+inline vector3_packet<T, W>& vector3_packet<T, W>::operator+=(const vector3_packet<T, W>& v)
+{
+    x += v.x; y += v.y; z += v.z; return *this;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W>& vector3_packet<T, W>::operator+=(T a)
+{
+    x += a; y += a; z += a; return *this;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W>& vector3_packet<T, W>::operator-=(const vector3_packet<T, W>& v)
+{
+    x -= v.x; y -= v.y; z -= v.z; return *this;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W>& vector3_packet<T, W>::operator-=(T a)
+{
+    x -= a; y -= a; z -= a; return *this;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W>& vector3_packet<T, W>::operator*=(const vector3_packet<T, W>& v)
+{
+    x *= v.x; y *= v.y; z *= v.z; return *this;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W>& vector3_packet<T, W>::operator*=(T a)
+{
+    x *= a; y *= a; z *= a; return *this;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W>& vector3_packet<T, W>::operator*=(lane_type a)
+{
+    x *= a; y *= a; z *= a; return *this;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W>& vector3_packet<T, W>::operator/=(const vector3_packet<T, W>& v)
+{
+    x /= v.x; y /= v.y; z /= v.z; return *this;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W>& vector3_packet<T, W>::operator/=(T a)
+{
+    x /= a; y /= a; z /= a; return *this;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W>& vector3_packet<T, W>::operator/=(lane_type a)
+{
+    x /= a; y /= a; z /= a; return *this;
+}
+
+/* Unary arithmetic operators */
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::operator-(void) const
+{
+    return vector3_packet<T, W>(-x, -y, -z);
+}
+
+/* Binary arithmetic operators */
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::operator+(const vector3_packet<T, W>& v) const
+{
+    return vector3_packet<T, W>(x + v.x, y + v.y, z + v.z);
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::operator-(const vector3_packet<T, W>& v) const
+{
+    return vector3_packet<T, W>(x - v.x, y - v.y, z - v.z);
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::operator*(const vector3_packet<T, W>& v) const   // Element wise multiplication
+{
+    return vector3_packet<T, W>(x * v.x, y * v.y, z * v.z);
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::operator*(T a) const
+{
+    return vector3_packet<T, W>(x * a, y * a, z * a);
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::operator*(lane_type a) const
+{
+    return vector3_packet<T, W>(x * a, y * a, z * a);
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> operator*(T a, const vector3_packet<T, W>& v)     // Symmetric multiplication by scalar
+{
+    return v * a;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::operator/(const vector3_packet<T, W>& v) const   // Element wise division
+{
+    return vector3_packet<T, W>(x / v.x, y / v.y, z / v.z);
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::operator/(T a) const
+{
+    return vector3_packet<T, W>(x / a, y / a, z / a);
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::operator/(lane_type a) const
+{
+    return vector3_packet<T, W>(x / a, y / a, z / a);
+}
+
+/* Other operations */
+template <typename T, int W>
+inline typename vector3_packet<T, W>::lane_type vector3_packet<T, W>::lengthsqr() const
+{
+    return x * x + y * y + z * z;
+}
+
+template <typename T, int W>
+inline typename vector3_packet<T, W>::lane_type vector3_packet<T, W>::length() const
+{
+    return packet_sqrt<T, W>(lengthsqr());
+}
+
+template <typename T, int W>
+inline void vector3_packet<T, W>::normalize_this()
+{
+    (*this) /= length();
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::normalize() const
+{
+    return (*this) / length();
+}
+
+template <typename T, int W>
+inline typename vector3_packet<T, W>::lane_type distance(const vector3_packet<T, W>& lv, const vector3_packet<T, W>& rv)
+{
+    return (lv - rv).length();
+}
+
+template <typename T, int W>
+inline typename vector3_packet<T, W>::lane_type vector3_packet<T, W>::distance(const vector3_packet<T, W>& v) const
+{
+    return ::distance(*this, v);
+}
+
+template <typename T, int W>
+inline typename vector3_packet<T, W>::lane_type dot(const vector3_packet<T, W>& lv, const vector3_packet<T, W>& rv)
+{
+    return lv.x * rv.x + lv.y * rv.y + lv.z * rv.z;
+}
+
+template <typename T, int W>
+inline typename vector3_packet<T, W>::lane_type vector3_packet<T, W>::dot(const vector3_packet<T, W>& v) const
+{
+    return ::dot(*this, v);
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> cross(const vector3_packet<T, W>& lv, const vector3_packet<T, W>& rv)
+{
+    return vector3_packet<T, W>(lv.y * rv.z - lv.z * rv.y,
+                                lv.z * rv.x - lv.x * rv.z,
+                                lv.x * rv.y - lv.y * rv.x);
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::cross(const vector3_packet<T, W>& v) const
+{
+    return ::cross(*this, v);
+}
+
+template <typename T, int W, typename... V>
+inline typename vector3_packet<T, W>::lane_type packet_max_abs(const vector3_packet<T, W>& v, const V&... w)    // vector_detail::max_abs per lane
+{
+    using lane_type = typename vector3_packet<T, W>::lane_type;
+    const lane_type zero = lane_type{};
+    lane_type m = zero;
+    auto f = [&](const lane_type& c) { const lane_type a = c < zero ? -c : c; m = a > m ? a : m; };
+    f(v.x); f(v.y); f(v.z);
+    ((f(w.x), f(w.y), f(w.z)), ...);
+    return m > zero ? m : zero + T(1);
+}
+
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::is_perpendicular(const vector3_packet<T, W>& v) const
+{
+    return to_mask<T, W>(dot(v) == 0);
+}
+
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::is_perpendicular(const vector3_packet<T, W>& v, T eps) const
+{
+    const vector3_packet<T, W> a = (*this) / packet_max_abs(*this), b = v / packet_max_abs(v);
+    const lane_type d = a.dot(b);
+    return to_mask<T, W>(d * d <= eps * eps * a.lengthsqr() * b.lengthsqr());
+}
+
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::is_opposite(const vector3_packet<T, W>& v) const
+{
+    return to_mask<T, W>((x == -v.x) & (y == -v.y) & (z == -v.z));
+}
+
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::is_opposite(const vector3_packet<T, W>& v, T eps) const
+{
+    const lane_type m = packet_max_abs(*this, v);
+    const vector3_packet<T, W> l = (*this) / m, r = v / m;
+    const lane_type a = l.lengthsqr(), b = r.lengthsqr();
+    return to_mask<T, W>((l + r).lengthsqr() <= eps * eps * (a > b ? a : b));
+}
+
+template <typename T, int W>
+inline void vector3_packet<T, W>::opposite_this()
+{
+    x = -x; y = -y; z = -z;
+}
+
+template <typename T, int W>
+inline vector3_packet<T, W> vector3_packet<T, W>::opposite() const
+{
+    return -(*this);
+}
+
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::is_collinear(const vector3_packet<T, W>& v) const
+{
+    return to_mask<T, W>((x * v.y == y * v.x) & (x * v.z == z * v.x) & (y * v.z == z * v.y));
+}
+
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::is_collinear(const vector3_packet<T, W>& v, T eps) const
+{
+    const vector3_packet<T, W> a = (*this) / packet_max_abs(*this), b = v / packet_max_abs(v);
+    const lane_type mxy = a.x * b.y - a.y * b.x;
+    const lane_type mxz = a.x * b.z - a.z * b.x;
+    const lane_type myz = a.y * b.z - a.z * b.y;
+    return to_mask<T, W>(mxy * mxy + mxz * mxz + myz * myz <= eps * eps * a.lengthsqr() * b.lengthsqr());
+}
+
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::is_anticollinear(const vector3_packet<T, W>& v) const
+{
+    return is_collinear(v) & to_mask<T, W>(dot(v) < 0);
+}
+
+template <typename T, int W>
+inline packet_mask vector3_packet<T, W>::is_anticollinear(const vector3_packet<T, W>& v, T eps) const
+{
+    return is_collinear(v, eps) & to_mask<T, W>(dot(v) < 0);
+}
+
+/* Lane selection, mask bit i picks lane i of a, otherwise of b */
+
+template <typename T, int W>
+inline vector3_packet<T, W> select(packet_mask m, const vector3_packet<T, W>& a, const vector3_packet<T, W>& b)
+{
+    using int_lane_type = typename vector3_packet<T, W>::int_lane_type;
+    using lane_type = typename vector3_packet<T, W>::lane_type;
+
+    int_lane_type sel;
+    for (int i = 0; i < W; ++i)
+        sel[i] = (m >> i) & 1 ? -1 : 0;
+
+    return vector3_packet<T, W>(lane_type((int_lane_type(a.x) & sel) | (int_lane_type(b.x) & ~sel)),
+                                lane_type((int_lane_type(a.y) & sel) | (int_lane_type(b.y) & ~sel)),
+                                lane_type((int_lane_type(a.z) & sel) | (int_lane_type(b.z) & ~sel)));
+}
+
+#endif
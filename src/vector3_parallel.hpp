@@ -0,0 +1,342 @@
+#ifndef VECTOR3_PARALLEL_H
+#define VECTOR3_PARALLEL_H
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "vector3.hpp"
+#include "vector3_simd.hpp"
+#include "vector_thread_pool.hpp"
+
+// Multithreaded batch operations for large vector3<float> and vector3<double> arrays.
+//
+// Arrays are cut into blocks of grain elements; each block runs the SIMD batch kernel
+// of vector3_simd.hpp on a vector_thread_pool. Block boundaries depend only on the
+// array length and the grain, never on the thread count, and reductions combine the
+// per-block results in block order on the calling thread. For a given grain every
+// result is therefore bitwise identical whatever the number of threads.
+
+constexpr std::size_t parallel_grain = 16384;      // Default elements per block
+
+struct parallel_dispatch
+{
+    std::unique_ptr<vector_thread_pool> pool;
+
+    parallel_dispatch() : pool(new vector_thread_pool()) {}
+
+    static parallel_dispatch& instance()
+    {
+        static parallel_dispatch d;
+        return d;
+    }
+};
+
+inline vector_thread_pool& parallel_pool()
+{
+    return *parallel_dispatch::instance().pool;
+}
+
+inline void set_parallel_threads(std::size_t threads)     // 0 = hardware_concurrency, not thread safe
+{
+    parallel_dispatch::instance().pool.reset(new vector_thread_pool(threads));
+}
+
+/* Block helpers */
+
+inline std::size_t parallel_blocks(std::size_t n, std::size_t grain)
+{
+    assert(grain > 0);
+    return (n + grain - 1) / grain;
+}
+
+template <typename K>
+void parallel_for_blocks(std::size_t n, std::size_t grain, K&& k)      // k(first, count) per block
+{
+    parallel_pool().parallel_for(parallel_blocks(n, grain), [&](std::size_t b)
+    {
+        const std::size_t first = b * grain;
+        k(first, n - first < grain ? n - first : grain);
+    });
+}
+
+template <typename R, typename K, typename C>
+R parallel_reduce_blocks(std::size_t n, std::size_t grain, R init, K&& k, C&& combine)
+{
+    std::vector<R> partial(parallel_blocks(n, grain));
+    parallel_for_blocks(n, grain, [&](std::size_t first, std::size_t count) { partial[first / grain] = k(first, count); });
+    for (const R& p : partial)
+        init = combine(init, p);
+    return init;
+}
+
+template <typename T>
+T parallel_dot_sum_impl(const vector3<T>* a, const vector3<T>* b, std::size_t n, std::size_t grain)
+{
+    return parallel_reduce_blocks(n, grain, T(0), [&](std::size_t first, std::size_t count)
+    {
+        T s[4] = { T(0), T(0), T(0), T(0) };        // Fixed interleave, independent of threads
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            s[0] += ::dot(a[first + i], b[first + i]);
+            s[1] += ::dot(a[first + i + 1], b[first + i + 1]);
+            s[2] += ::dot(a[first + i + 2], b[first + i + 2]);
+            s[3] += ::dot(a[first + i + 3], b[first + i + 3]);
+        }
+        for (; i < count; ++i)
+            s[0] += ::dot(a[first + i], b[first + i]);
+        return (s[0] + s[1]) + (s[2] + s[3]);
+    }, [](T l, T r) { return l + r; });
+}
+
+template <typename T>
+std::pair<vector3<T>, vector3<T>> parallel_bounds_impl(const vector3<T>* a, std::size_t n, std::size_t grain)
+{
+    const T inf = std::numeric_limits<T>::infinity();
+    const std::pair<vector3<T>, vector3<T>> empty(vector3<T>(inf), vector3<T>(-inf));
+    return parallel_reduce_blocks(n, grain, empty, [&](std::size_t first, std::size_t count)
+    {
+        vector3<T> lo = a[first];
+        vector3<T> hi = a[first];
+        for (std::size_t i = first + 1; i < first + count; ++i)
+        {
+            lo.x = a[i].x < lo.x ? a[i].x : lo.x; hi.x = a[i].x > hi.x ? a[i].x : hi.x;
+            lo.y = a[i].y < lo.y ? a[i].y : lo.y; hi.y = a[i].y > hi.y ? a[i].y : hi.y;
+            lo.z = a[i].z < lo.z ? a[i].z : lo.z; hi.z = a[i].z > hi.z ? a[i].z : hi.z;
+        }
+        return std::pair<vector3<T>, vector3<T>>(lo, hi);
+    }, [](const std::pair<vector3<T>, vector3<T>>& l, const std::pair<vector3<T>, vector3<T>>& r)
+    {
+        return std::pair<vector3<T>, vector3<T>>(
+            vector3<T>(r.first.x < l.first.x ? r.first.x : l.first.x,
+                       r.first.y < l.first.y ? r.first.y : l.first.y,
+                       r.first.z < l.first.z ? r.first.z : l.first.z),
+            vector3<T>(r.second.x > l.second.x ? r.second.x : l.second.x,
+                       r.second.y > l.second.y ? r.second.y : l.second.y,
+                       r.second.z > l.second.z ? r.second.z : l.second.z));
+    });
+}
+
+template <typename T>
+vector3<T> parallel_centroid_impl(const vector3<T>* a, std::size_t n, std::size_t grain)
+{
+    const vector3<T> sum = parallel_reduce_blocks(n, grain, vector3<T>(T(0)), [&](std::size_t first, std::size_t count)
+    {
+        vector3<T> s(T(0));
+        for (std::size_t i = first; i < first + count; ++i)
+            s += a[i];
+        return s;
+    }, [](const vector3<T>& l, const vector3<T>& r) { return l + r; });
+    return n ? sum / T(n) : sum;
+}
+
+/* Element wise operations. out must be as long as the inputs and may alias them exactly */
+
+inline void parallel_add(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<vector3<float>> out,
+                         std::size_t grain = parallel_grain)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_add(a.subspan(i, m), b.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_sub(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<vector3<float>> out,
+                         std::size_t grain = parallel_grain)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_sub(a.subspan(i, m), b.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_mul(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<vector3<float>> out,
+                         std::size_t grain = parallel_grain)     // Element wise multiplication
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_mul(a.subspan(i, m), b.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_scale(std::span<const vector3<float>> a, float s, std::span<vector3<float>> out,
+                           std::size_t grain = parallel_grain)
+{
+    assert(out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_scale(a.subspan(i, m), s, out.subspan(i, m)); });
+}
+
+inline void parallel_dot(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<float> out,
+                         std::size_t grain = parallel_grain)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_dot(a.subspan(i, m), b.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_cross(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<vector3<float>> out,
+                           std::size_t grain = parallel_grain)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_cross(a.subspan(i, m), b.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_normalize(std::span<const vector3<float>> a, std::span<vector3<float>> out,
+                               std::size_t grain = parallel_grain)
+{
+    assert(out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_normalize(a.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_normalize_fast(std::span<const vector3<float>> a, std::span<vector3<float>> out,
+                                    std::size_t grain = parallel_grain)     // Relative error below 5e-6
+{
+    assert(out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_normalize_fast(a.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_normalize_safe(std::span<const vector3<float>> a, std::span<vector3<float>> out,
+                                    std::size_t grain = parallel_grain)     // Zero length vectors stay zero
+{
+    assert(out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_normalize_safe(a.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_length(std::span<const vector3<float>> a, std::span<float> out,
+                            std::size_t grain = parallel_grain)
+{
+    assert(out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_length(a.subspan(i, m), out.subspan(i, m)); });
+}
+
+template <typename F>
+void parallel_transform(std::span<const vector3<float>> a, std::span<vector3<float>> out, F f,
+                        std::size_t grain = parallel_grain)     // out[i] = f(a[i])
+{
+    assert(out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m)
+    {
+        for (std::size_t j = i; j < i + m; ++j)
+            out[j] = f(a[j]);
+    });
+}
+
+inline void parallel_add(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<vector3<double>> out,
+                         std::size_t grain = parallel_grain)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_add(a.subspan(i, m), b.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_sub(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<vector3<double>> out,
+                         std::size_t grain = parallel_grain)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_sub(a.subspan(i, m), b.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_mul(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<vector3<double>> out,
+                         std::size_t grain = parallel_grain)     // Element wise multiplication
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_mul(a.subspan(i, m), b.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_scale(std::span<const vector3<double>> a, double s, std::span<vector3<double>> out,
+                           std::size_t grain = parallel_grain)
+{
+    assert(out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_scale(a.subspan(i, m), s, out.subspan(i, m)); });
+}
+
+inline void parallel_dot(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<double> out,
+                         std::size_t grain = parallel_grain)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_dot(a.subspan(i, m), b.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_cross(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<vector3<double>> out,
+                           std::size_t grain = parallel_grain)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_cross(a.subspan(i, m), b.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_normalize(std::span<const vector3<double>> a, std::span<vector3<double>> out,
+                               std::size_t grain = parallel_grain)
+{
+    assert(out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_normalize(a.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_normalize_fast(std::span<const vector3<double>> a, std::span<vector3<double>> out,
+                                    std::size_t grain = parallel_grain)     // Relative error below 5e-6
+{
+    assert(out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_normalize_fast(a.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_normalize_safe(std::span<const vector3<double>> a, std::span<vector3<double>> out,
+                                    std::size_t grain = parallel_grain)     // Zero length vectors stay zero
+{
+    assert(out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_normalize_safe(a.subspan(i, m), out.subspan(i, m)); });
+}
+
+inline void parallel_length(std::span<const vector3<double>> a, std::span<double> out,
+                            std::size_t grain = parallel_grain)
+{
+    assert(out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m) { batch_length(a.subspan(i, m), out.subspan(i, m)); });
+}
+
+template <typename F>
+void parallel_transform(std::span<const vector3<double>> a, std::span<vector3<double>> out, F f,
+                        std::size_t grain = parallel_grain)     // out[i] = f(a[i])
+{
+    assert(out.size() >= a.size());
+    parallel_for_blocks(a.size(), grain, [&](std::size_t i, std::size_t m)
+    {
+        for (std::size_t j = i; j < i + m; ++j)
+            out[j] = f(a[j]);
+    });
+}
+
+/* Reductions, deterministic for a given grain */
+
+inline float parallel_dot_sum(std::span<const vector3<float>> a, std::span<const vector3<float>> b,
+                              std::size_t grain = parallel_grain)     // Sum of a[i] . b[i]
+{
+    assert(a.size() == b.size());
+    return parallel_dot_sum_impl(a.data(), b.data(), a.size(), grain);
+}
+
+inline std::pair<vector3<float>, vector3<float>> parallel_bounds(std::span<const vector3<float>> a,
+                                                                 std::size_t grain = parallel_grain)   // Component wise min and max, (inf, -inf) when empty
+{
+    return parallel_bounds_impl(a.data(), a.size(), grain);
+}
+
+inline vector3<float> parallel_centroid(std::span<const vector3<float>> a, std::size_t grain = parallel_grain)
+{
+    return parallel_centroid_impl(a.data(), a.size(), grain);
+}
+
+inline double parallel_dot_sum(std::span<const vector3<double>> a, std::span<const vector3<double>> b,
+                               std::size_t grain = parallel_grain)    // Sum of a[i] . b[i]
+{
+    assert(a.size() == b.size());
+    return parallel_dot_sum_impl(a.data(), b.data(), a.size(), grain);
+}
+
+inline std::pair<vector3<double>, vector3<double>> parallel_bounds(std::span<const vector3<double>> a,
+                                                                   std::size_t grain = parallel_grain)     // Component wise min and max, (inf, -inf) when empty
+{
+    return parallel_bounds_impl(a.data(), a.size(), grain);
+}
+
+inline vector3<double> parallel_centroid(std::span<const vector3<double>> a, std::size_t grain = parallel_grain)
+{
+    return parallel_centroid_impl(a.data(), a.size(), grain);
+}
+
+#endif
@@ -0,0 +1,795 @@
+#ifndef VECTOR3_SIMD_H
+#define VECTOR3_SIMD_H
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#include "vector3.hpp"
+
+// Batch operations over arrays of vector3<float> and vector3<double> with hand written
+// SSE4.1, AVX2 and AVX-512 kernels. The instruction set is picked once, at first use,
+// from CPUID, so a single binary runs on any x86-64 machine; other targets and
+// compilers get the scalar kernels. FMA contraction is disabled inside the kernels,
+// the scalar backend included (avx512f implies FMA), so every backend returns the same
+// bits. They match the scalar operators as long as those are not contracted either:
+// GCC contracts them by default once FMA is enabled (-mfma, -march=native), so the
+// guarantee then needs -ffp-contract=off for the whole translation unit.
+// The _fma batches instead fuse exactly where madd, lerp, dot_fma and cross_fma do,
+// with FMA instructions on AVX2 and AVX-512 (the AVX2 level requires FMA) and std::fma
+// lane by lane below that, so they also match the scalar forms on every backend.
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR3_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define VECTOR3_SIMD_X86 0
+#endif
+
+static_assert(sizeof(vector3<float>) == 3 * sizeof(float), "vector3<float> must be tightly packed");
+static_assert(sizeof(vector3<double>) == 3 * sizeof(double), "vector3<double> must be tightly packed");
+
+enum class simd_level
+{
+    scalar,
+    sse41,
+    avx2,
+    avx512
+};
+
+template <typename T>
+struct vector3_kernels
+{
+    void (*add)(const vector3<T>* a, const vector3<T>* b, vector3<T>* out, std::size_t n);
+    void (*sub)(const vector3<T>* a, const vector3<T>* b, vector3<T>* out, std::size_t n);
+    void (*mul)(const vector3<T>* a, const vector3<T>* b, vector3<T>* out, std::size_t n);
+    void (*scale)(const vector3<T>* a, T s, vector3<T>* out, std::size_t n);
+    void (*dot)(const vector3<T>* a, const vector3<T>* b, T* out, std::size_t n);
+    void (*cross)(const vector3<T>* a, const vector3<T>* b, vector3<T>* out, std::size_t n);
+    void (*normalize)(const vector3<T>* a, vector3<T>* out, std::size_t n);
+    void (*normalize_fast)(const vector3<T>* a, vector3<T>* out, std::size_t n);
+    void (*normalize_safe)(const vector3<T>* a, vector3<T>* out, std::size_t n);
+    void (*length)(const vector3<T>* a, T* out, std::size_t n);
+    void (*madd)(const vector3<T>* a, const vector3<T>* b, const vector3<T>* c, vector3<T>* out, std::size_t n);
+    void (*madd_scale)(const vector3<T>* a, T s, const vector3<T>* c, vector3<T>* out, std::size_t n);
+    void (*lerp)(const vector3<T>* a, const vector3<T>* b, T t, vector3<T>* out, std::size_t n);
+    void (*dot_fma)(const vector3<T>* a, const vector3<T>* b, T* out, std::size_t n);
+    void (*cross_fma)(const vector3<T>* a, const vector3<T>* b, vector3<T>* out, std::size_t n);
+};
+
+/* Scalar backend */
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector3_simd_scalar
+{
+
+template <typename T>
+struct pack
+{
+    using scalar = T;
+    using reg = T;
+    static constexpr std::size_t width = 1;
+
+    static reg  load(const T* p)        { return *p; }
+    static void store(T* p, reg a)      { *p = a; }
+    static reg  set1(T a)               { return a; }
+    static reg  add(reg a, reg b)       { return a + b; }
+    static reg  sub(reg a, reg b)       { return a - b; }
+    static reg  mul(reg a, reg b)       { return a * b; }
+    static reg  div(reg a, reg b)       { return a / b; }
+    static reg  sqrt(reg a)             { return std::sqrt(a); }
+    static reg  rsqrt(reg a)            { return rsqrt_fast(a); }
+    static reg  keep_gt(reg v, reg a, reg b)    { return a > b ? v : T(0); }     // v where a > b, else zero
+    static reg  fma(reg a, reg b, reg c)        { return std::fma(a, b, c); }
+    static reg  fms(reg a, reg b, reg c)        { return std::fma(a, b, -c); }     // a b - c
+    static reg  fnma(reg a, reg b, reg c)       { return std::fma(-a, b, c); }     // c - a b
+
+    static void load3(const T* p, reg& x, reg& y, reg& z)   { x = p[0]; y = p[1]; z = p[2]; }
+    static void store3(T* p, reg x, reg y, reg z)           { p[0] = x; p[1] = y; p[2] = z; }
+};
+
+using pack_f = pack<float>;
+using pack_d = pack<double>;
+
+#include "vector3_simd_kernels.hpp"
+
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+#if VECTOR3_SIMD_X86
+
+/* SSE4.1 backend, 4 floats or 2 doubles per register */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector3_simd_sse41
+{
+
+struct pack_f
+{
+    using scalar = float;
+    using reg = __m128;
+    static constexpr std::size_t width = 4;
+
+    static reg  load(const float* p)    { return _mm_loadu_ps(p); }
+    static void store(float* p, reg a)  { _mm_storeu_ps(p, a); }
+    static reg  set1(float a)           { return _mm_set1_ps(a); }
+    static reg  add(reg a, reg b)       { return _mm_add_ps(a, b); }
+    static reg  sub(reg a, reg b)       { return _mm_sub_ps(a, b); }
+    static reg  mul(reg a, reg b)       { return _mm_mul_ps(a, b); }
+    static reg  div(reg a, reg b)       { return _mm_div_ps(a, b); }
+    static reg  sqrt(reg a)             { return _mm_sqrt_ps(a); }
+    static reg  keep_gt(reg v, reg a, reg b)    { return _mm_and_ps(_mm_cmpgt_ps(a, b), v); }
+    static reg  fms(reg a, reg b, reg c)        { return fma(a, b, _mm_xor_ps(c, set1(-0.0f))); }
+    static reg  fnma(reg a, reg b, reg c)       { return fma(_mm_xor_ps(a, set1(-0.0f)), b, c); }
+
+    static reg fma(reg a, reg b, reg c)     // SSE4.1 has no FMA, std::fma lane by lane
+    {
+        alignas(16) float x[4], y[4], z[4];
+        _mm_store_ps(x, a);
+        _mm_store_ps(y, b);
+        _mm_store_ps(z, c);
+        for (int j = 0; j < 4; ++j)
+            x[j] = std::fma(x[j], y[j], z[j]);
+        return _mm_load_ps(x);
+    }
+
+    static reg rsqrt(reg a)     // rsqrtps estimate and one Newton-Raphson step
+    {
+        const reg y = _mm_rsqrt_ps(a);
+        const reg h = mul(set1(0.5f), a);
+        return mul(y, sub(set1(1.5f), mul(mul(h, y), y)));
+    }
+
+    static void load3(const float* p, reg& x, reg& y, reg& z)    // x0y0z0x1 y1z1x2y2 z2x3y3z3
+    {
+        const reg m0 = _mm_loadu_ps(p);
+        const reg m1 = _mm_loadu_ps(p + 4);
+        const reg m2 = _mm_loadu_ps(p + 8);
+        const reg xy = _mm_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 1, 3, 2));
+        const reg yz = _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 2, 1));
+        x = _mm_shuffle_ps(m0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+        y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+        z = _mm_shuffle_ps(yz, m2, _MM_SHUFFLE(3, 0, 3, 1));
+    }
+
+    static void store3(float* p, reg x, reg y, reg z)
+    {
+        const reg xy = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        const reg yz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+        const reg zx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_ps(p,     _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(p + 4, _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0)));
+        _mm_storeu_ps(p + 8, _mm_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+};
+
+struct pack_d
+{
+    using scalar = double;
+    using reg = __m128d;
+    static constexpr std::size_t width = 2;
+
+    static reg  load(const double* p)   { return _mm_loadu_pd(p); }
+    static void store(double* p, reg a) { _mm_storeu_pd(p, a); }
+    static reg  set1(double a)          { return _mm_set1_pd(a); }
+    static reg  add(reg a, reg b)       { return _mm_add_pd(a, b); }
+    static reg  sub(reg a, reg b)       { return _mm_sub_pd(a, b); }
+    static reg  mul(reg a, reg b)       { return _mm_mul_pd(a, b); }
+    static reg  div(reg a, reg b)       { return _mm_div_pd(a, b); }
+    static reg  sqrt(reg a)             { return _mm_sqrt_pd(a); }
+    static reg  keep_gt(reg v, reg a, reg b)    { return _mm_and_pd(_mm_cmpgt_pd(a, b), v); }
+    static reg  fms(reg a, reg b, reg c)        { return fma(a, b, _mm_xor_pd(c, set1(-0.0))); }
+    static reg  fnma(reg a, reg b, reg c)       { return fma(_mm_xor_pd(a, set1(-0.0)), b, c); }
+
+    static reg fma(reg a, reg b, reg c)     // SSE4.1 has no FMA, std::fma lane by lane
+    {
+        alignas(16) double x[2], y[2], z[2];
+        _mm_store_pd(x, a);
+        _mm_store_pd(y, b);
+        _mm_store_pd(z, c);
+        for (int j = 0; j < 2; ++j)
+            x[j] = std::fma(x[j], y[j], z[j]);
+        return _mm_load_pd(x);
+    }
+
+    static reg rsqrt(reg a)     // Integer estimate and two Newton-Raphson steps, as rsqrt_fast(double)
+    {
+        reg y = _mm_castsi128_pd(_mm_sub_epi64(_mm_set1_epi64x(0x5fe6eb50c7b537a9ll), _mm_srli_epi64(_mm_castpd_si128(a), 1)));
+        const reg h = mul(set1(0.5), a);
+        y = mul(y, sub(set1(1.5), mul(mul(h, y), y)));
+        return mul(y, sub(set1(1.5), mul(mul(h, y), y)));
+    }
+
+    static void load3(const double* p, reg& x, reg& y, reg& z)   // x0y0 z0x1 y1z1
+    {
+        const reg m0 = _mm_loadu_pd(p);
+        const reg m1 = _mm_loadu_pd(p + 2);
+        const reg m2 = _mm_loadu_pd(p + 4);
+        x = _mm_shuffle_pd(m0, m1, 2);
+        y = _mm_shuffle_pd(m0, m2, 1);
+        z = _mm_shuffle_pd(m1, m2, 2);
+    }
+
+    static void store3(double* p, reg x, reg y, reg z)
+    {
+        _mm_storeu_pd(p,     _mm_shuffle_pd(x, y, 0));
+        _mm_storeu_pd(p + 2, _mm_shuffle_pd(z, x, 2));
+        _mm_storeu_pd(p + 4, _mm_shuffle_pd(y, z, 3));
+    }
+};
+
+#include "vector3_simd_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX2 backend, 8 floats or 4 doubles per register */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector3_simd_avx2
+{
+
+struct pack_f
+{
+    using scalar = float;
+    using reg = __m256;
+    static constexpr std::size_t width = 8;
+
+    static reg  load(const float* p)    { return _mm256_loadu_ps(p); }
+    static void store(float* p, reg a)  { _mm256_storeu_ps(p, a); }
+    static reg  set1(float a)           { return _mm256_set1_ps(a); }
+    static reg  add(reg a, reg b)       { return _mm256_add_ps(a, b); }
+    static reg  sub(reg a, reg b)       { return _mm256_sub_ps(a, b); }
+    static reg  mul(reg a, reg b)       { return _mm256_mul_ps(a, b); }
+    static reg  div(reg a, reg b)       { return _mm256_div_ps(a, b); }
+    static reg  sqrt(reg a)             { return _mm256_sqrt_ps(a); }
+    static reg  keep_gt(reg v, reg a, reg b)    { return _mm256_and_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ), v); }
+    static reg  fma(reg a, reg b, reg c)        { return _mm256_fmadd_ps(a, b, c); }
+    static reg  fms(reg a, reg b, reg c)        { return _mm256_fmsub_ps(a, b, c); }
+    static reg  fnma(reg a, reg b, reg c)       { return _mm256_fnmadd_ps(a, b, c); }
+
+    static reg rsqrt(reg a)     // rsqrtps estimate and one Newton-Raphson step
+    {
+        const reg y = _mm256_rsqrt_ps(a);
+        const reg h = mul(set1(0.5f), a);
+        return mul(y, sub(set1(1.5f), mul(mul(h, y), y)));
+    }
+
+    static void load3(const float* p, reg& x, reg& y, reg& z)    // Vectors 0-3 in the low lane, 4-7 in the high lane
+    {
+        reg m0 = _mm256_castps128_ps256(_mm_loadu_ps(p));
+        reg m1 = _mm256_castps128_ps256(_mm_loadu_ps(p + 4));
+        reg m2 = _mm256_castps128_ps256(_mm_loadu_ps(p + 8));
+        m0 = _mm256_insertf128_ps(m0, _mm_loadu_ps(p + 12), 1);
+        m1 = _mm256_insertf128_ps(m1, _mm_loadu_ps(p + 16), 1);
+        m2 = _mm256_insertf128_ps(m2, _mm_loadu_ps(p + 20), 1);
+        const reg xy = _mm256_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 1, 3, 2));
+        const reg yz = _mm256_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 2, 1));
+        x = _mm256_shuffle_ps(m0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+        y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+        z = _mm256_shuffle_ps(yz, m2, _MM_SHUFFLE(3, 0, 3, 1));
+    }
+
+    static void store3(float* p, reg x, reg y, reg z)
+    {
+        const reg xy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        const reg yz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+        const reg zx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+        const reg m0 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+        const reg m1 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+        const reg m2 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(p,      _mm256_castps256_ps128(m0));
+        _mm_storeu_ps(p + 4,  _mm256_castps256_ps128(m1));
+        _mm_storeu_ps(p + 8,  _mm256_castps256_ps128(m2));
+        _mm_storeu_ps(p + 12, _mm256_extractf128_ps(m0, 1));
+        _mm_storeu_ps(p + 16, _mm256_extractf128_ps(m1, 1));
+        _mm_storeu_ps(p + 20, _mm256_extractf128_ps(m2, 1));
+    }
+};
+
+struct pack_d
+{
+    using scalar = double;
+    using reg = __m256d;
+    static constexpr std::size_t width = 4;
+
+    static reg  load(const double* p)   { return _mm256_loadu_pd(p); }
+    static void store(double* p, reg a) { _mm256_storeu_pd(p, a); }
+    static reg  set1(double a)          { return _mm256_set1_pd(a); }
+    static reg  add(reg a, reg b)       { return _mm256_add_pd(a, b); }
+    static reg  sub(reg a, reg b)       { return _mm256_sub_pd(a, b); }
+    static reg  mul(reg a, reg b)       { return _mm256_mul_pd(a, b); }
+    static reg  div(reg a, reg b)       { return _mm256_div_pd(a, b); }
+    static reg  sqrt(reg a)             { return _mm256_sqrt_pd(a); }
+    static reg  keep_gt(reg v, reg a, reg b)    { return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ), v); }
+    static reg  fma(reg a, reg b, reg c)        { return _mm256_fmadd_pd(a, b, c); }
+    static reg  fms(reg a, reg b, reg c)        { return _mm256_fmsub_pd(a, b, c); }
+    static reg  fnma(reg a, reg b, reg c)       { return _mm256_fnmadd_pd(a, b, c); }
+
+    static reg rsqrt(reg a)     // Integer estimate and two Newton-Raphson steps, as rsqrt_fast(double)
+    {
+        reg y = _mm256_castsi256_pd(_mm256_sub_epi64(_mm256_set1_epi64x(0x5fe6eb50c7b537a9ll), _mm256_srli_epi64(_mm256_castpd_si256(a), 1)));
+        const reg h = mul(set1(0.5), a);
+        y = mul(y, sub(set1(1.5), mul(mul(h, y), y)));
+        return mul(y, sub(set1(1.5), mul(mul(h, y), y)));
+    }
+
+    static void load3(const double* p, reg& x, reg& y, reg& z)   // x0y0z0x1 y1z1x2y2 z2x3y3z3
+    {
+        const reg m0 = _mm256_loadu_pd(p);
+        const reg m1 = _mm256_loadu_pd(p + 4);
+        const reg m2 = _mm256_loadu_pd(p + 8);
+        x = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(m0, m1, 0x4), m2, 0x2), _MM_SHUFFLE(1, 2, 3, 0));
+        y = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(m0, m1, 0x9), m2, 0x4), _MM_SHUFFLE(2, 3, 0, 1));
+        z = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(m0, m1, 0x2), m2, 0x9), _MM_SHUFFLE(3, 0, 1, 2));
+    }
+
+    static void store3(double* p, reg x, reg y, reg z)
+    {
+        x = _mm256_permute4x64_pd(x, _MM_SHUFFLE(1, 2, 3, 0));     // x0x3x2x1
+        y = _mm256_permute4x64_pd(y, _MM_SHUFFLE(2, 3, 0, 1));     // y1y0y3y2
+        z = _mm256_permute4x64_pd(z, _MM_SHUFFLE(3, 0, 1, 2));     // z2z1z0z3
+        _mm256_storeu_pd(p,     _mm256_blend_pd(_mm256_blend_pd(x, y, 0x2), z, 0x4));
+        _mm256_storeu_pd(p + 4, _mm256_blend_pd(_mm256_blend_pd(y, z, 0x2), x, 0x4));
+        _mm256_storeu_pd(p + 8, _mm256_blend_pd(_mm256_blend_pd(z, x, 0x2), y, 0x4));
+    }
+};
+
+#include "vector3_simd_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX-512 backend, 16 floats or 8 doubles per register */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"  // False positives inside GCC's own avx512fintrin.h
+#endif
+
+namespace vector3_simd_avx512
+{
+
+// Permutation indices to deinterleave W vectors held in three registers a, b, c.
+// gather_ab picks component k from a:b, gather_c then replaces the lanes that live in c.
+// scatter_xy / scatter_z do the inverse for output register r.
+
+template <int W>
+struct permute_table
+{
+    int gather_ab[3][W];
+    int gather_c[3][W];
+    int scatter_xy[3][W];
+    int scatter_z[3][W];
+
+    constexpr permute_table() : gather_ab(), gather_c(), scatter_xy(), scatter_z()
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            for (int i = 0; i < W; ++i)
+            {
+                const int s = 3 * i + k;
+                gather_ab[k][i] = s < 2 * W ? s : 0;
+                gather_c[k][i] = s < 2 * W ? i : W + s - 2 * W;
+            }
+        }
+        for (int r = 0; r < 3; ++r)
+        {
+            for (int i = 0; i < W; ++i)
+            {
+                const int j = r * W + i;
+                const int c = j % 3;
+                const int v = j / 3;
+                scatter_xy[r][i] = c == 0 ? v : (c == 1 ? W + v : 0);
+                scatter_z[r][i] = c == 2 ? W + v : i;
+            }
+        }
+    }
+};
+
+struct pack_f
+{
+    using scalar = float;
+    using reg = __m512;
+    static constexpr std::size_t width = 16;
+    static constexpr permute_table<16> table{};
+
+    static reg  load(const float* p)    { return _mm512_loadu_ps(p); }
+    static void store(float* p, reg a)  { _mm512_storeu_ps(p, a); }
+    static reg  set1(float a)           { return _mm512_set1_ps(a); }
+    static reg  add(reg a, reg b)       { return _mm512_add_ps(a, b); }
+    static reg  sub(reg a, reg b)       { return _mm512_sub_ps(a, b); }
+    static reg  mul(reg a, reg b)       { return _mm512_mul_ps(a, b); }
+    static reg  div(reg a, reg b)       { return _mm512_div_ps(a, b); }
+    static reg  sqrt(reg a)             { return _mm512_sqrt_ps(a); }
+    static reg  keep_gt(reg v, reg a, reg b)    { return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), v); }
+    static reg  fma(reg a, reg b, reg c)        { return _mm512_fmadd_ps(a, b, c); }
+    static reg  fms(reg a, reg b, reg c)        { return _mm512_fmsub_ps(a, b, c); }
+    static reg  fnma(reg a, reg b, reg c)       { return _mm512_fnmadd_ps(a, b, c); }
+
+    static reg rsqrt(reg a)     // rsqrt14ps estimate and one Newton-Raphson step
+    {
+        const reg y = _mm512_rsqrt14_ps(a);
+        const reg h = mul(set1(0.5f), a);
+        return mul(y, sub(set1(1.5f), mul(mul(h, y), y)));
+    }
+
+    static __m512i index(const int* i)  { return _mm512_loadu_si512(i); }
+
+    static void load3(const float* p, reg& x, reg& y, reg& z)
+    {
+        const reg a = _mm512_loadu_ps(p);
+        const reg b = _mm512_loadu_ps(p + 16);
+        const reg c = _mm512_loadu_ps(p + 32);
+        x = _mm512_permutex2var_ps(_mm512_permutex2var_ps(a, index(table.gather_ab[0]), b), index(table.gather_c[0]), c);
+        y = _mm512_permutex2var_ps(_mm512_permutex2var_ps(a, index(table.gather_ab[1]), b), index(table.gather_c[1]), c);
+        z = _mm512_permutex2var_ps(_mm512_permutex2var_ps(a, index(table.gather_ab[2]), b), index(table.gather_c[2]), c);
+    }
+
+    static void store3(float* p, reg x, reg y, reg z)
+    {
+        for (int r = 0; r < 3; ++r)
+            _mm512_storeu_ps(p + 16 * r, _mm512_permutex2var_ps(_mm512_permutex2var_ps(x, index(table.scatter_xy[r]), y),
+                                                                index(table.scatter_z[r]), z));
+    }
+};
+
+struct pack_d
+{
+    using scalar = double;
+    using reg = __m512d;
+    static constexpr std::size_t width = 8;
+    static constexpr permute_table<8> table{};
+
+    static reg  load(const double* p)   { return _mm512_loadu_pd(p); }
+    static void store(double* p, reg a) { _mm512_storeu_pd(p, a); }
+    static reg  set1(double a)          { return _mm512_set1_pd(a); }
+    static reg  add(reg a, reg b)       { return _mm512_add_pd(a, b); }
+    static reg  sub(reg a, reg b)       { return _mm512_sub_pd(a, b); }
+    static reg  mul(reg a, reg b)       { return _mm512_mul_pd(a, b); }
+    static reg  div(reg a, reg b)       { return _mm512_div_pd(a, b); }
+    static reg  sqrt(reg a)             { return _mm512_sqrt_pd(a); }
+    static reg  keep_gt(reg v, reg a, reg b)    { return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ), v); }
+    static reg  fma(reg a, reg b, reg c)        { return _mm512_fmadd_pd(a, b, c); }
+    static reg  fms(reg a, reg b, reg c)        { return _mm512_fmsub_pd(a, b, c); }
+    static reg  fnma(reg a, reg b, reg c)       { return _mm512_fnmadd_pd(a, b, c); }
+
+    static reg rsqrt(reg a)     // rsqrt14pd estimate and one Newton-Raphson step
+    {
+        const reg y = _mm512_rsqrt14_pd(a);
+        const reg h = mul(set1(0.5), a);
+        return mul(y, sub(set1(1.5), mul(mul(h, y), y)));
+    }
+
+    static __m512i index(const int* i)  // 64 bit permute indices from the int table
+    {
+        return _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(i)));
+    }
+
+    static void load3(const double* p, reg& x, reg& y, reg& z)
+    {
+        const reg a = _mm512_loadu_pd(p);
+        const reg b = _mm512_loadu_pd(p + 8);
+        const reg c = _mm512_loadu_pd(p + 16);
+        x = _mm512_permutex2var_pd(_mm512_permutex2var_pd(a, index(table.gather_ab[0]), b), index(table.gather_c[0]), c);
+        y = _mm512_permutex2var_pd(_mm512_permutex2var_pd(a, index(table.gather_ab[1]), b), index(table.gather_c[1]), c);
+        z = _mm512_permutex2var_pd(_mm512_permutex2var_pd(a, index(table.gather_ab[2]), b), index(table.gather_c[2]), c);
+    }
+
+    static void store3(double* p, reg x, reg y, reg z)
+    {
+        for (int r = 0; r < 3; ++r)
+            _mm512_storeu_pd(p + 8 * r, _mm512_permutex2var_pd(_mm512_permutex2var_pd(x, index(table.scatter_xy[r]), y),
+                                                               index(table.scatter_z[r]), z));
+    }
+};
+
+#include "vector3_simd_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+#endif // VECTOR3_SIMD_X86
+
+/* Dispatch */
+
+inline simd_level detect_simd_level()      // Best instruction set supported by this CPU and OS
+{
+#if VECTOR3_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return simd_level::avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return simd_level::avx2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return simd_level::sse41;
+#endif
+    return simd_level::scalar;
+}
+
+template <typename T>
+vector3_kernels<T> select_kernels(simd_level level)
+{
+#if VECTOR3_SIMD_X86
+    if (level == simd_level::avx512)
+        return vector3_simd_avx512::make_kernels<typename std::conditional<sizeof(T) == 4, vector3_simd_avx512::pack_f, vector3_simd_avx512::pack_d>::type>();
+    if (level == simd_level::avx2)
+        return vector3_simd_avx2::make_kernels<typename std::conditional<sizeof(T) == 4, vector3_simd_avx2::pack_f, vector3_simd_avx2::pack_d>::type>();
+    if (level == simd_level::sse41)
+        return vector3_simd_sse41::make_kernels<typename std::conditional<sizeof(T) == 4, vector3_simd_sse41::pack_f, vector3_simd_sse41::pack_d>::type>();
+#else
+    (void)level;
+#endif
+    return vector3_simd_scalar::make_kernels<vector3_simd_scalar::pack<T>>();
+}
+
+struct simd_dispatch
+{
+    simd_level              level;
+    vector3_kernels<float>  kf;
+    vector3_kernels<double> kd;
+
+    simd_dispatch() { select(detect_simd_level()); }
+
+    void select(simd_level l)
+    {
+        level = l;
+        kf = select_kernels<float>(l);
+        kd = select_kernels<double>(l);
+    }
+
+    static simd_dispatch& instance()
+    {
+        static simd_dispatch d;
+        return d;
+    }
+};
+
+inline simd_level active_simd_level()
+{
+    return simd_dispatch::instance().level;
+}
+
+inline void set_simd_level(simd_level level)   // Clamped to what the CPU supports, not thread safe
+{
+    const simd_level best = detect_simd_level();
+    simd_dispatch::instance().select(level < best ? level : best);
+}
+
+inline const vector3_kernels<float>& active_kernels(float)
+{
+    return simd_dispatch::instance().kf;
+}
+
+inline const vector3_kernels<double>& active_kernels(double)
+{
+    return simd_dispatch::instance().kd;
+}
+
+/* Batch operations. out must be as long as the inputs and may alias them exactly */
+
+inline void batch_add(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<vector3<float>> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0f).add(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_sub(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<vector3<float>> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0f).sub(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_mul(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<vector3<float>> out)    // Element wise multiplication
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0f).mul(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_scale(std::span<const vector3<float>> a, float s, std::span<vector3<float>> out)
+{
+    assert(out.size() >= a.size());
+    active_kernels(0.0f).scale(a.data(), s, out.data(), a.size());
+}
+
+inline void batch_dot(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<float> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0f).dot(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_cross(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<vector3<float>> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0f).cross(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_normalize(std::span<const vector3<float>> a, std::span<vector3<float>> out)
+{
+    assert(out.size() >= a.size());
+    active_kernels(0.0f).normalize(a.data(), out.data(), a.size());
+}
+
+inline void batch_normalize_fast(std::span<const vector3<float>> a, std::span<vector3<float>> out)     // Relative error below 5e-6
+{
+    assert(out.size() >= a.size());
+    active_kernels(0.0f).normalize_fast(a.data(), out.data(), a.size());
+}
+
+inline void batch_normalize_safe(std::span<const vector3<float>> a, std::span<vector3<float>> out)     // Zero length vectors stay zero
+{
+    assert(out.size() >= a.size());
+    active_kernels(0.0f).normalize_safe(a.data(), out.data(), a.size());
+}
+
+inline void batch_length(std::span<const vector3<float>> a, std::span<float> out)
+{
+    assert(out.size() >= a.size());
+    active_kernels(0.0f).length(a.data(), out.data(), a.size());
+}
+
+inline void batch_madd(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<const vector3<float>> c, std::span<vector3<float>> out)     // a * b + c
+{
+    assert(a.size() == b.size() && a.size() == c.size() && out.size() >= a.size());
+    active_kernels(0.0f).madd(a.data(), b.data(), c.data(), out.data(), a.size());
+}
+
+inline void batch_madd(std::span<const vector3<float>> a, float s, std::span<const vector3<float>> c, std::span<vector3<float>> out)     // a * s + c
+{
+    assert(a.size() == c.size() && out.size() >= a.size());
+    active_kernels(0.0f).madd_scale(a.data(), s, c.data(), out.data(), a.size());
+}
+
+inline void batch_lerp(std::span<const vector3<float>> a, std::span<const vector3<float>> b, float t, std::span<vector3<float>> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0f).lerp(a.data(), b.data(), t, out.data(), a.size());
+}
+
+inline void batch_dot_fma(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<float> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0f).dot_fma(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_cross_fma(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<vector3<float>> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0f).cross_fma(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_add(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<vector3<double>> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0).add(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_sub(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<vector3<double>> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0).sub(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_mul(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<vector3<double>> out)    // Element wise multiplication
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0).mul(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_scale(std::span<const vector3<double>> a, double s, std::span<vector3<double>> out)
+{
+    assert(out.size() >= a.size());
+    active_kernels(0.0).scale(a.data(), s, out.data(), a.size());
+}
+
+inline void batch_dot(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<double> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0).dot(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_cross(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<vector3<double>> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0).cross(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_normalize(std::span<const vector3<double>> a, std::span<vector3<double>> out)
+{
+    assert(out.size() >= a.size());
+    active_kernels(0.0).normalize(a.data(), out.data(), a.size());
+}
+
+inline void batch_normalize_fast(std::span<const vector3<double>> a, std::span<vector3<double>> out)     // Relative error below 5e-6
+{
+    assert(out.size() >= a.size());
+    active_kernels(0.0).normalize_fast(a.data(), out.data(), a.size());
+}
+
+inline void batch_normalize_safe(std::span<const vector3<double>> a, std::span<vector3<double>> out)     // Zero length vectors stay zero
+{
+    assert(out.size() >= a.size());
+    active_kernels(0.0).normalize_safe(a.data(), out.data(), a.size());
+}
+
+inline void batch_length(std::span<const vector3<double>> a, std::span<double> out)
+{
+    assert(out.size() >= a.size());
+    active_kernels(0.0).length(a.data(), out.data(), a.size());
+}
+
+inline void batch_madd(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<const vector3<double>> c, std::span<vector3<double>> out)     // a * b + c
+{
+    assert(a.size() == b.size() && a.size() == c.size() && out.size() >= a.size());
+    active_kernels(0.0).madd(a.data(), b.data(), c.data(), out.data(), a.size());
+}
+
+inline void batch_madd(std::span<const vector3<double>> a, double s, std::span<const vector3<double>> c, std::span<vector3<double>> out)     // a * s + c
+{
+    assert(a.size() == c.size() && out.size() >= a.size());
+    active_kernels(0.0).madd_scale(a.data(), s, c.data(), out.data(), a.size());
+}
+
+inline void batch_lerp(std::span<const vector3<double>> a, std::span<const vector3<double>> b, double t, std::span<vector3<double>> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0).lerp(a.data(), b.data(), t, out.data(), a.size());
+}
+
+inline void batch_dot_fma(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<double> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0).dot_fma(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void batch_cross_fma(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<vector3<double>> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    active_kernels(0.0).cross_fma(a.data(), b.data(), out.data(), a.size());
+}
+
+#endif
@@ -0,0 +1,331 @@
+// Batch kernels shared by every vector3 SIMD backend. This file is included once per
+// instruction set from vector3_simd.hpp, inside a namespace that defines the pack
+// types, so it intentionally has no include guard.
+//
+// A pack P exposes: scalar, reg, width, load, store, set1, add, sub, mul, div, sqrt,
+// rsqrt (estimate refined to rsqrt_fast accuracy), keep_gt, fma, fms (a b - c) and fnma
+// (c - a b) each rounded once, load3 (width interleaved vector3 into x, y, z registers)
+// and store3 (the inverse).
+// Kernels process whole packs and finish the remainder with the scalar vector3 code,
+// or, where that code has several roundings, with the scalar backend, which is built
+// without FMA contraction like the other backends. So every backend returns the same
+// bits. The exception is the fast normalization, whose float estimate differs between
+// instruction sets and is only guaranteed to the documented error bound.
+
+template <typename P>
+void add(const vector3<typename P::scalar>* a, const vector3<typename P::scalar>* b,
+         vector3<typename P::scalar>* out, std::size_t n)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    const T* pb = reinterpret_cast<const T*>(b);
+    T* po = reinterpret_cast<T*>(out);
+    const std::size_t m = 3 * n;
+
+    std::size_t i = 0;
+    for (; i + P::width <= m; i += P::width)
+        P::store(po + i, P::add(P::load(pa + i), P::load(pb + i)));
+    for (; i < m; ++i)
+        po[i] = pa[i] + pb[i];
+}
+
+template <typename P>
+void sub(const vector3<typename P::scalar>* a, const vector3<typename P::scalar>* b,
+         vector3<typename P::scalar>* out, std::size_t n)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    const T* pb = reinterpret_cast<const T*>(b);
+    T* po = reinterpret_cast<T*>(out);
+    const std::size_t m = 3 * n;
+
+    std::size_t i = 0;
+    for (; i + P::width <= m; i += P::width)
+        P::store(po + i, P::sub(P::load(pa + i), P::load(pb + i)));
+    for (; i < m; ++i)
+        po[i] = pa[i] - pb[i];
+}
+
+template <typename P>
+void mul(const vector3<typename P::scalar>* a, const vector3<typename P::scalar>* b,
+         vector3<typename P::scalar>* out, std::size_t n)      // Element wise multiplication
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    const T* pb = reinterpret_cast<const T*>(b);
+    T* po = reinterpret_cast<T*>(out);
+    const std::size_t m = 3 * n;
+
+    std::size_t i = 0;
+    for (; i + P::width <= m; i += P::width)
+        P::store(po + i, P::mul(P::load(pa + i), P::load(pb + i)));
+    for (; i < m; ++i)
+        po[i] = pa[i] * pb[i];
+}
+
+template <typename P>
+void scale(const vector3<typename P::scalar>* a, typename P::scalar s,
+           vector3<typename P::scalar>* out, std::size_t n)     // Multiplication by scalar
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    T* po = reinterpret_cast<T*>(out);
+    const std::size_t m = 3 * n;
+    const typename P::reg vs = P::set1(s);
+
+    std::size_t i = 0;
+    for (; i + P::width <= m; i += P::width)
+        P::store(po + i, P::mul(P::load(pa + i), vs));
+    for (; i < m; ++i)
+        po[i] = pa[i] * s;
+}
+
+template <typename P>
+void dot(const vector3<typename P::scalar>* a, const vector3<typename P::scalar>* b,
+         typename P::scalar* out, std::size_t n)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    const T* pb = reinterpret_cast<const T*>(b);
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width)
+    {
+        typename P::reg ax, ay, az, bx, by, bz;
+        P::load3(pa + 3 * i, ax, ay, az);
+        P::load3(pb + 3 * i, bx, by, bz);
+        P::store(out + i, P::add(P::add(P::mul(ax, bx), P::mul(ay, by)), P::mul(az, bz)));
+    }
+    if (i < n)
+        vector3_simd_scalar::dot<vector3_simd_scalar::pack<T>>(a + i, b + i, out + i, n - i);
+}
+
+template <typename P>
+void cross(const vector3<typename P::scalar>* a, const vector3<typename P::scalar>* b,
+           vector3<typename P::scalar>* out, std::size_t n)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    const T* pb = reinterpret_cast<const T*>(b);
+    T* po = reinterpret_cast<T*>(out);
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width)
+    {
+        typename P::reg ax, ay, az, bx, by, bz;
+        P::load3(pa + 3 * i, ax, ay, az);
+        P::load3(pb + 3 * i, bx, by, bz);
+        P::store3(po + 3 * i,
+                  P::sub(P::mul(ay, bz), P::mul(az, by)),
+                  P::sub(P::mul(az, bx), P::mul(ax, bz)),
+                  P::sub(P::mul(ax, by), P::mul(ay, bx)));
+    }
+    if (i < n)
+        vector3_simd_scalar::cross<vector3_simd_scalar::pack<T>>(a + i, b + i, out + i, n - i);
+}
+
+template <typename P>
+void normalize(const vector3<typename P::scalar>* a, vector3<typename P::scalar>* out, std::size_t n)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    T* po = reinterpret_cast<T*>(out);
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width)
+    {
+        typename P::reg x, y, z;
+        P::load3(pa + 3 * i, x, y, z);
+        const typename P::reg l = P::sqrt(P::add(P::add(P::mul(x, x), P::mul(y, y)), P::mul(z, z)));
+        P::store3(po + 3 * i, P::div(x, l), P::div(y, l), P::div(z, l));
+    }
+    if (i < n)
+        vector3_simd_scalar::normalize<vector3_simd_scalar::pack<T>>(a + i, out + i, n - i);
+}
+
+template <typename P>
+void normalize_fast(const vector3<typename P::scalar>* a, vector3<typename P::scalar>* out, std::size_t n)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    T* po = reinterpret_cast<T*>(out);
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width)
+    {
+        typename P::reg x, y, z;
+        P::load3(pa + 3 * i, x, y, z);
+        const typename P::reg r = P::rsqrt(P::add(P::add(P::mul(x, x), P::mul(y, y)), P::mul(z, z)));
+        P::store3(po + 3 * i, P::mul(x, r), P::mul(y, r), P::mul(z, r));
+    }
+    for (; i < n; ++i)
+        out[i] = a[i].normalize_fast();
+}
+
+template <typename P>
+void normalize_safe(const vector3<typename P::scalar>* a, vector3<typename P::scalar>* out, std::size_t n)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    T* po = reinterpret_cast<T*>(out);
+    const typename P::reg tiny = P::set1(std::numeric_limits<T>::min());
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width)
+    {
+        typename P::reg x, y, z;
+        P::load3(pa + 3 * i, x, y, z);
+        const typename P::reg l = P::add(P::add(P::mul(x, x), P::mul(y, y)), P::mul(z, z));
+        const typename P::reg r = P::keep_gt(P::rsqrt(l), l, tiny);
+        P::store3(po + 3 * i, P::mul(x, r), P::mul(y, r), P::mul(z, r));
+    }
+    for (; i < n; ++i)
+        out[i] = a[i].normalize_safe();
+}
+
+template <typename P>
+void length(const vector3<typename P::scalar>* a, typename P::scalar* out, std::size_t n)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width)
+    {
+        typename P::reg x, y, z;
+        P::load3(pa + 3 * i, x, y, z);
+        P::store(out + i, P::sqrt(P::add(P::add(P::mul(x, x), P::mul(y, y)), P::mul(z, z))));
+    }
+    if (i < n)
+        vector3_simd_scalar::length<vector3_simd_scalar::pack<T>>(a + i, out + i, n - i);
+}
+
+template <typename P>
+void madd(const vector3<typename P::scalar>* a, const vector3<typename P::scalar>* b, const vector3<typename P::scalar>* c,
+          vector3<typename P::scalar>* out, std::size_t n)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    const T* pb = reinterpret_cast<const T*>(b);
+    const T* pc = reinterpret_cast<const T*>(c);
+    T* po = reinterpret_cast<T*>(out);
+    const std::size_t m = 3 * n;
+
+    std::size_t i = 0;
+    for (; i + P::width <= m; i += P::width)
+        P::store(po + i, P::fma(P::load(pa + i), P::load(pb + i), P::load(pc + i)));
+    for (; i < m; ++i)
+        po[i] = vector_fma(pa[i], pb[i], pc[i]);
+}
+
+template <typename P>
+void madd_scale(const vector3<typename P::scalar>* a, typename P::scalar s, const vector3<typename P::scalar>* c,
+                vector3<typename P::scalar>* out, std::size_t n)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    const T* pc = reinterpret_cast<const T*>(c);
+    T* po = reinterpret_cast<T*>(out);
+    const std::size_t m = 3 * n;
+    const typename P::reg vs = P::set1(s);
+
+    std::size_t i = 0;
+    for (; i + P::width <= m; i += P::width)
+        P::store(po + i, P::fma(P::load(pa + i), vs, P::load(pc + i)));
+    for (; i < m; ++i)
+        po[i] = vector_fma(pa[i], s, pc[i]);
+}
+
+template <typename P>
+void lerp(const vector3<typename P::scalar>* a, const vector3<typename P::scalar>* b, typename P::scalar t,
+          vector3<typename P::scalar>* out, std::size_t n)     // As ::lerp, t b + (a - t a)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    const T* pb = reinterpret_cast<const T*>(b);
+    T* po = reinterpret_cast<T*>(out);
+    const std::size_t m = 3 * n;
+    const typename P::reg vt = P::set1(t);
+
+    std::size_t i = 0;
+    for (; i + P::width <= m; i += P::width)
+    {
+        const typename P::reg va = P::load(pa + i);
+        P::store(po + i, P::fma(vt, P::load(pb + i), P::fnma(vt, va, va)));
+    }
+    for (; i < m; ++i)
+        po[i] = vector_fma(t, pb[i], vector_fma(-t, pa[i], pa[i]));
+}
+
+template <typename P>
+void dot_fma(const vector3<typename P::scalar>* a, const vector3<typename P::scalar>* b,
+             typename P::scalar* out, std::size_t n)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    const T* pb = reinterpret_cast<const T*>(b);
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width)
+    {
+        typename P::reg ax, ay, az, bx, by, bz;
+        P::load3(pa + 3 * i, ax, ay, az);
+        P::load3(pb + 3 * i, bx, by, bz);
+        P::store(out + i, P::fma(az, bz, P::fma(ay, by, P::mul(ax, bx))));
+    }
+    for (; i < n; ++i)
+        out[i] = ::dot_fma(a[i], b[i]);
+}
+
+template <typename P>
+inline typename P::reg difference_of_products(typename P::reg a, typename P::reg b, typename P::reg c, typename P::reg d)
+{
+    const typename P::reg w = P::mul(c, d);
+    return P::add(P::fms(a, b, w), P::fnma(c, d, w));
+}
+
+template <typename P>
+void cross_fma(const vector3<typename P::scalar>* a, const vector3<typename P::scalar>* b,
+               vector3<typename P::scalar>* out, std::size_t n)
+{
+    using T = typename P::scalar;
+    const T* pa = reinterpret_cast<const T*>(a);
+    const T* pb = reinterpret_cast<const T*>(b);
+    T* po = reinterpret_cast<T*>(out);
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width)
+    {
+        typename P::reg ax, ay, az, bx, by, bz;
+        P::load3(pa + 3 * i, ax, ay, az);
+        P::load3(pb + 3 * i, bx, by, bz);
+        P::store3(po + 3 * i,
+                  difference_of_products<P>(ay, bz, az, by),
+                  difference_of_products<P>(az, bx, ax, bz),
+                  difference_of_products<P>(ax, by, ay, bx));
+    }
+    for (; i < n; ++i)
+        out[i] = ::cross_fma(a[i], b[i]);
+}
+
+template <typename P>
+vector3_kernels<typename P::scalar> make_kernels()
+{
+    vector3_kernels<typename P::scalar> k;
+    k.add            = &add<P>;
+    k.sub            = &sub<P>;
+    k.mul            = &mul<P>;
+    k.scale          = &scale<P>;
+    k.dot            = &dot<P>;
+    k.cross          = &cross<P>;
+    k.normalize      = &normalize<P>;
+    k.normalize_fast = &normalize_fast<P>;
+    k.normalize_safe = &normalize_safe<P>;
+    k.length         = &length<P>;
+    k.madd           = &madd<P>;
+    k.madd_scale     = &madd_scale<P>;
+    k.lerp           = &lerp<P>;
+    k.dot_fma        = &dot_fma<P>;
+    k.cross_fma      = &cross_fma<P>;
+    return k;
+}
@@ -0,0 +1,17 @@
+#ifndef VECTOR4_H
+#define VECTOR4_H
+
+#include <type_traits>
+
+#include "vector.hpp"
+
+template <typename T>
+using vector4 = vector<4, T>;
+
+/* Layout guarantees relied on by ptr(), the SoA/SIMD batch code and memcpy based containers */
+
+static_assert(std::is_trivially_copyable_v<vector4<float>> && std::is_standard_layout_v<vector4<float>>);
+static_assert(std::is_trivially_copyable_v<vector4<double>> && std::is_standard_layout_v<vector4<double>>);
+static_assert(sizeof(vector4<float>) == 4 * sizeof(float) && sizeof(vector4<double>) == 4 * sizeof(double));
+
+#endif
@@ -0,0 +1,636 @@
+#ifndef VECTOR_AABB_H
+#define VECTOR_AABB_H
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "vector2.hpp"
+#include "vector3.hpp"
+#include "vector3_simd.hpp"
+#include "vector_order.hpp"
+#include "vector_thread_pool.hpp"
+
+// Axis aligned bounding boxes over vector2 and vector3, and the batch operations a
+// broadphase needs.
+//
+//     batch_bounds        the box of a point array, a SIMD min / max reduction
+//     batch_overlaps      bit i set when boxes[i] overlaps the query box
+//     batch_contains      bit i set when points[i] or boxes[i] lies inside the box
+//     sweep_and_prune     every overlapping pair of a box array
+//
+// Boxes are closed, so touching boxes overlap. The default box is empty, lo = +inf
+// and hi = -inf, which is the identity of expand and merge and overlaps nothing; a
+// box with lo > hi on any axis, or a NaN bound, counts as empty.
+//
+// The batch forms follow the vector3_simd dispatch (set_simd_level applies) and
+// return the same results on every backend; the bounds can differ only in the sign
+// of a zero, as min and max do not order -0 and +0. The bitmasks hold bit i % 64 of
+// word i / 64 for element i, like the batch predicates. With a pool, batch_bounds
+// reduces aabb_block sized blocks and sweep_and_prune sweeps them in parallel after
+// a radix sort along the axis of largest spread; neither result depends on it.
+// sweep_and_prune appends each pair once, as (lower index, higher index), in sweep
+// order.
+
+constexpr std::size_t aabb_block = 16384;      // Points or boxes per parallel block
+
+template <std::size_t N, typename T>
+struct aabb
+{
+    vector<N, T> lo;
+    vector<N, T> hi;
+
+    /* ctors */
+    constexpr aabb() noexcept;                                              // Empty
+    constexpr aabb(const vector<N, T>& l, const vector<N, T>& h) noexcept;
+    constexpr explicit aabb(const vector<N, T>& p) noexcept;                // The box of one point
+
+    /* Equality operators */
+
+    constexpr bool operator==(const aabb<N, T>& b) const noexcept;
+    constexpr bool operator!=(const aabb<N, T>& b) const noexcept;
+
+    /* Queries */
+
+    constexpr bool         is_empty() const noexcept;
+    constexpr vector<N, T> center() const noexcept;
+    constexpr vector<N, T> extent() const noexcept;        // hi - lo
+    constexpr T            volume() const noexcept;        // Area of an aabb2, 0 when empty
+    constexpr T            surface_area() const noexcept requires (N == 3);
+    constexpr std::size_t  longest_axis() const noexcept;
+    constexpr bool         contains(const vector<N, T>& p) const noexcept;
+    constexpr bool         contains(const aabb<N, T>& b) const noexcept;
+    constexpr bool         overlaps(const aabb<N, T>& b) const noexcept;
+
+    /* Growing and clipping */
+
+    constexpr void         expand(const vector<N, T>& p) noexcept;
+    constexpr void         expand(const aabb<N, T>& b) noexcept;
+    constexpr aabb<N, T>   merge(const aabb<N, T>& b) const noexcept;
+    constexpr aabb<N, T>   intersection(const aabb<N, T>& b) const noexcept;   // Empty when disjoint
+    constexpr aabb<N, T>   inflate(T margin) const noexcept;                  // Grown by margin on every side
+};
+
+template <typename T>
+using aabb2 = aabb<2, T>;
+
+template <typename T>
+using aabb3 = aabb<3, T>;
+
+static_assert(sizeof(aabb3<float>) == 6 * sizeof(float) && sizeof(aabb2<double>) == 4 * sizeof(double), "the batch code reads boxes as flat arrays");
+
+using aabb_pair = std::pair<std::uint32_t, std::uint32_t>;
+
+/* ctors */
+
+template <std::size_t N, typename T>
+constexpr aabb<N, T>::aabb() noexcept : lo(std::numeric_limits<T>::infinity()), hi(-std::numeric_limits<T>::infinity()) {}
+
+template <std::size_t N, typename T>
+constexpr aabb<N, T>::aabb(const vector<N, T>& l, const vector<N, T>& h) noexcept : lo(l), hi(h) {}
+
+template <std::size_t N, typename T>
+constexpr aabb<N, T>::aabb(const vector<N, T>& p) noexcept : lo(p), hi(p) {}
+
+/* Equality operators */
+
+template <std::size_t N, typename T>
+constexpr bool aabb<N, T>::operator==(const aabb<N, T>& b) const noexcept
+{
+    return lo == b.lo && hi == b.hi;
+}
+
+template <std::size_t N, typename T>
+constexpr bool aabb<N, T>::operator!=(const aabb<N, T>& b) const noexcept
+{
+    return !((*this) == b);
+}
+
+/* Queries */
+
+template <std::size_t N, typename T>
+constexpr bool aabb<N, T>::is_empty() const noexcept
+{
+    return !vector_detail::all<N>([&](auto i) { return get<i>(lo) <= get<i>(hi); });     // NaN bounds too
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> aabb<N, T>::center() const noexcept
+{
+    return (lo + hi) * T(0.5);
+}
+
+template <std::size_t N, typename T>
+constexpr vector<N, T> aabb<N, T>::extent() const noexcept
+{
+    return hi - lo;
+}
+
+template <std::size_t N, typename T>
+constexpr T aabb<N, T>::volume() const noexcept
+{
+    if (is_empty())
+        return T(0);
+    const vector<N, T> e = extent();
+    T v = e.x;
+    vector_detail::for_each<N>([&](auto i) { if constexpr (i > 0) v *= get<i>(e); });
+    return v;
+}
+
+template <std::size_t N, typename T>
+constexpr T aabb<N, T>::surface_area() const noexcept requires (N == 3)
+{
+    if (is_empty())
+        return T(0);
+    const vector<N, T> e = extent();
+    return T(2) * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+template <std::size_t N, typename T>
+constexpr std::size_t aabb<N, T>::longest_axis() const noexcept       // The first of equal ones
+{
+    const vector<N, T> e = extent();
+    std::size_t axis = 0;
+    T best = e.x;
+    vector_detail::for_each<N>([&](auto i) { if (get<i>(e) > best) { best = get<i>(e); axis = i; } });
+    return axis;
+}
+
+template <std::size_t N, typename T>
+constexpr bool aabb<N, T>::contains(const vector<N, T>& p) const noexcept
+{
+    return vector_detail::all<N>([&](auto i) { return get<i>(lo) <= get<i>(p) && get<i>(p) <= get<i>(hi); });
+}
+
+template <std::size_t N, typename T>
+constexpr bool aabb<N, T>::contains(const aabb<N, T>& b) const noexcept
+{
+    return vector_detail::all<N>([&](auto i) { return get<i>(lo) <= get<i>(b.lo) && get<i>(b.hi) <= get<i>(hi); });
+}
+
+template <std::size_t N, typename T>
+constexpr bool aabb<N, T>::overlaps(const aabb<N, T>& b) const noexcept
+{
+    return vector_detail::all<N>([&](auto i) { return get<i>(lo) <= get<i>(b.hi) && get<i>(b.lo) <= get<i>(hi); });
+}
+
+/* Growing and clipping */
+
+template <std::size_t N, typename T>
+constexpr void aabb<N, T>::expand(const vector<N, T>& p) noexcept
+{
+    vector_detail::for_each<N>([&](auto i)
+    {
+        get<i>(lo) = get<i>(p) < get<i>(lo) ? get<i>(p) : get<i>(lo);
+        get<i>(hi) = get<i>(p) > get<i>(hi) ? get<i>(p) : get<i>(hi);
+    });
+}
+
+template <std::size_t N, typename T>
+constexpr void aabb<N, T>::expand(const aabb<N, T>& b) noexcept
+{
+    vector_detail::for_each<N>([&](auto i)
+    {
+        get<i>(lo) = get<i>(b.lo) < get<i>(lo) ? get<i>(b.lo) : get<i>(lo);
+        get<i>(hi) = get<i>(b.hi) > get<i>(hi) ? get<i>(b.hi) : get<i>(hi);
+    });
+}
+
+template <std::size_t N, typename T>
+constexpr aabb<N, T> aabb<N, T>::merge(const aabb<N, T>& b) const noexcept
+{
+    aabb<N, T> r = *this;
+    r.expand(b);
+    return r;
+}
+
+template <std::size_t N, typename T>
+constexpr aabb<N, T> aabb<N, T>::intersection(const aabb<N, T>& b) const noexcept
+{
+    aabb<N, T> r;
+    vector_detail::for_each<N>([&](auto i)
+    {
+        get<i>(r.lo) = get<i>(b.lo) > get<i>(lo) ? get<i>(b.lo) : get<i>(lo);
+        get<i>(r.hi) = get<i>(b.hi) < get<i>(hi) ? get<i>(b.hi) : get<i>(hi);
+    });
+    return r.is_empty() ? aabb<N, T>() : r;
+}
+
+template <std::size_t N, typename T>
+constexpr aabb<N, T> aabb<N, T>::inflate(T margin) const noexcept
+{
+    return aabb<N, T>(lo - margin, hi + margin);
+}
+
+/* Scalar backend. Boxes and points are read as flat arrays of 2 N and N components */
+
+namespace vector_aabb_scalar
+{
+
+template <std::size_t N, typename T>
+void bounds(const T* p, std::size_t n, T* lo, T* hi)       // Widens lo[N], hi[N] by n points
+{
+    for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            const T a = p[i * N + d];
+            lo[d] = a < lo[d] ? a : lo[d];
+            hi[d] = a > hi[d] ? a : hi[d];
+        }
+}
+
+template <std::size_t N, typename T>
+void overlaps(const T* q, const T* b, std::size_t n, std::uint64_t* hit)      // q: lo[N], hi[N] of the query
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        bool h = true;
+        for (std::size_t d = 0; d < N; ++d)
+            h &= b[i * 2 * N + d] <= q[N + d] && q[d] <= b[i * 2 * N + N + d];
+        hit[i / 64] |= std::uint64_t(h) << (i % 64);
+    }
+}
+
+template <std::size_t N, typename T>
+void contains_points(const T* q, const T* p, std::size_t n, std::uint64_t* hit)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        bool h = true;
+        for (std::size_t d = 0; d < N; ++d)
+            h &= q[d] <= p[i * N + d] && p[i * N + d] <= q[N + d];
+        hit[i / 64] |= std::uint64_t(h) << (i % 64);
+    }
+}
+
+template <std::size_t N, typename T>
+void contains_boxes(const T* q, const T* b, std::size_t n, std::uint64_t* hit)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        bool h = true;
+        for (std::size_t d = 0; d < N; ++d)
+            h &= q[d] <= b[i * 2 * N + d] && b[i * 2 * N + N + d] <= q[N + d];
+        hit[i / 64] |= std::uint64_t(h) << (i % 64);
+    }
+}
+
+// Pairs of sorted boxes k in [first, last) with the boxes after k. s holds the sorted
+// lo streams 0 .. N - 1 and hi streams N .. 2 N - 1, idx the original indices.
+template <std::size_t N, typename T>
+void sweep(const T* const* s, const std::uint32_t* idx, std::size_t n, std::size_t axis, std::size_t first, std::size_t last, std::vector<aabb_pair>& out)
+{
+    for (std::size_t k = first; k < last; ++k)
+    {
+        const T end = s[N + axis][k];
+        for (std::size_t j = k + 1; j < n && s[axis][j] <= end; ++j)
+        {
+            bool h = true;
+            for (std::size_t d = 0; d < N; ++d)
+                h &= s[d][j] <= s[N + d][k] && s[d][k] <= s[N + d][j];
+            if (h)
+                out.emplace_back(idx[k] < idx[j] ? idx[k] : idx[j], idx[k] < idx[j] ? idx[j] : idx[k]);
+        }
+    }
+}
+
+}
+
+#if VECTOR3_SIMD_X86
+
+/* SSE4.1 backend, 4 float or 2 double lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_aabb_sse41
+{
+
+using vf = float __attribute__((vector_size(16)));
+using vi = int __attribute__((vector_size(16)));
+using vd = double __attribute__((vector_size(16)));
+using vl = long long __attribute__((vector_size(16)));
+
+inline std::uint64_t movemask(vi m) { return std::uint64_t(_mm_movemask_ps(__m128(m))); }
+inline std::uint64_t movemask(vl m) { return std::uint64_t(_mm_movemask_pd(__m128d(m))); }
+
+#include "vector_aabb_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX2 backend, 8 float or 4 double lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_aabb_avx2
+{
+
+using vf = float __attribute__((vector_size(32)));
+using vi = int __attribute__((vector_size(32)));
+using vd = double __attribute__((vector_size(32)));
+using vl = long long __attribute__((vector_size(32)));
+
+inline std::uint64_t movemask(vi m) { return std::uint64_t(_mm256_movemask_ps(__m256(m))); }
+inline std::uint64_t movemask(vl m) { return std::uint64_t(_mm256_movemask_pd(__m256d(m))); }
+
+#include "vector_aabb_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX-512 backend, 16 float or 8 double lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"  // False positives inside GCC's own avx512fintrin.h
+#endif
+
+namespace vector_aabb_avx512
+{
+
+using vf = float __attribute__((vector_size(64)));
+using vi = int __attribute__((vector_size(64)));
+using vd = double __attribute__((vector_size(64)));
+using vl = long long __attribute__((vector_size(64)));
+
+inline std::uint64_t movemask(vi m) { return std::uint64_t(_mm512_test_epi32_mask(__m512i(m), __m512i(m))); }
+inline std::uint64_t movemask(vl m) { return std::uint64_t(_mm512_test_epi64_mask(__m512i(m), __m512i(m))); }
+
+#include "vector_aabb_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+#endif // VECTOR3_SIMD_X86
+
+/* Dispatch on the active simd_level */
+
+#if VECTOR3_SIMD_X86
+#define VECTOR_AABB_DISPATCH(...)                                       \
+    switch (active_simd_level())                                        \
+    {                                                                   \
+    case simd_level::avx512: vector_aabb_avx512::__VA_ARGS__; return;   \
+    case simd_level::avx2:   vector_aabb_avx2::__VA_ARGS__;   return;   \
+    case simd_level::sse41:  vector_aabb_sse41::__VA_ARGS__;  return;   \
+    case simd_level::scalar: vector_aabb_scalar::__VA_ARGS__; return;   \
+    }
+#else
+#define VECTOR_AABB_DISPATCH(...) vector_aabb_scalar::__VA_ARGS__;
+#endif
+
+namespace vector_aabb_detail
+{
+
+template <std::size_t N, typename T>
+const T* flat(const vector<N, T>* p) { return reinterpret_cast<const T*>(p); }
+
+template <std::size_t N, typename T>
+const T* flat(const aabb<N, T>* b) { return reinterpret_cast<const T*>(b); }
+
+template <std::size_t N, typename T>
+void bounds(const vector<N, T>* p, std::size_t n, T* lo, T* hi)
+{
+    VECTOR_AABB_DISPATCH(bounds<N, T>(flat(p), n, lo, hi))
+}
+
+template <std::size_t N, typename T>
+aabb<N, T> bounds(std::span<const vector<N, T>> p, vector_thread_pool* pool)
+{
+    const std::size_t count = (p.size() + aabb_block - 1) / aabb_block;
+    std::vector<aabb<N, T>> partial(count);
+    const auto block = [&](std::size_t b)
+    {
+        const std::size_t first = b * aabb_block;
+        bounds(p.data() + first, p.size() - first < aabb_block ? p.size() - first : aabb_block, partial[b].lo.ptr(), partial[b].hi.ptr());
+    };
+    if (pool && count > 1)
+        pool->parallel_for(count, block);
+    else
+        for (std::size_t b = 0; b < count; ++b)
+            block(b);
+
+    aabb<N, T> r;
+    for (const aabb<N, T>& b : partial)
+        r.expand(b);
+    return r;
+}
+
+inline void clear_mask(std::size_t n, std::span<std::uint64_t> hit)
+{
+    const std::size_t words = (n + 63) / 64;
+    assert(hit.size() >= words);
+    std::fill_n(hit.data(), words, std::uint64_t(0));       // No memset, data() may be null when empty
+}
+
+template <std::size_t N, typename T>
+void overlaps(const aabb<N, T>& q, std::span<const aabb<N, T>> b, std::span<std::uint64_t> hit)
+{
+    clear_mask(b.size(), hit);
+    VECTOR_AABB_DISPATCH(overlaps<N, T>(flat(&q), flat(b.data()), b.size(), hit.data()))
+}
+
+template <std::size_t N, typename T>
+void contains(const aabb<N, T>& q, std::span<const vector<N, T>> p, std::span<std::uint64_t> hit)
+{
+    clear_mask(p.size(), hit);
+    VECTOR_AABB_DISPATCH(contains_points<N, T>(flat(&q), flat(p.data()), p.size(), hit.data()))
+}
+
+template <std::size_t N, typename T>
+void contains(const aabb<N, T>& q, std::span<const aabb<N, T>> b, std::span<std::uint64_t> hit)
+{
+    clear_mask(b.size(), hit);
+    VECTOR_AABB_DISPATCH(contains_boxes<N, T>(flat(&q), flat(b.data()), b.size(), hit.data()))
+}
+
+template <std::size_t N, typename T>
+void sweep(const T* const* s, const std::uint32_t* idx, std::size_t n, std::size_t axis, std::size_t first, std::size_t last, std::vector<aabb_pair>& out)
+{
+    VECTOR_AABB_DISPATCH(sweep<N, T>(s, idx, n, axis, first, last, out))
+}
+
+template <typename T>
+std::uint64_t order_key(T a)        // Unsigned keys in the order of the values, -0 before +0
+{
+    using U = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+    const U b = std::bit_cast<U>(a);
+    const U sign = U(1) << (sizeof(U) * 8 - 1);
+    return std::uint64_t(b & sign ? ~b : b | sign);
+}
+
+template <std::size_t N, typename T>
+std::size_t sweep_axis(std::span<const aabb<N, T>> b)       // Largest variance of the centers
+{
+    double s[N] = {}, q[N] = {};
+    std::size_t n = 0;                                          // Non-empty boxes, the only ones summed
+    for (const aabb<N, T>& x : b)
+        if (!x.is_empty())
+        {
+            ++n;
+            vector_detail::for_each<N>([&](auto i)
+            {
+                const double c = double(get<i>(x.lo)) + double(get<i>(x.hi));
+                s[i] += c;
+                q[i] += c * c;
+            });
+        }
+    std::size_t axis = 0;
+    double best = -1.0;
+    for (std::size_t d = 0; d < N; ++d)
+    {
+        const double v = q[d] - s[d] * s[d] / double(n ? n : 1);
+        if (v > best)
+        {
+            best = v;
+            axis = d;
+        }
+    }
+    return axis;
+}
+
+template <std::size_t N, typename T>
+void sweep_and_prune(std::span<const aabb<N, T>> b, std::vector<aabb_pair>& out, vector_thread_pool* pool)
+{
+    assert(b.size() < std::size_t(std::numeric_limits<std::uint32_t>::max()));
+    const std::size_t axis = sweep_axis(b);
+
+    std::vector<std::uint64_t> keys;
+    std::vector<std::uint32_t> idx;
+    keys.reserve(b.size());
+    idx.reserve(b.size());
+    for (std::size_t i = 0; i < b.size(); ++i)
+        if (!b[i].is_empty())       // Overlaps nothing
+        {
+            keys.push_back(order_key(b[i].lo.ptr()[axis]));
+            idx.push_back(std::uint32_t(i));
+        }
+    radix_sort(keys, idx, pool);
+
+    const std::size_t n = idx.size();
+    std::vector<T> streams(2 * N * n);
+    const T* s[2 * N];
+    for (std::size_t d = 0; d < 2 * N; ++d)
+        s[d] = streams.data() + d * n;
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        const T* x = flat(b.data() + idx[k]);
+        for (std::size_t d = 0; d < 2 * N; ++d)
+            streams[d * n + k] = x[d];
+    }
+
+    const std::size_t count = (n + aabb_block - 1) / aabb_block;
+    if (pool && count > 1)
+    {
+        std::vector<std::vector<aabb_pair>> partial(count);
+        pool->parallel_for(count, [&](std::size_t c)
+        {
+            const std::size_t first = c * aabb_block;
+            sweep<N, T>(s, idx.data(), n, axis, first, n - first < aabb_block ? n : first + aabb_block, partial[c]);
+        });
+        for (const std::vector<aabb_pair>& p : partial)
+            out.insert(out.end(), p.begin(), p.end());
+    }
+    else
+        sweep<N, T>(s, idx.data(), n, axis, 0, n, out);
+}
+
+} // namespace vector_aabb_detail
+
+#undef VECTOR_AABB_DISPATCH
+
+/* Bounds of a point array, (inf, -inf) when empty */
+
+inline aabb2<float> batch_bounds(std::span<const vector2<float>> p, vector_thread_pool* pool = nullptr)
+{
+    return vector_aabb_detail::bounds(p, pool);
+}
+
+inline aabb2<double> batch_bounds(std::span<const vector2<double>> p, vector_thread_pool* pool = nullptr)
+{
+    return vector_aabb_detail::bounds(p, pool);
+}
+
+inline aabb3<float> batch_bounds(std::span<const vector3<float>> p, vector_thread_pool* pool = nullptr)
+{
+    return vector_aabb_detail::bounds(p, pool);
+}
+
+inline aabb3<double> batch_bounds(std::span<const vector3<double>> p, vector_thread_pool* pool = nullptr)
+{
+    return vector_aabb_detail::bounds(p, pool);
+}
+
+/* Batch tests against one box. hit holds at least (n + 63) / 64 words */
+
+template <std::size_t N, typename T>
+inline void batch_overlaps(const aabb<N, T>& q, std::span<const aabb<N, T>> boxes, std::span<std::uint64_t> hit)
+{
+    static_assert((N == 2 || N == 3) && (std::is_same_v<T, float> || std::is_same_v<T, double>), "aabb2 or aabb3 of float or double");
+    vector_aabb_detail::overlaps(q, boxes, hit);
+}
+
+template <std::size_t N, typename T>
+inline void batch_contains(const aabb<N, T>& q, std::span<const vector<N, T>> points, std::span<std::uint64_t> hit)
+{
+    static_assert((N == 2 || N == 3) && (std::is_same_v<T, float> || std::is_same_v<T, double>), "aabb2 or aabb3 of float or double");
+    vector_aabb_detail::contains(q, points, hit);
+}
+
+template <std::size_t N, typename T>
+inline void batch_contains(const aabb<N, T>& q, std::span<const aabb<N, T>> boxes, std::span<std::uint64_t> hit)
+{
+    static_assert((N == 2 || N == 3) && (std::is_same_v<T, float> || std::is_same_v<T, double>), "aabb2 or aabb3 of float or double");
+    vector_aabb_detail::contains(q, boxes, hit);
+}
+
+/* Broadphase, appends the overlapping pairs */
+
+template <std::size_t N, typename T>
+inline void sweep_and_prune(std::span<const aabb<N, T>> boxes, std::vector<aabb_pair>& out, vector_thread_pool* pool = nullptr)
+{
+    static_assert((N == 2 || N == 3) && (std::is_same_v<T, float> || std::is_same_v<T, double>), "aabb2 or aabb3 of float or double");
+    vector_aabb_detail::sweep_and_prune(boxes, out, pool);
+}
+
+#endif
@@ -0,0 +1,218 @@
+// Bounding box kernels shared by the SIMD backends. This file is included once per
+// instruction set from vector_aabb.hpp, inside a namespace that defines vf, vi, vd and
+// vl (GCC/clang vector extension types of floats, ints, doubles and 64 bit ints of the
+// register width) and movemask for vi and vl, so it intentionally has no include guard.
+//
+// The bounds reduction reads the points as one flat array: N registers cover W points,
+// and lane j of register r always sees component (r W + j) % N, so the loop needs no
+// shuffles. The box and point tests copy aabb_stage elements at a time into component
+// streams and compare whole lane groups; the sweep reads the sorted streams directly.
+// Comparisons are the ones of vector_aabb_scalar, so every lane agrees with it.
+
+template <typename T> struct lanes_of;
+template <> struct lanes_of<float>  { using type = vf; using mask = vi; };
+template <> struct lanes_of<double> { using type = vd; using mask = vl; };
+
+template <typename T> using lanes = typename lanes_of<T>::type;
+template <typename T> using lane_mask = typename lanes_of<T>::mask;       // 0 / -1 per lane
+
+template <typename T>
+constexpr std::size_t width = sizeof(lanes<T>) / sizeof(T);
+
+constexpr std::size_t aabb_stage = 256;     // Elements per staged block, a multiple of 64
+
+template <typename V, typename T>
+inline V splat(T a)                 { return V{} + a; }
+
+template <typename V, typename M>
+inline V select(M m, V a, V b)      { return V((M(a) & m) | (M(b) & ~m)); }     // a where m is set, else b
+
+template <typename V, typename T>
+inline V load(const T* p)           { V a; std::memcpy(&a, p, sizeof(a)); return a; }
+
+template <std::size_t N, typename T>
+void bounds(const T* p, std::size_t n, T* lo, T* hi)
+{
+    using V = lanes<T>;
+    constexpr std::size_t w = width<T>;
+    V l[N], h[N];
+    for (std::size_t r = 0; r < N; ++r)
+    {
+        l[r] = splat<V>(std::numeric_limits<T>::infinity());
+        h[r] = splat<V>(-std::numeric_limits<T>::infinity());
+    }
+    const std::size_t m = n / w * w;
+    for (std::size_t i = 0; i < m; i += w)
+        for (std::size_t r = 0; r < N; ++r)
+        {
+            const V a = load<V>(p + i * N + r * w);
+            l[r] = select(a < l[r], a, l[r]);
+            h[r] = select(a > h[r], a, h[r]);
+        }
+    for (std::size_t r = 0; r < N; ++r)
+        for (std::size_t j = 0; j < w; ++j)
+        {
+            const std::size_t d = (r * w + j) % N;
+            lo[d] = l[r][j] < lo[d] ? l[r][j] : lo[d];
+            hi[d] = h[r][j] > hi[d] ? h[r][j] : hi[d];
+        }
+    vector_aabb_scalar::bounds<N, T>(p + m * N, n - m, lo, hi);
+}
+
+// Copies elements [first, first + count) of a flat array of stride S into S streams
+template <std::size_t S, typename T>
+inline void stage(const T* p, std::size_t first, std::size_t count, T (*s)[aabb_stage])
+{
+    for (std::size_t d = 0; d < S; ++d)        // Stream by stream, so the stores are sequential
+        for (std::size_t i = 0; i < count; ++i)
+            s[d][i] = p[(first + i) * S + d];
+}
+
+// Sets bit i of hit where test(streams, k) holds, for lane groups and then single elements
+template <std::size_t S, typename T, typename F, typename G>
+inline void staged(const T* p, std::size_t n, std::uint64_t* hit, F lane_test, G test)
+{
+    constexpr std::size_t w = width<T>;
+    T s[S][aabb_stage];
+    for (std::size_t first = 0; first < n; first += aabb_stage)
+    {
+        const std::size_t count = n - first < aabb_stage ? n - first : aabb_stage;
+        stage<S>(p, first, count, s);
+        const std::size_t m = count / w * w;
+        for (std::size_t k = 0; k < m; k += w)
+            hit[(first + k) / 64] |= movemask(lane_test(s, k)) << ((first + k) % 64);      // Widths divide 64, a group never straddles two words
+        for (std::size_t k = m; k < count; ++k)
+            hit[(first + k) / 64] |= std::uint64_t(test(s, k)) << ((first + k) % 64);
+    }
+}
+
+template <std::size_t N, typename T>
+void overlaps(const T* q, const T* b, std::size_t n, std::uint64_t* hit)
+{
+    using V = lanes<T>;
+    using M = lane_mask<T>;
+    V ql[N], qh[N];
+    for (std::size_t d = 0; d < N; ++d)
+    {
+        ql[d] = splat<V>(q[d]);
+        qh[d] = splat<V>(q[N + d]);
+    }
+    staged<2 * N>(b, n, hit, [&](const T (*s)[aabb_stage], std::size_t k)
+    {
+        M m = splat<M>(-1);
+        for (std::size_t d = 0; d < N; ++d)
+            m &= (load<V>(s[d] + k) <= qh[d]) & (ql[d] <= load<V>(s[N + d] + k));
+        return m;
+    },
+    [&](const T (*s)[aabb_stage], std::size_t k)
+    {
+        bool h = true;
+        for (std::size_t d = 0; d < N; ++d)
+            h &= s[d][k] <= q[N + d] && q[d] <= s[N + d][k];
+        return h;
+    });
+}
+
+template <std::size_t N, typename T>
+void contains_points(const T* q, const T* p, std::size_t n, std::uint64_t* hit)
+{
+    using V = lanes<T>;
+    using M = lane_mask<T>;
+    V ql[N], qh[N];
+    for (std::size_t d = 0; d < N; ++d)
+    {
+        ql[d] = splat<V>(q[d]);
+        qh[d] = splat<V>(q[N + d]);
+    }
+    staged<N>(p, n, hit, [&](const T (*s)[aabb_stage], std::size_t k)
+    {
+        M m = splat<M>(-1);
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            const V a = load<V>(s[d] + k);
+            m &= (ql[d] <= a) & (a <= qh[d]);
+        }
+        return m;
+    },
+    [&](const T (*s)[aabb_stage], std::size_t k)
+    {
+        bool h = true;
+        for (std::size_t d = 0; d < N; ++d)
+            h &= q[d] <= s[d][k] && s[d][k] <= q[N + d];
+        return h;
+    });
+}
+
+template <std::size_t N, typename T>
+void contains_boxes(const T* q, const T* b, std::size_t n, std::uint64_t* hit)
+{
+    using V = lanes<T>;
+    using M = lane_mask<T>;
+    V ql[N], qh[N];
+    for (std::size_t d = 0; d < N; ++d)
+    {
+        ql[d] = splat<V>(q[d]);
+        qh[d] = splat<V>(q[N + d]);
+    }
+    staged<2 * N>(b, n, hit, [&](const T (*s)[aabb_stage], std::size_t k)
+    {
+        M m = splat<M>(-1);
+        for (std::size_t d = 0; d < N; ++d)
+            m &= (ql[d] <= load<V>(s[d] + k)) & (load<V>(s[N + d] + k) <= qh[d]);
+        return m;
+    },
+    [&](const T (*s)[aabb_stage], std::size_t k)
+    {
+        bool h = true;
+        for (std::size_t d = 0; d < N; ++d)
+            h &= q[d] <= s[d][k] && s[N + d][k] <= q[N + d];
+        return h;
+    });
+}
+
+// The candidates of box k are the boxes after it whose lo on the sweep axis is within
+// its hi; they are tested a lane group at a time, and the sweep of k stops at the first
+// group that reaches past hi, as the lo stream is sorted.
+template <std::size_t N, typename T>
+void sweep(const T* const* s, const std::uint32_t* idx, std::size_t n, std::size_t axis, std::size_t first, std::size_t last, std::vector<aabb_pair>& out)
+{
+    using V = lanes<T>;
+    using M = lane_mask<T>;
+    constexpr std::size_t w = width<T>;
+    for (std::size_t k = first; k < last; ++k)
+    {
+        const T end = s[N + axis][k];
+        V kl[N], kh[N];
+        for (std::size_t d = 0; d < N; ++d)
+        {
+            kl[d] = splat<V>(s[d][k]);
+            kh[d] = splat<V>(s[N + d][k]);
+        }
+        std::size_t j = k + 1;
+        bool done = false;
+        for (; j + w <= n; j += w)
+        {
+            M m = splat<M>(-1);
+            for (std::size_t d = 0; d < N; ++d)
+                m &= (load<V>(s[d] + j) <= kh[d]) & (kl[d] <= load<V>(s[N + d] + j));
+            for (std::uint64_t b = movemask(m); b; b &= b - 1)
+            {
+                const std::uint32_t a = idx[k], c = idx[j + std::size_t(std::countr_zero(b))];
+                out.emplace_back(a < c ? a : c, a < c ? c : a);
+            }
+            if (!(s[axis][j + w - 1] <= end))
+            {
+                done = true;
+                break;
+            }
+        }
+        for (; !done && j < n && s[axis][j] <= end; ++j)
+        {
+            bool h = true;
+            for (std::size_t d = 0; d < N; ++d)
+                h &= s[d][j] <= s[N + d][k] && s[d][k] <= s[N + d][j];
+            if (h)
+                out.emplace_back(idx[k] < idx[j] ? idx[k] : idx[j], idx[k] < idx[j] ? idx[j] : idx[k]);
+        }
+    }
+}
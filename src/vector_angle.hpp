@@ -0,0 +1,537 @@
+#ifndef VECTOR_ANGLE_H
+#define VECTOR_ANGLE_H
+
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#include "vector2.hpp"
+#include "vector3.hpp"
+#include "vector3_simd.hpp"
+
+// Angles, rotations, slerp and spherical / polar coordinates.
+//
+//     angle          in [0, pi], atan2(|a x b|, a . b), accurate also for nearly
+//                    parallel and nearly opposite vectors
+//     signed_angle   in [-pi, pi], counterclockwise from a to b for vector2, about n
+//                    (on the side a x b points to) for vector3
+//     rotate         by angle radians, counterclockwise for vector2, about a unit axis
+//                    by the right hand rule for vector3 (Rodrigues)
+//     slerp          constant angular speed between unit vectors, a normalized lerp
+//                    once they are nearly parallel; undefined for opposite vectors
+//     to_spherical   (r, theta, phi): radius, polar angle from +z in [0, pi] and
+//                    azimuth from +x towards +y in [-pi, pi]; to_polar gives (r, phi)
+//
+// The single vector forms call std::sin, std::cos, std::atan2 and std::acos. The batch
+// forms evaluate the same expressions with polynomial sin / cos, atan2 and acos on
+// every lane, following the vector3_simd dispatch (set_simd_level applies), and return
+// the same bits on every backend. Their largest errors in ulps, measured on dense
+// samples of the domain against long double results:
+//
+//                     float   double
+//     sin, cos        2.4     2.5         for |x| up to 8192 (float), 2^20 (double)
+//     atan2           2.0     1.5
+//     acos            1.3     1.2
+//
+// The vector results then differ from the single vector forms by a few ulps, more for
+// slerp near opposite vectors, where it is ill conditioned anyway. batch_sin_cos,
+// batch_atan2 and batch_acos expose the primitives themselves.
+//
+// Larger sin / cos arguments, and atan2 arguments that are not finite (or from 2^1022
+// on for double), go through the std functions lane by lane; the special values (signed
+// zeros, NaN, acos beyond +-1) come out as from the std functions. The kernels rely on
+// round to nearest and IEEE arithmetic, so they must not be built with -ffast-math.
+// Batch outputs must be as long as the inputs and may alias them exactly.
+
+/* Single vectors */
+
+template <typename T>
+inline T angle(const vector2<T>& a, const vector2<T>& b) noexcept
+{
+    return std::atan2(std::abs(a.x * b.y - a.y * b.x), a.dot(b));
+}
+
+template <typename T>
+inline T angle(const vector3<T>& a, const vector3<T>& b) noexcept
+{
+    return std::atan2(a.cross(b).length(), a.dot(b));
+}
+
+template <typename T>
+inline T signed_angle(const vector2<T>& a, const vector2<T>& b) noexcept
+{
+    return std::atan2(a.x * b.y - a.y * b.x, a.dot(b));
+}
+
+template <typename T>
+inline T signed_angle(const vector3<T>& a, const vector3<T>& b, const vector3<T>& n) noexcept
+{
+    const vector3<T> c = a.cross(b);
+    const T s = c.length();
+    return std::atan2(c.dot(n) < T(0) ? -s : s, a.dot(b));
+}
+
+template <typename T>
+inline vector2<T> rotate(const vector2<T>& v, T angle) noexcept
+{
+    const T c = std::cos(angle);
+    const T s = std::sin(angle);
+    return vector2<T>(v.x * c - v.y * s, v.x * s + v.y * c);
+}
+
+template <typename T>
+inline vector3<T> rotate(const vector3<T>& v, const vector3<T>& axis, T angle) noexcept     // axis of unit length
+{
+    const T c = std::cos(angle);
+    const T s = std::sin(angle);
+    return (v * c + axis.cross(v) * s) + axis * (axis.dot(v) * (T(1) - c));
+}
+
+template <std::size_t N, typename T>
+inline vector<N, T> slerp(const vector<N, T>& a, const vector<N, T>& b, std::type_identity_t<T> t) noexcept     // a and b of unit length
+{
+    T d = a.dot(b);
+    d = d > T(1) ? T(1) : d;
+    d = d < T(-1) ? T(-1) : d;
+    if (d > T(1) - T(16) * std::numeric_limits<T>::epsilon())      // sin(angle) vanishes, the blend is linear
+        return (a * (T(1) - t) + b * t).normalize();
+    const T angle = std::acos(d);
+    const T s = T(1) / std::sin(angle);
+    return a * (std::sin((T(1) - t) * angle) * s) + b * (std::sin(t * angle) * s);
+}
+
+template <typename T>
+inline vector3<T> to_spherical(const vector3<T>& v) noexcept
+{
+    const T xy = v.x * v.x + v.y * v.y;
+    return vector3<T>(std::sqrt(xy + v.z * v.z), std::atan2(std::sqrt(xy), v.z), std::atan2(v.y, v.x));
+}
+
+template <typename T>
+inline vector3<T> from_spherical(const vector3<T>& s) noexcept
+{
+    const T rs = s.x * std::sin(s.y);
+    return vector3<T>(rs * std::cos(s.z), rs * std::sin(s.z), s.x * std::cos(s.y));
+}
+
+template <typename T>
+inline vector2<T> to_polar(const vector2<T>& v) noexcept
+{
+    return vector2<T>(std::sqrt(v.x * v.x + v.y * v.y), std::atan2(v.y, v.x));
+}
+
+template <typename T>
+inline vector2<T> from_polar(const vector2<T>& p) noexcept
+{
+    return vector2<T>(p.x * std::cos(p.y), p.x * std::sin(p.y));
+}
+
+namespace vector_angle_detail
+{
+
+// Polynomials, highest degree first, in z = r^2:
+//     sin r = r + r z S(z), cos r = 1 - z / 2 + z^2 C(z)     |r| <= pi / 4
+//     atan u = u + u z A(z)                                   |u| <= 1, tan(pi / 8) with atan_fold
+//     asin s = s + s z B(z)                                   |s| <= 1 / 2
+// pio2 splits pi / 2 into parts whose products with the k up to reduce_max are exact,
+// except for the last one.
+
+template <typename T> struct constants;
+
+template <>
+struct constants<float>
+{
+    static constexpr float two_over_pi = 0x1.45f306p-1f;
+    static constexpr float shifter     = 0x1.8p23f;         // Adding it rounds to an integer in the low bits
+    static constexpr float reduce_max  = 8192.0f;
+    static constexpr bool  atan_fold   = false;
+    static constexpr float atan_max    = std::numeric_limits<float>::infinity();
+    static constexpr float pi_2        = 0x1.921fb6p+0f;
+    static constexpr float pi          = 0x1.921fb6p+1f;
+    static constexpr float pi_2_hi     = 0x1.921fb6p+0f;
+    static constexpr float pi_2_lo     = -0x1.777a5cp-25f;
+    static constexpr float pi_hi       = 0x1.921fb6p+1f;
+    static constexpr float pi_lo       = -0x1.777a5cp-24f;
+    static constexpr float slerp_linear = 1.0f - 16.0f * std::numeric_limits<float>::epsilon();
+
+    static constexpr float pio2[4] = { 0x1.92p+0f, 0x1.fb4p-12f, 0x1.444p-24f, 0x1.68c234p-39f };
+    static constexpr float sin[3]  = { -0x1.9ac9bp-13f, 0x1.110c28p-7f, -0x1.555552p-3f };
+    static constexpr float cos[3]  = { 0x1.9bd89cp-16f, -0x1.6c12d2p-10f, 0x1.555554p-5f };
+    static constexpr float atan[9] = { -0x1.38de56p-9f, 0x1.ba9f66p-7f, -0x1.25dc12p-5f, 0x1.0001c6p-4f, -0x1.6295f8p-4f, 0x1.c3f168p-4f,
+                                       -0x1.246cd2p-3f, 0x1.99983cp-3f, -0x1.555554p-2f };
+    static constexpr float asin[6] = { 0x1.13fed4p-5f, 0x1.18f91ep-6f, 0x1.fd8da2p-6f, 0x1.6d5bbap-5f, 0x1.33343p-4f, 0x1.555554p-3f };
+};
+
+template <>
+struct constants<double>
+{
+    static constexpr double two_over_pi = 0x1.45f306dc9c883p-1;
+    static constexpr double shifter     = 0x1.8p52;
+    static constexpr double reduce_max  = 0x1p20;
+    static constexpr bool   atan_fold   = true;
+    static constexpr double atan_max    = 0x1p1022;
+    static constexpr double tan_pi_8    = 0x1.a827999fcef32p-2;
+    static constexpr double pi_4_hi     = 0x1.921fb54442d18p-1;
+    static constexpr double pi_4_lo     = 0x1.1a62633145c07p-55;
+    static constexpr double atan_tiny   = 0x1p-500;         // Folded atan2 scales n and d by atan_scale below it
+    static constexpr double atan_scale  = 0x1p500;
+    static constexpr std::int64_t split_mask = std::int64_t(-1) << 27;     // High 26 bits of the significand
+    static constexpr double pi_2        = 0x1.921fb54442d18p+0;
+    static constexpr double pi          = 0x1.921fb54442d18p+1;
+    static constexpr double pi_2_hi     = 0x1.921fb54442d18p+0;
+    static constexpr double pi_2_lo     = 0x1.1a62633145c07p-54;
+    static constexpr double pi_hi       = 0x1.921fb54442d18p+1;
+    static constexpr double pi_lo       = 0x1.1a62633145c07p-53;
+    static constexpr double slerp_linear = 1.0 - 16.0 * std::numeric_limits<double>::epsilon();
+
+    static constexpr double pio2[3]  = { 0x1.921fb544p+0, 0x1.0b4611a6p-34, 0x1.3198a2e037073p-69 };
+    static constexpr double sin[7]   = { -0x1.ab54fcfea67c3p-41, 0x1.6121f206fe57dp-33, -0x1.ae6454b337896p-26, 0x1.71de3a54c606p-19,
+                                         -0x1.a01a01a019cbcp-13, 0x1.1111111111111p-7, -0x1.5555555555555p-3 };
+    static constexpr double cos[6]   = { -0x1.907d94a5658dep-37, 0x1.1eeb68cd4020bp-29, -0x1.27e4fa17b4f74p-22, 0x1.a01a019f4e893p-16,
+                                         -0x1.6c16c16c16966p-10, 0x1.5555555555555p-5 };
+    static constexpr double atan[11] = { -0x1.3a32bfeb85e5dp-6, 0x1.416335704d018p-5, -0x1.a099c7594fc26p-5, 0x1.dfe6521c9215ep-5,
+                                         -0x1.10fa783513692p-4, 0x1.3b12630fc06dep-4, -0x1.745d0b290d71dp-4, 0x1.c71c71853fcdfp-4,
+                                         -0x1.2492492436233p-3, 0x1.999999999934cp-3, -0x1.5555555555555p-2 };
+    static constexpr double asin[13] = { 0x1.d72d3a19f5b5dp-6, -0x1.e6b160a9062a2p-7, 0x1.1d1af6523fc67p-6, 0x1.65a5ea4dc675ap-8,
+                                         0x1.52428819ddc51p-7, 0x1.78263d203a0ccp-7, 0x1.c9cf09a40f3cfp-7, 0x1.1c4d35bba695ep-6,
+                                         0x1.6e8bb1c8fa8aap-6, 0x1.f1c71c1dab236p-6, 0x1.6db6db6e31f91p-5, 0x1.3333333332ecap-4,
+                                         0x1.5555555555556p-3 };
+};
+
+} // namespace vector_angle_detail
+
+/* Scalar backend, the kernels on single lanes */
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_angle_scalar
+{
+
+using vf = float;
+using vi = std::int32_t;
+using vd = double;
+using vl = std::int64_t;
+
+inline vf vsqrt(vf a) { return std::sqrt(a); }
+inline vd vsqrt(vd a) { return std::sqrt(a); }
+
+#include "vector_angle_kernels.hpp"
+
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+#if VECTOR3_SIMD_X86
+
+/* SSE4.1 backend, 4 float or 2 double lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_angle_sse41
+{
+
+using vf = float __attribute__((vector_size(16)));
+using vi = int __attribute__((vector_size(16)));
+using vd = double __attribute__((vector_size(16)));
+using vl = long long __attribute__((vector_size(16)));
+
+inline vf vsqrt(vf a) { return vf(_mm_sqrt_ps(__m128(a))); }
+inline vd vsqrt(vd a) { return vd(_mm_sqrt_pd(__m128d(a))); }
+
+#include "vector_angle_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX2 backend, 8 float or 4 double lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_angle_avx2
+{
+
+using vf = float __attribute__((vector_size(32)));
+using vi = int __attribute__((vector_size(32)));
+using vd = double __attribute__((vector_size(32)));
+using vl = long long __attribute__((vector_size(32)));
+
+inline vf vsqrt(vf a) { return vf(_mm256_sqrt_ps(__m256(a))); }
+inline vd vsqrt(vd a) { return vd(_mm256_sqrt_pd(__m256d(a))); }
+
+#include "vector_angle_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX-512 backend, 16 float or 8 double lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"  // False positives inside GCC's own avx512fintrin.h
+#endif
+
+namespace vector_angle_avx512
+{
+
+using vf = float __attribute__((vector_size(64)));
+using vi = int __attribute__((vector_size(64)));
+using vd = double __attribute__((vector_size(64)));
+using vl = long long __attribute__((vector_size(64)));
+
+inline vf vsqrt(vf a) { return vf(_mm512_maskz_sqrt_ps(__mmask16(0xffff), __m512(a))); }
+inline vd vsqrt(vd a) { return vd(_mm512_maskz_sqrt_pd(__mmask8(0xff), __m512d(a))); }
+
+#include "vector_angle_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+#endif // VECTOR3_SIMD_X86
+
+/* Dispatch on the active simd_level */
+
+#if VECTOR3_SIMD_X86
+#define VECTOR_ANGLE_DISPATCH(...)                                          \
+    switch (active_simd_level())                                            \
+    {                                                                       \
+    case simd_level::avx512: vector_angle_avx512::__VA_ARGS__; return;      \
+    case simd_level::avx2:   vector_angle_avx2::__VA_ARGS__;   return;      \
+    case simd_level::sse41:  vector_angle_sse41::__VA_ARGS__;  return;      \
+    case simd_level::scalar: vector_angle_scalar::__VA_ARGS__; return;      \
+    }
+#else
+#define VECTOR_ANGLE_DISPATCH(...) vector_angle_scalar::__VA_ARGS__;
+#endif
+
+namespace vector_angle_detail
+{
+
+template <std::size_t N, typename T>
+const T* flat(const vector<N, T>* p) { return reinterpret_cast<const T*>(p); }
+
+template <std::size_t N, typename T>
+T* flat(vector<N, T>* p) { return reinterpret_cast<T*>(p); }
+
+template <typename T>
+void sin_cos(std::span<const T> x, std::span<T> s, std::span<T> c)
+{
+    assert(s.size() >= x.size() && c.size() >= x.size());
+    VECTOR_ANGLE_DISPATCH(sin_cos<T>(x.data(), x.size(), s.data(), c.data()))
+}
+
+template <typename T>
+void atan2(std::span<const T> y, std::span<const T> x, std::span<T> out)
+{
+    assert(x.size() == y.size() && out.size() >= y.size());
+    VECTOR_ANGLE_DISPATCH(atan2<T>(y.data(), x.data(), y.size(), out.data()))
+}
+
+template <typename T>
+void acos(std::span<const T> x, std::span<T> out)
+{
+    assert(out.size() >= x.size());
+    VECTOR_ANGLE_DISPATCH(acos<T>(x.data(), x.size(), out.data()))
+}
+
+template <typename T>
+void angle(std::span<const vector3<T>> a, std::span<const vector3<T>> b, std::span<T> out)
+{
+    assert(b.size() == a.size() && out.size() >= a.size());
+    VECTOR_ANGLE_DISPATCH(angle<T>(flat(a.data()), flat(b.data()), a.size(), out.data()))
+}
+
+template <typename T>
+void rotate(std::span<const vector3<T>> v, std::span<const vector3<T>> axis, std::span<const T> angle, std::span<vector3<T>> out)
+{
+    assert(axis.size() == v.size() && angle.size() == v.size() && out.size() >= v.size());
+    VECTOR_ANGLE_DISPATCH(rotate<T>(flat(v.data()), flat(axis.data()), angle.data(), v.size(), flat(out.data())))
+}
+
+template <typename T>
+void slerp(std::span<const vector3<T>> a, std::span<const vector3<T>> b, T t, std::span<vector3<T>> out)
+{
+    assert(b.size() == a.size() && out.size() >= a.size());
+    VECTOR_ANGLE_DISPATCH(slerp<T>(flat(a.data()), flat(b.data()), t, a.size(), flat(out.data())))
+}
+
+template <typename T>
+void to_spherical(std::span<const vector3<T>> v, std::span<vector3<T>> out)
+{
+    assert(out.size() >= v.size());
+    VECTOR_ANGLE_DISPATCH(to_spherical<T>(flat(v.data()), v.size(), flat(out.data())))
+}
+
+template <typename T>
+void from_spherical(std::span<const vector3<T>> v, std::span<vector3<T>> out)
+{
+    assert(out.size() >= v.size());
+    VECTOR_ANGLE_DISPATCH(from_spherical<T>(flat(v.data()), v.size(), flat(out.data())))
+}
+
+template <typename T>
+void to_polar(std::span<const vector2<T>> v, std::span<vector2<T>> out)
+{
+    assert(out.size() >= v.size());
+    VECTOR_ANGLE_DISPATCH(to_polar<T>(flat(v.data()), v.size(), flat(out.data())))
+}
+
+template <typename T>
+void from_polar(std::span<const vector2<T>> v, std::span<vector2<T>> out)
+{
+    assert(out.size() >= v.size());
+    VECTOR_ANGLE_DISPATCH(from_polar<T>(flat(v.data()), v.size(), flat(out.data())))
+}
+
+} // namespace vector_angle_detail
+
+#undef VECTOR_ANGLE_DISPATCH
+
+/* Batch primitives */
+
+inline void batch_sin_cos(std::span<const float> x, std::span<float> s, std::span<float> c)
+{
+    vector_angle_detail::sin_cos(x, s, c);
+}
+
+inline void batch_sin_cos(std::span<const double> x, std::span<double> s, std::span<double> c)
+{
+    vector_angle_detail::sin_cos(x, s, c);
+}
+
+inline void batch_atan2(std::span<const float> y, std::span<const float> x, std::span<float> out)
+{
+    vector_angle_detail::atan2(y, x, out);
+}
+
+inline void batch_atan2(std::span<const double> y, std::span<const double> x, std::span<double> out)
+{
+    vector_angle_detail::atan2(y, x, out);
+}
+
+inline void batch_acos(std::span<const float> x, std::span<float> out)
+{
+    vector_angle_detail::acos(x, out);
+}
+
+inline void batch_acos(std::span<const double> x, std::span<double> out)
+{
+    vector_angle_detail::acos(x, out);
+}
+
+/* Batch vector operations */
+
+inline void batch_angle(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<float> out)
+{
+    vector_angle_detail::angle(a, b, out);
+}
+
+inline void batch_angle(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<double> out)
+{
+    vector_angle_detail::angle(a, b, out);
+}
+
+inline void batch_rotate(std::span<const vector3<float>> v, std::span<const vector3<float>> axis, std::span<const float> angle, std::span<vector3<float>> out)    // Unit axes
+{
+    vector_angle_detail::rotate(v, axis, angle, out);
+}
+
+inline void batch_rotate(std::span<const vector3<double>> v, std::span<const vector3<double>> axis, std::span<const double> angle, std::span<vector3<double>> out)
+{
+    vector_angle_detail::rotate(v, axis, angle, out);
+}
+
+inline void batch_slerp(std::span<const vector3<float>> a, std::span<const vector3<float>> b, float t, std::span<vector3<float>> out)    // Unit vectors
+{
+    vector_angle_detail::slerp(a, b, t, out);
+}
+
+inline void batch_slerp(std::span<const vector3<double>> a, std::span<const vector3<double>> b, double t, std::span<vector3<double>> out)
+{
+    vector_angle_detail::slerp(a, b, t, out);
+}
+
+inline void batch_to_spherical(std::span<const vector3<float>> v, std::span<vector3<float>> out)
+{
+    vector_angle_detail::to_spherical(v, out);
+}
+
+inline void batch_to_spherical(std::span<const vector3<double>> v, std::span<vector3<double>> out)
+{
+    vector_angle_detail::to_spherical(v, out);
+}
+
+inline void batch_from_spherical(std::span<const vector3<float>> s, std::span<vector3<float>> out)
+{
+    vector_angle_detail::from_spherical(s, out);
+}
+
+inline void batch_from_spherical(std::span<const vector3<double>> s, std::span<vector3<double>> out)
+{
+    vector_angle_detail::from_spherical(s, out);
+}
+
+inline void batch_to_polar(std::span<const vector2<float>> v, std::span<vector2<float>> out)
+{
+    vector_angle_detail::to_polar(v, out);
+}
+
+inline void batch_to_polar(std::span<const vector2<double>> v, std::span<vector2<double>> out)
+{
+    vector_angle_detail::to_polar(v, out);
+}
+
+inline void batch_from_polar(std::span<const vector2<float>> p, std::span<vector2<float>> out)
+{
+    vector_angle_detail::from_polar(p, out);
+}
+
+inline void batch_from_polar(std::span<const vector2<double>> p, std::span<vector2<double>> out)
+{
+    vector_angle_detail::from_polar(p, out);
+}
+
+#endif
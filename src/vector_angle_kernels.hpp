@@ -0,0 +1,488 @@
+// Angle kernels shared by every backend. This file is included once per instruction
+// set from vector_angle.hpp, inside a namespace that defines vf, vi, vd and vl (floats,
+// ints, doubles and 64 bit ints: GCC/clang vector extension types of the register
+// width, or the plain scalar types for the scalar backend) and vsqrt for vf and vd, so
+// it intentionally has no include guard.
+//
+// The code only uses operations that mean the same on a scalar and on a vector: the
+// arithmetic operators, comparisons turned into masks by mask<M>, bit casts by as<To>, and
+// lane() to read single lanes. The scalar backend therefore runs this very code one
+// lane at a time, and since fp contraction is off in every backend all of them return
+// the same bits. The vector batches copy angle_stage elements at a time into component
+// streams, zero padded to a whole lane group, and copy the results back.
+
+template <typename T> struct lanes_of;
+template <> struct lanes_of<float>  { using type = vf; using mask = vi; };
+template <> struct lanes_of<double> { using type = vd; using mask = vl; };
+
+template <typename T> using lanes = typename lanes_of<T>::type;
+template <typename T> using lane_mask = typename lanes_of<T>::mask;       // 0 / -1 per lane
+
+template <typename T>
+constexpr std::size_t width = sizeof(lanes<T>) / sizeof(T);
+
+constexpr std::size_t angle_stage = 256;    // Elements per staged block, a multiple of every width
+
+template <typename V, typename T>
+inline V splat(T a)                 { return V{} + a; }
+
+template <typename V, typename T>
+inline V load(const T* p)           { V a; std::memcpy(&a, p, sizeof(a)); return a; }
+
+template <typename T, typename V>
+inline void store(T* p, V a)        { std::memcpy(p, &a, sizeof(a)); }
+
+template <typename To, typename From>
+inline To as(From a)                { To b; std::memcpy(&b, &a, sizeof(b)); return b; }      // Same bits
+
+template <typename M, typename C>
+inline M mask(C c)                  // A comparison result as 0 / -1 lanes
+{
+    if constexpr (std::is_same_v<C, bool>)
+        return -M(c);
+    else
+        return M(c);
+}
+
+template <typename V, typename M>
+inline V select(M m, V a, V b)      // a where m is set, else b
+{
+    return as<V>((as<M>(a) & m) | (as<M>(b) & ~m));
+}
+
+template <typename V>
+inline auto lane(const V& a, std::size_t j)
+{
+    if constexpr (std::is_arithmetic_v<V>)
+        return a;
+    else
+        return a[j];
+}
+
+template <typename V, typename T>
+inline void set_lane(V& a, std::size_t j, T b)
+{
+    if constexpr (std::is_arithmetic_v<V>)
+        a = b;
+    else
+        a[j] = b;
+}
+
+template <typename M>
+inline bool any_lane(M m)
+{
+    bool a = false;
+    for (std::size_t j = 0; j < sizeof(M) / sizeof(lane(m, 0)); ++j)
+        a |= lane(m, j) != 0;
+    return a;
+}
+
+/* Sign bit helpers */
+
+template <typename T>
+inline lane_mask<T> sign_bit()
+{
+    using M = lane_mask<T>;
+    return splat<M>(std::numeric_limits<std::remove_cvref_t<decltype(lane(M{}, 0))>>::min());
+}
+
+template <typename T>
+inline lanes<T> vabs(lanes<T> a)            { return as<lanes<T>>(as<lane_mask<T>>(a) & ~sign_bit<T>()); }
+
+template <typename T>
+inline lane_mask<T> negative(lanes<T> a)    { return mask<lane_mask<T>>(as<lane_mask<T>>(a) < 0); }     // Sign bit set, -0 included
+
+template <typename T>
+inline lanes<T> flip(lanes<T> a, lane_mask<T> m)    // a with its sign flipped where m has the sign bit
+{
+    return as<lanes<T>>(as<lane_mask<T>>(a) ^ (m & sign_bit<T>()));
+}
+
+template <typename T, std::size_t K>
+inline lanes<T> horner(lanes<T> z, const T (&c)[K])
+{
+    lanes<T> p = splat<lanes<T>>(c[0]);
+    for (std::size_t k = 1; k < K; ++k)
+        p = p * z + splat<lanes<T>>(c[k]);
+    return p;
+}
+
+/* Lane group primitives */
+
+// x = k pi / 2 + r with |r| <= pi / 4: k comes from the round to nearest of the
+// shifter, which leaves it in the low bits, and r from pi / 2 in parts. Bit 0 of k
+// swaps sin and cos, bit 1 of k (of k + 1 for cos) negates.
+template <typename T>
+inline void sin_cos(lanes<T> x, lanes<T>& s, lanes<T>& c)
+{
+    using V = lanes<T>;
+    using M = lane_mask<T>;
+    using C = vector_angle_detail::constants<T>;
+    constexpr int top = int(sizeof(T) * 8) - 2;     // Moves bit 1 to the sign bit
+
+    const V q = x * splat<V>(C::two_over_pi) + splat<V>(C::shifter);
+    const M k = as<M>(q);
+    const V f = q - splat<V>(C::shifter);
+    V r = x;
+    for (const T p : C::pio2)
+        r = r - f * splat<V>(p);
+    const V z = r * r;
+    const V sr = as<V>(as<M>(r + r * (z * horner<T>(z, C::sin))) | (as<M>(r) & sign_bit<T>()));      // Keeps the sign of r = -0
+    const V cr = (splat<V>(T(1)) - z * splat<V>(T(0.5))) + z * z * horner<T>(z, C::cos);
+    const M swap = mask<M>((k & 1) != 0);
+    s = flip<T>(select(swap, cr, sr), k << top);
+    c = flip<T>(select(swap, sr, cr), (k + 1) << top);
+
+    const M far = ~mask<M>(vabs<T>(x) <= splat<V>(C::reduce_max));     // Also inf and NaN
+    if (any_lane(far))
+        for (std::size_t j = 0; j < width<T>; ++j)
+            if (lane(far, j))
+            {
+                set_lane(s, j, std::sin(lane(x, j)));
+                set_lane(c, j, std::cos(lane(x, j)));
+            }
+}
+
+// a b - p for p = a b rounded, Dekker's product with the factors split by masking
+// their low mantissa bits, so large factors cannot overflow as in Veltkamp's split
+template <typename T>
+inline lanes<T> mul_error(lanes<T> a, lanes<T> b, lanes<T> p)
+{
+    using V = lanes<T>;
+    using M = lane_mask<T>;
+    using C = vector_angle_detail::constants<T>;
+    const M hi = splat<M>(C::split_mask);
+    const V ah = as<V>(as<M>(a) & hi), bh = as<V>(as<M>(b) & hi);
+    const V al = a - ah, bl = b - bh;
+    return ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+}
+
+// atan of t = min(|y|, |x|) / max(|y|, |x|) in [0, 1], unfolded to the quadrant of
+// (x, y). With atan_fold t past tan(pi / 8) goes through
+// atan t = pi / 4 + atan((t - 1) / (t + 1)), which keeps the polynomial short. There
+// the result can be as small as the atan term, so the rounding errors of
+// u = (n - d) / (n + d) are carried along in c, which adds c / (1 + u^2), and
+// pi / 4 + u is summed exactly before the small terms join it.
+template <typename T>
+inline lanes<T> atan2(lanes<T> y, lanes<T> x)
+{
+    using V = lanes<T>;
+    using M = lane_mask<T>;
+    using C = vector_angle_detail::constants<T>;
+    const V zero = splat<V>(T(0));
+
+    const V ax = vabs<T>(x), ay = vabs<T>(y);
+    const M swap = mask<M>(ay > ax);
+    const V n = select(swap, ax, ay);
+    const V d = select(swap, ay, ax);
+    const V t = select(mask<M>(d == zero), zero, n / d);
+    V r;
+    if constexpr (C::atan_fold)
+    {
+        const M far = mask<M>(t > splat<V>(C::tan_pi_8));
+        const V k = select(mask<M>(d < splat<V>(C::atan_tiny)), splat<V>(C::atan_scale), splat<V>(T(1)));     // Keeps the errors of c normal
+        const V nk = n * k, dk = d * k;
+        const V a = nk - dk, b = nk + dk;                   // n + d is finite below atan_max
+        const V ea = nk - (a + dk), eb = nk - (b - dk);     // Exact, as d >= n
+        const V q = a / b;
+        const V p = q * b;                                  // a - p is exact, p being within ulps of a
+        const V u = select(far, q, t);
+        const V c = select(far, (((a - p) - mul_error<T>(q, b, p)) + (ea - q * eb)) / b, zero);
+        const V z = u * u;
+        const V tail = u * (z * horner<T>(z, C::atan));
+        const V s = splat<V>(C::pi_4_hi) + u;
+        const V es = u - (s - splat<V>(C::pi_4_hi));        // Exact, as |u| < pi / 4
+        r = select(far, s + ((es + splat<V>(C::pi_4_lo)) + (tail + c / (splat<V>(T(1)) + z))), u + tail);
+    }
+    else
+    {
+        const V z = t * t;
+        r = t + t * (z * horner<T>(z, C::atan));
+    }
+    r = select(swap, splat<V>(C::pi_2) - r, r);
+    r = select(negative<T>(x), splat<V>(C::pi) - r, r);
+    r = as<V>(as<M>(r) | (as<M>(y) & sign_bit<T>()));
+
+    const M odd = ~mask<M>(ax < splat<V>(C::atan_max)) | ~mask<M>(ay < splat<V>(C::atan_max));      // Also inf and NaN
+    if (any_lane(odd))
+        for (std::size_t j = 0; j < width<T>; ++j)
+            if (lane(odd, j))
+                set_lane(r, j, std::atan2(lane(y, j), lane(x, j)));
+    return r;
+}
+
+// acos x = pi / 2 - asin x up to |x| = 1 / 2, beyond that acos |x| = 2 asin s with
+// s = sqrt((1 - |x|) / 2), where 1 - |x| is exact
+template <typename T>
+inline lanes<T> acos(lanes<T> x)
+{
+    using V = lanes<T>;
+    using M = lane_mask<T>;
+    using C = vector_angle_detail::constants<T>;
+    const V half = splat<V>(T(0.5));
+
+    const V ax = vabs<T>(x);
+    const M far = mask<M>(ax > half);
+    const V h = (splat<V>(T(1)) - ax) * half;
+    const V z = select(far, h, x * x);
+    const V s = select(far, vsqrt(h), x);        // Beyond 1 the root is NaN, as acos is
+    const V a = s + s * (z * horner<T>(z, C::asin));
+    const V b = a + a;
+    return select(far, select(negative<T>(x), (splat<V>(C::pi_hi) - b) + splat<V>(C::pi_lo), b), (splat<V>(C::pi_2_hi) - a) + splat<V>(C::pi_2_lo));
+}
+
+/* Staging */
+
+// Copies elements [first, first + count) of a flat array of stride S into S streams,
+// zero filled up to padded
+template <std::size_t S, typename T>
+inline void stage(const T* p, std::size_t first, std::size_t count, std::size_t padded, T (*s)[angle_stage])
+{
+    for (std::size_t d = 0; d < S; ++d)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            s[d][i] = p[(first + i) * S + d];
+        for (std::size_t i = count; i < padded; ++i)
+            s[d][i] = T(0);
+    }
+}
+
+template <std::size_t S, typename T>
+inline void unstage(const T (*s)[angle_stage], std::size_t first, std::size_t count, T* p)
+{
+    for (std::size_t d = 0; d < S; ++d)
+        for (std::size_t i = 0; i < count; ++i)
+            p[(first + i) * S + d] = s[d][i];
+}
+
+// fill(s, first, count, padded) stages the inputs of a block, group(s, r, k) computes
+// the O output streams of the lane group at k
+template <std::size_t S, std::size_t O, typename T, typename F, typename G>
+inline void staged(std::size_t n, T* out, F fill, G group)
+{
+    constexpr std::size_t w = width<T>;
+    T s[S][angle_stage];
+    T r[O][angle_stage];
+    for (std::size_t first = 0; first < n; first += angle_stage)
+    {
+        const std::size_t count = n - first < angle_stage ? n - first : angle_stage;
+        const std::size_t padded = (count + w - 1) / w * w;
+        fill(s, first, count, padded);
+        for (std::size_t k = 0; k < padded; k += w)
+            group(s, r, k);
+        unstage<O>(r, first, count, out);
+    }
+}
+
+// Elements [m, n) of streams too short for a whole lane group, through a zero padded group
+template <std::size_t I, std::size_t O, typename T, typename G>
+inline void tail(const T* const (&in)[I], T* const (&out)[O], std::size_t m, std::size_t n, G group)
+{
+    if (m == n)
+        return;
+    T a[I][width<T>] = {}, b[O][width<T>];
+    for (std::size_t d = 0; d < I; ++d)
+        std::memcpy(a[d], in[d] + m, (n - m) * sizeof(T));
+    lanes<T> v[I], r[O];
+    for (std::size_t d = 0; d < I; ++d)
+        v[d] = load<lanes<T>>(a[d]);
+    group(v, r);
+    for (std::size_t d = 0; d < O; ++d)
+    {
+        store(b[d], r[d]);
+        std::memcpy(out[d] + m, b[d], (n - m) * sizeof(T));
+    }
+}
+
+/* Kernels, on flat arrays of n elements */
+
+template <typename T>
+void sin_cos(const T* x, std::size_t n, T* s, T* c)
+{
+    using V = lanes<T>;
+    const std::size_t m = n / width<T> * width<T>;
+    for (std::size_t k = 0; k < m; k += width<T>)
+    {
+        V a, b;
+        sin_cos<T>(load<V>(x + k), a, b);
+        store(s + k, a);
+        store(c + k, b);
+    }
+    tail<1, 2>({ x }, { s, c }, m, n, [](const V* v, V* r) { sin_cos<T>(v[0], r[0], r[1]); });
+}
+
+template <typename T>
+void atan2(const T* y, const T* x, std::size_t n, T* out)
+{
+    using V = lanes<T>;
+    const std::size_t m = n / width<T> * width<T>;
+    for (std::size_t k = 0; k < m; k += width<T>)
+        store(out + k, atan2<T>(load<V>(y + k), load<V>(x + k)));
+    tail<2, 1>({ y, x }, { out }, m, n, [](const V* v, V* r) { r[0] = atan2<T>(v[0], v[1]); });
+}
+
+template <typename T>
+void acos(const T* x, std::size_t n, T* out)
+{
+    using V = lanes<T>;
+    const std::size_t m = n / width<T> * width<T>;
+    for (std::size_t k = 0; k < m; k += width<T>)
+        store(out + k, acos<T>(load<V>(x + k)));
+    tail<1, 1>({ x }, { out }, m, n, [](const V* v, V* r) { r[0] = acos<T>(v[0]); });
+}
+
+// The vector kernels repeat the operations of the single vector forms in
+// vector_angle.hpp in the same order, with the fast primitives for the std ones.
+
+template <typename T>
+void angle(const T* a, const T* b, std::size_t n, T* out)      // atan2(|a x b|, a . b)
+{
+    using V = lanes<T>;
+    staged<6, 1>(n, out, [&](T (*s)[angle_stage], std::size_t first, std::size_t count, std::size_t padded)
+    {
+        stage<3>(a, first, count, padded, s);
+        stage<3>(b, first, count, padded, s + 3);
+    },
+    [&](const T (*s)[angle_stage], T (*r)[angle_stage], std::size_t k)
+    {
+        const V ax = load<V>(s[0] + k), ay = load<V>(s[1] + k), az = load<V>(s[2] + k);
+        const V bx = load<V>(s[3] + k), by = load<V>(s[4] + k), bz = load<V>(s[5] + k);
+        const V cx = ay * bz - az * by, cy = az * bx - ax * bz, cz = ax * by - ay * bx;
+        const V d = (ax * bx + ay * by) + az * bz;
+        store(r[0] + k, atan2<T>(vsqrt((cx * cx + cy * cy) + cz * cz), d));
+    });
+}
+
+template <typename T>
+void rotate(const T* v, const T* axis, const T* angle, std::size_t n, T* out)      // v cos + (axis x v) sin + axis (axis . v) (1 - cos)
+{
+    using V = lanes<T>;
+    staged<7, 3>(n, out, [&](T (*s)[angle_stage], std::size_t first, std::size_t count, std::size_t padded)
+    {
+        stage<3>(v, first, count, padded, s);
+        stage<3>(axis, first, count, padded, s + 3);
+        stage<1>(angle, first, count, padded, s + 6);
+    },
+    [&](const T (*s)[angle_stage], T (*r)[angle_stage], std::size_t k)
+    {
+        const V vx = load<V>(s[0] + k), vy = load<V>(s[1] + k), vz = load<V>(s[2] + k);
+        const V ax = load<V>(s[3] + k), ay = load<V>(s[4] + k), az = load<V>(s[5] + k);
+        V sn, cs;
+        sin_cos<T>(load<V>(s[6] + k), sn, cs);
+        const V cx = ay * vz - az * vy, cy = az * vx - ax * vz, cz = ax * vy - ay * vx;
+        const V e = ((ax * vx + ay * vy) + az * vz) * (splat<V>(T(1)) - cs);
+        store(r[0] + k, (vx * cs + cx * sn) + ax * e);
+        store(r[1] + k, (vy * cs + cy * sn) + ay * e);
+        store(r[2] + k, (vz * cs + cz * sn) + az * e);
+    });
+}
+
+template <typename T>
+void slerp(const T* a, const T* b, T t, std::size_t n, T* out)
+{
+    using V = lanes<T>;
+    using M = lane_mask<T>;
+    using C = vector_angle_detail::constants<T>;
+    staged<6, 3>(n, out, [&](T (*s)[angle_stage], std::size_t first, std::size_t count, std::size_t padded)
+    {
+        stage<3>(a, first, count, padded, s);
+        stage<3>(b, first, count, padded, s + 3);
+    },
+    [&](const T (*s)[angle_stage], T (*r)[angle_stage], std::size_t k)
+    {
+        const V one = splat<V>(T(1)), vt = splat<V>(t), vu = splat<V>(T(1) - t);
+        const V ax = load<V>(s[0] + k), ay = load<V>(s[1] + k), az = load<V>(s[2] + k);
+        const V bx = load<V>(s[3] + k), by = load<V>(s[4] + k), bz = load<V>(s[5] + k);
+        V d = (ax * bx + ay * by) + az * bz;
+        d = select(mask<M>(d > one), one, d);
+        d = select(mask<M>(d < -one), -one, d);
+
+        const V theta = acos<T>(d);
+        V st, ct, s0, s1;
+        sin_cos<T>(theta, st, ct);
+        sin_cos<T>(vu * theta, s0, ct);
+        sin_cos<T>(vt * theta, s1, ct);
+        const V inv = one / st;
+        const V p = s0 * inv, q = s1 * inv;
+
+        const V lx = ax * vu + bx * vt, ly = ay * vu + by * vt, lz = az * vu + bz * vt;      // Nearly parallel, normalized lerp
+        const V len = vsqrt((lx * lx + ly * ly) + lz * lz);
+        const M near = mask<M>(d > splat<V>(C::slerp_linear));
+        store(r[0] + k, select(near, lx / len, ax * p + bx * q));
+        store(r[1] + k, select(near, ly / len, ay * p + by * q));
+        store(r[2] + k, select(near, lz / len, az * p + bz * q));
+    });
+}
+
+template <typename T>
+void to_spherical(const T* v, std::size_t n, T* out)        // (r, theta, phi)
+{
+    using V = lanes<T>;
+    staged<3, 3>(n, out, [&](T (*s)[angle_stage], std::size_t first, std::size_t count, std::size_t padded)
+    {
+        stage<3>(v, first, count, padded, s);
+    },
+    [&](const T (*s)[angle_stage], T (*r)[angle_stage], std::size_t k)
+    {
+        const V x = load<V>(s[0] + k), y = load<V>(s[1] + k), z = load<V>(s[2] + k);
+        const V xy = x * x + y * y;
+        store(r[0] + k, vsqrt(xy + z * z));
+        store(r[1] + k, atan2<T>(vsqrt(xy), z));
+        store(r[2] + k, atan2<T>(y, x));
+    });
+}
+
+template <typename T>
+void from_spherical(const T* v, std::size_t n, T* out)
+{
+    using V = lanes<T>;
+    staged<3, 3>(n, out, [&](T (*s)[angle_stage], std::size_t first, std::size_t count, std::size_t padded)
+    {
+        stage<3>(v, first, count, padded, s);
+    },
+    [&](const T (*s)[angle_stage], T (*r)[angle_stage], std::size_t k)
+    {
+        V st, ct, sp, cp;
+        sin_cos<T>(load<V>(s[1] + k), st, ct);
+        sin_cos<T>(load<V>(s[2] + k), sp, cp);
+        const V rad = load<V>(s[0] + k);
+        const V rs = rad * st;
+        store(r[0] + k, rs * cp);
+        store(r[1] + k, rs * sp);
+        store(r[2] + k, rad * ct);
+    });
+}
+
+template <typename T>
+void to_polar(const T* v, std::size_t n, T* out)        // (r, phi)
+{
+    using V = lanes<T>;
+    staged<2, 2>(n, out, [&](T (*s)[angle_stage], std::size_t first, std::size_t count, std::size_t padded)
+    {
+        stage<2>(v, first, count, padded, s);
+    },
+    [&](const T (*s)[angle_stage], T (*r)[angle_stage], std::size_t k)
+    {
+        const V x = load<V>(s[0] + k), y = load<V>(s[1] + k);
+        store(r[0] + k, vsqrt(x * x + y * y));
+        store(r[1] + k, atan2<T>(y, x));
+    });
+}
+
+template <typename T>
+void from_polar(const T* v, std::size_t n, T* out)
+{
+    using V = lanes<T>;
+    staged<2, 2>(n, out, [&](T (*s)[angle_stage], std::size_t first, std::size_t count, std::size_t padded)
+    {
+        stage<2>(v, first, count, padded, s);
+    },
+    [&](const T (*s)[angle_stage], T (*r)[angle_stage], std::size_t k)
+    {
+        V sp, cp;
+        sin_cos<T>(load<V>(s[1] + k), sp, cp);
+        const V rad = load<V>(s[0] + k);
+        store(r[0] + k, rad * cp);
+        store(r[1] + k, rad * sp);
+    });
+}
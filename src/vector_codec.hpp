@@ -0,0 +1,442 @@
+#ifndef VECTOR_CODEC_H
+#define VECTOR_CODEC_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "vector3.hpp"
+#include "vector3_simd.hpp"
+
+// Compact storage for vector3<float> data.
+//
+//     vector_oct16 / vector_oct32   unit vectors, octahedral map in 2 x 8 or 2 x 16 bits
+//     vector3_q16                   positions quantized to 3 x 16 bits inside a box
+//     delta_encode / delta_decode   vector3_q16 streams as zigzag deltas in LEB128 varints
+//
+// The octahedral map projects the unit sphere onto the octahedron |x| + |y| + |z| = 1
+// and unfolds the lower half over the corners of the square, so both halves share
+// one [-1, 1]^2 grid stored as snorm integers. Decoding returns a unit vector. The
+// largest angle between a unit vector and its decoded value is below
+// vector_oct16_max_error and vector_oct32_max_error (radians). The zero vector
+// encodes as +z.
+//
+// vector3_quantizer maps its box onto 0..65535 per axis; decode(encode(v)) is within
+// max_error() of v for every v in the box, and points outside are clamped to it.
+//
+// The batch functions follow the vector3_simd dispatch (set_simd_level applies) to
+// SSE4.1, AVX2 or AVX-512 kernels written with GCC/clang vector extensions. Every
+// backend returns the same bits as the scalar encode and decode, which are constexpr
+// and, like the kernels, kept free of FMA contraction under -mfma or -march=native.
+// Inputs must be finite.
+
+constexpr float vector_oct16_max_error = 0.0175f;       // Radians, about 1 degree (0.0167 seen over 2^26 random directions)
+constexpr float vector_oct32_max_error = 7.0e-5f;       // Radians, about 0.004 degrees (6.5e-5 seen)
+
+template <typename I>
+struct vector_oct
+{
+    static_assert(std::is_same_v<I, std::int8_t> || std::is_same_v<I, std::int16_t>, "vector_oct stores int8_t or int16_t");
+
+    I u;
+    I v;
+
+    static constexpr float scale = float(std::numeric_limits<I>::max());
+
+    static constexpr vector_oct<I> encode(const vector3<float>& n) noexcept;
+    constexpr vector3<float>       decode() const noexcept;
+
+    constexpr bool operator==(const vector_oct<I>& o) const noexcept = default;
+};
+
+using vector_oct16 = vector_oct<std::int8_t>;
+using vector_oct32 = vector_oct<std::int16_t>;
+
+static_assert(sizeof(vector_oct16) == 2 && sizeof(vector_oct32) == 4, "octahedral vectors must be tightly packed");
+
+struct vector3_q16
+{
+    std::uint16_t x;
+    std::uint16_t y;
+    std::uint16_t z;
+
+    constexpr bool operator==(const vector3_q16& q) const noexcept = default;
+};
+
+static_assert(sizeof(vector3_q16) == 6, "vector3_q16 must be tightly packed");
+
+struct vector3_quantizer
+{
+    vector3<float> lo;
+    vector3<float> hi;
+    vector3<float> step;        // Size of one quantization step per axis
+    vector3<float> inv_step;    // 0 on a flat axis
+
+    constexpr vector3_quantizer(const vector3<float>& lo_, const vector3<float>& hi_) noexcept;
+
+    constexpr vector3_q16    encode(const vector3<float>& v) const noexcept;   // Clamped to the box
+    constexpr vector3<float> decode(const vector3_q16& q) const noexcept;
+    constexpr vector3<float> max_error() const noexcept;                        // Per axis, for points inside the box
+};
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")     // The scalar codecs must not fuse where the batch kernels do not
+#endif
+
+/* Scalar helpers, written to compile to selects rather than branches */
+
+namespace vector_codec_detail
+{
+
+constexpr float absf(float a) noexcept           { return a < 0.0f ? -a : a; }
+constexpr float signf(float a) noexcept          { return a < 0.0f ? -1.0f : 1.0f; }    // +1 for zero
+constexpr float clampf(float a, float lo, float hi) noexcept { return a < lo ? lo : (a > hi ? hi : a); }
+
+// Lane kernels shared by the scalar codecs and the batch kernels. Integer outputs are
+// returned as floats biased by half a step, so a truncating conversion rounds them half
+// away from zero.
+
+constexpr void oct_encode_lane(float x, float y, float z, float scale, float& u, float& v) noexcept
+{
+    const float s = absf(x) + absf(y) + absf(z);
+    const float r = 1.0f / (s > 0.0f ? s : 1.0f);     // Zero stays zero, and maps to +z
+    const float px = x * r;
+    const float py = y * r;
+    const float fx = (1.0f - absf(py)) * signf(px);  // Lower hemisphere, folded over the corners
+    const float fy = (1.0f - absf(px)) * signf(py);
+    const float su = clampf(z < 0.0f ? fx : px, -1.0f, 1.0f) * scale;
+    const float sv = clampf(z < 0.0f ? fy : py, -1.0f, 1.0f) * scale;
+    u = su + (su < 0.0f ? -0.5f : 0.5f);
+    v = sv + (sv < 0.0f ? -0.5f : 0.5f);
+}
+
+constexpr void oct_decode_lane(float u, float v, float inv_scale, float& x, float& y, float& z) noexcept
+{
+    float px = u * inv_scale;
+    float py = v * inv_scale;
+    const float pz = 1.0f - absf(px) - absf(py);
+    const float t = pz < 0.0f ? -pz : 0.0f;
+    px += px < 0.0f ? t : -t;
+    py += py < 0.0f ? t : -t;
+    const float l = 1.0f / vector_sqrt(px * px + py * py + pz * pz);
+    x = px * l;
+    y = py * l;
+    z = pz * l;
+}
+
+constexpr float quantize_lane(float a, float lo, float hi, float inv_step) noexcept
+{
+    return clampf((clampf(a, lo, hi) - lo) * inv_step, 0.0f, 65535.0f) + 0.5f;
+}
+
+} // namespace vector_codec_detail
+
+/* Octahedral unit vectors */
+
+template <typename I>
+constexpr vector_oct<I> vector_oct<I>::encode(const vector3<float>& n) noexcept
+{
+    float u, v;
+    vector_codec_detail::oct_encode_lane(n.x, n.y, n.z, scale, u, v);
+    return vector_oct<I>{ I(u), I(v) };
+}
+
+template <typename I>
+constexpr vector3<float> vector_oct<I>::decode() const noexcept
+{
+    vector3<float> n;
+    vector_codec_detail::oct_decode_lane(float(u), float(v), 1.0f / scale, n.x, n.y, n.z);
+    return n;
+}
+
+/* Box quantized positions */
+
+constexpr vector3_quantizer::vector3_quantizer(const vector3<float>& lo_, const vector3<float>& hi_) noexcept
+    : lo(lo_), hi(hi_), step((hi_ - lo_) * (1.0f / 65535.0f)), inv_step(0.0f)
+{
+    vector_detail::for_each<3>([&](auto c)
+    {
+        get<c>(inv_step) = get<c>(hi) > get<c>(lo) ? 65535.0f / (get<c>(hi) - get<c>(lo)) : 0.0f;
+    });
+}
+
+constexpr vector3_q16 vector3_quantizer::encode(const vector3<float>& v) const noexcept
+{
+    using vector_codec_detail::quantize_lane;
+    return vector3_q16{ std::uint16_t(quantize_lane(v.x, lo.x, hi.x, inv_step.x)),
+                        std::uint16_t(quantize_lane(v.y, lo.y, hi.y, inv_step.y)),
+                        std::uint16_t(quantize_lane(v.z, lo.z, hi.z, inv_step.z)) };
+}
+
+constexpr vector3<float> vector3_quantizer::decode(const vector3_q16& q) const noexcept
+{
+    return vector3<float>(lo.x + float(q.x) * step.x, lo.y + float(q.y) * step.y, lo.z + float(q.z) * step.z);
+}
+
+constexpr vector3<float> vector3_quantizer::max_error() const noexcept    // Half a step, plus the float rounding of the box coordinates
+{
+    using namespace vector_codec_detail;
+    constexpr float eps = std::numeric_limits<float>::epsilon();
+    return vector3<float>(vector_detail::generate<3, float>([&](auto c)
+    {
+        return 0.5f * get<c>(step) + 2.0f * eps * (absf(get<c>(lo)) + absf(get<c>(hi)));
+    }));
+}
+
+/* Delta + varint streams */
+
+inline void delta_encode(std::span<const vector3_q16> q, std::vector<std::uint8_t>& out)     // Appends, at most 9 bytes per vector
+{
+    const std::size_t start = out.size();
+    out.resize(start + 9 * q.size());
+    std::uint8_t* p = out.data() + start;
+
+    const auto put = [&](std::uint16_t d)       // Wrapped delta, zigzag, LEB128
+    {
+        std::uint32_t z = std::uint16_t((d << 1) ^ (d & 0x8000 ? 0xffff : 0));
+        while (z >= 0x80)
+        {
+            *p++ = std::uint8_t(z | 0x80);
+            z >>= 7;
+        }
+        *p++ = std::uint8_t(z);
+    };
+
+    vector3_q16 prev{ 0, 0, 0 };
+    for (const vector3_q16& e : q)
+    {
+        put(std::uint16_t(e.x - prev.x));
+        put(std::uint16_t(e.y - prev.y));
+        put(std::uint16_t(e.z - prev.z));
+        prev = e;
+    }
+    out.resize(std::size_t(p - out.data()));
+}
+
+inline std::optional<std::size_t> delta_decode(std::span<const std::uint8_t> in, std::span<vector3_q16> out)     // Fills out, returns the bytes read (0 for an empty out), nullopt on truncated or malformed input
+{
+    std::size_t i = 0;
+    bool ok = true;
+    const auto get = [&]() -> std::uint16_t
+    {
+        std::uint32_t z = 0;
+        for (unsigned shift = 0; shift < 21; shift += 7)
+        {
+            if (i == in.size())
+                break;
+            const std::uint8_t b = in[i++];
+            z |= std::uint32_t(b & 0x7f) << shift;
+            if (!(b & 0x80))
+            {
+                ok = ok && z <= 0xffff;
+                return std::uint16_t((z >> 1) ^ (0u - (z & 1)));
+            }
+        }
+        ok = false;
+        return 0;
+    };
+
+    vector3_q16 prev{ 0, 0, 0 };
+    for (vector3_q16& e : out)
+    {
+        e.x = std::uint16_t(prev.x + get());
+        e.y = std::uint16_t(prev.y + get());
+        e.z = std::uint16_t(prev.z + get());
+        if (!ok)
+            return std::nullopt;
+        prev = e;
+    }
+    return i;
+}
+
+/* Scalar backend */
+
+namespace vector_codec_scalar
+{
+
+template <typename I>
+void oct_encode(const vector3<float>* a, vector_oct<I>* out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = vector_oct<I>::encode(a[i]);
+}
+
+template <typename I>
+void oct_decode(const vector_oct<I>* a, vector3<float>* out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = a[i].decode();
+}
+
+inline void quantize(const vector3_quantizer& q, const vector3<float>* a, vector3_q16* out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = q.encode(a[i]);
+}
+
+inline void dequantize(const vector3_quantizer& q, const vector3_q16* a, vector3<float>* out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = q.decode(a[i]);
+}
+
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+#if VECTOR3_SIMD_X86
+
+/* SSE4.1 backend, 4 lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_codec_sse41
+{
+
+using vf = __m128;
+using vi = int __attribute__((vector_size(16)));
+
+inline vf sqrt(vf a) { return _mm_sqrt_ps(a); }
+
+#include "vector_codec_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX2 backend, 8 lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_codec_avx2
+{
+
+using vf = __m256;
+using vi = int __attribute__((vector_size(32)));
+
+inline vf sqrt(vf a) { return _mm256_sqrt_ps(a); }
+
+#include "vector_codec_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX-512 backend, 16 lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"  // False positives inside GCC's own avx512fintrin.h
+#endif
+
+namespace vector_codec_avx512
+{
+
+using vf = __m512;
+using vi = int __attribute__((vector_size(64)));
+
+inline vf sqrt(vf a) { return _mm512_sqrt_ps(a); }
+
+#include "vector_codec_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+#endif // VECTOR3_SIMD_X86
+
+/* Dispatch on the active simd_level */
+
+#if VECTOR3_SIMD_X86
+#define VECTOR_CODEC_DISPATCH(call)                                         \
+    switch (active_simd_level())                                            \
+    {                                                                       \
+    case simd_level::avx512: vector_codec_avx512::call; return;             \
+    case simd_level::avx2:   vector_codec_avx2::call;   return;             \
+    case simd_level::sse41:  vector_codec_sse41::call;  return;             \
+    case simd_level::scalar: vector_codec_scalar::call; return;             \
+    }
+#else
+#define VECTOR_CODEC_DISPATCH(call) vector_codec_scalar::call;
+#endif
+
+/* Batch operations. out must be at least as long as the input */
+
+inline void batch_oct_encode(std::span<const vector3<float>> a, std::span<vector_oct16> out)
+{
+    assert(out.size() >= a.size());
+    VECTOR_CODEC_DISPATCH(oct_encode(a.data(), out.data(), a.size()))
+}
+
+inline void batch_oct_encode(std::span<const vector3<float>> a, std::span<vector_oct32> out)
+{
+    assert(out.size() >= a.size());
+    VECTOR_CODEC_DISPATCH(oct_encode(a.data(), out.data(), a.size()))
+}
+
+inline void batch_oct_decode(std::span<const vector_oct16> a, std::span<vector3<float>> out)
+{
+    assert(out.size() >= a.size());
+    VECTOR_CODEC_DISPATCH(oct_decode(a.data(), out.data(), a.size()))
+}
+
+inline void batch_oct_decode(std::span<const vector_oct32> a, std::span<vector3<float>> out)
+{
+    assert(out.size() >= a.size());
+    VECTOR_CODEC_DISPATCH(oct_decode(a.data(), out.data(), a.size()))
+}
+
+inline void batch_quantize(const vector3_quantizer& q, std::span<const vector3<float>> a, std::span<vector3_q16> out)
+{
+    assert(out.size() >= a.size());
+    VECTOR_CODEC_DISPATCH(quantize(q, a.data(), out.data(), a.size()))
+}
+
+inline void batch_dequantize(const vector3_quantizer& q, std::span<const vector3_q16> a, std::span<vector3<float>> out)
+{
+    assert(out.size() >= a.size());
+    VECTOR_CODEC_DISPATCH(dequantize(q, a.data(), out.data(), a.size()))
+}
+
+#undef VECTOR_CODEC_DISPATCH
+
+#endif
@@ -0,0 +1,159 @@
+// Batch codec kernels shared by the SIMD backends. This file is included once per
+// instruction set from vector_codec.hpp, inside a namespace that defines vf and vi
+// (GCC/clang vector extension types of floats and ints of the register width) and
+// sqrt(vf), so it intentionally has no include guard.
+//
+// Each kernel walks the input in blocks: the AoS data is split into component
+// arrays, the lanes go through the same operations, in the same order, as the
+// scalar lane kernels in vector_codec_detail, and the results are converted and
+// interleaved back. So every backend returns the same bits as encode and decode.
+
+constexpr std::size_t width = sizeof(vf) / sizeof(float);
+constexpr std::size_t block = 256;      // Elements per block, a multiple of every width
+
+inline vf   splat(float a)                  { return vf{} + a; }
+inline vf   select(vi m, vf a, vf b)        { return vf(((vi)a & m) | ((vi)b & ~m)); }     // a where m is set, else b
+inline vf   absf(vf a)                      { return select(a < splat(0.0f), -a, a); }
+inline vf   signf(vf a)                     { return select(a < splat(0.0f), splat(-1.0f), splat(1.0f)); }
+inline vf   clampf(vf a, float lo, float hi) { return select(a < splat(lo), splat(lo), select(a > splat(hi), splat(hi), a)); }
+inline vf   load(const float* p)            { vf a; std::memcpy(&a, p, sizeof(a)); return a; }
+inline void store(float* p, vf a)           { std::memcpy(p, &a, sizeof(a)); }
+inline vi   loadi(const int* p)             { vi a; std::memcpy(&a, p, sizeof(a)); return a; }
+inline void storei(int* p, vi a)            { std::memcpy(p, &a, sizeof(a)); }
+
+template <typename I>
+void oct_encode(const vector3<float>* __restrict a, vector_oct<I>* __restrict out, std::size_t n)
+{
+    alignas(64) float x[block], y[block], z[block];
+    alignas(64) int u[block], v[block];
+    const vf scale = splat(vector_oct<I>::scale);
+
+    for (std::size_t i = 0; i < n; i += block)
+    {
+        const std::size_t m = n - i < block ? n - i : block;
+        const std::size_t mw = (m + width - 1) / width * width;
+        for (std::size_t k = 0; k < m; ++k)
+        {
+            x[k] = a[i + k].x; y[k] = a[i + k].y; z[k] = a[i + k].z;
+        }
+        for (std::size_t k = m; k < mw; ++k)
+            x[k] = y[k] = z[k] = 0.0f;
+
+        for (std::size_t k = 0; k < mw; k += width)
+        {
+            const vf px0 = load(x + k), py0 = load(y + k), pz0 = load(z + k);
+            const vf s = absf(px0) + absf(py0) + absf(pz0);
+            const vf r = splat(1.0f) / select(s > splat(0.0f), s, splat(1.0f));
+            const vf px = px0 * r;
+            const vf py = py0 * r;
+            const vf fx = (splat(1.0f) - absf(py)) * signf(px);
+            const vf fy = (splat(1.0f) - absf(px)) * signf(py);
+            const vi lower = pz0 < splat(0.0f);
+            const vf su = clampf(select(lower, fx, px), -1.0f, 1.0f) * scale;
+            const vf sv = clampf(select(lower, fy, py), -1.0f, 1.0f) * scale;
+            storei(u + k, __builtin_convertvector(su + select(su < splat(0.0f), splat(-0.5f), splat(0.5f)), vi));
+            storei(v + k, __builtin_convertvector(sv + select(sv < splat(0.0f), splat(-0.5f), splat(0.5f)), vi));
+        }
+
+        for (std::size_t k = 0; k < m; ++k)
+            out[i + k] = vector_oct<I>{ I(u[k]), I(v[k]) };
+    }
+}
+
+template <typename I>
+void oct_decode(const vector_oct<I>* __restrict a, vector3<float>* __restrict out, std::size_t n)
+{
+    alignas(64) float x[block], y[block], z[block];
+    alignas(64) int u[block], v[block];
+    const vf inv_scale = splat(1.0f / vector_oct<I>::scale);
+
+    for (std::size_t i = 0; i < n; i += block)
+    {
+        const std::size_t m = n - i < block ? n - i : block;
+        const std::size_t mw = (m + width - 1) / width * width;
+        for (std::size_t k = 0; k < m; ++k)
+        {
+            u[k] = a[i + k].u; v[k] = a[i + k].v;
+        }
+        for (std::size_t k = m; k < mw; ++k)
+            u[k] = v[k] = 0;
+
+        for (std::size_t k = 0; k < mw; k += width)
+        {
+            vf px = __builtin_convertvector(loadi(u + k), vf) * inv_scale;
+            vf py = __builtin_convertvector(loadi(v + k), vf) * inv_scale;
+            const vf pz = splat(1.0f) - absf(px) - absf(py);
+            const vf t = select(pz < splat(0.0f), -pz, splat(0.0f));
+            px += select(px < splat(0.0f), t, -t);
+            py += select(py < splat(0.0f), t, -t);
+            const vf l = splat(1.0f) / sqrt(px * px + py * py + pz * pz);
+            store(x + k, px * l);
+            store(y + k, py * l);
+            store(z + k, pz * l);
+        }
+
+        for (std::size_t k = 0; k < m; ++k)
+            out[i + k] = vector3<float>(x[k], y[k], z[k]);
+    }
+}
+
+inline vi quantize_lane(vf c, float lo, float hi, float inv_step)
+{
+    return __builtin_convertvector(clampf((clampf(c, lo, hi) - splat(lo)) * splat(inv_step), 0.0f, 65535.0f) + splat(0.5f), vi);
+}
+
+inline void quantize(const vector3_quantizer& q, const vector3<float>* __restrict a, vector3_q16* __restrict out, std::size_t n)
+{
+    alignas(64) float x[block], y[block], z[block];
+    alignas(64) int qx[block], qy[block], qz[block];
+
+    for (std::size_t i = 0; i < n; i += block)
+    {
+        const std::size_t m = n - i < block ? n - i : block;
+        const std::size_t mw = (m + width - 1) / width * width;
+        for (std::size_t k = 0; k < m; ++k)
+        {
+            x[k] = a[i + k].x; y[k] = a[i + k].y; z[k] = a[i + k].z;
+        }
+        for (std::size_t k = m; k < mw; ++k)
+            x[k] = y[k] = z[k] = 0.0f;
+
+        for (std::size_t k = 0; k < mw; k += width)
+        {
+            storei(qx + k, quantize_lane(load(x + k), q.lo.x, q.hi.x, q.inv_step.x));
+            storei(qy + k, quantize_lane(load(y + k), q.lo.y, q.hi.y, q.inv_step.y));
+            storei(qz + k, quantize_lane(load(z + k), q.lo.z, q.hi.z, q.inv_step.z));
+        }
+
+        for (std::size_t k = 0; k < m; ++k)
+            out[i + k] = vector3_q16{ std::uint16_t(qx[k]), std::uint16_t(qy[k]), std::uint16_t(qz[k]) };
+    }
+}
+
+inline void dequantize(const vector3_quantizer& q, const vector3_q16* __restrict a, vector3<float>* __restrict out, std::size_t n)
+{
+    alignas(64) int qx[block], qy[block], qz[block];
+    alignas(64) float x[block], y[block], z[block];
+
+    for (std::size_t i = 0; i < n; i += block)
+    {
+        const std::size_t m = n - i < block ? n - i : block;
+        const std::size_t mw = (m + width - 1) / width * width;
+        for (std::size_t k = 0; k < m; ++k)
+        {
+            qx[k] = a[i + k].x; qy[k] = a[i + k].y; qz[k] = a[i + k].z;
+        }
+        for (std::size_t k = m; k < mw; ++k)
+            qx[k] = qy[k] = qz[k] = 0;
+
+        for (std::size_t k = 0; k < mw; k += width)
+        {
+            store(x + k, splat(q.lo.x) + __builtin_convertvector(loadi(qx + k), vf) * splat(q.step.x));
+            store(y + k, splat(q.lo.y) + __builtin_convertvector(loadi(qy + k), vf) * splat(q.step.y));
+            store(z + k, splat(q.lo.z) + __builtin_convertvector(loadi(qz + k), vf) * splat(q.step.z));
+        }
+
+        for (std::size_t k = 0; k < m; ++k)
+            out[i + k] = vector3<float>(x[k], y[k], z[k]);
+    }
+}
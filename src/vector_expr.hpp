@@ -0,0 +1,351 @@
+#ifndef VECTOR_EXPR_H
+#define VECTOR_EXPR_H
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+#include "vector.hpp"
+#include "vector_soa.hpp"
+
+// Optional expression templates for whole-array vector arithmetic.
+//
+// lazy() wraps a container (vector2_soa, vector3_soa, or any contiguous range of
+// vectors or scalars) in a lightweight view. Arithmetic on views builds an expression
+// tree instead of computing anything; assign() and the compound operators then
+// evaluate the whole tree element by element in a single pass, without intermediate
+// buffers:
+//
+//     pos += lazy(vel) * dt;
+//     assign(out, lazy(a) + lazy(b) * s - lazy(c) / lazy(d));
+//     assign(std::span<float>(len), length(lazy(a) - lazy(b)));
+//     assign(std::span<vector2<float>>(ground), swizzle<0, 2>(lazy(points)));
+//     assign(std::span<float>(h), lazy(components<1>(points)) - floor);
+//
+// Views and nodes hold pointers and scalars by value, so an expression may be kept
+// in a variable while the containers it refers to are alive and not resized. The
+// output may be one of the inputs: every element is read before it is written.
+// Element values are computed with the vector<N, T> operators, so they match the
+// eager code bit for bit.
+
+// Evaluation loops only ever depend on the same element, so the vectorizer may skip
+// the alias checks between the output and the views. The output pointers are not
+// __restrict, as they may be the very streams the views read.
+#if defined(__clang__)
+#define VECTOR_EXPR_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define VECTOR_EXPR_IVDEP _Pragma("GCC ivdep")
+#elif defined(_MSC_VER)
+#define VECTOR_EXPR_IVDEP __pragma(loop(ivdep))
+#else
+#define VECTOR_EXPR_IVDEP
+#endif
+
+struct vector_expr_base {};
+
+template <typename E>
+concept vector_expression = std::is_base_of_v<vector_expr_base, E>;
+
+template <typename L, typename R>
+concept vector_operands = (vector_expression<L> && vector_expression<R>) ||
+                          (vector_expression<L> && std::is_arithmetic_v<R>) ||
+                          (std::is_arithmetic_v<L> && vector_expression<R>);
+
+/* Terminals */
+
+template <std::size_t N, typename T>
+struct vector_soa_view : vector_expr_base       // One stream per component
+{
+    using value_type = vector<N, T>;
+
+    const T*    stream[N];
+    std::size_t count;
+
+    std::size_t size() const { return count; }
+    value_type  operator[](std::size_t i) const
+    {
+        return value_type(vector_detail::generate<N, T>([&](auto c) { return stream[c][i]; }));
+    }
+};
+
+template <typename V>
+struct vector_array_view : vector_expr_base     // Contiguous vectors or scalars
+{
+    using value_type = V;
+
+    const V*    data;
+    std::size_t count;
+
+    std::size_t size() const { return count; }
+    value_type  operator[](std::size_t i) const { return data[i]; }
+};
+
+template <typename T>
+struct vector_stride_view : vector_expr_base    // One component of each vector, from components()
+{
+    using value_type = T;
+
+    const T*    data;
+    std::size_t stride;
+    std::size_t count;
+
+    std::size_t size() const { return count; }
+    value_type  operator[](std::size_t i) const { return data[i * stride]; }
+};
+
+/* Nodes */
+
+template <typename A>
+constexpr decltype(auto) vector_expr_at(const A& a, std::size_t i)     // Scalars broadcast to every element
+{
+    if constexpr (vector_expression<A>)
+        return a[i];
+    else
+        return a;
+}
+
+template <typename Op, typename E>
+struct vector_unary_expr : vector_expr_base
+{
+    using value_type = std::remove_cvref_t<decltype(Op{}(std::declval<typename E::value_type>()))>;
+
+    E e;
+
+    std::size_t size() const { return e.size(); }
+    value_type  operator[](std::size_t i) const { return Op{}(e[i]); }
+};
+
+template <typename Op, typename L, typename R>
+struct vector_binary_expr : vector_expr_base
+{
+    using value_type = std::remove_cvref_t<decltype(Op{}(vector_expr_at(std::declval<L>(), 0),
+                                                         vector_expr_at(std::declval<R>(), 0)))>;
+
+    L l;
+    R r;
+
+    std::size_t size() const
+    {
+        if constexpr (vector_expression<L> && vector_expression<R>)
+        {
+            assert(l.size() == r.size());
+            return l.size();
+        }
+        else if constexpr (vector_expression<L>)
+            return l.size();
+        else
+            return r.size();
+    }
+    value_type operator[](std::size_t i) const { return Op{}(vector_expr_at(l, i), vector_expr_at(r, i)); }
+};
+
+/* Element operations not covered by <functional> */
+
+struct vector_dot_op
+{
+    template <typename V> constexpr auto operator()(const V& a, const V& b) const { return ::dot(a, b); }
+};
+
+struct vector_cross_op
+{
+    template <typename V> constexpr auto operator()(const V& a, const V& b) const { return ::cross(a, b); }
+};
+
+struct vector_distance_op
+{
+    template <typename V> constexpr auto operator()(const V& a, const V& b) const { return ::distance(a, b); }
+};
+
+struct vector_lengthsqr_op
+{
+    template <typename V> constexpr auto operator()(const V& a) const { return a.lengthsqr(); }
+};
+
+struct vector_length_op
+{
+    template <typename V> constexpr auto operator()(const V& a) const { return a.length(); }
+};
+
+struct vector_normalize_op
+{
+    template <typename V> constexpr auto operator()(const V& a) const { return a.normalize(); }
+};
+
+template <std::size_t... I>
+struct vector_swizzle_op
+{
+    template <typename V> constexpr auto operator()(const V& a) const { return a.template swizzle<I...>(); }
+};
+
+/* Views */
+
+template <typename T>
+inline vector_soa_view<2, T> lazy(const vector2_soa<T>& v)
+{
+    return vector_soa_view<2, T>{ {}, { v.x_ptr(), v.y_ptr() }, v.size() };
+}
+
+template <typename T>
+inline vector_soa_view<3, T> lazy(const vector3_soa<T>& v)
+{
+    return vector_soa_view<3, T>{ {}, { v.x_ptr(), v.y_ptr(), v.z_ptr() }, v.size() };
+}
+
+template <std::ranges::contiguous_range R>
+inline auto lazy(const R& r)        // std::vector, std::span, std::array ... of vectors or scalars
+{
+    using V = std::ranges::range_value_t<R>;
+    return vector_array_view<V>{ {}, std::ranges::data(r), std::size_t(std::ranges::size(r)) };
+}
+
+template <typename T>
+inline vector_stride_view<std::remove_cv_t<T>> lazy(const vector_component_view<T>& v)
+{
+    return vector_stride_view<std::remove_cv_t<T>>{ {}, v.data, v.stride, v.count };
+}
+
+/* Expression operators */
+
+template <typename E> requires vector_expression<E>
+constexpr auto operator-(const E& e)
+{
+    return vector_unary_expr<std::negate<>, E>{ {}, e };
+}
+
+template <typename L, typename R> requires vector_operands<L, R>
+constexpr auto operator+(const L& l, const R& r)
+{
+    return vector_binary_expr<std::plus<>, L, R>{ {}, l, r };
+}
+
+template <typename L, typename R> requires vector_operands<L, R>
+constexpr auto operator-(const L& l, const R& r)
+{
+    return vector_binary_expr<std::minus<>, L, R>{ {}, l, r };
+}
+
+template <typename L, typename R> requires vector_operands<L, R>
+constexpr auto operator*(const L& l, const R& r)      // Element wise, or by a scalar
+{
+    return vector_binary_expr<std::multiplies<>, L, R>{ {}, l, r };
+}
+
+template <typename L, typename R> requires vector_operands<L, R>
+constexpr auto operator/(const L& l, const R& r)      // Element wise, or by a scalar
+{
+    return vector_binary_expr<std::divides<>, L, R>{ {}, l, r };
+}
+
+template <typename L, typename R> requires vector_expression<L> && vector_expression<R>
+constexpr auto dot(const L& l, const R& r)
+{
+    return vector_binary_expr<vector_dot_op, L, R>{ {}, l, r };
+}
+
+template <typename L, typename R> requires vector_expression<L> && vector_expression<R>
+constexpr auto cross(const L& l, const R& r)
+{
+    return vector_binary_expr<vector_cross_op, L, R>{ {}, l, r };
+}
+
+template <typename L, typename R> requires vector_expression<L> && vector_expression<R>
+constexpr auto distance(const L& l, const R& r)
+{
+    return vector_binary_expr<vector_distance_op, L, R>{ {}, l, r };
+}
+
+template <typename E> requires vector_expression<E>
+constexpr auto lengthsqr(const E& e)
+{
+    return vector_unary_expr<vector_lengthsqr_op, E>{ {}, e };
+}
+
+template <typename E> requires vector_expression<E>
+constexpr auto length(const E& e)
+{
+    return vector_unary_expr<vector_length_op, E>{ {}, e };
+}
+
+template <typename E> requires vector_expression<E>
+constexpr auto normalize(const E& e)
+{
+    return vector_unary_expr<vector_normalize_op, E>{ {}, e };
+}
+
+template <std::size_t... I, typename E> requires vector_expression<E>
+constexpr auto swizzle(const E& e)      // e[i].swizzle<I...>() for every element
+{
+    return vector_unary_expr<vector_swizzle_op<I...>, E>{ {}, e };
+}
+
+/* Evaluation, one pass over the elements */
+
+template <typename T, typename E> requires vector_expression<E>
+inline void assign(vector2_soa<T>& out, const E& e)
+{
+    static_assert(std::is_same_v<typename E::value_type, vector2<T>>, "expression does not produce vector2<T>");
+    const E ex = e;                     // Local copy so the view pointers stay in registers
+    const std::size_t n = ex.size();
+    out.resize(n);
+    T* x = out.x_ptr(); T* y = out.y_ptr();
+    VECTOR_EXPR_IVDEP
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const vector2<T> v = ex[i];
+        x[i] = v.x; y[i] = v.y;
+    }
+}
+
+template <typename T, typename E> requires vector_expression<E>
+inline void assign(vector3_soa<T>& out, const E& e)
+{
+    static_assert(std::is_same_v<typename E::value_type, vector3<T>>, "expression does not produce vector3<T>");
+    const E ex = e;                     // Local copy so the view pointers stay in registers
+    const std::size_t n = ex.size();
+    out.resize(n);
+    T* x = out.x_ptr(); T* y = out.y_ptr(); T* z = out.z_ptr();
+    VECTOR_EXPR_IVDEP
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const vector3<T> v = ex[i];
+        x[i] = v.x; y[i] = v.y; z[i] = v.z;
+    }
+}
+
+template <typename V, typename E> requires vector_expression<E>
+inline void assign(std::span<V> out, const E& e)      // AoS vectors, or scalars from dot/length/...
+{
+    static_assert(std::is_same_v<typename E::value_type, std::remove_cv_t<V>>, "expression does not produce the span element type");
+    const E ex = e;
+    const std::size_t n = out.size();
+    assert(n == ex.size());
+    V* o = out.data();
+    VECTOR_EXPR_IVDEP
+    for (std::size_t i = 0; i < n; ++i)
+        o[i] = ex[i];
+}
+
+/* Compound arithmetic operators, fused with the expression */
+
+template <typename T, typename E> requires vector_expression<E>
+inline vector2_soa<T>& operator+=(vector2_soa<T>& out, const E& e) { assign(out, lazy(out) + e); return out; }
+
+template <typename T, typename E> requires vector_expression<E>
+inline vector2_soa<T>& operator-=(vector2_soa<T>& out, const E& e) { assign(out, lazy(out) - e); return out; }
+
+template <typename T, typename E> requires vector_expression<E>
+inline vector2_soa<T>& operator*=(vector2_soa<T>& out, const E& e) { assign(out, lazy(out) * e); return out; }
+
+template <typename T, typename E> requires vector_expression<E>
+inline vector3_soa<T>& operator+=(vector3_soa<T>& out, const E& e) { assign(out, lazy(out) + e); return out; }
+
+template <typename T, typename E> requires vector_expression<E>
+inline vector3_soa<T>& operator-=(vector3_soa<T>& out, const E& e) { assign(out, lazy(out) - e); return out; }
+
+template <typename T, typename E> requires vector_expression<E>
+inline vector3_soa<T>& operator*=(vector3_soa<T>& out, const E& e) { assign(out, lazy(out) * e); return out; }
+
+#endif
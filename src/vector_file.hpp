@@ -0,0 +1,526 @@
+#ifndef VECTOR_FILE_H
+#define VECTOR_FILE_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "vector.hpp"
+#include "vector_soa.hpp"
+
+// Binary files of vector arrays.
+//
+// A file is a 64 byte header followed by the data, little endian throughout:
+//
+//     AoS   count packed vector<N, T>, exactly the in-memory array
+//     SoA   N component streams of count scalars, each padded with zeros to a
+//           multiple of 64 bytes (header.stream_bytes)
+//
+// The data starts at offset 64, so a mapped file hands out aligned spans straight
+// from the page cache. The optional checksum covers every data byte, padding
+// included. vector_file_writer streams AoS arrays of unknown length; when the stream
+// cannot seek back to patch the header, the file stays valid without a checksum and
+// the reader takes the count from the file size. vector_file_reader maps a file
+// read only and checks the header and the size; verify() reads everything and checks
+// the checksum, on request only since it touches every page.
+//
+// Errors (I/O failures, malformed files, asking for the wrong type) throw
+// std::system_error or std::runtime_error.
+
+static_assert(std::endian::native == std::endian::little, "vector files are mapped in host byte order");
+
+constexpr char          vector_file_magic[4] = { 'V', 'E', 'C', 'B' };
+constexpr std::uint16_t vector_file_version = 1;
+constexpr std::size_t   vector_file_alignment = 64;                 // Header size and stream padding
+constexpr std::uint64_t vector_file_unknown_count = ~std::uint64_t(0);
+
+enum class vector_file_scalar : std::uint8_t { f32 = 1, f64 = 2 };
+enum class vector_file_layout : std::uint8_t { aos = 1, soa = 2 };
+
+constexpr std::uint8_t vector_file_has_checksum = 1;    // header.flags
+
+struct vector_file_header
+{
+    char               magic[4];
+    std::uint16_t      version;
+    std::uint16_t      header_bytes;        // Offset of the data
+    vector_file_scalar scalar;
+    std::uint8_t       dimension;
+    vector_file_layout layout;
+    std::uint8_t       flags;
+    std::uint32_t      reserved0;
+    std::uint64_t      count;               // vector_file_unknown_count: derive from the file size (AoS only)
+    std::uint64_t      stream_bytes;        // SoA bytes per component stream, 0 for AoS
+    std::uint64_t      checksum;
+    std::uint64_t      reserved1[3];
+};
+
+static_assert(sizeof(vector_file_header) == vector_file_alignment, "vector_file_header must stay 64 bytes");
+static_assert(std::is_trivially_copyable_v<vector_file_header> && std::is_standard_layout_v<vector_file_header>);
+
+template <typename T>
+constexpr vector_file_scalar vector_file_scalar_of()
+{
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "vector files store float or double");
+    return std::is_same_v<T, float> ? vector_file_scalar::f32 : vector_file_scalar::f64;
+}
+
+constexpr std::size_t vector_file_scalar_size(vector_file_scalar s)
+{
+    return s == vector_file_scalar::f32 ? 4 : s == vector_file_scalar::f64 ? 8 : 0;
+}
+
+/* Checksum, Fletcher style running sums over little endian 64-bit words */
+
+struct vector_file_checksum
+{
+    std::uint64_t a = 0;
+    std::uint64_t b = 0;
+    unsigned char tail[8] = {};
+    std::size_t   ntail = 0;        // Bytes waiting in tail for a full word
+
+    void          update(const void* data, std::size_t bytes);
+    std::uint64_t value() const;    // Pending bytes count as a zero padded word
+};
+
+inline void vector_file_checksum::update(const void* data, std::size_t bytes)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    if (ntail)
+    {
+        const std::size_t k = bytes < 8 - ntail ? bytes : 8 - ntail;
+        std::memcpy(tail + ntail, p, k);
+        ntail += k;
+        p += k;
+        bytes -= k;
+        if (ntail < 8)
+            return;
+        std::uint64_t w;
+        std::memcpy(&w, tail, 8);
+        a += w;
+        b += a;
+        ntail = 0;
+    }
+
+    std::uint64_t sa = a, sb = b;
+    for (; bytes >= 8; p += 8, bytes -= 8)
+    {
+        std::uint64_t w;
+        std::memcpy(&w, p, 8);
+        sa += w;
+        sb += sa;
+    }
+    a = sa;
+    b = sb;
+
+    std::memcpy(tail, p, bytes);
+    ntail = bytes;
+}
+
+inline std::uint64_t vector_file_checksum::value() const
+{
+    std::uint64_t sa = a, sb = b;
+    if (ntail)
+    {
+        std::uint64_t w = 0;
+        std::memcpy(&w, tail, ntail);
+        sa += w;
+        sb += sa;
+    }
+    return sa ^ std::rotl(sb, 32);
+}
+
+/* Writers */
+
+inline void vector_file_put(std::ostream& out, const void* data, std::size_t bytes)
+{
+    out.write(static_cast<const char*>(data), std::streamsize(bytes));
+    if (!out)
+        throw std::runtime_error("vector file: write failed");
+}
+
+template <std::size_t N, typename T>
+inline vector_file_header vector_file_make_header(vector_file_layout layout, std::uint64_t count, std::uint64_t stream_bytes)
+{
+    vector_file_header h = {};
+    std::memcpy(h.magic, vector_file_magic, 4);
+    h.version = vector_file_version;
+    h.header_bytes = sizeof(vector_file_header);
+    h.scalar = vector_file_scalar_of<T>();
+    h.dimension = std::uint8_t(N);
+    h.layout = layout;
+    h.count = count;
+    h.stream_bytes = stream_bytes;
+    return h;
+}
+
+template <std::size_t N, typename T>
+struct vector_file_writer       // Streams an AoS file, vectors may arrive in any number of pieces
+{
+    explicit vector_file_writer(std::ostream& out, bool checksum = true);
+    ~vector_file_writer();      // Calls finish(), swallowing errors; call it yourself to see them
+
+    vector_file_writer(const vector_file_writer&) = delete;
+    vector_file_writer& operator=(const vector_file_writer&) = delete;
+
+    void write(std::span<const vector<N, T>> v);
+    void write(const vector<N, T>& v);
+    void finish();              // Patches count and checksum into the header if the stream can seek
+
+    std::uint64_t size() const;
+
+    std::ostream&          out;
+    std::ostream::pos_type start;
+    vector_file_checksum   sum;
+    std::uint64_t          count;
+    bool                   checksum;
+    bool                   finished;
+};
+
+template <std::size_t N, typename T>
+inline vector_file_writer<N, T>::vector_file_writer(std::ostream& o, bool c)
+    : out(o), start(o.tellp()), count(0), checksum(c), finished(false)
+{
+    const vector_file_header h = vector_file_make_header<N, T>(vector_file_layout::aos, vector_file_unknown_count, 0);
+    vector_file_put(out, &h, sizeof(h));
+}
+
+template <std::size_t N, typename T>
+inline vector_file_writer<N, T>::~vector_file_writer()
+{
+    try
+    {
+        finish();
+    }
+    catch (...)
+    {
+    }
+}
+
+template <std::size_t N, typename T>
+inline void vector_file_writer<N, T>::write(std::span<const vector<N, T>> v)
+{
+    if (v.empty())
+        return;
+    vector_file_put(out, v.data(), v.size_bytes());
+    if (checksum)
+        sum.update(v.data(), v.size_bytes());
+    count += v.size();
+}
+
+template <std::size_t N, typename T>
+inline void vector_file_writer<N, T>::write(const vector<N, T>& v)
+{
+    write(std::span<const vector<N, T>>(&v, 1));
+}
+
+template <std::size_t N, typename T>
+inline void vector_file_writer<N, T>::finish()
+{
+    if (finished)
+        return;
+    finished = true;
+    out.flush();
+    if (start == std::ostream::pos_type(-1))
+        return;         // Not seekable: count from the file size, no checksum
+
+    vector_file_header h = vector_file_make_header<N, T>(vector_file_layout::aos, count, 0);
+    if (checksum)
+    {
+        h.flags |= vector_file_has_checksum;
+        h.checksum = sum.value();
+    }
+    const std::ostream::pos_type end = out.tellp();
+    out.seekp(start);
+    if (!out)
+    {
+        out.clear();    // Seek refused, the header keeps its unknown count
+        return;
+    }
+    vector_file_put(out, &h, sizeof(h));
+    out.seekp(end);
+    out.flush();
+    if (!out)
+        throw std::runtime_error("vector file: write failed");
+}
+
+template <std::size_t N, typename T>
+inline std::uint64_t vector_file_writer<N, T>::size() const
+{
+    return count;
+}
+
+template <std::size_t N, typename T>
+inline void write_vector_file(std::ostream& out, std::span<const vector<N, T>> v, bool checksum = true)       // AoS in one go
+{
+    vector_file_writer<N, T> w(out, checksum);
+    w.write(v);
+    w.finish();
+}
+
+template <vector_range R>
+inline void write_vector_file(std::ostream& out, const R& v, bool checksum = true)       // std::vector, std::array ... of vectors
+{
+    using V = std::ranges::range_value_t<R>;
+    write_vector_file<V::dimension, typename V::value_type>(out, std::span<const V>(std::ranges::data(v), std::ranges::size(v)), checksum);
+}
+
+template <std::size_t N, typename T>
+inline void write_vector_file_soa(std::ostream& out, const T* const (&stream)[N], std::size_t count, bool checksum = true)
+{
+    static const unsigned char zero[vector_file_alignment] = {};
+    const std::size_t bytes = count * sizeof(T);
+    const std::size_t pad = (vector_file_alignment - bytes % vector_file_alignment) % vector_file_alignment;
+
+    vector_file_header h = vector_file_make_header<N, T>(vector_file_layout::soa, count, bytes + pad);
+    if (checksum)
+    {
+        vector_file_checksum sum;
+        for (std::size_t c = 0; c < N; ++c)
+        {
+            sum.update(stream[c], bytes);
+            sum.update(zero, pad);
+        }
+        h.flags |= vector_file_has_checksum;
+        h.checksum = sum.value();
+    }
+
+    vector_file_put(out, &h, sizeof(h));
+    for (std::size_t c = 0; c < N; ++c)
+    {
+        vector_file_put(out, stream[c], bytes);
+        vector_file_put(out, zero, pad);
+    }
+    out.flush();
+}
+
+template <typename T>
+inline void write_vector_file(std::ostream& out, const vector2_soa<T>& v, bool checksum = true)
+{
+    const T* const stream[2] = { v.x_ptr(), v.y_ptr() };
+    write_vector_file_soa<2, T>(out, stream, v.size(), checksum);
+}
+
+template <typename T>
+inline void write_vector_file(std::ostream& out, const vector3_soa<T>& v, bool checksum = true)
+{
+    const T* const stream[3] = { v.x_ptr(), v.y_ptr(), v.z_ptr() };
+    write_vector_file_soa<3, T>(out, stream, v.size(), checksum);
+}
+
+/* Memory mapped reader */
+
+struct vector_file_reader
+{
+    explicit vector_file_reader(const std::string& path);
+    ~vector_file_reader();
+
+    vector_file_reader(const vector_file_reader&) = delete;
+    vector_file_reader& operator=(const vector_file_reader&) = delete;
+
+    const vector_file_header& header() const;
+    std::size_t size() const;                   // Vectors in the file
+    bool        verify() const;                 // Recompute the checksum, true when the file has none
+
+    template <typename V>
+    std::span<const V> vectors() const;         // AoS data, e.g. vectors<vector3<float>>()
+
+    template <typename T>
+    std::span<const T> component(std::size_t c) const;     // SoA stream c
+
+    /* Internals */
+
+    void map(const std::string& path);
+    void unmap();
+    void check(bool ok, const char* what) const;
+
+    const unsigned char* base;
+    std::size_t          bytes;
+    vector_file_header   head;
+    std::uint64_t        count;
+#if defined(_WIN32)
+    HANDLE               mapping;
+#endif
+};
+
+inline vector_file_reader::vector_file_reader(const std::string& path) : base(nullptr), bytes(0), head{}, count(0)
+{
+    map(path);
+    try
+    {
+        check(bytes >= sizeof(vector_file_header), "truncated header");
+        std::memcpy(&head, base, sizeof(head));
+        check(std::memcmp(head.magic, vector_file_magic, 4) == 0, "not a vector file");
+        check(head.version == vector_file_version, "unsupported version");
+        check(head.header_bytes == sizeof(vector_file_header), "unsupported header size");
+        check(head.dimension >= 2 && head.dimension <= 4, "bad dimension");
+
+        const std::size_t scalar = vector_file_scalar_size(head.scalar);
+        check(scalar != 0, "bad scalar type");
+        const std::size_t data = bytes - sizeof(vector_file_header);
+        const std::size_t element = scalar * head.dimension;
+
+        if (head.layout == vector_file_layout::aos)
+        {
+            count = head.count == vector_file_unknown_count ? data / element : head.count;
+            check(count <= data / element, "truncated data");
+        }
+        else
+        {
+            check(head.layout == vector_file_layout::soa, "bad layout");
+            count = head.count;
+            check(head.stream_bytes % vector_file_alignment == 0 && count <= head.stream_bytes / scalar, "bad stream size");
+            check(head.stream_bytes <= data / head.dimension, "truncated data");
+        }
+    }
+    catch (...)
+    {
+        unmap();
+        throw;
+    }
+}
+
+inline vector_file_reader::~vector_file_reader()
+{
+    unmap();
+}
+
+inline void vector_file_reader::check(bool ok, const char* what) const
+{
+    if (!ok)
+        throw std::runtime_error(std::string("vector file: ") + what);
+}
+
+#if defined(_WIN32)
+
+inline void vector_file_reader::map(const std::string& path)
+{
+    mapping = nullptr;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::system_error(int(GetLastError()), std::system_category(), "vector file: open " + path);
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        const DWORD e = GetLastError();
+        CloseHandle(file);
+        throw std::system_error(int(e), std::system_category(), "vector file: size " + path);
+    }
+    bytes = std::size_t(size.QuadPart);
+    if (bytes)
+    {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping)
+            base = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    const DWORD e = GetLastError();
+    CloseHandle(file);
+    if (bytes && !base)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        throw std::system_error(int(e), std::system_category(), "vector file: map " + path);
+    }
+}
+
+inline void vector_file_reader::unmap()
+{
+    if (base)
+        UnmapViewOfFile(base);
+    if (mapping)
+        CloseHandle(mapping);
+    base = nullptr;
+    mapping = nullptr;
+}
+
+#else
+
+inline void vector_file_reader::map(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "vector file: open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        const int e = errno;
+        ::close(fd);
+        throw std::system_error(e, std::generic_category(), "vector file: stat " + path);
+    }
+    bytes = std::size_t(st.st_size);
+    void* p = bytes ? ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+    const int e = errno;
+    ::close(fd);
+    if (p == MAP_FAILED)
+        throw std::system_error(e, std::generic_category(), "vector file: mmap " + path);
+    base = static_cast<const unsigned char*>(p);
+}
+
+inline void vector_file_reader::unmap()
+{
+    if (base)
+        ::munmap(const_cast<unsigned char*>(base), bytes);
+    base = nullptr;
+}
+
+#endif
+
+inline const vector_file_header& vector_file_reader::header() const
+{
+    return head;
+}
+
+inline std::size_t vector_file_reader::size() const
+{
+    return std::size_t(count);
+}
+
+inline bool vector_file_reader::verify() const
+{
+    if (!(head.flags & vector_file_has_checksum))
+        return true;
+    vector_file_checksum sum;
+    sum.update(base + sizeof(vector_file_header), bytes - sizeof(vector_file_header));
+    return sum.value() == head.checksum;
+}
+
+template <typename V>
+inline std::span<const V> vector_file_reader::vectors() const
+{
+    using T = typename V::value_type;
+    static_assert(std::is_same_v<V, vector<V::dimension, T>>, "vectors<V>() expects a vector type");
+    check(head.layout == vector_file_layout::aos, "not an AoS file");
+    check(head.scalar == vector_file_scalar_of<T>() && head.dimension == V::dimension, "element type mismatch");
+    return std::span<const V>(reinterpret_cast<const V*>(base + sizeof(vector_file_header)), std::size_t(count));
+}
+
+template <typename T>
+inline std::span<const T> vector_file_reader::component(std::size_t c) const
+{
+    check(head.layout == vector_file_layout::soa, "not an SoA file");
+    check(head.scalar == vector_file_scalar_of<T>(), "scalar type mismatch");
+    check(c < head.dimension, "component out of range");
+    const unsigned char* p = base + sizeof(vector_file_header) + c * head.stream_bytes;
+    return std::span<const T>(reinterpret_cast<const T*>(p), std::size_t(count));
+}
+
+#endif
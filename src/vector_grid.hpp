@@ -0,0 +1,438 @@
+#ifndef VECTOR_GRID_H
+#define VECTOR_GRID_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "vector.hpp"
+#include "vector_thread_pool.hpp"
+
+// Uniform grid over vector2 or vector3 points, hashed into a power of two table, for
+// neighbour searches among points that all move every frame (particles, SPH), where
+// rebuilding a tree each frame would cost more than the searches.
+//
+// Points are kept in slots, one linked list of slots per hash bucket, and are named by
+// the id insert returns (or their index for assign). insert, move and remove are
+// O(1); rebuild is a stable counting sort of the slots by bucket that also drops
+// removed slots, after which every bucket is one contiguous run of positions that the
+// searches stream through. Until the next rebuild, an edit that changes a bucket
+// switches the searches to following the lists, which still works but chases
+// pointers around memory.
+//
+// Searches visit the 3^N cells around a point, so the radius must not exceed the cell
+// size, and compare lengthsqr against r * r. Cells that collide in the table share a
+// bucket; their points are skipped by the distance test, and a bucket reached twice
+// from the same point is visited once.
+
+constexpr std::uint32_t grid_none = 0xffffffff;
+constexpr std::size_t   grid_pair_block = 4096;     // Slots per block of the parallel pair search
+
+template <typename T>
+struct grid_pair
+{
+    std::uint32_t a;            // Ids, a is the one in the lower slot
+    std::uint32_t b;
+    T             distsqr;
+};
+
+template <std::size_t N, typename T>
+struct vector_grid
+{
+    static_assert(N == 2 || N == 3, "vector_grid supports vector2 or vector3");
+    static_assert(std::is_floating_point_v<T>, "vector_grid needs floating point positions");
+
+    explicit vector_grid(T cell_size);
+
+    void          clear();
+    void          assign(std::span<const vector<N, T>> points);       // Replaces the contents, point i gets id i, then rebuilds
+    std::uint32_t insert(const vector<N, T>& p);                     // Returns the new point's id, reusing removed ids
+    void          move(std::uint32_t id, const vector<N, T>& p);
+    void          remove(std::uint32_t id);
+    void          rebuild();                                         // Counting sort of the slots by bucket, resizes the table to the point count
+
+    std::size_t          size() const noexcept { return live; }
+    bool                 contains(std::uint32_t id) const noexcept { return id < slot_of.size() && slot_of[id] != grid_none; }
+    const vector<N, T>&  position(std::uint32_t id) const { assert(contains(id)); return pos[slot_of[id]]; }
+
+    /* Searches, r <= cell size */
+
+    template <typename F>
+    void for_each_neighbor(const vector<N, T>& q, T r, F&& f) const;   // f(id, distsqr) for every point within r of q, q's own point included
+
+    template <typename F>
+    void for_each_pair(T r, F&& f) const;                               // f(a, b, distsqr) once for every pair of distinct points within r
+
+    void pairs(T r, std::vector<grid_pair<T>>& out, vector_thread_pool* pool = nullptr) const;    // Appends the pairs of for_each_pair, in the same order with or without a pool
+
+    /* Internals */
+
+    std::uint32_t cell_of(T c) const;                                  // Cell coordinate of a component, as an int32 bit pattern
+    std::uint32_t bucket(const vector<N, T>& p) const;
+    std::size_t   neighbor_buckets(const vector<N, T>& p, std::array<std::uint32_t, 27>& b) const;     // Distinct buckets of the cells around p, sorted
+    void          link(std::uint32_t slot);
+    void          unlink(std::uint32_t slot);
+    void          resize_table(std::size_t points);
+
+    template <typename F>
+    void visit(std::uint32_t b, F&& f) const;                          // f(slot) for every slot of bucket b
+
+    template <typename F>
+    void candidates(std::uint32_t slot, F&& f) const;                  // f(slot, distsqr) for the higher slots in the buckets around a slot
+
+    T                          cell;
+    T                          inv_cell;
+    std::uint32_t              mask;            // Table size - 1
+    std::size_t                live;
+    bool                       clean;           // No bucket changed since the last rebuild
+    std::vector<std::uint32_t> head;            // First slot of each bucket
+    std::vector<std::uint32_t> start;           // Bucket b is slots [start[b], start[b + 1]) while clean
+    std::vector<vector<N, T>>  pos;             // Per slot
+    std::vector<std::uint32_t> ids;             // Per slot, grid_none once removed
+    std::vector<std::uint32_t> next;            // Per slot
+    std::vector<std::uint32_t> prev;            // Per slot
+    std::vector<std::uint32_t> buckets;         // Per slot
+    std::vector<std::uint32_t> slot_of;         // Per id, grid_none when the id is free
+    std::vector<std::uint32_t> free_ids;
+};
+
+template <typename T>
+using vector2_grid = vector_grid<2, T>;
+
+template <typename T>
+using vector3_grid = vector_grid<3, T>;
+
+template <std::size_t N, typename T>
+inline vector_grid<N, T>::vector_grid(T cell_size) : cell(cell_size), inv_cell(T(1) / cell_size), mask(0), live(0), clean(true)
+{
+    assert(cell_size > T(0));
+    resize_table(0);
+}
+
+/* Internals */
+
+template <std::size_t N, typename T>
+inline std::uint32_t vector_grid<N, T>::cell_of(T c) const
+{
+    // Cells beyond the int32 range clamp to its ends and NaN goes to the low end, as
+    // converting them would be undefined; such points just share the outermost cells
+    const T f = std::floor(c * inv_cell);
+    if (!(f >= T(-0x1p31) && f < T(0x1p31)))
+        return std::uint32_t(f > T(0) ? std::numeric_limits<std::int32_t>::max() : std::numeric_limits<std::int32_t>::min());
+    return std::uint32_t(std::int32_t(f));
+}
+
+template <std::size_t N, typename T>
+inline std::uint32_t vector_grid<N, T>::bucket(const vector<N, T>& p) const
+{
+    constexpr std::uint32_t prime[3] = { 73856093u, 19349663u, 83492791u };
+    std::uint32_t h = 0;
+    vector_detail::for_each<N>([&](auto c)
+    {
+        h ^= cell_of(get<c>(p)) * prime[c];
+    });
+    return h & mask;
+}
+
+template <std::size_t N, typename T>
+inline std::size_t vector_grid<N, T>::neighbor_buckets(const vector<N, T>& p, std::array<std::uint32_t, 27>& b) const
+{
+    constexpr std::uint32_t prime[3] = { 73856093u, 19349663u, 83492791u };
+    std::array<std::uint32_t, N> base;
+    vector_detail::for_each<N>([&](auto c)
+    {
+        base[c] = cell_of(get<c>(p));
+    });
+
+    std::size_t n = 0;
+    for (std::uint32_t dx = 0; dx < 3; ++dx)
+        for (std::uint32_t dy = 0; dy < 3; ++dy)
+            for (std::uint32_t dz = 0; dz < (N == 3 ? 3u : 1u); ++dz)
+            {
+                std::uint32_t h = (base[0] + dx - 1) * prime[0] ^ (base[1] + dy - 1) * prime[1];
+                if constexpr (N == 3)
+                    h ^= (base[2] + dz - 1) * prime[2];
+                b[n++] = h & mask;
+            }
+    std::sort(b.begin(), b.begin() + std::ptrdiff_t(n));
+    return std::size_t(std::unique(b.begin(), b.begin() + std::ptrdiff_t(n)) - b.begin());
+}
+
+template <std::size_t N, typename T>
+inline void vector_grid<N, T>::link(std::uint32_t s)
+{
+    const std::uint32_t b = buckets[s];
+    clean = false;
+    prev[s] = grid_none;
+    next[s] = head[b];
+    if (head[b] != grid_none)
+        prev[head[b]] = s;
+    head[b] = s;
+}
+
+template <std::size_t N, typename T>
+inline void vector_grid<N, T>::unlink(std::uint32_t s)
+{
+    clean = false;
+    if (prev[s] != grid_none)
+        next[prev[s]] = next[s];
+    else
+        head[buckets[s]] = next[s];
+    if (next[s] != grid_none)
+        prev[next[s]] = prev[s];
+}
+
+template <std::size_t N, typename T>
+inline void vector_grid<N, T>::resize_table(std::size_t points)
+{
+    const std::size_t size = std::bit_ceil(std::max<std::size_t>(2 * points, 64));
+    mask = std::uint32_t(size - 1);
+    head.assign(size, grid_none);
+    start.assign(size + 1, 0);
+    clean = true;
+}
+
+/* Editing */
+
+template <std::size_t N, typename T>
+inline void vector_grid<N, T>::clear()
+{
+    live = 0;
+    pos.clear();
+    ids.clear();
+    next.clear();
+    prev.clear();
+    buckets.clear();
+    slot_of.clear();
+    free_ids.clear();
+    resize_table(0);
+}
+
+template <std::size_t N, typename T>
+inline void vector_grid<N, T>::assign(std::span<const vector<N, T>> points)
+{
+    assert(points.size() < grid_none);
+    clear();
+    pos.assign(points.begin(), points.end());
+    ids.resize(points.size());
+    slot_of.resize(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+        ids[i] = slot_of[i] = std::uint32_t(i);
+    next.resize(points.size());
+    prev.resize(points.size());
+    buckets.resize(points.size());
+    live = points.size();
+    rebuild();
+}
+
+template <std::size_t N, typename T>
+inline std::uint32_t vector_grid<N, T>::insert(const vector<N, T>& p)
+{
+    std::uint32_t id;
+    if (!free_ids.empty())
+    {
+        id = free_ids.back();
+        free_ids.pop_back();
+    }
+    else
+    {
+        id = std::uint32_t(slot_of.size());
+        slot_of.push_back(grid_none);
+    }
+
+    const std::uint32_t s = std::uint32_t(pos.size());
+    assert(s < grid_none);
+    pos.push_back(p);
+    ids.push_back(id);
+    next.push_back(grid_none);
+    prev.push_back(grid_none);
+    buckets.push_back(bucket(p));
+    slot_of[id] = s;
+    link(s);
+    ++live;
+    return id;
+}
+
+template <std::size_t N, typename T>
+inline void vector_grid<N, T>::move(std::uint32_t id, const vector<N, T>& p)
+{
+    assert(contains(id));
+    const std::uint32_t s = slot_of[id];
+    pos[s] = p;
+    const std::uint32_t b = bucket(p);
+    if (b == buckets[s])
+        return;
+    unlink(s);
+    buckets[s] = b;
+    link(s);
+}
+
+template <std::size_t N, typename T>
+inline void vector_grid<N, T>::remove(std::uint32_t id)
+{
+    assert(contains(id));
+    const std::uint32_t s = slot_of[id];
+    unlink(s);
+    ids[s] = grid_none;         // The slot is reclaimed by the next rebuild
+    slot_of[id] = grid_none;
+    free_ids.push_back(id);
+    --live;
+}
+
+template <std::size_t N, typename T>
+inline void vector_grid<N, T>::rebuild()
+{
+    resize_table(live);
+    const std::size_t table = std::size_t(mask) + 1;
+    for (std::size_t s = 0; s < pos.size(); ++s)
+    {
+        if (ids[s] == grid_none)
+            continue;
+        buckets[s] = bucket(pos[s]);
+        ++start[buckets[s] + 1];
+    }
+    for (std::size_t b = 0; b < table; ++b)
+        start[b + 1] += start[b];
+
+    std::vector<vector<N, T>> p(live);
+    std::vector<std::uint32_t> id(live), bk(live);
+    for (std::size_t s = 0; s < pos.size(); ++s)
+    {
+        if (ids[s] == grid_none)
+            continue;
+        const std::uint32_t d = start[buckets[s]]++;
+        p[d] = pos[s];
+        id[d] = ids[s];
+        bk[d] = buckets[s];
+        slot_of[ids[s]] = d;
+    }
+    pos.swap(p);
+    ids.swap(id);
+    buckets.swap(bk);
+
+    next.resize(live);
+    prev.resize(live);
+    for (std::uint32_t s = 0; s < live; ++s)        // start[b] is now the end of bucket b
+    {
+        const std::uint32_t b = buckets[s];
+        const bool first = s == 0 || buckets[s - 1] != b;
+        if (first)
+            head[b] = s;
+        prev[s] = first ? grid_none : s - 1;
+        next[s] = s + 1 < start[b] ? s + 1 : grid_none;
+    }
+    for (std::size_t b = table; b > 0; --b)          // Back to starts
+        start[b] = start[b - 1];
+    start[0] = 0;
+}
+
+/* Searches */
+
+template <std::size_t N, typename T>
+template <typename F>
+inline void vector_grid<N, T>::visit(std::uint32_t b, F&& f) const
+{
+    if (clean)
+    {
+        for (std::uint32_t s = start[b]; s < start[b + 1]; ++s)
+            f(s);
+    }
+    else
+    {
+        for (std::uint32_t s = head[b]; s != grid_none; s = next[s])
+            f(s);
+    }
+}
+
+template <std::size_t N, typename T>
+template <typename F>
+inline void vector_grid<N, T>::for_each_neighbor(const vector<N, T>& q, T r, F&& f) const
+{
+    assert(r <= cell);
+    const T rr = r * r;
+    std::array<std::uint32_t, 27> b;
+    const std::size_t nb = neighbor_buckets(q, b);
+    for (std::size_t k = 0; k < nb; ++k)
+        visit(b[k], [&](std::uint32_t s)
+        {
+            const T d = (pos[s] - q).lengthsqr();
+            if (d <= rr)
+                f(ids[s], d);
+        });
+}
+
+template <std::size_t N, typename T>
+template <typename F>
+inline void vector_grid<N, T>::candidates(std::uint32_t a, F&& f) const
+{
+    std::array<std::uint32_t, 27> b;
+    const vector<N, T> p = pos[a];
+    const std::size_t nb = neighbor_buckets(p, b);
+    for (std::size_t k = 0; k < nb; ++k)
+        visit(b[k], [&](std::uint32_t s)
+        {
+            if (s > a)
+                f(s, (pos[s] - p).lengthsqr());
+        });
+}
+
+template <std::size_t N, typename T>
+template <typename F>
+inline void vector_grid<N, T>::for_each_pair(T r, F&& f) const
+{
+    assert(r <= cell);
+    const T rr = r * r;
+    for (std::uint32_t a = 0; a < pos.size(); ++a)
+        if (ids[a] != grid_none)
+            candidates(a, [&](std::uint32_t s, T d)
+            {
+                if (d <= rr)
+                    f(ids[a], ids[s], d);
+            });
+}
+
+template <std::size_t N, typename T>
+inline void vector_grid<N, T>::pairs(T r, std::vector<grid_pair<T>>& out, vector_thread_pool* pool) const
+{
+    assert(r <= cell);
+    const T rr = r * r;
+    const auto collect = [&](std::size_t first, std::size_t last, std::vector<grid_pair<T>>& o)
+    {
+        std::size_t n = o.size();
+        for (std::size_t a = first; a < last; ++a)
+            if (ids[a] != grid_none)
+                candidates(std::uint32_t(a), [&](std::uint32_t s, T d)
+                {
+                    if (n == o.size())
+                        o.resize(2 * n + 256);
+                    o[n] = grid_pair<T>{ ids[a], ids[s], d };
+                    n += d <= rr;       // Branch free, a branch on the distance test mispredicts often
+                });
+        o.resize(n);
+    };
+    if (!pool || pos.size() <= grid_pair_block)
+        return collect(0, pos.size(), out);
+
+    const std::size_t blocks = (pos.size() + grid_pair_block - 1) / grid_pair_block;
+    std::vector<std::vector<grid_pair<T>>> part(blocks);
+    pool->parallel_for(blocks, [&](std::size_t k)
+    {
+        collect(k * grid_pair_block, std::min(pos.size(), (k + 1) * grid_pair_block), part[k]);
+    });
+    std::size_t total = out.size();
+    for (const std::vector<grid_pair<T>>& p : part)
+        total += p.size();
+    out.reserve(total);
+    for (const std::vector<grid_pair<T>>& p : part)
+        out.insert(out.end(), p.begin(), p.end());
+}
+
+#endif
@@ -0,0 +1,635 @@
+#ifndef VECTOR_HALF_H
+#define VECTOR_HALF_H
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#include "vector3.hpp"
+#include "vector3_simd.hpp"
+
+// 16 bit storage scalars for large vector buffers, e.g. normals and velocities,
+// at half the memory bandwidth of float.
+//
+//     half       IEEE 754 binary16: 5 exponent bits, 11 significant bits, up to 65504
+//     bfloat16   the upper half of a float: 8 exponent bits, 8 significant bits
+//
+// Both convert implicitly to and from float, with round to nearest even, and all
+// arithmetic on them is done in float; they are storage types, not arithmetic types.
+// vector3<half> and vector3<bfloat16> get every vector operation that way, one
+// rounding per component at the end of each operation.
+//
+// batch_convert moves whole arrays between 16 bit and float vectors with F16C or
+// AVX-512 for half and integer vector code for bfloat16, following the vector3_simd
+// dispatch. Every backend returns the same bits as the scalar conversions, which are
+// constexpr. The mixed precision batch operations below convert blocks to float, run
+// the vector3<float> batch kernels on them and round the results once.
+
+struct half
+{
+    std::uint16_t bits;
+
+    half() = default;
+    constexpr half(float a) noexcept;
+    constexpr operator float() const noexcept;
+
+    static constexpr half from_bits(std::uint16_t b) noexcept;
+
+    constexpr half& operator+=(float a) noexcept { return *this = float(*this) + a; }
+    constexpr half& operator-=(float a) noexcept { return *this = float(*this) - a; }
+    constexpr half& operator*=(float a) noexcept { return *this = float(*this) * a; }
+    constexpr half& operator/=(float a) noexcept { return *this = float(*this) / a; }
+};
+
+struct bfloat16
+{
+    std::uint16_t bits;
+
+    bfloat16() = default;
+    constexpr bfloat16(float a) noexcept;
+    constexpr operator float() const noexcept;
+
+    static constexpr bfloat16 from_bits(std::uint16_t b) noexcept;
+
+    constexpr bfloat16& operator+=(float a) noexcept { return *this = float(*this) + a; }
+    constexpr bfloat16& operator-=(float a) noexcept { return *this = float(*this) - a; }
+    constexpr bfloat16& operator*=(float a) noexcept { return *this = float(*this) * a; }
+    constexpr bfloat16& operator/=(float a) noexcept { return *this = float(*this) / a; }
+};
+
+/* Layout guarantees relied on by the batch conversions */
+
+static_assert(sizeof(half) == 2 && sizeof(bfloat16) == 2, "16 bit scalars must be tightly packed");
+static_assert(std::is_trivially_copyable_v<vector3<half>> && std::is_standard_layout_v<vector3<half>>);
+static_assert(std::is_trivially_copyable_v<vector3<bfloat16>> && std::is_standard_layout_v<vector3<bfloat16>>);
+static_assert(sizeof(vector3<half>) == 3 * sizeof(half) && sizeof(vector3<bfloat16>) == 3 * sizeof(bfloat16));
+
+/* Scalar conversions */
+
+namespace vector_half_detail
+{
+
+constexpr float half_to_float(std::uint16_t h) noexcept
+{
+    const std::uint32_t sign = std::uint32_t(h & 0x8000) << 16;
+    const std::uint32_t exp = (h >> 10) & 0x1f;
+    const std::uint32_t mant = h & 0x3ff;
+    if (exp == 0x1f)                                        // Inf and NaN, NaNs come back quiet as with F16C
+        return std::bit_cast<float>(sign | 0x7f800000 | (mant << 13) | (mant ? 0x400000 : 0));
+    if (exp == 0)                                           // Zero and subnormals, exact in float
+    {
+        const float a = float(mant) * 0x1p-24f;
+        return sign ? -a : a;
+    }
+    return std::bit_cast<float>(sign | ((exp + 112) << 23) | (mant << 13));
+}
+
+constexpr std::uint16_t float_to_half(float f) noexcept
+{
+    const std::uint32_t u = std::bit_cast<std::uint32_t>(f);
+    const std::uint16_t sign = std::uint16_t((u >> 16) & 0x8000);
+    std::uint32_t a = u & 0x7fffffff;
+    if (a > 0x7f800000)                                     // NaN, quieted, payload truncated
+        return std::uint16_t(sign | 0x7e00 | ((a >> 13) & 0x3ff));
+    if (a >= 0x477ff000)                                    // Rounds to 65536 or more
+        return std::uint16_t(sign | 0x7c00);
+    if (a < 0x38800000)                                     // Below 2^-14, subnormal: let the float adder round at 2^-24
+        return std::uint16_t(sign | (std::bit_cast<std::uint32_t>(std::bit_cast<float>(a) + 0.5f) - 0x3f000000));
+    a += 0xc8000fff + ((a >> 13) & 1);                      // Rebias the exponent by -112 and round to nearest even
+    return std::uint16_t(sign | (a >> 13));
+}
+
+constexpr float bfloat16_to_float(std::uint16_t b) noexcept
+{
+    return std::bit_cast<float>(std::uint32_t(b) << 16);
+}
+
+constexpr std::uint16_t float_to_bfloat16(float f) noexcept
+{
+    const std::uint32_t u = std::bit_cast<std::uint32_t>(f);
+    if ((u & 0x7fffffff) > 0x7f800000)                      // NaN, quieted so truncation can not make it inf
+        return std::uint16_t((u >> 16) | 0x40);
+    return std::uint16_t((u + 0x7fff + ((u >> 16) & 1)) >> 16);
+}
+
+} // namespace vector_half_detail
+
+constexpr half::half(float a) noexcept : bits(vector_half_detail::float_to_half(a))
+{
+}
+
+constexpr half::operator float() const noexcept
+{
+    return vector_half_detail::half_to_float(bits);
+}
+
+constexpr half half::from_bits(std::uint16_t b) noexcept
+{
+    half h;
+    h.bits = b;
+    return h;
+}
+
+constexpr bfloat16::bfloat16(float a) noexcept : bits(vector_half_detail::float_to_bfloat16(a))
+{
+}
+
+constexpr bfloat16::operator float() const noexcept
+{
+    return vector_half_detail::bfloat16_to_float(bits);
+}
+
+constexpr bfloat16 bfloat16::from_bits(std::uint16_t b) noexcept
+{
+    bfloat16 h;
+    h.bits = b;
+    return h;
+}
+
+/* numeric_limits, used e.g. by normalize_safe */
+
+template <>
+class std::numeric_limits<half>
+{
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr bool has_signaling_NaN = true;
+    static constexpr std::float_denorm_style has_denorm = std::denorm_present;
+    static constexpr bool has_denorm_loss = false;
+    static constexpr bool is_iec559 = true;
+    static constexpr bool is_bounded = true;
+    static constexpr bool is_modulo = false;
+    static constexpr bool traps = false;
+    static constexpr bool tinyness_before = false;
+    static constexpr int  radix = 2;
+    static constexpr int  digits = 11;
+    static constexpr int  digits10 = 3;
+    static constexpr int  max_digits10 = 5;
+    static constexpr int  min_exponent = -13;
+    static constexpr int  max_exponent = 16;
+    static constexpr int  min_exponent10 = -4;
+    static constexpr int  max_exponent10 = 4;
+    static constexpr std::float_round_style round_style = std::round_to_nearest;
+
+    static constexpr half min() noexcept            { return half::from_bits(0x0400); }
+    static constexpr half max() noexcept            { return half::from_bits(0x7bff); }
+    static constexpr half lowest() noexcept         { return half::from_bits(0xfbff); }
+    static constexpr half epsilon() noexcept        { return half::from_bits(0x1400); }
+    static constexpr half round_error() noexcept    { return half::from_bits(0x3800); }
+    static constexpr half infinity() noexcept       { return half::from_bits(0x7c00); }
+    static constexpr half quiet_NaN() noexcept      { return half::from_bits(0x7e00); }
+    static constexpr half signaling_NaN() noexcept  { return half::from_bits(0x7d00); }
+    static constexpr half denorm_min() noexcept     { return half::from_bits(0x0001); }
+};
+
+template <>
+class std::numeric_limits<bfloat16>
+{
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr bool has_signaling_NaN = true;
+    static constexpr std::float_denorm_style has_denorm = std::denorm_present;
+    static constexpr bool has_denorm_loss = false;
+    static constexpr bool is_iec559 = false;
+    static constexpr bool is_bounded = true;
+    static constexpr bool is_modulo = false;
+    static constexpr bool traps = false;
+    static constexpr bool tinyness_before = false;
+    static constexpr int  radix = 2;
+    static constexpr int  digits = 8;
+    static constexpr int  digits10 = 2;
+    static constexpr int  max_digits10 = 4;
+    static constexpr int  min_exponent = -125;
+    static constexpr int  max_exponent = 128;
+    static constexpr int  min_exponent10 = -37;
+    static constexpr int  max_exponent10 = 38;
+    static constexpr std::float_round_style round_style = std::round_to_nearest;
+
+    static constexpr bfloat16 min() noexcept            { return bfloat16::from_bits(0x0080); }
+    static constexpr bfloat16 max() noexcept            { return bfloat16::from_bits(0x7f7f); }
+    static constexpr bfloat16 lowest() noexcept         { return bfloat16::from_bits(0xff7f); }
+    static constexpr bfloat16 epsilon() noexcept        { return bfloat16::from_bits(0x3c00); }
+    static constexpr bfloat16 round_error() noexcept    { return bfloat16::from_bits(0x3f00); }
+    static constexpr bfloat16 infinity() noexcept       { return bfloat16::from_bits(0x7f80); }
+    static constexpr bfloat16 quiet_NaN() noexcept      { return bfloat16::from_bits(0x7fc0); }
+    static constexpr bfloat16 signaling_NaN() noexcept  { return bfloat16::from_bits(0x7fa0); }
+    static constexpr bfloat16 denorm_min() noexcept     { return bfloat16::from_bits(0x0001); }
+};
+
+/* Scalar backend */
+
+namespace vector_half_scalar
+{
+
+inline void from_half(const half* a, float* out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = a[i];
+}
+
+inline void to_half(const float* a, half* out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = a[i];
+}
+
+inline void from_bfloat16(const bfloat16* a, float* out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = a[i];
+}
+
+inline void to_bfloat16(const float* a, bfloat16* out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = a[i];
+}
+
+}
+
+#if VECTOR3_SIMD_X86
+
+/* SSE4.1 backend, 4 lanes, bfloat16 only: F16C needs VEX encoding */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+
+namespace vector_half_sse41
+{
+
+constexpr std::size_t width = 4;
+
+#include "vector_half_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX2 + F16C backend, 8 lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,f16c"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,f16c")
+#endif
+
+namespace vector_half_avx2
+{
+
+constexpr std::size_t width = 8;
+
+inline void from_half_block(const half* a, float* out)
+{
+    _mm256_storeu_ps(out, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a))));
+}
+
+inline void to_half_block(const float* a, half* out)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_cvtps_ph(_mm256_loadu_ps(a), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+}
+
+#include "vector_half_kernels.hpp"
+
+inline void from_half(const half* a, float* out, std::size_t n)
+{
+    run<half, float, from_half_block>(a, out, n);
+}
+
+inline void to_half(const float* a, half* out, std::size_t n)
+{
+    run<float, half, to_half_block>(a, out, n);
+}
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX-512 backend, 16 lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"  // False positives inside GCC's own avx512fintrin.h
+#endif
+
+namespace vector_half_avx512
+{
+
+constexpr std::size_t width = 16;
+
+inline void from_half_block(const half* a, float* out)
+{
+    _mm512_storeu_ps(out, _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a))));
+}
+
+inline void to_half_block(const float* a, half* out)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm512_cvtps_ph(_mm512_loadu_ps(a), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+}
+
+#include "vector_half_kernels.hpp"
+
+inline void from_half(const half* a, float* out, std::size_t n)
+{
+    run<half, float, from_half_block>(a, out, n);
+}
+
+inline void to_half(const float* a, half* out, std::size_t n)
+{
+    run<float, half, to_half_block>(a, out, n);
+}
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+#endif // VECTOR3_SIMD_X86
+
+/* Dispatch on the active simd_level */
+
+namespace vector_half_detail
+{
+
+inline bool has_f16c()
+{
+#if VECTOR3_SIMD_X86
+    static const bool f16c = []
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("f16c") != 0;
+    }();
+    return f16c;
+#else
+    return false;
+#endif
+}
+
+inline void from_half(const half* a, float* out, std::size_t n)
+{
+#if VECTOR3_SIMD_X86
+    const simd_level level = active_simd_level();
+    if (level == simd_level::avx512)
+        return vector_half_avx512::from_half(a, out, n);
+    if (level == simd_level::avx2 && has_f16c())
+        return vector_half_avx2::from_half(a, out, n);
+#endif
+    vector_half_scalar::from_half(a, out, n);
+}
+
+inline void to_half(const float* a, half* out, std::size_t n)
+{
+#if VECTOR3_SIMD_X86
+    const simd_level level = active_simd_level();
+    if (level == simd_level::avx512)
+        return vector_half_avx512::to_half(a, out, n);
+    if (level == simd_level::avx2 && has_f16c())
+        return vector_half_avx2::to_half(a, out, n);
+#endif
+    vector_half_scalar::to_half(a, out, n);
+}
+
+inline void from_bfloat16(const bfloat16* a, float* out, std::size_t n)
+{
+#if VECTOR3_SIMD_X86
+    switch (active_simd_level())
+    {
+    case simd_level::avx512: return vector_half_avx512::from_bfloat16(a, out, n);
+    case simd_level::avx2:   return vector_half_avx2::from_bfloat16(a, out, n);
+    case simd_level::sse41:  return vector_half_sse41::from_bfloat16(a, out, n);
+    case simd_level::scalar: break;
+    }
+#endif
+    vector_half_scalar::from_bfloat16(a, out, n);
+}
+
+inline void to_bfloat16(const float* a, bfloat16* out, std::size_t n)
+{
+#if VECTOR3_SIMD_X86
+    switch (active_simd_level())
+    {
+    case simd_level::avx512: return vector_half_avx512::to_bfloat16(a, out, n);
+    case simd_level::avx2:   return vector_half_avx2::to_bfloat16(a, out, n);
+    case simd_level::sse41:  return vector_half_sse41::to_bfloat16(a, out, n);
+    case simd_level::scalar: break;
+    }
+#endif
+    vector_half_scalar::to_bfloat16(a, out, n);
+}
+
+inline void convert(const half* a, float* out, std::size_t n)     { from_half(a, out, n); }
+inline void convert(const float* a, half* out, std::size_t n)     { to_half(a, out, n); }
+inline void convert(const bfloat16* a, float* out, std::size_t n) { from_bfloat16(a, out, n); }
+inline void convert(const float* a, bfloat16* out, std::size_t n) { to_bfloat16(a, out, n); }
+
+constexpr std::size_t block = 256;      // vector3 per block of the mixed precision operations, 3 KiB of floats per operand
+
+// Runs op on blocks of float copies of a and b (b may be null) and rounds its vector
+// results into out; float results are written to out directly.
+template <typename S, typename O, typename F>
+void mixed(const vector3<S>* a, const vector3<S>* b, O* out, std::size_t n, F op)
+{
+    alignas(64) vector3<float> fa[block], fb[block];
+    for (std::size_t i = 0; i < n; i += block)
+    {
+        const std::size_t m = n - i < block ? n - i : block;
+        convert(&a[i].x, &fa[0].x, 3 * m);
+        if (b)
+            convert(&b[i].x, &fb[0].x, 3 * m);
+        if constexpr (std::is_same_v<O, float>)
+        {
+            op(fa, fb, out + i, m);
+        }
+        else
+        {
+            op(fa, fb, fa, m);
+            convert(&fa[0].x, &out[i].x, 3 * m);
+        }
+    }
+}
+
+} // namespace vector_half_detail
+
+/* Batch conversions. out must be at least as long as the input */
+
+inline void batch_convert(std::span<const half> a, std::span<float> out)
+{
+    assert(out.size() >= a.size());
+    vector_half_detail::from_half(a.data(), out.data(), a.size());
+}
+
+inline void batch_convert(std::span<const float> a, std::span<half> out)
+{
+    assert(out.size() >= a.size());
+    vector_half_detail::to_half(a.data(), out.data(), a.size());
+}
+
+inline void batch_convert(std::span<const bfloat16> a, std::span<float> out)
+{
+    assert(out.size() >= a.size());
+    vector_half_detail::from_bfloat16(a.data(), out.data(), a.size());
+}
+
+inline void batch_convert(std::span<const float> a, std::span<bfloat16> out)
+{
+    assert(out.size() >= a.size());
+    vector_half_detail::to_bfloat16(a.data(), out.data(), a.size());
+}
+
+inline void batch_convert(std::span<const vector3<half>> a, std::span<vector3<float>> out)
+{
+    assert(out.size() >= a.size());
+    vector_half_detail::from_half(&a.data()->x, &out.data()->x, 3 * a.size());
+}
+
+inline void batch_convert(std::span<const vector3<float>> a, std::span<vector3<half>> out)
+{
+    assert(out.size() >= a.size());
+    vector_half_detail::to_half(&a.data()->x, &out.data()->x, 3 * a.size());
+}
+
+inline void batch_convert(std::span<const vector3<bfloat16>> a, std::span<vector3<float>> out)
+{
+    assert(out.size() >= a.size());
+    vector_half_detail::from_bfloat16(&a.data()->x, &out.data()->x, 3 * a.size());
+}
+
+inline void batch_convert(std::span<const vector3<float>> a, std::span<vector3<bfloat16>> out)
+{
+    assert(out.size() >= a.size());
+    vector_half_detail::to_bfloat16(&a.data()->x, &out.data()->x, 3 * a.size());
+}
+
+/* Mixed precision batch operations, computed in float and rounded once. out must be as long as the inputs and may alias them exactly */
+
+namespace vector_half_detail
+{
+
+template <typename S>
+void add(std::span<const vector3<S>> a, std::span<const vector3<S>> b, std::span<vector3<S>> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    mixed(a.data(), b.data(), out.data(), a.size(), [](const vector3<float>* x, const vector3<float>* y, vector3<float>* r, std::size_t m)
+    {
+        active_kernels(0.0f).add(x, y, r, m);
+    });
+}
+
+template <typename S>
+void sub(std::span<const vector3<S>> a, std::span<const vector3<S>> b, std::span<vector3<S>> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    mixed(a.data(), b.data(), out.data(), a.size(), [](const vector3<float>* x, const vector3<float>* y, vector3<float>* r, std::size_t m)
+    {
+        active_kernels(0.0f).sub(x, y, r, m);
+    });
+}
+
+template <typename S>
+void scale(std::span<const vector3<S>> a, float s, std::span<vector3<S>> out)
+{
+    assert(out.size() >= a.size());
+    mixed(a.data(), static_cast<const vector3<S>*>(nullptr), out.data(), a.size(), [s](const vector3<float>* x, const vector3<float>*, vector3<float>* r, std::size_t m)
+    {
+        active_kernels(0.0f).scale(x, s, r, m);
+    });
+}
+
+template <typename S>
+void normalize(std::span<const vector3<S>> a, std::span<vector3<S>> out)
+{
+    assert(out.size() >= a.size());
+    mixed(a.data(), static_cast<const vector3<S>*>(nullptr), out.data(), a.size(), [](const vector3<float>* x, const vector3<float>*, vector3<float>* r, std::size_t m)
+    {
+        active_kernels(0.0f).normalize_safe(x, r, m);
+    });
+}
+
+template <typename S>
+void dot(std::span<const vector3<S>> a, std::span<const vector3<S>> b, std::span<float> out)
+{
+    assert(a.size() == b.size() && out.size() >= a.size());
+    mixed(a.data(), b.data(), out.data(), a.size(), [](const vector3<float>* x, const vector3<float>* y, float* r, std::size_t m)
+    {
+        active_kernels(0.0f).dot(x, y, r, m);
+    });
+}
+
+template <typename S>
+void length(std::span<const vector3<S>> a, std::span<float> out)
+{
+    assert(out.size() >= a.size());
+    mixed(a.data(), static_cast<const vector3<S>*>(nullptr), out.data(), a.size(), [](const vector3<float>* x, const vector3<float>*, float* r, std::size_t m)
+    {
+        active_kernels(0.0f).length(x, r, m);
+    });
+}
+
+template <typename S>
+void accumulate(std::span<vector3<float>> acc, std::span<const vector3<S>> a, float s)
+{
+    assert(acc.size() == a.size());
+    alignas(64) vector3<float> fa[block];
+    for (std::size_t i = 0; i < a.size(); i += block)
+    {
+        const std::size_t m = a.size() - i < block ? a.size() - i : block;
+        convert(&a[i].x, &fa[0].x, 3 * m);
+        active_kernels(0.0f).scale(fa, s, fa, m);
+        active_kernels(0.0f).add(acc.data() + i, fa, acc.data() + i, m);
+    }
+}
+
+} // namespace vector_half_detail
+
+inline void batch_add(std::span<const vector3<half>> a, std::span<const vector3<half>> b, std::span<vector3<half>> out)                 { vector_half_detail::add(a, b, out); }
+inline void batch_sub(std::span<const vector3<half>> a, std::span<const vector3<half>> b, std::span<vector3<half>> out)                 { vector_half_detail::sub(a, b, out); }
+inline void batch_scale(std::span<const vector3<half>> a, float s, std::span<vector3<half>> out)                                       { vector_half_detail::scale(a, s, out); }
+inline void batch_normalize_safe(std::span<const vector3<half>> a, std::span<vector3<half>> out)                                       { vector_half_detail::normalize(a, out); }    // Zero length vectors stay zero
+inline void batch_dot(std::span<const vector3<half>> a, std::span<const vector3<half>> b, std::span<float> out)                        { vector_half_detail::dot(a, b, out); }
+inline void batch_length(std::span<const vector3<half>> a, std::span<float> out)                                                       { vector_half_detail::length(a, out); }
+inline void batch_accumulate(std::span<vector3<float>> acc, std::span<const vector3<half>> a, float s)                                 { vector_half_detail::accumulate(acc, a, s); }   // acc += a * s, e.g. integrating half velocities into float positions
+
+inline void batch_add(std::span<const vector3<bfloat16>> a, std::span<const vector3<bfloat16>> b, std::span<vector3<bfloat16>> out)     { vector_half_detail::add(a, b, out); }
+inline void batch_sub(std::span<const vector3<bfloat16>> a, std::span<const vector3<bfloat16>> b, std::span<vector3<bfloat16>> out)     { vector_half_detail::sub(a, b, out); }
+inline void batch_scale(std::span<const vector3<bfloat16>> a, float s, std::span<vector3<bfloat16>> out)                               { vector_half_detail::scale(a, s, out); }
+inline void batch_normalize_safe(std::span<const vector3<bfloat16>> a, std::span<vector3<bfloat16>> out)                               { vector_half_detail::normalize(a, out); }    // Zero length vectors stay zero
+inline void batch_dot(std::span<const vector3<bfloat16>> a, std::span<const vector3<bfloat16>> b, std::span<float> out)                { vector_half_detail::dot(a, b, out); }
+inline void batch_length(std::span<const vector3<bfloat16>> a, std::span<float> out)                                                   { vector_half_detail::length(a, out); }
+inline void batch_accumulate(std::span<vector3<float>> acc, std::span<const vector3<bfloat16>> a, float s)                             { vector_half_detail::accumulate(acc, a, s); }   // acc += a * s
+
+#endif
@@ -0,0 +1,56 @@
+// Batch 16 bit conversion kernels shared by the SIMD backends. This file is included
+// once per instruction set from vector_half.hpp, inside a namespace that defines width
+// (floats per register), so it intentionally has no include guard.
+//
+// The bfloat16 kernels are written with GCC/clang vector extensions and do the same
+// integer operations as the scalar conversions in vector_half_detail. The tail of an
+// array goes through the same block kernel on a zero padded copy, so every element of
+// an array is converted by the same instructions.
+
+using vu = std::uint32_t __attribute__((vector_size(4 * width)));
+using vh = std::uint16_t __attribute__((vector_size(2 * width)));
+
+inline void from_bfloat16_block(const bfloat16* a, float* out)
+{
+    vh h;
+    std::memcpy(&h, a, sizeof(h));
+    const vu u = __builtin_convertvector(h, vu) << 16;
+    std::memcpy(out, &u, sizeof(u));
+}
+
+inline void to_bfloat16_block(const float* a, bfloat16* out)
+{
+    vu u;
+    std::memcpy(&u, a, sizeof(u));
+    const vu nan = (u & 0x7fffffff) > 0x7f800000;         // All ones in NaN lanes
+    const vu rounded = (u + 0x7fff + ((u >> 16) & 1)) >> 16;
+    const vu quiet = (u >> 16) | 0x40;
+    const vh h = __builtin_convertvector((quiet & nan) | (rounded & ~nan), vh);
+    std::memcpy(out, &h, sizeof(h));
+}
+
+template <typename S, typename D, void (*Block)(const S*, D*)>
+void run(const S* __restrict a, D* __restrict out, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + width <= n; i += width)
+        Block(a + i, out + i);
+    if (i < n)
+    {
+        S s[width] = {};
+        D d[width];
+        std::memcpy(s, a + i, (n - i) * sizeof(S));
+        Block(s, d);
+        std::memcpy(out + i, d, (n - i) * sizeof(D));
+    }
+}
+
+inline void from_bfloat16(const bfloat16* a, float* out, std::size_t n)
+{
+    run<bfloat16, float, from_bfloat16_block>(a, out, n);
+}
+
+inline void to_bfloat16(const float* a, bfloat16* out, std::size_t n)
+{
+    run<float, bfloat16, to_bfloat16_block>(a, out, n);
+}
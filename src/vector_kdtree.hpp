@@ -0,0 +1,198 @@
+#ifndef VECTOR_KDTREE_H
+#define VECTOR_KDTREE_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "vector3.hpp"
+#include "vector_spatial.hpp"
+#include "vector_thread_pool.hpp"
+
+// k-d tree over a vector3<float> or vector3<double> point set, for nearest
+// neighbour, k nearest, radius and box queries in O(log n) per query instead of a
+// loop over distance.
+//
+// An inner node keeps only its split axis and value, 20 or 24 bytes per node; queries
+// bound the distance to a subtree by the distance to its splitting planes. The tree
+// is static: build it once over a snapshot of the points (copied in tree order), and
+// rebuild when they move. Results are reported by index into the span it was built
+// from, distances are squared. Ties are broken by index, so every query has one
+// answer whatever the tree shape or thread count.
+
+template <typename T>
+struct vector3_kdtree_node
+{
+    T             value;        // Split coordinate: left has coordinates <= value, right >= value
+    std::uint32_t axis;
+    std::uint32_t right;        // Right child, 0 for a leaf; the left child is the next node
+    std::uint32_t first;        // Points [first, first + count) in tree order
+    std::uint32_t count;
+
+    void leaf(const vector3<T>&, const vector3<T>&) { axis = 0; value = T(0); }
+    void split(const vector3<T>&, const vector3<T>&, std::uint32_t a, T v) { axis = a; value = v; }
+};
+
+template <typename T>
+struct vector3_kdtree
+{
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "vector3_kdtree supports float or double");
+
+    vector3_kdtree() = default;
+    explicit vector3_kdtree(std::span<const vector3<T>> points, std::size_t leaf_size = spatial_leaf_size, vector_thread_pool* pool = nullptr);
+
+    void build(std::span<const vector3<T>> points, std::size_t leaf_size = spatial_leaf_size, vector_thread_pool* pool = nullptr);
+
+    std::size_t size() const noexcept { return points.size(); }
+    bool        empty() const noexcept { return points.empty(); }
+
+    /* Queries */
+
+    vector_neighbor<T> nearest(const vector3<T>& q) const;                                             // { spatial_none, inf } on an empty tree
+    std::size_t        knn(const vector3<T>& q, std::size_t k, std::span<vector_neighbor<T>> out) const;   // Closest first, returns min(k, size())
+    void               radius(const vector3<T>& q, T r, std::vector<vector_neighbor<T>>& out) const;       // Appends every point within r, in tree order
+    void               box(const vector3<T>& lo, const vector3<T>& hi, std::vector<std::uint32_t>& out) const;   // Appends every point in [lo, hi], in tree order
+
+    /* Batched queries, optionally on a thread pool; results do not depend on it */
+
+    void knn(std::span<const vector3<T>> q, std::size_t k, std::span<vector_neighbor<T>> out, vector_thread_pool* pool = nullptr) const;   // Row i is out[i * k, i * k + k), padded with spatial_none
+    void radius(std::span<const vector3<T>> q, T r, std::vector<std::size_t>& offsets, std::vector<vector_neighbor<T>>& out, vector_thread_pool* pool = nullptr) const;     // Query i gets out[offsets[i], offsets[i + 1])
+
+    std::vector<vector3_kdtree_node<T>> nodes;
+    std::vector<vector3<T>>             points;     // Tree order
+    std::vector<std::uint32_t>          index;      // Original index of each point in tree order
+};
+
+template <typename T>
+inline vector3_kdtree<T>::vector3_kdtree(std::span<const vector3<T>> p, std::size_t leaf_size, vector_thread_pool* pool)
+{
+    build(p, leaf_size, pool);
+}
+
+template <typename T>
+inline void vector3_kdtree<T>::build(std::span<const vector3<T>> p, std::size_t leaf_size, vector_thread_pool* pool)
+{
+    spatial_detail::build_tree(p, leaf_size, pool, nodes, points, index);
+}
+
+/* Queries */
+
+template <typename T>
+inline vector_neighbor<T> vector3_kdtree<T>::nearest(const vector3<T>& q) const
+{
+    vector_neighbor<T> n{ spatial_none, std::numeric_limits<T>::infinity() };
+    knn(q, 1, std::span<vector_neighbor<T>>(&n, 1));
+    return n;
+}
+
+template <typename T>
+inline std::size_t vector3_kdtree<T>::knn(const vector3<T>& q, std::size_t k, std::span<vector_neighbor<T>> out) const
+{
+    assert(out.size() >= k);
+    k = std::min(k, size());
+    if (k == 0)
+        return 0;
+
+    struct entry { std::uint32_t node; T bound; };
+    std::array<entry, 64> stack;                // Depth is at most log2(n) + 1 for a median split tree
+    std::size_t top = 0;
+    std::size_t found = 0;
+    stack[top++] = entry{ 0, T(0) };
+    while (top)
+    {
+        const entry e = stack[--top];
+        if (e.bound > spatial_detail::heap_bound(out.data(), found, k))
+            continue;
+        const vector3_kdtree_node<T>& n = nodes[e.node];
+        if (!n.right)
+        {
+            for (std::uint32_t i = n.first; i < n.first + n.count; ++i)
+                spatial_detail::heap_offer(out.data(), found, k, vector_neighbor<T>{ index[i], (points[i] - q).lengthsqr() });
+            continue;
+        }
+        const T d = q.ptr()[n.axis] - n.value;
+        const T far = std::max(e.bound, d * d);
+        const std::uint32_t left = e.node + 1;
+        stack[top++] = entry{ d <= T(0) ? n.right : left, far };       // Far side first, so the near side is popped next
+        stack[top++] = entry{ d <= T(0) ? left : n.right, e.bound };
+    }
+    std::sort_heap(out.data(), out.data() + k);
+    return k;
+}
+
+template <typename T>
+inline void vector3_kdtree<T>::radius(const vector3<T>& q, T r, std::vector<vector_neighbor<T>>& out) const
+{
+    if (empty())
+        return;
+    const T rr = r * r;
+    std::array<std::uint32_t, 64> stack;
+    std::size_t top = 0;
+    stack[top++] = 0;
+    while (top)
+    {
+        const std::uint32_t i = stack[--top];
+        const vector3_kdtree_node<T>& n = nodes[i];
+        if (!n.right)
+        {
+            for (std::uint32_t j = n.first; j < n.first + n.count; ++j)
+            {
+                const T d = (points[j] - q).lengthsqr();
+                if (d <= rr)
+                    out.push_back(vector_neighbor<T>{ index[j], d });
+            }
+            continue;
+        }
+        const T d = q.ptr()[n.axis] - n.value;
+        if (d >= T(0) || d * d <= rr)       // Pushed right first, so the output is in tree order
+            stack[top++] = n.right;
+        if (d <= T(0) || d * d <= rr)
+            stack[top++] = i + 1;
+    }
+}
+
+template <typename T>
+inline void vector3_kdtree<T>::box(const vector3<T>& lo, const vector3<T>& hi, std::vector<std::uint32_t>& out) const
+{
+    if (empty())
+        return;
+    std::array<std::uint32_t, 64> stack;
+    std::size_t top = 0;
+    stack[top++] = 0;
+    while (top)
+    {
+        const std::uint32_t i = stack[--top];
+        const vector3_kdtree_node<T>& n = nodes[i];
+        if (!n.right)
+        {
+            for (std::uint32_t j = n.first; j < n.first + n.count; ++j)
+                if (spatial_detail::inside(lo, hi, points[j]))
+                    out.push_back(index[j]);
+            continue;
+        }
+        if (hi.ptr()[n.axis] >= n.value)
+            stack[top++] = n.right;
+        if (lo.ptr()[n.axis] <= n.value)
+            stack[top++] = i + 1;
+    }
+}
+
+template <typename T>
+inline void vector3_kdtree<T>::knn(std::span<const vector3<T>> q, std::size_t k, std::span<vector_neighbor<T>> out, vector_thread_pool* pool) const
+{
+    spatial_detail::batch_knn(*this, q, k, out, pool);
+}
+
+template <typename T>
+inline void vector3_kdtree<T>::radius(std::span<const vector3<T>> q, T r, std::vector<std::size_t>& offsets, std::vector<vector_neighbor<T>>& out, vector_thread_pool* pool) const
+{
+    spatial_detail::batch_radius(*this, q, r, offsets, out, pool);
+}
+
+#endif
@@ -0,0 +1,316 @@
+#ifndef VECTOR_MATH_H
+#define VECTOR_MATH_H
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Scalar helpers for the vector types that stay usable in constant expressions.
+//
+// std::sqrt and std::signbit are not constexpr before C++23, so during constant
+// evaluation vector_sqrt takes an integer square root of the significand and
+// vector_signbit reads the sign bit through std::bit_cast. Both give the same bits as
+// the standard functions, which they forward to at run time. vector_fma is std::fma,
+// a * b + c with a single rounding, and works the same way: in constant expressions it
+// adds the exact product of the significands to c in 128 bit integers and rounds once.
+// At run time std::fma is a single instruction only when the build targets FMA (-mfma,
+// -march=haswell or later); otherwise it is a libm call, correct but much slower.
+
+constexpr double vector_sqrt_exact(double a)     // Correctly rounded, digit by digit
+{
+    if (!(a > 0.0) || a == std::numeric_limits<double>::infinity())
+        return a < 0.0 ? std::numeric_limits<double>::quiet_NaN() : a;   // NaN, negative, zero and inf
+
+    const std::uint64_t bits = std::bit_cast<std::uint64_t>(a);
+    std::uint64_t m = bits & ((std::uint64_t(1) << 52) - 1);
+    int e = int(bits >> 52);
+    if (e == 0)                                     // Denormal, normalize the significand
+    {
+        e = 1;
+        while (!(m & (std::uint64_t(1) << 52)))
+        {
+            m <<= 1;
+            --e;
+        }
+    }
+    else
+        m |= std::uint64_t(1) << 52;
+
+    int p = e - 1075;                               // a = m * 2^p
+    if (p & 1)
+    {
+        m <<= 1;
+        --p;
+    }
+
+    // q = floor(sqrt(m * 2^56)), two bits of the operand per step; rem stays below 2^57
+    std::uint64_t q = 0;
+    std::uint64_t rem = 0;
+    for (int j = 108; j >= 0; j -= 2)
+    {
+        rem = (rem << 2) | (j >= 56 ? (m >> (j - 56)) & 3 : 0);
+        const std::uint64_t trial = (q << 2) | 1;
+        q <<= 1;
+        if (rem >= trial)
+        {
+            rem -= trial;
+            q |= 1;
+        }
+    }
+
+    // Round the 54 or 55 bit root to 53 bits, ties cannot happen for a square root
+    const int s = q >> 54 ? 2 : 1;
+    std::uint64_t r = q >> s;
+    const bool round = (q >> (s - 1)) & 1;
+    const bool sticky = (q & ((std::uint64_t(1) << (s - 1)) - 1)) || rem;
+    int x = s + (p - 56) / 2;
+    if (round && (sticky || (r & 1)))
+    {
+        if (++r >> 53)
+        {
+            r >>= 1;
+            ++x;
+        }
+    }
+    return std::bit_cast<double>((std::uint64_t(x + 52 + 1023) << 52) | (r & ((std::uint64_t(1) << 52) - 1)));
+}
+
+template <typename T>
+constexpr T vector_sqrt(T a)
+{
+    if (std::is_constant_evaluated())
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return static_cast<float>(vector_sqrt_exact(a));    // Double rounding is exact for sqrt
+        else
+            return static_cast<T>(vector_sqrt_exact(a));
+    }
+    return static_cast<T>(std::sqrt(a));
+}
+
+namespace vector_math_detail
+{
+
+struct u128         // Just enough 128 bit arithmetic for vector_fma_exact
+{
+    std::uint64_t hi;
+    std::uint64_t lo;
+};
+
+constexpr u128 mul(std::uint64_t a, std::uint64_t b)
+{
+    const std::uint64_t a0 = a & 0xffffffffu, a1 = a >> 32, b0 = b & 0xffffffffu, b1 = b >> 32;
+    const std::uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0;
+    const std::uint64_t mid = (p00 >> 32) + (p01 & 0xffffffffu) + (p10 & 0xffffffffu);
+    return u128{ a1 * b1 + (p01 >> 32) + (p10 >> 32) + (mid >> 32), (p00 & 0xffffffffu) | (mid << 32) };
+}
+
+constexpr int width(u128 a)         // Bits up to the highest set one
+{
+    return a.hi ? 64 + std::bit_width(a.hi) : std::bit_width(a.lo);
+}
+
+constexpr u128 shl(u128 a, int k)   // k < 128
+{
+    if (k == 0)
+        return a;
+    if (k >= 64)
+        return u128{ a.lo << (k - 64), 0 };
+    return u128{ (a.hi << k) | (a.lo >> (64 - k)), a.lo << k };
+}
+
+constexpr u128 shr(u128 a, int k)   // k < 128
+{
+    if (k == 0)
+        return a;
+    if (k >= 64)
+        return u128{ 0, a.hi >> (k - 64) };
+    return u128{ a.hi >> k, (a.lo >> k) | (a.hi << (64 - k)) };
+}
+
+constexpr u128 low_bits(u128 a, int k)      // The k lowest bits of a, k < 128
+{
+    if (k >= 64)
+        return u128{ a.hi & ((std::uint64_t(1) << (k - 64)) - 1), a.lo };
+    return u128{ 0, a.lo & ((std::uint64_t(1) << k) - 1) };
+}
+
+constexpr u128 shr_sticky(u128 a, int k)    // Shifted out bits are or'ed into bit 0
+{
+    if (k <= 0)
+        return a;
+    if (k >= 128)
+        return u128{ 0, (a.hi | a.lo) != 0 };
+    const u128 lost = low_bits(a, k);
+    u128 r = shr(a, k);
+    r.lo |= (lost.hi | lost.lo) != 0;
+    return r;
+}
+
+constexpr bool less(u128 a, u128 b)
+{
+    return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo);
+}
+
+constexpr u128 add(u128 a, u128 b)
+{
+    const std::uint64_t lo = a.lo + b.lo;
+    return u128{ a.hi + b.hi + (lo < a.lo), lo };
+}
+
+constexpr u128 sub(u128 a, u128 b)          // a >= b
+{
+    return u128{ a.hi - b.hi - (a.lo < b.lo), a.lo - b.lo };
+}
+
+template <typename T>
+struct fma_format
+{
+    using bits = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+    static constexpr int digits = std::numeric_limits<T>::digits;                                 // Significand bits, 24 or 53
+    static constexpr int lsb_min = std::numeric_limits<T>::min_exponent - digits;                 // Exponent of the lowest denormal bit
+    static constexpr int bias = std::numeric_limits<T>::max_exponent - 1;
+    static constexpr int field_max = 2 * std::numeric_limits<T>::max_exponent - 1;                // Inf and NaN exponent field
+};
+
+template <typename T>
+constexpr void split(T a, bool& sign, std::uint64_t& m, int& e)      // |a| = m 2^e, a finite
+{
+    using F = fma_format<T>;
+    const auto u = std::bit_cast<typename F::bits>(a);
+    sign = (u >> (sizeof(u) * 8 - 1)) != 0;
+    m = std::uint64_t(u) & ((std::uint64_t(1) << (F::digits - 1)) - 1);
+    const int field = int((std::uint64_t(u) >> (F::digits - 1)) & std::uint64_t(F::field_max));
+    if (field == 0)
+        e = F::lsb_min;
+    else
+    {
+        m |= std::uint64_t(1) << (F::digits - 1);
+        e = field - F::bias - (F::digits - 1);
+    }
+}
+
+} // namespace vector_math_detail
+
+template <typename T>
+constexpr T vector_fma_exact(T a, T b, T c)     // Correctly rounded a * b + c, float or double
+{
+    using namespace vector_math_detail;
+    using F = fma_format<T>;
+    constexpr T inf = std::numeric_limits<T>::infinity();
+    constexpr int top = 125;        // Both terms are aligned to this bit, so their sum fits
+
+    if (a != a || b != b || c != c || a == inf || a == -inf || b == inf || b == -inf)
+        return a * b + c;                   // NaN and inf operands of the product
+    if (c == inf || c == -inf)
+        return c;                           // A finite product cannot cancel it
+    if (a == T(0) || b == T(0))
+        return a * b + c;                   // The zero product is exact
+
+    bool sa = false, sb = false, sc = false;
+    std::uint64_t ma = 0, mb = 0, mc = 0;
+    int ea = 0, eb = 0, ec = 0;
+    split(a, sa, ma, ea);
+    split(b, sb, mb, eb);
+    split(c, sc, mc, ec);
+
+    const bool sp = sa != sb;
+    u128 p = mul(ma, mb);
+    int e = ea + eb - (top + 1 - width(p));
+    p = shl(p, top + 1 - width(p));
+    bool sign = sp;
+    u128 r = p;
+    if (mc)
+    {
+        u128 q{ 0, mc };
+        int eq = ec - (top + 1 - width(q));
+        q = shl(q, top + 1 - width(q));
+        if (e >= eq)        // The shifted out bits only need to be sticky, both low bits are 0
+            q = shr_sticky(q, e - eq);
+        else
+        {
+            p = shr_sticky(p, eq - e);
+            e = eq;
+        }
+        if (sp == sc)
+            r = add(p, q);
+        else if (less(p, q))
+        {
+            r = sub(q, p);
+            sign = sc;
+        }
+        else
+            r = sub(p, q);
+        if (!r.hi && !r.lo)
+            return T(0);                    // Exact cancellation rounds to +0
+    }
+
+    // Round r 2^e to the significand width, or to the denormal grid
+    int shift = width(r) - F::digits;
+    if (e + shift < F::lsb_min)
+        shift = F::lsb_min - e;
+    std::uint64_t m = 0;
+    if (shift <= 0)
+        m = r.lo << -shift;
+    else if (shift < 128)           // Else r is below half the lowest denormal and m stays 0
+    {
+        const u128 rest = low_bits(r, shift);
+        const u128 half = shl(u128{ 0, 1 }, shift - 1);
+        m = shr(r, shift).lo;
+        if (less(half, rest) || (!less(rest, half) && (m & 1)))     // To nearest, ties to even
+            ++m;
+    }
+    e += shift;
+    if (m >> F::digits)
+    {
+        m >>= 1;
+        ++e;
+    }
+
+    using U = typename F::bits;
+    const U s = sign ? U(U(1) << (sizeof(U) * 8 - 1)) : U(0);
+    if (m >> (F::digits - 1))
+    {
+        const int field = e + F::bias + (F::digits - 1);
+        if (field >= F::field_max)
+            return sign ? -inf : inf;
+        return std::bit_cast<T>(U(s | (U(field) << (F::digits - 1)) | U(m & ((std::uint64_t(1) << (F::digits - 1)) - 1))));
+    }
+    return std::bit_cast<T>(U(s | U(m)));       // Denormal or zero
+}
+
+template <typename T>
+constexpr T vector_fma(T a, T b, T c)
+{
+    if constexpr (!std::is_floating_point_v<T>)
+        return a * b + c;
+    else if (std::is_constant_evaluated())
+    {
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>)
+            return vector_fma_exact(a, b, c);
+        else
+            return a * b + c;
+    }
+    else
+        return std::fma(a, b, c);
+}
+
+template <typename T>
+constexpr bool vector_signbit(T a)
+{
+    if constexpr (!std::is_floating_point_v<T>)
+        return a < T(0);
+    else if (std::is_constant_evaluated())
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return (std::bit_cast<std::uint32_t>(a) >> 31) != 0;
+        else
+            return (std::bit_cast<std::uint64_t>(a) >> 63) != 0;
+    }
+    else
+        return std::signbit(a);
+}
+
+#endif
@@ -0,0 +1,508 @@
+#ifndef VECTOR_MEMORY_H
+#define VECTOR_MEMORY_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Allocators for short lived vector buffers, as std::pmr::memory_resource so they also
+// serve std::pmr::vector and friends.
+//
+//     vector_arena    bump allocation from a chain of chunks, freed all at once by
+//                     reset() at the end of a frame. Deallocating the latest block
+//                     gives it back, anything else waits for the reset. A reset after
+//                     a frame that needed several chunks merges them into one, so the
+//                     arena settles at the size of the largest frame and then stops
+//                     calling the system allocator. thread_arena() is one per thread.
+//                     Blocks still held at a reset must not be given back after it.
+//     vector_pool     fixed size blocks from a free list, for scratch buffers of a
+//                     known bound that are taken and returned in any order.
+//     vector_buffer   a std::vector like container of trivially copyable elements on
+//                     any memory_resource, by default the aligned global heap. Its
+//                     storage always starts on a vector_alignment boundary.
+//
+// Every block an arena or pool hands out is vector_alignment aligned unless more is
+// asked for. Neither is thread safe: an arena belongs to one thread, a pool to one
+// owner. The statistics are kept always, they cost a few additions per call.
+
+constexpr std::size_t vector_alignment = 64;            // Cache line and AVX-512 register size
+constexpr std::size_t arena_chunk_size = 1 << 20;       // Default first chunk of an arena, in bytes
+
+struct vector_alloc_stats
+{
+    std::size_t allocations = 0;            // Blocks handed out
+    std::size_t bytes = 0;                  // Bytes handed out, in total
+    std::size_t in_use = 0;                 // Bytes handed out and not given back (arena: since the last reset)
+    std::size_t peak = 0;                   // Highest in_use, the size an arena needs for its largest frame
+    std::size_t reserved = 0;               // Bytes held from the system
+    std::size_t system_allocations = 0;     // Chunks taken from the system; stops growing once an arena is big enough
+};
+
+namespace vector_memory_detail
+{
+
+inline std::size_t align_up(std::size_t n, std::size_t a)
+{
+    return (n + a - 1) & ~(a - 1);
+}
+
+inline void* system_allocate(std::size_t bytes, std::size_t align)
+{
+    return ::operator new(bytes, std::align_val_t(align < vector_alignment ? vector_alignment : align));
+}
+
+inline void system_deallocate(void* p, std::size_t align)
+{
+    ::operator delete(p, std::align_val_t(align < vector_alignment ? vector_alignment : align));
+}
+
+inline void count(vector_alloc_stats& s, std::size_t bytes)
+{
+    ++s.allocations;
+    s.bytes += bytes;
+    s.in_use += bytes;
+    if (s.in_use > s.peak)
+        s.peak = s.in_use;
+}
+
+inline void restart(vector_alloc_stats& s)      // Counts from zero, keeping the state
+{
+    vector_alloc_stats r;
+    r.in_use = r.peak = s.in_use;
+    r.reserved = s.reserved;
+    s = r;
+}
+
+} // namespace vector_memory_detail
+
+/* Global heap, vector_alignment aligned */
+
+struct vector_heap_resource : std::pmr::memory_resource
+{
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t align) override;
+    void  do_deallocate(void* p, std::size_t bytes, std::size_t align) override;
+    bool  do_is_equal(const std::pmr::memory_resource& r) const noexcept override;
+};
+
+inline void* vector_heap_resource::do_allocate(std::size_t bytes, std::size_t align)
+{
+    return vector_memory_detail::system_allocate(bytes, align);
+}
+
+inline void vector_heap_resource::do_deallocate(void* p, std::size_t, std::size_t align)
+{
+    vector_memory_detail::system_deallocate(p, align);
+}
+
+inline bool vector_heap_resource::do_is_equal(const std::pmr::memory_resource& r) const noexcept
+{
+    return this == &r;
+}
+
+inline std::pmr::memory_resource* vector_heap()
+{
+    static vector_heap_resource heap;
+    return &heap;
+}
+
+/* Bump arena with frame reset */
+
+struct vector_arena : std::pmr::memory_resource
+{
+    explicit vector_arena(std::size_t chunk_size = arena_chunk_size);     // The first chunk is taken at the first allocation
+    ~vector_arena() override;
+
+    vector_arena(const vector_arena&) = delete;
+    vector_arena& operator=(const vector_arena&) = delete;
+
+    void reset();           // Frees every block at once, keeps the memory
+    void release();         // Returns the memory to the system as well
+
+    const vector_alloc_stats& stats() const { return counters; }
+    void                      clear_stats();    // Counts from zero again, keeping in_use and reserved
+
+    /* Internals */
+
+    struct chunk            // Header at the start of every chunk
+    {
+        chunk*      next;   // Older chunk
+        std::size_t size;   // Bytes, header included
+    };
+
+    static constexpr std::size_t header = vector_alignment;    // Keeps the first block aligned
+
+    void* do_allocate(std::size_t bytes, std::size_t align) override;
+    void  do_deallocate(void* p, std::size_t bytes, std::size_t align) override;
+    bool  do_is_equal(const std::pmr::memory_resource& r) const noexcept override;
+
+    std::size_t offset(std::size_t align) const;     // First offset at or past top whose address is aligned
+    void        grow(std::size_t need);             // Starts a chunk with room for need bytes past the header
+    void        free_chunks();
+
+    chunk*             head;        // Chunk in use, the newest
+    std::size_t        top;         // Next free byte in head
+    std::size_t        next_size;   // Size of the next chunk
+    vector_alloc_stats counters;
+};
+
+inline vector_arena::vector_arena(std::size_t chunk_size)
+    : head(nullptr), top(0), next_size(vector_memory_detail::align_up(chunk_size < 2 * header ? 2 * header : chunk_size, vector_alignment)) {}
+
+inline vector_arena::~vector_arena()
+{
+    free_chunks();
+}
+
+inline void vector_arena::free_chunks()
+{
+    while (head)
+    {
+        chunk* c = head;
+        head = c->next;
+        vector_memory_detail::system_deallocate(c, vector_alignment);
+    }
+    top = 0;
+    counters.reserved = 0;
+}
+
+inline void vector_arena::grow(std::size_t need)
+{
+    std::size_t size = next_size;
+    while (size < header + need)
+        size *= 2;
+    chunk* c = static_cast<chunk*>(vector_memory_detail::system_allocate(size, vector_alignment));
+    c->next = head;
+    c->size = size;
+    head = c;
+    top = header;
+    next_size = size * 2;       // Geometric, so a frame needs few chunks before the first reset
+    counters.reserved += size;
+    ++counters.system_allocations;
+}
+
+inline std::size_t vector_arena::offset(std::size_t align) const
+{
+    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(head);
+    return vector_memory_detail::align_up(base + top, align) - base;
+}
+
+inline void* vector_arena::do_allocate(std::size_t bytes, std::size_t align)
+{
+    if (align < vector_alignment)
+        align = vector_alignment;
+    std::size_t at = head ? offset(align) : 0;
+    if (!head || at + bytes > head->size)
+    {
+        grow(bytes + align - vector_alignment);     // Chunks are vector_alignment aligned, larger alignments need slack
+        at = offset(align);
+    }
+    top = at + bytes;
+    vector_memory_detail::count(counters, bytes);
+    return reinterpret_cast<char*>(head) + at;
+}
+
+inline void vector_arena::do_deallocate(void* p, std::size_t bytes, std::size_t)
+{
+    counters.in_use -= bytes < counters.in_use ? bytes : counters.in_use;
+    if (head && static_cast<char*>(p) + bytes == reinterpret_cast<char*>(head) + top)      // The latest block
+        top = std::size_t(static_cast<char*>(p) - reinterpret_cast<char*>(head));
+}
+
+inline bool vector_arena::do_is_equal(const std::pmr::memory_resource& r) const noexcept
+{
+    return this == &r;
+}
+
+inline void vector_arena::reset()
+{
+    counters.in_use = 0;
+    if (head && head->next)     // Several chunks: merge them into one of their total size
+    {
+        const std::size_t total = counters.reserved;
+        free_chunks();
+        next_size = total;
+        grow(0);
+    }
+    top = header;
+}
+
+inline void vector_arena::release()
+{
+    free_chunks();
+    counters.in_use = 0;
+}
+
+inline void vector_arena::clear_stats()
+{
+    vector_memory_detail::restart(counters);
+}
+
+inline vector_arena& thread_arena()     // One arena per thread, reset by its owner
+{
+    thread_local vector_arena arena;
+    return arena;
+}
+
+/* Fixed size pool */
+
+struct vector_pool : std::pmr::memory_resource
+{
+    explicit vector_pool(std::size_t block_size, std::size_t blocks_per_chunk = 64);
+    ~vector_pool() override;
+
+    vector_pool(const vector_pool&) = delete;
+    vector_pool& operator=(const vector_pool&) = delete;
+
+    std::size_t block_size() const { return size; }
+    void        release();          // Returns the memory to the system; every block must be back
+
+    const vector_alloc_stats& stats() const { return counters; }
+    void                      clear_stats();    // Counts from zero again, keeping in_use and reserved
+
+    /* Internals */
+
+    struct node { node* next; };    // A free block
+
+    void* do_allocate(std::size_t bytes, std::size_t align) override;     // bytes <= block_size(), else std::bad_alloc
+    void  do_deallocate(void* p, std::size_t bytes, std::size_t align) override;
+    bool  do_is_equal(const std::pmr::memory_resource& r) const noexcept override;
+
+    std::size_t        size;        // Block size, a multiple of vector_alignment
+    std::size_t        per_chunk;
+    node*              free_list;
+    std::vector<void*> chunks;
+    vector_alloc_stats counters;
+};
+
+inline vector_pool::vector_pool(std::size_t block_size, std::size_t blocks_per_chunk)
+    : size(vector_memory_detail::align_up(block_size ? block_size : 1, vector_alignment)),
+      per_chunk(blocks_per_chunk ? blocks_per_chunk : 1), free_list(nullptr) {}
+
+inline vector_pool::~vector_pool()
+{
+    release();
+}
+
+inline void vector_pool::release()
+{
+    assert(counters.in_use == 0);
+    for (void* c : chunks)
+        vector_memory_detail::system_deallocate(c, vector_alignment);
+    chunks.clear();
+    free_list = nullptr;
+    counters.reserved = 0;
+}
+
+inline void* vector_pool::do_allocate(std::size_t bytes, std::size_t align)
+{
+    if (bytes > size || align > vector_alignment)
+        throw std::bad_alloc();
+    if (!free_list)
+    {
+        char* c = static_cast<char*>(vector_memory_detail::system_allocate(size * per_chunk, vector_alignment));
+        chunks.push_back(c);
+        for (std::size_t i = per_chunk; i-- > 0; )      // Lowest address first out
+        {
+            node* n = reinterpret_cast<node*>(c + i * size);
+            n->next = free_list;
+            free_list = n;
+        }
+        counters.reserved += size * per_chunk;
+        ++counters.system_allocations;
+    }
+    node* n = free_list;
+    free_list = n->next;
+    vector_memory_detail::count(counters, size);
+    return n;
+}
+
+inline void vector_pool::do_deallocate(void* p, std::size_t, std::size_t)
+{
+    node* n = static_cast<node*>(p);
+    n->next = free_list;
+    free_list = n;
+    counters.in_use -= size;
+}
+
+inline void vector_pool::clear_stats()
+{
+    vector_memory_detail::restart(counters);
+}
+
+inline bool vector_pool::do_is_equal(const std::pmr::memory_resource& r) const noexcept
+{
+    return this == &r;
+}
+
+/* Aligned buffer on a memory_resource */
+
+template <typename T>
+struct vector_buffer
+{
+    static_assert(std::is_trivially_copyable_v<T>, "vector_buffer moves its elements with memcpy");
+    static_assert(alignof(T) <= vector_alignment);
+
+    /* ctors */
+    explicit vector_buffer(std::pmr::memory_resource* r = vector_heap());
+    explicit vector_buffer(std::size_t n, std::pmr::memory_resource* r = vector_heap());     // n uninitialized elements, as vector3<T>()
+    vector_buffer(std::span<const T> v, std::pmr::memory_resource* r = vector_heap());
+    vector_buffer(const vector_buffer<T>& b);                   // On the resource of b
+    vector_buffer(vector_buffer<T>&& b) noexcept;
+    ~vector_buffer();
+
+    vector_buffer<T>& operator=(const vector_buffer<T>& b);    // Keeps the own resource
+    vector_buffer<T>& operator=(vector_buffer<T>&& b);         // Steals the storage on an equal resource, copies otherwise
+
+    /* Element access */
+    T&       operator[](std::size_t i)       { assert(i < count); return ptr[i]; }
+    const T& operator[](std::size_t i) const { assert(i < count); return ptr[i]; }
+
+    T*       data()        { return ptr; }
+    const T* data() const  { return ptr; }
+    T*       begin()       { return ptr; }
+    T*       end()         { return ptr + count; }
+    const T* begin() const { return ptr; }
+    const T* end() const   { return ptr + count; }
+
+    operator std::span<T>()             { return std::span<T>(ptr, count); }
+    operator std::span<const T>() const { return std::span<const T>(ptr, count); }
+
+    std::size_t size() const     { return count; }
+    std::size_t capacity() const { return cap; }
+    bool        empty() const    { return count == 0; }
+    void        reserve(std::size_t n);
+    void        resize(std::size_t n);          // New elements are left uninitialized
+    void        clear()          { count = 0; }
+    void        push_back(const T& v);
+    void        swap(vector_buffer<T>& b) noexcept;
+
+    std::pmr::memory_resource* resource() const { return res; }
+
+    /* Internals */
+
+    T*                         ptr;
+    std::size_t                count;
+    std::size_t                cap;
+    std::pmr::memory_resource* res;
+};
+
+template <typename T>
+inline vector_buffer<T>::vector_buffer(std::pmr::memory_resource* r) : ptr(nullptr), count(0), cap(0), res(r) {}
+
+template <typename T>
+inline vector_buffer<T>::vector_buffer(std::size_t n, std::pmr::memory_resource* r) : ptr(nullptr), count(0), cap(0), res(r)
+{
+    resize(n);
+}
+
+template <typename T>
+inline vector_buffer<T>::vector_buffer(std::span<const T> v, std::pmr::memory_resource* r) : ptr(nullptr), count(0), cap(0), res(r)
+{
+    resize(v.size());
+    if (count)
+        std::memcpy(ptr, v.data(), count * sizeof(T));
+}
+
+template <typename T>
+inline vector_buffer<T>::vector_buffer(const vector_buffer<T>& b) : vector_buffer(std::span<const T>(b), b.res) {}
+
+template <typename T>
+inline vector_buffer<T>::vector_buffer(vector_buffer<T>&& b) noexcept : ptr(b.ptr), count(b.count), cap(b.cap), res(b.res)
+{
+    b.ptr = nullptr;
+    b.count = 0;
+    b.cap = 0;
+}
+
+template <typename T>
+inline vector_buffer<T>::~vector_buffer()
+{
+    if (ptr)
+        res->deallocate(ptr, cap * sizeof(T), vector_alignment);
+}
+
+template <typename T>
+inline vector_buffer<T>& vector_buffer<T>::operator=(const vector_buffer<T>& b)
+{
+    if (this != &b)
+    {
+        count = 0;
+        resize(b.count);
+        if (count)
+            std::memcpy(ptr, b.ptr, count * sizeof(T));
+    }
+    return *this;
+}
+
+template <typename T>
+inline vector_buffer<T>& vector_buffer<T>::operator=(vector_buffer<T>&& b)
+{
+    if (this == &b)
+        return *this;
+    if (res->is_equal(*b.res))
+    {
+        if (ptr)
+            res->deallocate(ptr, cap * sizeof(T), vector_alignment);
+        ptr = std::exchange(b.ptr, nullptr);
+        count = std::exchange(b.count, 0);
+        cap = std::exchange(b.cap, 0);
+    }
+    else
+        *this = std::as_const(b);
+    return *this;
+}
+
+template <typename T>
+inline void vector_buffer<T>::reserve(std::size_t n)
+{
+    if (n <= cap)
+        return;
+
+    const std::size_t c = vector_memory_detail::align_up(n * sizeof(T), vector_alignment) / sizeof(T);     // Fills the last cache line
+    T* p = static_cast<T*>(res->allocate(c * sizeof(T), vector_alignment));
+    if (count)
+        std::memcpy(p, ptr, count * sizeof(T));
+    if (ptr)
+        res->deallocate(ptr, cap * sizeof(T), vector_alignment);
+    ptr = p;
+    cap = c;
+}
+
+template <typename T>
+inline void vector_buffer<T>::resize(std::size_t n)
+{
+    reserve(n);
+    count = n;
+}
+
+template <typename T>
+inline void vector_buffer<T>::push_back(const T& v)
+{
+    if (count == cap)
+    {
+        const T e = v;                          // v may live in the block reserve frees
+        reserve(cap ? cap * 2 : 1);
+        ptr[count++] = e;
+        return;
+    }
+    ptr[count++] = v;
+}
+
+template <typename T>
+inline void vector_buffer<T>::swap(vector_buffer<T>& b) noexcept
+{
+    std::swap(ptr, b.ptr);
+    std::swap(count, b.count);
+    std::swap(cap, b.cap);
+    std::swap(res, b.res);
+}
+
+#endif
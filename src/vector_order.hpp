@@ -0,0 +1,469 @@
+#ifndef VECTOR_ORDER_H
+#define VECTOR_ORDER_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "vector.hpp"
+#include "vector3_simd.hpp"
+#include "vector_thread_pool.hpp"
+
+// Space filling curve order for vector2 and vector3 arrays: points close in space get
+// close keys, so sorting an array (and the attribute arrays that go with it) by key
+// puts neighbours close in memory for every pass that works on neighbourhoods.
+//
+//     morton_encode / hilbert_encode   keys of integer coordinates, 32 bits per axis in
+//                                      2D and 21 in 3D, constexpr
+//     curve_keys                       keys of a point array, quantized in its bounding box
+//     radix_sort                       stable LSD sort of (key, value) pairs
+//     curve_order / reorder            the sorting permutation, and gathering arrays by it
+//     sort_by_curve                    all of it on a points array and its attributes
+//
+// Morton (Z order) keys interleave the coordinate bits. Hilbert keys are walked from
+// the Morton key through a small table, a few levels per lookup; consecutive Hilbert
+// cells are face neighbours, so the order has no long jumps and somewhat better
+// locality for a little more work per key. On x86 with BMI2 the interleave is one
+// pdep per axis (slow microcode on AMD before Zen 3, still the same keys). The points
+// are quantized with one scale for every axis, so the cells are cubes. With a thread
+// pool the keys and each radix pass run in blocks, and every result is the same as on
+// one thread.
+
+constexpr std::size_t order_block = 16384;      // Elements per parallel block
+constexpr std::size_t order_radix_bits = 8;     // Digit size of the radix sort
+
+enum class space_curve
+{
+    morton,
+    hilbert
+};
+
+/* Integer keys */
+
+namespace vector_order_detail
+{
+
+constexpr std::uint64_t spread2(std::uint32_t a) noexcept      // Bit i to bit 2i
+{
+    std::uint64_t x = a;
+    x = (x | x << 16) & 0x0000ffff0000ffffull;
+    x = (x | x << 8)  & 0x00ff00ff00ff00ffull;
+    x = (x | x << 4)  & 0x0f0f0f0f0f0f0f0full;
+    x = (x | x << 2)  & 0x3333333333333333ull;
+    x = (x | x << 1)  & 0x5555555555555555ull;
+    return x;
+}
+
+constexpr std::uint64_t spread3(std::uint32_t a) noexcept      // Bit i to bit 3i, 21 bits
+{
+    std::uint64_t x = a & 0x1fffff;
+    x = (x | x << 32) & 0x001f00000000ffffull;
+    x = (x | x << 16) & 0x001f0000ff0000ffull;
+    x = (x | x << 8)  & 0x100f00f00f00f00full;
+    x = (x | x << 4)  & 0x10c30c30c30c30c3ull;
+    x = (x | x << 2)  & 0x1249249249249249ull;
+    return x;
+}
+
+// Hilbert order as Hamilton's state machine ("Compact Hilbert Indices", 2006): at each
+// level, from the top, the N bits of the point select a subcell, whose rank along the
+// curve gives the next N bits of the key and whose entry point and direction give the
+// orientation of the curve inside it. The (entry, direction) state and the per level
+// step are tabulated for several levels at once and walked over the Morton key.
+
+template <std::size_t N>
+constexpr std::uint32_t rotate_right(std::uint32_t x, std::uint32_t r) noexcept        // Over N bits
+{
+    constexpr std::uint32_t mask = (std::uint32_t(1) << N) - 1;
+    r %= N;
+    return ((x >> r) | (x << (N - r))) & mask;
+}
+
+template <std::size_t N>
+constexpr std::uint32_t hilbert_step(std::uint32_t& state, std::uint32_t l) noexcept    // Rank of subcell l, updates the state e * N + d
+{
+    const std::uint32_t e = state / N, d = state % N;
+    std::uint32_t t = rotate_right<N>(l ^ e, d + 1);
+    std::uint32_t w = 0;
+    for (; t; t >>= 1)          // Inverse Gray code
+        w ^= t;
+    const std::uint32_t entry = w ? ((w - 1) & ~std::uint32_t(1)) ^ (((w - 1) & ~std::uint32_t(1)) >> 1) : 0;
+    const std::uint32_t direction = w ? std::uint32_t(std::countr_one(w & 1 ? w : w - 1)) % N : 0;
+    const std::uint32_t e2 = e ^ rotate_right<N>(entry, N - (d + 1) % N);      // Rotate left by d + 1
+    state = e2 * N + (d + direction + 1) % N;
+    return w;
+}
+
+template <std::size_t N, unsigned L>
+constexpr std::array<std::uint16_t, (N << N) << (N * L)> hilbert_table() noexcept     // L levels per lookup: key bits | next state << 8
+{
+    std::array<std::uint16_t, (N << N) << (N * L)> table{};
+    for (std::uint32_t s = 0; s < (N << N); ++s)
+    {
+        for (std::uint32_t c = 0; c < (std::uint32_t(1) << (N * L)); ++c)
+        {
+            std::uint32_t state = s, h = 0;
+            for (unsigned k = L; k-- > 0;)
+                h = h << N | hilbert_step<N>(state, (c >> (N * k)) & ((std::uint32_t(1) << N) - 1));
+            table[s << (N * L) | c] = std::uint16_t(h | state << 8);
+        }
+    }
+    return table;
+}
+
+template <std::size_t N, unsigned L>
+inline constexpr std::array<std::uint16_t, (N << N) << (N * L)> hilbert_lut = hilbert_table<N, L>();
+
+template <std::size_t N>
+constexpr std::uint64_t hilbert_from_morton(std::uint64_t m) noexcept
+{
+    constexpr unsigned levels = N == 2 ? 32 : 21;
+    constexpr unsigned step = N == 2 ? 4 : 2;                       // 2048 and 1536 entry tables
+    constexpr unsigned first = levels % step ? levels % step : step;
+    std::uint32_t state = 0;
+    std::uint64_t h = 0;
+    unsigned level = levels - first;
+    {
+        const std::uint32_t t = hilbert_lut<N, first>[std::uint32_t(m >> (N * level)) & ((std::uint32_t(1) << (N * first)) - 1)];
+        h = t & 0xff;
+        state = t >> 8;
+    }
+    while (level)
+    {
+        level -= step;
+        const std::uint32_t t = hilbert_lut<N, step>[state << (N * step) | (std::uint32_t(m >> (N * level)) & ((std::uint32_t(1) << (N * step)) - 1))];
+        h = h << (N * step) | (t & 0xff);
+        state = t >> 8;
+    }
+    return h;
+}
+
+} // namespace vector_order_detail
+
+constexpr std::uint64_t morton_encode(std::uint32_t x, std::uint32_t y) noexcept
+{
+    return vector_order_detail::spread2(x) | vector_order_detail::spread2(y) << 1;
+}
+
+constexpr std::uint64_t morton_encode(std::uint32_t x, std::uint32_t y, std::uint32_t z) noexcept      // 21 bits per axis
+{
+    using vector_order_detail::spread3;
+    return spread3(x) | spread3(y) << 1 | spread3(z) << 2;
+}
+
+constexpr std::uint64_t hilbert_encode(std::uint32_t x, std::uint32_t y) noexcept
+{
+    return vector_order_detail::hilbert_from_morton<2>(morton_encode(x, y));
+}
+
+constexpr std::uint64_t hilbert_encode(std::uint32_t x, std::uint32_t y, std::uint32_t z) noexcept     // 21 bits per axis
+{
+    return vector_order_detail::hilbert_from_morton<3>(morton_encode(x, y, z));
+}
+
+/* Point keys */
+
+namespace vector_order_detail
+{
+
+template <std::size_t N>
+constexpr unsigned key_bits = N == 2 ? 32 : 21;                 // Bits per axis
+
+template <std::size_t N, typename T>
+struct quantizer                // Maps the bounding box onto [0, 2^key_bits) per axis, same scale for every axis
+{
+    vector<N, double> lo;
+    double            scale;
+
+    quantizer(std::span<const vector<N, T>> p, vector_thread_pool* pool)
+    {
+        vector<N, T> l(T(0)), h(T(0));
+        if (!p.empty())
+        {
+            const std::size_t blocks = (p.size() + order_block - 1) / order_block;
+            std::vector<vector<N, T>> bl(blocks), bh(blocks);
+            const auto block = [&](std::size_t b)
+            {
+                const std::size_t first = b * order_block, last = std::min(p.size(), first + order_block);
+                vector<N, T> a = p[first], z = p[first];
+                for (std::size_t i = first + 1; i < last; ++i)
+                    vector_detail::for_each<N>([&](auto c)
+                    {
+                        get<c>(a) = get<c>(p[i]) < get<c>(a) ? get<c>(p[i]) : get<c>(a);
+                        get<c>(z) = get<c>(p[i]) > get<c>(z) ? get<c>(p[i]) : get<c>(z);
+                    });
+                bl[b] = a;
+                bh[b] = z;
+            };
+            if (pool && blocks > 1)
+                pool->parallel_for(blocks, block);
+            else
+                for (std::size_t b = 0; b < blocks; ++b)
+                    block(b);
+            l = bl[0];
+            h = bh[0];
+            for (std::size_t b = 1; b < blocks; ++b)
+                vector_detail::for_each<N>([&](auto c)
+                {
+                    get<c>(l) = get<c>(bl[b]) < get<c>(l) ? get<c>(bl[b]) : get<c>(l);
+                    get<c>(h) = get<c>(bh[b]) > get<c>(h) ? get<c>(bh[b]) : get<c>(h);
+                });
+        }
+
+        double extent = 0.0;
+        vector_detail::for_each<N>([&](auto c)
+        {
+            get<c>(lo) = double(get<c>(l));
+            extent = std::max(extent, double(get<c>(h)) - double(get<c>(l)));
+        });
+        constexpr double cells = double((std::uint64_t(1) << key_bits<N>) - 1);
+        scale = extent > 0.0 ? cells / extent : 0.0;
+    }
+
+    std::array<std::uint32_t, N> operator()(const vector<N, T>& p) const noexcept
+    {
+        constexpr double cells = double((std::uint64_t(1) << key_bits<N>) - 1);
+        std::array<std::uint32_t, N> q;
+        vector_detail::for_each<N>([&](auto c)
+        {
+            const double a = (double(get<c>(p)) - get<c>(lo)) * scale;
+            q[c] = std::uint32_t(a > 0.0 ? (a < cells ? a : cells) : 0.0);
+        });
+        return q;
+    }
+};
+
+template <std::size_t N>
+constexpr std::uint64_t encode(const std::array<std::uint32_t, N>& q, space_curve curve) noexcept
+{
+    if constexpr (N == 2)
+        return curve == space_curve::hilbert ? hilbert_encode(q[0], q[1]) : morton_encode(q[0], q[1]);
+    else
+        return curve == space_curve::hilbert ? hilbert_encode(q[0], q[1], q[2]) : morton_encode(q[0], q[1], q[2]);
+}
+
+inline bool has_bmi2()
+{
+#if VECTOR3_SIMD_X86
+    static const bool bmi2 = []
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("bmi2") != 0;
+    }();
+    return bmi2;
+#else
+    return false;
+#endif
+}
+
+template <std::size_t N, typename T>
+void keys_scalar(const quantizer<N, T>& quant, const vector<N, T>* p, std::uint64_t* keys, std::size_t n, space_curve curve)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        keys[i] = encode<N>(quant(p[i]), curve);
+}
+
+} // namespace vector_order_detail
+
+#if VECTOR3_SIMD_X86
+
+/* BMI2 backend: the interleave as one pdep per axis */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("bmi2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("bmi2")
+#endif
+
+namespace vector_order_bmi2
+{
+
+template <std::size_t N>
+inline std::uint64_t interleave(const std::array<std::uint32_t, N>& q)
+{
+    if constexpr (N == 2)
+        return _pdep_u64(q[0], 0x5555555555555555ull) | _pdep_u64(q[1], 0xaaaaaaaaaaaaaaaaull);
+    else
+        return _pdep_u64(q[0], 0x1249249249249249ull) | _pdep_u64(q[1], 0x2492492492492492ull) | _pdep_u64(q[2], 0x4924924924924924ull);
+}
+
+template <std::size_t N, typename T>
+void keys(const vector_order_detail::quantizer<N, T>& quant, const vector<N, T>* p, std::uint64_t* keys, std::size_t n, space_curve curve)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        keys[i] = curve == space_curve::hilbert ? vector_order_detail::hilbert_from_morton<N>(interleave<N>(quant(p[i]))) : interleave<N>(quant(p[i]));
+}
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif // VECTOR3_SIMD_X86
+
+template <std::size_t N, typename T>
+void curve_keys(std::span<const vector<N, T>> p, std::span<std::uint64_t> keys, space_curve curve = space_curve::hilbert, vector_thread_pool* pool = nullptr)
+{
+    assert(keys.size() >= p.size());
+    const vector_order_detail::quantizer<N, T> quant(p, pool);
+    const auto block = [&](std::size_t b)
+    {
+        const std::size_t first = b * order_block, count = std::min(order_block, p.size() - first);
+#if VECTOR3_SIMD_X86
+        if (vector_order_detail::has_bmi2())
+            return vector_order_bmi2::keys(quant, p.data() + first, keys.data() + first, count, curve);
+#endif
+        vector_order_detail::keys_scalar(quant, p.data() + first, keys.data() + first, count, curve);
+    };
+    const std::size_t blocks = (p.size() + order_block - 1) / order_block;
+    if (pool && blocks > 1)
+        pool->parallel_for(blocks, block);
+    else
+        for (std::size_t b = 0; b < blocks; ++b)
+            block(b);
+}
+
+/* Radix sort */
+
+inline void radix_sort(std::span<std::uint64_t> keys, std::span<std::uint32_t> values, vector_thread_pool* pool = nullptr)     // Stable, by key
+{
+    assert(keys.size() == values.size() && keys.size() <= 0xffffffff);
+    constexpr std::size_t radix = std::size_t(1) << order_radix_bits;
+    const std::size_t n = keys.size();
+    const std::size_t blocks = (n + order_block - 1) / order_block;
+    if (n < 2)
+        return;
+
+    std::vector<std::uint64_t> k2(n);
+    std::vector<std::uint32_t> v2(n);
+    std::vector<std::uint32_t> count(blocks * radix);     // Per block digit counts, then scatter offsets
+    std::uint64_t* ks = keys.data();
+    std::uint32_t* vs = values.data();
+    std::uint64_t* kd = k2.data();
+    std::uint32_t* vd = v2.data();
+
+    const auto run = [&](auto&& f)
+    {
+        if (pool && blocks > 1)
+            pool->parallel_for(blocks, f);
+        else
+            for (std::size_t b = 0; b < blocks; ++b)
+                f(b);
+    };
+
+    for (unsigned shift = 0; shift < 64; shift += order_radix_bits)
+    {
+        run([&](std::size_t b)
+        {
+            std::uint32_t* c = count.data() + b * radix;
+            const std::uint64_t* k = ks;
+            std::fill(c, c + radix, std::uint32_t(0));
+            for (std::size_t i = b * order_block, e = std::min(n, i + order_block); i < e; ++i)
+                ++c[(k[i] >> shift) & (radix - 1)];
+        });
+
+        std::size_t sum = 0;
+        bool trivial = false;
+        for (std::size_t d = 0; d < radix; ++d)         // Digit major, block minor: stable
+        {
+            std::size_t total = 0;
+            for (std::size_t b = 0; b < blocks; ++b)
+            {
+                const std::size_t c = count[b * radix + d];
+                count[b * radix + d] = std::uint32_t(sum);
+                sum += c;
+                total += c;
+            }
+            trivial = trivial || total == n;
+        }
+        if (trivial)            // Every key has the same digit, the pass would not move anything
+            continue;
+
+        run([&](std::size_t b)
+        {
+            std::uint32_t* c = count.data() + b * radix;
+            const std::uint64_t* k = ks;
+            const std::uint32_t* v = vs;
+            std::uint64_t* kout = kd;
+            std::uint32_t* vout = vd;
+            for (std::size_t i = b * order_block, e = std::min(n, i + order_block); i < e; ++i)
+            {
+                const std::uint32_t o = c[(k[i] >> shift) & (radix - 1)]++;
+                kout[o] = k[i];
+                vout[o] = v[i];
+            }
+        });
+        std::swap(ks, kd);
+        std::swap(vs, vd);
+    }
+
+    if (ks != keys.data())
+    {
+        std::memcpy(keys.data(), ks, n * sizeof(std::uint64_t));
+        std::memcpy(values.data(), vs, n * sizeof(std::uint32_t));
+    }
+}
+
+/* Orders and reordering */
+
+template <std::size_t N, typename T>
+std::vector<std::uint32_t> curve_order(std::span<const vector<N, T>> p, space_curve curve = space_curve::hilbert, vector_thread_pool* pool = nullptr)    // order[i] = index of the ith point along the curve
+{
+    assert(p.size() < std::size_t(0xffffffff));
+    std::vector<std::uint64_t> keys(p.size());
+    std::vector<std::uint32_t> order(p.size());
+    std::iota(order.begin(), order.end(), std::uint32_t(0));
+    curve_keys(p, std::span<std::uint64_t>(keys), curve, pool);
+    radix_sort(keys, order, pool);
+    return order;
+}
+
+template <std::ranges::contiguous_range... R>
+void reorder(std::span<const std::uint32_t> order, vector_thread_pool* pool, R&... arrays)      // arrays[i] = old arrays[order[i]], each as long as order
+{
+    const std::size_t n = order.size();
+    const std::size_t blocks = (n + order_block - 1) / order_block;
+    const auto gather = [&](auto& a)
+    {
+        using V = std::ranges::range_value_t<std::remove_reference_t<decltype(a)>>;
+        assert(std::size_t(std::ranges::size(a)) == n);
+        V* data = std::ranges::data(a);
+        std::vector<V> old(data, data + n);
+        const auto block = [&](std::size_t b)
+        {
+            for (std::size_t i = b * order_block, e = std::min(n, i + order_block); i < e; ++i)
+                data[i] = old[order[i]];
+        };
+        if (pool && blocks > 1)
+            pool->parallel_for(blocks, block);
+        else
+            for (std::size_t b = 0; b < blocks; ++b)
+                block(b);
+    };
+    (gather(arrays), ...);
+}
+
+template <vector_range P, std::ranges::contiguous_range... R>
+std::vector<std::uint32_t> sort_by_curve(P& points, space_curve curve = space_curve::hilbert, vector_thread_pool* pool = nullptr, R&... attributes)    // Returns the order applied
+{
+    using V = std::ranges::range_value_t<P>;
+    const std::span<const V> p(std::ranges::data(points), std::ranges::size(points));
+    std::vector<std::uint32_t> order = curve_order<V::dimension, typename V::value_type>(p, curve, pool);
+    reorder(order, pool, points, attributes...);
+    return order;
+}
+
+#endif
@@ -0,0 +1,616 @@
+#ifndef VECTOR_PREDICATES_H
+#define VECTOR_PREDICATES_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "vector2.hpp"
+#include "vector3.hpp"
+#include "vector3_simd.hpp"
+
+// Orientation and incircle predicates for meshing and geometry code.
+//
+//     orient2d(a, b, c)       > 0 when a, b, c turn counterclockwise, < 0 clockwise, 0 collinear
+//     orient3d(a, b, c, d)    > 0 when d lies below the plane of a, b, c, which turn
+//                             counterclockwise seen from above; 0 when coplanar
+//     incircle(a, b, c, d)    > 0 when d lies inside the circle through the
+//                             counterclockwise a, b, c; 0 when cocircular
+//
+// Each comes in three forms:
+//
+//     orient2d        the exact sign, with Shewchuk's adaptive scheme: the determinant is
+//                     evaluated in double with a forward error bound, and only when the
+//                     bound does not settle the sign it is recomputed exactly with
+//                     floating point expansions. The value is the approximate
+//                     determinant, its sign is always right.
+//     orient2d_eps    -1, 0 or 1, 0 when |det| is within eps times the sum of the
+//                     magnitudes of its products, so eps is a relative tolerance
+//     orient2d_fast   the plain determinant in T, no guarantee near degeneracy
+//
+// float inputs are converted to double, which is exact, so the exact forms are exact
+// for both. The batch forms write bitmasks, bit i % 64 of word i / 64 set when the
+// predicate of element i is positive, and optionally a second mask of the zero
+// results. They follow the vector3_simd dispatch (set_simd_level applies) to SSE4.1,
+// AVX2 or AVX-512 filter kernels written with the GCC/clang vector extensions, with
+// the exact fallback per element, and agree bit for bit with the single calls.
+//
+// The exact arithmetic needs round to nearest double arithmetic without extended
+// precision (x87) or -ffast-math, and inputs whose products neither overflow nor
+// underflow.
+
+namespace vector_predicates_detail
+{
+
+constexpr double epsilon = 0x1p-53;                                   // Half an ulp of 1
+constexpr double splitter = 134217729.0;                              // 2^27 + 1
+constexpr double orient2d_bound = (3.0 + 16.0 * epsilon) * epsilon;   // Relative error bounds of the filters
+constexpr double orient3d_bound = (7.0 + 56.0 * epsilon) * epsilon;
+constexpr double incircle_bound = (10.0 + 96.0 * epsilon) * epsilon;
+
+/* Error free transformations: x + y equals the exact result, |y| <= ulp(x) / 2 */
+
+inline void two_sum(double a, double b, double& x, double& y)
+{
+    const double s = a + b;
+    const double bv = s - a;
+    const double av = s - bv;
+    y = (a - av) + (b - bv);
+    x = s;
+}
+
+inline void two_diff(double a, double b, double& x, double& y)
+{
+    const double s = a - b;
+    const double bv = a - s;
+    const double av = s + bv;
+    y = (a - av) + (bv - b);
+    x = s;
+}
+
+inline void split(double a, double& hi, double& lo)      // 26 bit halves, a = hi + lo
+{
+    const double c = splitter * a;
+    const double big = c - a;
+    hi = c - big;
+    lo = a - hi;
+}
+
+inline void two_product(double a, double b, double bhi, double blo, double& x, double& y)     // b already split
+{
+    double ahi, alo;
+    split(a, ahi, alo);
+    const double p = a * b;
+    const double e1 = p - ahi * bhi;
+    const double e2 = e1 - alo * bhi;
+    const double e3 = e2 - ahi * blo;
+    y = alo * blo - e3;
+    x = p;
+}
+
+/* Expansions: sums of nonoverlapping doubles, by increasing magnitude, zeros removed */
+
+template <std::size_t C>
+struct expansion
+{
+    double      e[C];
+    std::size_t n;
+
+    double sign() const { return e[n - 1]; }   // The largest component carries the sign of the sum
+};
+
+// h = e + f. Merges by magnitude and accumulates with two_sum, as Shewchuk's
+// fast_expansion_sum_zeroelim; h holds at least one component and may alias neither.
+inline std::size_t sum(std::size_t en, const double* e, std::size_t fn, const double* f, double* h)
+{
+    std::size_t i = 0, j = 0, k = 0;
+    const auto next = [&]
+    {
+        return j == fn || (i < en && (f[j] > e[i]) == (f[j] > -e[i])) ? e[i++] : f[j++];
+    };
+    double q = next();
+    while (i < en || j < fn)
+    {
+        double r;
+        two_sum(q, next(), q, r);
+        if (r != 0.0)
+            h[k++] = r;
+    }
+    if (q != 0.0 || k == 0)
+        h[k++] = q;
+    return k;
+}
+
+inline std::size_t scale(std::size_t en, const double* e, double b, double* h)      // h = e * b, scale_expansion_zeroelim
+{
+    double bhi, blo, q, r;
+    split(b, bhi, blo);
+    std::size_t k = 0;
+    two_product(e[0], b, bhi, blo, q, r);
+    if (r != 0.0)
+        h[k++] = r;
+    for (std::size_t i = 1; i < en; ++i)
+    {
+        double p1, p0, s;
+        two_product(e[i], b, bhi, blo, p1, p0);
+        two_sum(q, p0, s, r);
+        if (r != 0.0)
+            h[k++] = r;
+        q = p1 + s;             // Fast two sum, |p1| >= |s|
+        r = s - (q - p1);
+        if (r != 0.0)
+            h[k++] = r;
+    }
+    if (q != 0.0 || k == 0)
+        h[k++] = q;
+    return k;
+}
+
+inline expansion<2> diff(double a, double b)       // Exact a - b
+{
+    expansion<2> r;
+    double x, y;
+    two_diff(a, b, x, y);
+    r.n = 0;
+    if (y != 0.0)
+        r.e[r.n++] = y;
+    r.e[r.n++] = x;
+    return r;
+}
+
+template <std::size_t A, std::size_t B>
+expansion<A + B> operator+(const expansion<A>& a, const expansion<B>& b)
+{
+    expansion<A + B> r;
+    r.n = sum(a.n, a.e, b.n, b.e, r.e);
+    return r;
+}
+
+template <std::size_t A>
+expansion<A> operator-(const expansion<A>& a)
+{
+    expansion<A> r;
+    r.n = a.n;
+    for (std::size_t i = 0; i < a.n; ++i)
+        r.e[i] = -a.e[i];
+    return r;
+}
+
+template <std::size_t A, std::size_t B>
+expansion<A + B> operator-(const expansion<A>& a, const expansion<B>& b)
+{
+    return a + (-b);
+}
+
+template <std::size_t A, std::size_t B>
+expansion<2 * A * B> operator*(const expansion<A>& a, const expansion<B>& b)    // Sum of a scaled by each component of b
+{
+    expansion<2 * A * B> r, t;
+    double s[2 * A];
+    r.n = scale(a.n, a.e, b.e[0], r.e);
+    for (std::size_t i = 1; i < b.n; ++i)
+    {
+        const std::size_t sn = scale(a.n, a.e, b.e[i], s);
+        t.n = sum(r.n, r.e, sn, s, t.e);
+        r = t;
+    }
+    return r;
+}
+
+/* Exact determinants, the sign of the most significant component */
+
+inline double orient2d_exact(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    return (diff(ax, cx) * diff(by, cy) - diff(ay, cy) * diff(bx, cx)).sign();
+}
+
+inline double orient3d_exact(double ax, double ay, double az, double bx, double by, double bz,
+                             double cx, double cy, double cz, double dx, double dy, double dz)
+{
+    const expansion<2> adx = diff(ax, dx), ady = diff(ay, dy), adz = diff(az, dz);
+    const expansion<2> bdx = diff(bx, dx), bdy = diff(by, dy), bdz = diff(bz, dz);
+    const expansion<2> cdx = diff(cx, dx), cdy = diff(cy, dy), cdz = diff(cz, dz);
+    return (adz * (bdx * cdy - cdx * bdy) + bdz * (cdx * ady - adx * cdy) + cdz * (adx * bdy - bdx * ady)).sign();
+}
+
+inline double incircle_exact(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+{
+    const expansion<2> adx = diff(ax, dx), ady = diff(ay, dy);
+    const expansion<2> bdx = diff(bx, dx), bdy = diff(by, dy);
+    const expansion<2> cdx = diff(cx, dx), cdy = diff(cy, dy);
+    const expansion<16> alift = adx * adx + ady * ady;
+    const expansion<16> blift = bdx * bdx + bdy * bdy;
+    const expansion<16> clift = cdx * cdx + cdy * cdy;
+    return (alift * (bdx * cdy - cdx * bdy) + blift * (cdx * ady - adx * cdy) + clift * (adx * bdy - bdx * ady)).sign();
+}
+
+/* Filters. det and the bound of its error (or the eps tolerance), the same operations as the batch kernels */
+
+inline double orient2d_det(double ax, double ay, double bx, double by, double cx, double cy, double& permanent)
+{
+    const double l = (ax - cx) * (by - cy);
+    const double r = (ay - cy) * (bx - cx);
+    permanent = (l < 0.0 ? -l : l) + (r < 0.0 ? -r : r);
+    return l - r;
+}
+
+inline double orient3d_det(double ax, double ay, double az, double bx, double by, double bz,
+                           double cx, double cy, double cz, double dx, double dy, double dz, double& permanent)
+{
+    const double adx = ax - dx, ady = ay - dy, adz = az - dz;
+    const double bdx = bx - dx, bdy = by - dy, bdz = bz - dz;
+    const double cdx = cx - dx, cdy = cy - dy, cdz = cz - dz;
+    const double bc = bdx * cdy, cb = cdx * bdy;
+    const double ca = cdx * ady, ac = adx * cdy;
+    const double ab = adx * bdy, ba = bdx * ady;
+    const auto abs = [](double a) { return a < 0.0 ? -a : a; };
+    permanent = (abs(bc) + abs(cb)) * abs(adz) + (abs(ca) + abs(ac)) * abs(bdz) + (abs(ab) + abs(ba)) * abs(cdz);
+    return adz * (bc - cb) + bdz * (ca - ac) + cdz * (ab - ba);
+}
+
+inline double incircle_det(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy, double& permanent)
+{
+    const double adx = ax - dx, ady = ay - dy;
+    const double bdx = bx - dx, bdy = by - dy;
+    const double cdx = cx - dx, cdy = cy - dy;
+    const double bc = bdx * cdy, cb = cdx * bdy, alift = adx * adx + ady * ady;
+    const double ca = cdx * ady, ac = adx * cdy, blift = bdx * bdx + bdy * bdy;
+    const double ab = adx * bdy, ba = bdx * ady, clift = cdx * cdx + cdy * cdy;
+    const auto abs = [](double a) { return a < 0.0 ? -a : a; };
+    permanent = (abs(bc) + abs(cb)) * alift + (abs(ca) + abs(ac)) * blift + (abs(ab) + abs(ba)) * clift;
+    return alift * (bc - cb) + blift * (ca - ac) + clift * (ab - ba);
+}
+
+inline bool certain(double det, double bound)      // The filter settles the sign
+{
+    return (det < 0.0 ? -det : det) > bound || bound == 0.0;
+}
+
+inline int tolerant_sign(double det, double bound)
+{
+    return (det < 0.0 ? -det : det) <= bound ? 0 : (det > 0.0 ? 1 : -1);
+}
+
+} // namespace vector_predicates_detail
+
+/* Exact, adaptive */
+
+template <typename T>
+inline double orient2d(const vector2<T>& a, const vector2<T>& b, const vector2<T>& c)
+{
+    using namespace vector_predicates_detail;
+    double p;
+    const double det = orient2d_det(a.x, a.y, b.x, b.y, c.x, c.y, p);
+    return certain(det, orient2d_bound * p) ? det : orient2d_exact(a.x, a.y, b.x, b.y, c.x, c.y);
+}
+
+template <typename T>
+inline double orient3d(const vector3<T>& a, const vector3<T>& b, const vector3<T>& c, const vector3<T>& d)
+{
+    using namespace vector_predicates_detail;
+    double p;
+    const double det = orient3d_det(a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z, d.x, d.y, d.z, p);
+    return certain(det, orient3d_bound * p) ? det : orient3d_exact(a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z, d.x, d.y, d.z);
+}
+
+template <typename T>
+inline double incircle(const vector2<T>& a, const vector2<T>& b, const vector2<T>& c, const vector2<T>& d)
+{
+    using namespace vector_predicates_detail;
+    double p;
+    const double det = incircle_det(a.x, a.y, b.x, b.y, c.x, c.y, d.x, d.y, p);
+    return certain(det, incircle_bound * p) ? det : incircle_exact(a.x, a.y, b.x, b.y, c.x, c.y, d.x, d.y);
+}
+
+/* With a relative tolerance, evaluated in double */
+
+template <typename T>
+inline int orient2d_eps(const vector2<T>& a, const vector2<T>& b, const vector2<T>& c, double eps)
+{
+    double p;
+    const double det = vector_predicates_detail::orient2d_det(a.x, a.y, b.x, b.y, c.x, c.y, p);
+    return vector_predicates_detail::tolerant_sign(det, eps * p);
+}
+
+template <typename T>
+inline int orient3d_eps(const vector3<T>& a, const vector3<T>& b, const vector3<T>& c, const vector3<T>& d, double eps)
+{
+    double p;
+    const double det = vector_predicates_detail::orient3d_det(a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z, d.x, d.y, d.z, p);
+    return vector_predicates_detail::tolerant_sign(det, eps * p);
+}
+
+template <typename T>
+inline int incircle_eps(const vector2<T>& a, const vector2<T>& b, const vector2<T>& c, const vector2<T>& d, double eps)
+{
+    double p;
+    const double det = vector_predicates_detail::incircle_det(a.x, a.y, b.x, b.y, c.x, c.y, d.x, d.y, p);
+    return vector_predicates_detail::tolerant_sign(det, eps * p);
+}
+
+/* Plain determinants in T */
+
+template <typename T>
+constexpr T orient2d_fast(const vector2<T>& a, const vector2<T>& b, const vector2<T>& c) noexcept
+{
+    return (a.x - c.x) * (b.y - c.y) - (a.y - c.y) * (b.x - c.x);
+}
+
+template <typename T>
+constexpr T orient3d_fast(const vector3<T>& a, const vector3<T>& b, const vector3<T>& c, const vector3<T>& d) noexcept
+{
+    return dot(a - d, cross(b - d, c - d));
+}
+
+template <typename T>
+constexpr T incircle_fast(const vector2<T>& a, const vector2<T>& b, const vector2<T>& c, const vector2<T>& d) noexcept
+{
+    const vector2<T> ad = a - d, bd = b - d, cd = c - d;
+    return ad.lengthsqr() * (bd.x * cd.y - cd.x * bd.y) + bd.lengthsqr() * (cd.x * ad.y - ad.x * cd.y) + cd.lengthsqr() * (ad.x * bd.y - bd.x * ad.y);
+}
+
+/* Scalar backend */
+
+namespace vector_predicates_scalar
+{
+
+template <typename T, bool Exact>
+void orient2d(const vector2<T>* a, const vector2<T>* b, const vector2<T>* c, double eps, std::uint64_t* positive, std::uint64_t* zero, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const double s = Exact ? ::orient2d(a[i], b[i], c[i]) : double(orient2d_eps(a[i], b[i], c[i], eps));
+        positive[i / 64] |= std::uint64_t(s > 0.0) << (i % 64);
+        if (zero)
+            zero[i / 64] |= std::uint64_t(s == 0.0) << (i % 64);
+    }
+}
+
+template <typename T, bool Exact>
+void orient3d(const vector3<T>* a, const vector3<T>* b, const vector3<T>* c, const vector3<T>* d, double eps, std::uint64_t* positive, std::uint64_t* zero, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const double s = Exact ? ::orient3d(a[i], b[i], c[i], d[i]) : double(orient3d_eps(a[i], b[i], c[i], d[i], eps));
+        positive[i / 64] |= std::uint64_t(s > 0.0) << (i % 64);
+        if (zero)
+            zero[i / 64] |= std::uint64_t(s == 0.0) << (i % 64);
+    }
+}
+
+template <typename T, bool Exact>
+void incircle(const vector2<T>* a, const vector2<T>* b, const vector2<T>* c, const vector2<T>* d, double eps, std::uint64_t* positive, std::uint64_t* zero, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const double s = Exact ? ::incircle(a[i], b[i], c[i], d[i]) : double(incircle_eps(a[i], b[i], c[i], d[i], eps));
+        positive[i / 64] |= std::uint64_t(s > 0.0) << (i % 64);
+        if (zero)
+            zero[i / 64] |= std::uint64_t(s == 0.0) << (i % 64);
+    }
+}
+
+}
+
+#if VECTOR3_SIMD_X86
+
+/* SSE4.1 backend, 2 lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_predicates_sse41
+{
+
+using vd = double __attribute__((vector_size(16)));
+using vl = long long __attribute__((vector_size(16)));
+
+#include "vector_predicates_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX2 backend, 4 lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_predicates_avx2
+{
+
+using vd = double __attribute__((vector_size(32)));
+using vl = long long __attribute__((vector_size(32)));
+
+#include "vector_predicates_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX-512 backend, 8 lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"  // False positives inside GCC's own avx512fintrin.h
+#endif
+
+namespace vector_predicates_avx512
+{
+
+using vd = double __attribute__((vector_size(64)));
+using vl = long long __attribute__((vector_size(64)));
+
+#include "vector_predicates_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+#endif // VECTOR3_SIMD_X86
+
+/* Dispatch on the active simd_level */
+
+#if VECTOR3_SIMD_X86
+#define VECTOR_PREDICATES_DISPATCH(...)                                     \
+    switch (active_simd_level())                                            \
+    {                                                                       \
+    case simd_level::avx512: vector_predicates_avx512::__VA_ARGS__; return; \
+    case simd_level::avx2:   vector_predicates_avx2::__VA_ARGS__;   return; \
+    case simd_level::sse41:  vector_predicates_sse41::__VA_ARGS__;  return; \
+    case simd_level::scalar: vector_predicates_scalar::__VA_ARGS__; return; \
+    }
+#else
+#define VECTOR_PREDICATES_DISPATCH(...) vector_predicates_scalar::__VA_ARGS__;
+#endif
+
+namespace vector_predicates_detail
+{
+
+inline std::uint64_t* clear_masks(std::size_t n, std::span<std::uint64_t> positive, std::span<std::uint64_t> zero)    // Returns zero.data(), or null when not wanted
+{
+    const std::size_t words = (n + 63) / 64;
+    assert(positive.size() >= words && (zero.empty() || zero.size() >= words));
+    std::memset(positive.data(), 0, words * sizeof(std::uint64_t));
+    if (zero.empty())
+        return nullptr;
+    std::memset(zero.data(), 0, words * sizeof(std::uint64_t));
+    return zero.data();
+}
+
+template <bool Exact, typename T>
+void orient2d(std::span<const vector2<T>> a, std::span<const vector2<T>> b, std::span<const vector2<T>> c, double eps,
+              std::span<std::uint64_t> positive, std::span<std::uint64_t> zero)
+{
+    assert(b.size() == a.size() && c.size() == a.size());
+    std::uint64_t* z = clear_masks(a.size(), positive, zero);
+    VECTOR_PREDICATES_DISPATCH(orient2d<T, Exact>(a.data(), b.data(), c.data(), eps, positive.data(), z, a.size()))
+}
+
+template <bool Exact, typename T>
+void orient3d(std::span<const vector3<T>> a, std::span<const vector3<T>> b, std::span<const vector3<T>> c, std::span<const vector3<T>> d, double eps,
+              std::span<std::uint64_t> positive, std::span<std::uint64_t> zero)
+{
+    assert(b.size() == a.size() && c.size() == a.size() && d.size() == a.size());
+    std::uint64_t* z = clear_masks(a.size(), positive, zero);
+    VECTOR_PREDICATES_DISPATCH(orient3d<T, Exact>(a.data(), b.data(), c.data(), d.data(), eps, positive.data(), z, a.size()))
+}
+
+template <bool Exact, typename T>
+void incircle(std::span<const vector2<T>> a, std::span<const vector2<T>> b, std::span<const vector2<T>> c, std::span<const vector2<T>> d, double eps,
+              std::span<std::uint64_t> positive, std::span<std::uint64_t> zero)
+{
+    assert(b.size() == a.size() && c.size() == a.size() && d.size() == a.size());
+    std::uint64_t* z = clear_masks(a.size(), positive, zero);
+    VECTOR_PREDICATES_DISPATCH(incircle<T, Exact>(a.data(), b.data(), c.data(), d.data(), eps, positive.data(), z, a.size()))
+}
+
+} // namespace vector_predicates_detail
+
+#undef VECTOR_PREDICATES_DISPATCH
+
+/* Batch predicates. positive (and zero, when not empty) hold at least (n + 63) / 64 words */
+
+inline void batch_orient2d(std::span<const vector2<float>> a, std::span<const vector2<float>> b, std::span<const vector2<float>> c,
+                           std::span<std::uint64_t> positive, std::span<std::uint64_t> zero = {})
+{
+    vector_predicates_detail::orient2d<true>(a, b, c, 0.0, positive, zero);
+}
+
+inline void batch_orient2d(std::span<const vector2<double>> a, std::span<const vector2<double>> b, std::span<const vector2<double>> c,
+                           std::span<std::uint64_t> positive, std::span<std::uint64_t> zero = {})
+{
+    vector_predicates_detail::orient2d<true>(a, b, c, 0.0, positive, zero);
+}
+
+inline void batch_orient2d_eps(std::span<const vector2<float>> a, std::span<const vector2<float>> b, std::span<const vector2<float>> c, double eps,
+                               std::span<std::uint64_t> positive, std::span<std::uint64_t> zero = {})
+{
+    vector_predicates_detail::orient2d<false>(a, b, c, eps, positive, zero);
+}
+
+inline void batch_orient2d_eps(std::span<const vector2<double>> a, std::span<const vector2<double>> b, std::span<const vector2<double>> c, double eps,
+                               std::span<std::uint64_t> positive, std::span<std::uint64_t> zero = {})
+{
+    vector_predicates_detail::orient2d<false>(a, b, c, eps, positive, zero);
+}
+
+inline void batch_orient3d(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<const vector3<float>> c, std::span<const vector3<float>> d,
+                           std::span<std::uint64_t> positive, std::span<std::uint64_t> zero = {})
+{
+    vector_predicates_detail::orient3d<true>(a, b, c, d, 0.0, positive, zero);
+}
+
+inline void batch_orient3d(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<const vector3<double>> c, std::span<const vector3<double>> d,
+                           std::span<std::uint64_t> positive, std::span<std::uint64_t> zero = {})
+{
+    vector_predicates_detail::orient3d<true>(a, b, c, d, 0.0, positive, zero);
+}
+
+inline void batch_orient3d_eps(std::span<const vector3<float>> a, std::span<const vector3<float>> b, std::span<const vector3<float>> c, std::span<const vector3<float>> d,
+                               double eps, std::span<std::uint64_t> positive, std::span<std::uint64_t> zero = {})
+{
+    vector_predicates_detail::orient3d<false>(a, b, c, d, eps, positive, zero);
+}
+
+inline void batch_orient3d_eps(std::span<const vector3<double>> a, std::span<const vector3<double>> b, std::span<const vector3<double>> c, std::span<const vector3<double>> d,
+                               double eps, std::span<std::uint64_t> positive, std::span<std::uint64_t> zero = {})
+{
+    vector_predicates_detail::orient3d<false>(a, b, c, d, eps, positive, zero);
+}
+
+inline void batch_incircle(std::span<const vector2<float>> a, std::span<const vector2<float>> b, std::span<const vector2<float>> c, std::span<const vector2<float>> d,
+                           std::span<std::uint64_t> positive, std::span<std::uint64_t> zero = {})
+{
+    vector_predicates_detail::incircle<true>(a, b, c, d, 0.0, positive, zero);
+}
+
+inline void batch_incircle(std::span<const vector2<double>> a, std::span<const vector2<double>> b, std::span<const vector2<double>> c, std::span<const vector2<double>> d,
+                           std::span<std::uint64_t> positive, std::span<std::uint64_t> zero = {})
+{
+    vector_predicates_detail::incircle<true>(a, b, c, d, 0.0, positive, zero);
+}
+
+inline void batch_incircle_eps(std::span<const vector2<float>> a, std::span<const vector2<float>> b, std::span<const vector2<float>> c, std::span<const vector2<float>> d,
+                               double eps, std::span<std::uint64_t> positive, std::span<std::uint64_t> zero = {})
+{
+    vector_predicates_detail::incircle<false>(a, b, c, d, eps, positive, zero);
+}
+
+inline void batch_incircle_eps(std::span<const vector2<double>> a, std::span<const vector2<double>> b, std::span<const vector2<double>> c, std::span<const vector2<double>> d,
+                               double eps, std::span<std::uint64_t> positive, std::span<std::uint64_t> zero = {})
+{
+    vector_predicates_detail::incircle<false>(a, b, c, d, eps, positive, zero);
+}
+
+#endif
@@ -0,0 +1,169 @@
+// Batch predicate filters shared by the SIMD backends. This file is included once per
+// instruction set from vector_predicates.hpp, inside a namespace that defines vd and
+// vl (GCC/clang vector extension types of doubles and 64 bit ints of the register
+// width), so it intentionally has no include guard.
+//
+// Each kernel walks the input in blocks: the AoS points are converted into double
+// component arrays, every lane evaluates the determinant and its permanent with the
+// operations of the scalar filters in vector_predicates_detail, in the same order,
+// and the lanes the filter cannot settle are recomputed one by one with the exact
+// expansions. So every backend returns the bits of the single calls.
+
+constexpr std::size_t width = sizeof(vd) / sizeof(double);
+constexpr std::size_t block = 256;      // Elements per block, a multiple of 64 and of every width
+
+inline vd   splat(double a)                 { return vd{} + a; }
+inline vd   select(vl m, vd a, vd b)        { return vd(((vl)a & m) | ((vl)b & ~m)); }     // a where m is set, else b
+inline vd   absd(vd a)                      { return select(a < splat(0.0), -a, a); }
+inline vd   load(const double* p)           { vd a; std::memcpy(&a, p, sizeof(a)); return a; }
+inline void store(double* p, vd a)          { std::memcpy(p, &a, sizeof(a)); }
+inline void storel(long long* p, vl a)      { std::memcpy(p, &a, sizeof(a)); }
+
+// Lane results: det where the filter is certain (sure set), in Exact mode; with a
+// tolerance, det is zeroed inside it and every lane is sure.
+template <bool Exact>
+inline void result(vd det, vd bound, double* d, long long* sure)
+{
+    if constexpr (Exact)
+    {
+        store(d, det);
+        storel(sure, (absd(det) > bound) | (bound == splat(0.0)));
+    }
+    else
+    {
+        store(d, select(absd(det) <= bound, splat(0.0), det));
+        storel(sure, vl{} - 1);
+    }
+}
+
+// Writes the bits of elements first .. first + m; exact(k) settles lane k of the block
+template <typename F>
+inline void emit(std::size_t first, std::size_t m, const double* d, const long long* sure, std::uint64_t* positive, std::uint64_t* zero, F exact)
+{
+    for (std::size_t k = 0; k < m; ++k)
+    {
+        const double s = sure[k] ? d[k] : exact(k);
+        const std::size_t i = first + k;
+        positive[i / 64] |= std::uint64_t(s > 0.0) << (i % 64);
+        if (zero)
+            zero[i / 64] |= std::uint64_t(s == 0.0) << (i % 64);
+    }
+}
+
+template <typename T, bool Exact>
+void orient2d(const vector2<T>* a, const vector2<T>* b, const vector2<T>* c, double eps, std::uint64_t* positive, std::uint64_t* zero, std::size_t n)
+{
+    alignas(64) double ax[block], ay[block], bx[block], by[block], cx[block], cy[block], d[block];
+    alignas(64) long long sure[block];
+    const vd e = splat(Exact ? vector_predicates_detail::orient2d_bound : eps);
+
+    for (std::size_t i = 0; i < n; i += block)
+    {
+        const std::size_t m = n - i < block ? n - i : block;
+        const std::size_t mw = (m + width - 1) / width * width;
+        for (std::size_t k = 0; k < m; ++k)
+        {
+            ax[k] = a[i + k].x; ay[k] = a[i + k].y;
+            bx[k] = b[i + k].x; by[k] = b[i + k].y;
+            cx[k] = c[i + k].x; cy[k] = c[i + k].y;
+        }
+        for (std::size_t k = m; k < mw; ++k)
+            ax[k] = ay[k] = bx[k] = by[k] = cx[k] = cy[k] = 0.0;
+
+        for (std::size_t k = 0; k < mw; k += width)
+        {
+            const vd pcx = load(cx + k), pcy = load(cy + k);
+            const vd l = (load(ax + k) - pcx) * (load(by + k) - pcy);
+            const vd r = (load(ay + k) - pcy) * (load(bx + k) - pcx);
+            result<Exact>(l - r, e * (absd(l) + absd(r)), d + k, sure + k);
+        }
+
+        emit(i, m, d, sure, positive, zero, [&](std::size_t k)
+        {
+            return vector_predicates_detail::orient2d_exact(ax[k], ay[k], bx[k], by[k], cx[k], cy[k]);
+        });
+    }
+}
+
+template <typename T, bool Exact>
+void orient3d(const vector3<T>* a, const vector3<T>* b, const vector3<T>* c, const vector3<T>* p, double eps, std::uint64_t* positive, std::uint64_t* zero, std::size_t n)
+{
+    alignas(64) double ax[block], ay[block], az[block], bx[block], by[block], bz[block];
+    alignas(64) double cx[block], cy[block], cz[block], dx[block], dy[block], dz[block], d[block];
+    alignas(64) long long sure[block];
+    const vd e = splat(Exact ? vector_predicates_detail::orient3d_bound : eps);
+
+    for (std::size_t i = 0; i < n; i += block)
+    {
+        const std::size_t m = n - i < block ? n - i : block;
+        const std::size_t mw = (m + width - 1) / width * width;
+        for (std::size_t k = 0; k < m; ++k)
+        {
+            ax[k] = a[i + k].x; ay[k] = a[i + k].y; az[k] = a[i + k].z;
+            bx[k] = b[i + k].x; by[k] = b[i + k].y; bz[k] = b[i + k].z;
+            cx[k] = c[i + k].x; cy[k] = c[i + k].y; cz[k] = c[i + k].z;
+            dx[k] = p[i + k].x; dy[k] = p[i + k].y; dz[k] = p[i + k].z;
+        }
+        for (std::size_t k = m; k < mw; ++k)
+            ax[k] = ay[k] = az[k] = bx[k] = by[k] = bz[k] = cx[k] = cy[k] = cz[k] = dx[k] = dy[k] = dz[k] = 0.0;
+
+        for (std::size_t k = 0; k < mw; k += width)
+        {
+            const vd pdx = load(dx + k), pdy = load(dy + k), pdz = load(dz + k);
+            const vd adx = load(ax + k) - pdx, ady = load(ay + k) - pdy, adz = load(az + k) - pdz;
+            const vd bdx = load(bx + k) - pdx, bdy = load(by + k) - pdy, bdz = load(bz + k) - pdz;
+            const vd cdx = load(cx + k) - pdx, cdy = load(cy + k) - pdy, cdz = load(cz + k) - pdz;
+            const vd bc = bdx * cdy, cb = cdx * bdy;
+            const vd ca = cdx * ady, ac = adx * cdy;
+            const vd ab = adx * bdy, ba = bdx * ady;
+            const vd perm = (absd(bc) + absd(cb)) * absd(adz) + (absd(ca) + absd(ac)) * absd(bdz) + (absd(ab) + absd(ba)) * absd(cdz);
+            result<Exact>(adz * (bc - cb) + bdz * (ca - ac) + cdz * (ab - ba), e * perm, d + k, sure + k);
+        }
+
+        emit(i, m, d, sure, positive, zero, [&](std::size_t k)
+        {
+            return vector_predicates_detail::orient3d_exact(ax[k], ay[k], az[k], bx[k], by[k], bz[k], cx[k], cy[k], cz[k], dx[k], dy[k], dz[k]);
+        });
+    }
+}
+
+template <typename T, bool Exact>
+void incircle(const vector2<T>* a, const vector2<T>* b, const vector2<T>* c, const vector2<T>* p, double eps, std::uint64_t* positive, std::uint64_t* zero, std::size_t n)
+{
+    alignas(64) double ax[block], ay[block], bx[block], by[block], cx[block], cy[block], dx[block], dy[block], d[block];
+    alignas(64) long long sure[block];
+    const vd e = splat(Exact ? vector_predicates_detail::incircle_bound : eps);
+
+    for (std::size_t i = 0; i < n; i += block)
+    {
+        const std::size_t m = n - i < block ? n - i : block;
+        const std::size_t mw = (m + width - 1) / width * width;
+        for (std::size_t k = 0; k < m; ++k)
+        {
+            ax[k] = a[i + k].x; ay[k] = a[i + k].y;
+            bx[k] = b[i + k].x; by[k] = b[i + k].y;
+            cx[k] = c[i + k].x; cy[k] = c[i + k].y;
+            dx[k] = p[i + k].x; dy[k] = p[i + k].y;
+        }
+        for (std::size_t k = m; k < mw; ++k)
+            ax[k] = ay[k] = bx[k] = by[k] = cx[k] = cy[k] = dx[k] = dy[k] = 0.0;
+
+        for (std::size_t k = 0; k < mw; k += width)
+        {
+            const vd pdx = load(dx + k), pdy = load(dy + k);
+            const vd adx = load(ax + k) - pdx, ady = load(ay + k) - pdy;
+            const vd bdx = load(bx + k) - pdx, bdy = load(by + k) - pdy;
+            const vd cdx = load(cx + k) - pdx, cdy = load(cy + k) - pdy;
+            const vd bc = bdx * cdy, cb = cdx * bdy, alift = adx * adx + ady * ady;
+            const vd ca = cdx * ady, ac = adx * cdy, blift = bdx * bdx + bdy * bdy;
+            const vd ab = adx * bdy, ba = bdx * ady, clift = cdx * cdx + cdy * cdy;
+            const vd perm = (absd(bc) + absd(cb)) * alift + (absd(ca) + absd(ac)) * blift + (absd(ab) + absd(ba)) * clift;
+            result<Exact>(alift * (bc - cb) + blift * (ca - ac) + clift * (ab - ba), e * perm, d + k, sure + k);
+        }
+
+        emit(i, m, d, sure, positive, zero, [&](std::size_t k)
+        {
+            return vector_predicates_detail::incircle_exact(ax[k], ay[k], bx[k], by[k], cx[k], cy[k], dx[k], dy[k]);
+        });
+    }
+}
@@ -0,0 +1,649 @@
+#ifndef VECTOR_RAY_H
+#define VECTOR_RAY_H
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#include "vector3.hpp"
+#include "vector3_simd.hpp"
+#include "vector_soa.hpp"
+#include "vector_thread_pool.hpp"
+
+// Ray intersection tests against triangles, axis aligned boxes and spheres.
+//
+//     intersect_triangle  Moller-Trumbore, two sided; t and the barycentric u, v of the
+//                         hit, which is (1 - u - v) a + u b + v c
+//     intersect_box       slab test; the entry and exit distances clipped to the ray
+//     intersect_sphere    the nearest root in the ray interval, the exit root when the
+//                         origin is inside
+//
+// A hit needs tmin <= t <= tmax. Directions need not be unit length, t is in units of
+// dir. Degenerate triangles and rays parallel to a triangle miss; a ray lying in a
+// slab plane counts as inside that slab, so boxes are closed.
+//
+// triangle_soa keeps a triangle as a vertex and its two edges in nine component
+// streams. The batch forms test one ray against all of them, or against boxes and
+// spheres in SoA form, write bitmasks like the batch predicates (bit i % 64 of word
+// i / 64 for element i), and follow the vector3_simd dispatch (set_simd_level
+// applies). Every backend evaluates the operations of the single ray tests in the
+// same order, and both are built without FMA contraction, so the results agree bit
+// for bit with them, -mfma or not. closest_hit breaks ties in t by index and any_hit
+// stops at the first hit. The ray batches split the rays into ray_block sized blocks
+// on an optional pool, which changes nothing in the results.
+// For packets of rays traversing the same primitives see vector_ray_packet.hpp.
+
+constexpr std::size_t ray_block = 64;      // Rays per parallel block
+
+constexpr std::uint32_t ray_miss = ~std::uint32_t(0);
+
+template <typename T>
+struct ray
+{
+    vector3<T> origin;
+    vector3<T> dir;
+    vector3<T> inv_dir;     // 1 / dir per component, infinite for zero components
+    T          tmin;
+    T          tmax;
+
+    /* ctors */
+    ray() = default;
+    ray(const vector3<T>& o, const vector3<T>& d, T t0 = T(0), T t1 = std::numeric_limits<T>::infinity());
+
+    vector3<T> at(T t) const;       // origin + dir * t
+};
+
+template <typename T>
+struct ray_hit
+{
+    std::uint32_t index;    // ray_miss when nothing was hit
+    T             t;
+    T             u;        // Barycentrics of the hit
+    T             v;
+};
+
+template <typename T>
+inline ray<T>::ray(const vector3<T>& o, const vector3<T>& d, T t0, T t1)
+    : origin(o), dir(d), inv_dir(T(1) / d.x, T(1) / d.y, T(1) / d.z), tmin(t0), tmax(t1) {}
+
+template <typename T>
+inline vector3<T> ray<T>::at(T t) const
+{
+    return origin + dir * t;
+}
+
+/* Triangles in structure-of-arrays form: v0, e1 = v1 - v0 and e2 = v2 - v0, component streams 0..8 */
+
+template <typename T>
+struct triangle_soa
+{
+    soa_buffer<T, 9> buf;
+
+    /* ctors */
+    triangle_soa() = default;
+    triangle_soa(const vector3<T>* v, std::size_t n);       // n triangles from 3 n vertices
+
+    std::size_t size() const;
+    bool        empty() const;
+    void        reserve(std::size_t n);
+    void        clear();
+    void        push_back(const vector3<T>& a, const vector3<T>& b, const vector3<T>& c);
+
+    vector3<T> vertex(std::size_t i) const;     // v0 of triangle i
+    vector3<T> edge1(std::size_t i) const;
+    vector3<T> edge2(std::size_t i) const;
+};
+
+template <typename T>
+inline triangle_soa<T>::triangle_soa(const vector3<T>* v, std::size_t n)
+{
+    reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        push_back(v[3 * i], v[3 * i + 1], v[3 * i + 2]);
+}
+
+template <typename T>
+inline std::size_t triangle_soa<T>::size() const { return buf.count; }
+
+template <typename T>
+inline bool triangle_soa<T>::empty() const { return buf.count == 0; }
+
+template <typename T>
+inline void triangle_soa<T>::reserve(std::size_t n) { buf.reserve(n); }
+
+template <typename T>
+inline void triangle_soa<T>::clear() { buf.count = 0; }
+
+template <typename T>
+inline void triangle_soa<T>::push_back(const vector3<T>& a, const vector3<T>& b, const vector3<T>& c)
+{
+    if (buf.count == buf.capacity)
+        buf.reserve(buf.capacity ? buf.capacity * 2 : 1);
+    const vector3<T> e1 = b - a;
+    const vector3<T> e2 = c - a;
+    const T s[9] = { a.x, a.y, a.z, e1.x, e1.y, e1.z, e2.x, e2.y, e2.z };
+    for (std::size_t k = 0; k < 9; ++k)
+        buf.stream(k)[buf.count] = s[k];
+    ++buf.count;
+}
+
+template <typename T>
+inline vector3<T> triangle_soa<T>::vertex(std::size_t i) const { return vector3<T>(buf.stream(0)[i], buf.stream(1)[i], buf.stream(2)[i]); }
+
+template <typename T>
+inline vector3<T> triangle_soa<T>::edge1(std::size_t i) const { return vector3<T>(buf.stream(3)[i], buf.stream(4)[i], buf.stream(5)[i]); }
+
+template <typename T>
+inline vector3<T> triangle_soa<T>::edge2(std::size_t i) const { return vector3<T>(buf.stream(6)[i], buf.stream(7)[i], buf.stream(8)[i]); }
+
+// The single ray tests and the scalar backend are compiled without FMA contraction,
+// like the SIMD kernels, so they round the same way under -mfma or -march=native
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_ray_detail
+{
+
+/* The single ray tests; the SIMD kernels repeat these operations lane by lane */
+
+template <typename T>
+inline bool triangle(const ray<T>& r, const vector3<T>& v0, const vector3<T>& e1, const vector3<T>& e2, T& t, T& u, T& v)
+{
+    const vector3<T> p = r.dir.cross(e2);
+    const T det = e1.dot(p);
+    const T inv = T(1) / det;
+    const vector3<T> s = r.origin - v0;
+    const T a = s.dot(p) * inv;
+    if (!(det != T(0) && a >= T(0) && a <= T(1)))      // Also rejects NaN
+        return false;
+    const vector3<T> q = s.cross(e1);
+    const T b = r.dir.dot(q) * inv;
+    if (!(b >= T(0) && a + b <= T(1)))
+        return false;
+    const T d = e2.dot(q) * inv;
+    if (!(d >= r.tmin && d <= r.tmax))
+        return false;
+    t = d;
+    u = a;
+    v = b;
+    return true;
+}
+
+template <typename T>
+inline void slab(T lo, T hi, T o, T inv, T& t0, T& t1)      // A NaN bound, 0 * inf for an origin in a slab plane, leaves t0 and t1 alone
+{
+    const T a = (lo - o) * inv;
+    const T b = (hi - o) * inv;
+    if (a > t0 && b > t0)       // max(t0, min(a, b))
+        t0 = a < b ? a : b;
+    if (a < t1 && b < t1)       // min(t1, max(a, b))
+        t1 = a < b ? b : a;
+}
+
+template <typename T>
+inline bool box(const ray<T>& r, const vector3<T>& lo, const vector3<T>& hi, T& t0, T& t1)
+{
+    T n = r.tmin;
+    T f = r.tmax;
+    slab(lo.x, hi.x, r.origin.x, r.inv_dir.x, n, f);
+    slab(lo.y, hi.y, r.origin.y, r.inv_dir.y, n, f);
+    slab(lo.z, hi.z, r.origin.z, r.inv_dir.z, n, f);
+    if (!(n <= f))
+        return false;
+    t0 = n;
+    t1 = f;
+    return true;
+}
+
+// b^2 - a c written as a (radius^2 - |l|^2), l the part of the origin offset normal to
+// dir, which does not cancel for spheres far from the origin
+template <typename T>
+inline bool sphere(const ray<T>& r, const vector3<T>& center, T radius, T& t)
+{
+    const vector3<T> oc = r.origin - center;
+    const T a = r.dir.dot(r.dir);
+    const T b = oc.dot(r.dir);
+    const vector3<T> l = oc - r.dir * (b / a);
+    const T disc = a * (radius * radius - l.dot(l));
+    if (!(disc >= T(0)))
+        return false;
+    const T s = std::sqrt(disc);
+    const T n = (-b - s) / a;
+    const T d = n >= r.tmin ? n : (-b + s) / a;
+    if (!(d >= r.tmin && d <= r.tmax))
+        return false;
+    t = d;
+    return true;
+}
+
+template <typename T>
+inline vector3<T> at(const T* const* s, std::size_t i)     // Element i of three component streams
+{
+    return vector3<T>(s[0][i], s[1][i], s[2][i]);
+}
+
+template <typename T>
+inline bool triangle(const ray<T>& r, const T* const* s, std::size_t i, T& t)
+{
+    T u, v;
+    return triangle(r, at(s, i), at(s + 3, i), at(s + 6, i), t, u, v);
+}
+
+} // namespace vector_ray_detail
+
+/* Single rays */
+
+template <typename T>
+inline bool intersect_triangle(const ray<T>& r, const vector3<T>& a, const vector3<T>& b, const vector3<T>& c, T& t, T& u, T& v)
+{
+    return vector_ray_detail::triangle(r, a, b - a, c - a, t, u, v);
+}
+
+template <typename T>
+inline bool intersect_box(const ray<T>& r, const vector3<T>& lo, const vector3<T>& hi, T& t0, T& t1)
+{
+    return vector_ray_detail::box(r, lo, hi, t0, t1);
+}
+
+template <typename T>
+inline bool intersect_sphere(const ray<T>& r, const vector3<T>& center, T radius, T& t)
+{
+    return vector_ray_detail::sphere(r, center, radius, t);
+}
+
+/* Scalar backend */
+
+namespace vector_ray_scalar
+{
+
+template <typename T>
+void triangles(const ray<T>& r, const T* const* s, std::size_t n, std::uint64_t* hit)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        T t;
+        hit[i / 64] |= std::uint64_t(vector_ray_detail::triangle(r, s, i, t)) << (i % 64);
+    }
+}
+
+template <typename T>
+void closest(const ray<T>& r, const T* const* s, std::size_t n, ray_hit<T>* out)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        T t;
+        if (vector_ray_detail::triangle(r, s, i, t) && t < out->t)
+        {
+            out->index = std::uint32_t(i);
+            out->t = t;
+        }
+    }
+}
+
+template <typename T>
+void any(const ray<T>& r, const T* const* s, std::size_t n, bool* out)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        T t;
+        if (vector_ray_detail::triangle(r, s, i, t))
+        {
+            *out = true;
+            return;
+        }
+    }
+}
+
+template <typename T>
+void boxes(const ray<T>& r, const T* const* s, std::size_t n, std::uint64_t* hit)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        T t0, t1;
+        hit[i / 64] |= std::uint64_t(vector_ray_detail::box(r, vector_ray_detail::at(s, i), vector_ray_detail::at(s + 3, i), t0, t1)) << (i % 64);
+    }
+}
+
+template <typename T>
+void spheres(const ray<T>& r, const T* const* s, const T* radius, std::size_t n, std::uint64_t* hit)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        T t;
+        hit[i / 64] |= std::uint64_t(vector_ray_detail::sphere(r, vector_ray_detail::at(s, i), radius[i], t)) << (i % 64);
+    }
+}
+
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+#if VECTOR3_SIMD_X86
+
+/* SSE4.1 backend, 4 float or 2 double lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_ray_sse41
+{
+
+using vf = float __attribute__((vector_size(16)));
+using vi = int __attribute__((vector_size(16)));
+using vd = double __attribute__((vector_size(16)));
+using vl = long long __attribute__((vector_size(16)));
+
+inline vf vsqrt(vf a) { return vf(_mm_sqrt_ps(__m128(a))); }
+inline vd vsqrt(vd a) { return vd(_mm_sqrt_pd(__m128d(a))); }
+
+#include "vector_ray_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX2 backend, 8 float or 4 double lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_ray_avx2
+{
+
+using vf = float __attribute__((vector_size(32)));
+using vi = int __attribute__((vector_size(32)));
+using vd = double __attribute__((vector_size(32)));
+using vl = long long __attribute__((vector_size(32)));
+
+inline vf vsqrt(vf a) { return vf(_mm256_sqrt_ps(__m256(a))); }
+inline vd vsqrt(vd a) { return vd(_mm256_sqrt_pd(__m256d(a))); }
+
+#include "vector_ray_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX-512 backend, 16 float or 8 double lanes */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"  // False positives inside GCC's own avx512fintrin.h
+#endif
+
+namespace vector_ray_avx512
+{
+
+using vf = float __attribute__((vector_size(64)));
+using vi = int __attribute__((vector_size(64)));
+using vd = double __attribute__((vector_size(64)));
+using vl = long long __attribute__((vector_size(64)));
+
+inline vf vsqrt(vf a) { return vf(_mm512_maskz_sqrt_ps(__mmask16(0xffff), __m512(a))); }
+inline vd vsqrt(vd a) { return vd(_mm512_maskz_sqrt_pd(__mmask8(0xff), __m512d(a))); }
+
+#include "vector_ray_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+#endif // VECTOR3_SIMD_X86
+
+/* Dispatch on the active simd_level */
+
+#if VECTOR3_SIMD_X86
+#define VECTOR_RAY_DISPATCH(...)                                        \
+    switch (active_simd_level())                                        \
+    {                                                                   \
+    case simd_level::avx512: vector_ray_avx512::__VA_ARGS__; return;    \
+    case simd_level::avx2:   vector_ray_avx2::__VA_ARGS__;   return;    \
+    case simd_level::sse41:  vector_ray_sse41::__VA_ARGS__;  return;    \
+    case simd_level::scalar: vector_ray_scalar::__VA_ARGS__; return;    \
+    }
+#else
+#define VECTOR_RAY_DISPATCH(...) vector_ray_scalar::__VA_ARGS__;
+#endif
+
+namespace vector_ray_detail
+{
+
+inline void clear_mask(std::size_t n, std::span<std::uint64_t> hit)
+{
+    const std::size_t words = (n + 63) / 64;
+    assert(hit.size() >= words);
+    std::memset(hit.data(), 0, words * sizeof(std::uint64_t));
+}
+
+template <typename T>
+struct streams      // Component stream pointers of a triangle_soa, or of a lo / hi box pair
+{
+    const T* s[9];
+
+    explicit streams(const triangle_soa<T>& tris)
+    {
+        for (std::size_t k = 0; k < 9; ++k)
+            s[k] = tris.buf.stream(k);
+    }
+
+    streams(const vector3_soa<T>& a, const vector3_soa<T>& b)
+        : s{ a.x_ptr(), a.y_ptr(), a.z_ptr(), b.x_ptr(), b.y_ptr(), b.z_ptr(), nullptr, nullptr, nullptr } {}
+};
+
+template <typename T>
+void triangles(const ray<T>& r, const triangle_soa<T>& tris, std::span<std::uint64_t> hit)
+{
+    clear_mask(tris.size(), hit);
+    const streams<T> p(tris);
+    VECTOR_RAY_DISPATCH(triangles<T>(r, p.s, tris.size(), hit.data()))
+}
+
+template <typename T>
+void closest(const ray<T>& r, const streams<T>& p, std::size_t n, ray_hit<T>* out)
+{
+    VECTOR_RAY_DISPATCH(closest<T>(r, p.s, n, out))
+}
+
+template <typename T>
+ray_hit<T> closest(const ray<T>& r, const triangle_soa<T>& tris, const streams<T>& p)
+{
+    ray_hit<T> h{ ray_miss, std::numeric_limits<T>::infinity(), T(0), T(0) };
+    closest(r, p, tris.size(), &h);
+    if (h.index != ray_miss)        // Same bits as the kernel lane that found it
+        triangle(r, tris.vertex(h.index), tris.edge1(h.index), tris.edge2(h.index), h.t, h.u, h.v);
+    return h;
+}
+
+template <typename T>
+void any(const ray<T>& r, const streams<T>& p, std::size_t n, bool* out)
+{
+    VECTOR_RAY_DISPATCH(any<T>(r, p.s, n, out))
+}
+
+template <typename T>
+void boxes(const ray<T>& r, const vector3_soa<T>& lo, const vector3_soa<T>& hi, std::span<std::uint64_t> hit)
+{
+    assert(hi.size() == lo.size());
+    clear_mask(lo.size(), hit);
+    const streams<T> p(lo, hi);
+    VECTOR_RAY_DISPATCH(boxes<T>(r, p.s, lo.size(), hit.data()))
+}
+
+template <typename T>
+void spheres(const ray<T>& r, const vector3_soa<T>& center, std::span<const T> radius, std::span<std::uint64_t> hit)
+{
+    assert(radius.size() == center.size());
+    clear_mask(center.size(), hit);
+    const T* s[3] = { center.x_ptr(), center.y_ptr(), center.z_ptr() };
+    VECTOR_RAY_DISPATCH(spheres<T>(r, s, radius.data(), center.size(), hit.data()))
+}
+
+template <typename F>
+void blocks(std::size_t n, vector_thread_pool* pool, F&& f)        // f(i) for every ray, ray_block rays per block
+{
+    const std::size_t count = (n + ray_block - 1) / ray_block;
+    const auto block = [&](std::size_t b)
+    {
+        const std::size_t last = (b + 1) * ray_block < n ? (b + 1) * ray_block : n;
+        for (std::size_t i = b * ray_block; i < last; ++i)
+            f(i);
+    };
+    if (pool && count > 1)
+        pool->parallel_for(count, block);
+    else
+        for (std::size_t b = 0; b < count; ++b)
+            block(b);
+}
+
+template <typename T>
+void batch_closest(std::span<const ray<T>> rays, const triangle_soa<T>& tris, std::span<ray_hit<T>> out, vector_thread_pool* pool)
+{
+    assert(out.size() >= rays.size());
+    const streams<T> p(tris);
+    blocks(rays.size(), pool, [&](std::size_t i) { out[i] = closest(rays[i], tris, p); });
+}
+
+template <typename T>
+void batch_occluded(std::span<const ray<T>> rays, const triangle_soa<T>& tris, std::span<std::uint64_t> hit, vector_thread_pool* pool)
+{
+    const std::size_t words = (rays.size() + 63) / 64;
+    assert(hit.size() >= words);
+    const streams<T> p(tris);
+    const auto word = [&](std::size_t w)        // Whole words, so no two threads share one
+    {
+        std::uint64_t bits = 0;
+        for (std::size_t i = w * 64; i < rays.size() && i < w * 64 + 64; ++i)
+        {
+            bool found = false;
+            any(rays[i], p, tris.size(), &found);
+            bits |= std::uint64_t(found) << (i % 64);
+        }
+        hit[w] = bits;
+    };
+    if (pool && words > 1)
+        pool->parallel_for(words, word);
+    else
+        for (std::size_t w = 0; w < words; ++w)
+            word(w);
+}
+
+} // namespace vector_ray_detail
+
+#undef VECTOR_RAY_DISPATCH
+
+/* One ray against many primitives. hit holds at least (n + 63) / 64 words */
+
+inline void batch_intersect_triangles(const ray<float>& r, const triangle_soa<float>& tris, std::span<std::uint64_t> hit)
+{
+    vector_ray_detail::triangles(r, tris, hit);
+}
+
+inline void batch_intersect_triangles(const ray<double>& r, const triangle_soa<double>& tris, std::span<std::uint64_t> hit)
+{
+    vector_ray_detail::triangles(r, tris, hit);
+}
+
+inline void batch_intersect_boxes(const ray<float>& r, const vector3_soa<float>& lo, const vector3_soa<float>& hi, std::span<std::uint64_t> hit)
+{
+    vector_ray_detail::boxes(r, lo, hi, hit);
+}
+
+inline void batch_intersect_boxes(const ray<double>& r, const vector3_soa<double>& lo, const vector3_soa<double>& hi, std::span<std::uint64_t> hit)
+{
+    vector_ray_detail::boxes(r, lo, hi, hit);
+}
+
+inline void batch_intersect_spheres(const ray<float>& r, const vector3_soa<float>& center, std::span<const float> radius, std::span<std::uint64_t> hit)
+{
+    vector_ray_detail::spheres(r, center, radius, hit);
+}
+
+inline void batch_intersect_spheres(const ray<double>& r, const vector3_soa<double>& center, std::span<const double> radius, std::span<std::uint64_t> hit)
+{
+    vector_ray_detail::spheres(r, center, radius, hit);
+}
+
+inline ray_hit<float> closest_hit(const ray<float>& r, const triangle_soa<float>& tris)
+{
+    return vector_ray_detail::closest(r, tris, vector_ray_detail::streams<float>(tris));
+}
+
+inline ray_hit<double> closest_hit(const ray<double>& r, const triangle_soa<double>& tris)
+{
+    return vector_ray_detail::closest(r, tris, vector_ray_detail::streams<double>(tris));
+}
+
+inline bool any_hit(const ray<float>& r, const triangle_soa<float>& tris)
+{
+    bool found = false;
+    vector_ray_detail::any(r, vector_ray_detail::streams<float>(tris), tris.size(), &found);
+    return found;
+}
+
+inline bool any_hit(const ray<double>& r, const triangle_soa<double>& tris)
+{
+    bool found = false;
+    vector_ray_detail::any(r, vector_ray_detail::streams<double>(tris), tris.size(), &found);
+    return found;
+}
+
+/* Many rays against the same triangles, optionally on a thread pool */
+
+inline void batch_closest_hit(std::span<const ray<float>> rays, const triangle_soa<float>& tris, std::span<ray_hit<float>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_ray_detail::batch_closest(rays, tris, out, pool);
+}
+
+inline void batch_closest_hit(std::span<const ray<double>> rays, const triangle_soa<double>& tris, std::span<ray_hit<double>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_ray_detail::batch_closest(rays, tris, out, pool);
+}
+
+inline void batch_occluded(std::span<const ray<float>> rays, const triangle_soa<float>& tris, std::span<std::uint64_t> hit, vector_thread_pool* pool = nullptr)    // Bit i set when ray i hits any triangle
+{
+    vector_ray_detail::batch_occluded(rays, tris, hit, pool);
+}
+
+inline void batch_occluded(std::span<const ray<double>> rays, const triangle_soa<double>& tris, std::span<std::uint64_t> hit, vector_thread_pool* pool = nullptr)
+{
+    vector_ray_detail::batch_occluded(rays, tris, hit, pool);
+}
+
+#endif
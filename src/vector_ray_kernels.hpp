@@ -0,0 +1,234 @@
+// Ray batch kernels shared by the SIMD backends. This file is included once per
+// instruction set from vector_ray.hpp, inside a namespace that defines vf, vi, vd and
+// vl (GCC/clang vector extension types of floats, ints, doubles and 64 bit ints of the
+// register width) and vsqrt for vf and vd, so it intentionally has no include guard.
+//
+// The primitives are already in component streams, so every lane group is a plain
+// load; the ray is broadcast once. Each lane runs the operations of the single ray
+// tests in vector_ray_detail in the same order, with the early returns folded into
+// one mask, and the elements past the last full group go through those tests.
+
+template <typename T> struct lanes_of;
+template <> struct lanes_of<float>  { using type = vf; using mask = vi; };
+template <> struct lanes_of<double> { using type = vd; using mask = vl; };
+
+template <typename T> using lanes = typename lanes_of<T>::type;
+template <typename T> using lane_mask = typename lanes_of<T>::mask;       // 0 / -1 per lane
+
+template <typename T>
+constexpr std::size_t width = sizeof(lanes<T>) / sizeof(T);
+
+template <typename V, typename T>
+inline V splat(T a)                 { return V{} + a; }
+
+template <typename V, typename M>
+inline V select(M m, V a, V b)      { return V((M(a) & m) | (M(b) & ~m)); }     // a where m is set, else b
+
+template <typename V, typename T>
+inline V load(const T* p)           { V a; std::memcpy(&a, p, sizeof(a)); return a; }
+
+template <typename M>
+inline std::uint64_t bits(M m)      // One bit per lane
+{
+    std::uint64_t b = 0;
+    for (std::size_t j = 0; j < sizeof(M) / sizeof(m[0]); ++j)
+        b |= std::uint64_t(m[j] != 0) << j;
+    return b;
+}
+
+template <typename M>
+inline bool any_lane(M m)
+{
+    std::uint64_t w[sizeof(M) / 8];
+    std::memcpy(w, &m, sizeof(M));
+    std::uint64_t a = 0;
+    for (std::size_t j = 0; j < sizeof(M) / 8; ++j)
+        a |= w[j];
+    return a != 0;
+}
+
+template <typename T>
+struct ray_lanes        // The ray in every lane
+{
+    lanes<T> ox, oy, oz, dx, dy, dz, ix, iy, iz, dd, tmin, tmax;
+
+    explicit ray_lanes(const ray<T>& r)
+    {
+        using V = lanes<T>;
+        ox = splat<V>(r.origin.x); oy = splat<V>(r.origin.y); oz = splat<V>(r.origin.z);
+        dx = splat<V>(r.dir.x);    dy = splat<V>(r.dir.y);    dz = splat<V>(r.dir.z);
+        ix = splat<V>(r.inv_dir.x); iy = splat<V>(r.inv_dir.y); iz = splat<V>(r.inv_dir.z);
+        dd = splat<V>(r.dir.dot(r.dir));
+        tmin = splat<V>(r.tmin);
+        tmax = splat<V>(r.tmax);
+    }
+};
+
+/* Lane group tests at element k */
+
+template <typename T>
+inline lane_mask<T> triangle(const ray_lanes<T>& r, const T* const* s, std::size_t k, lanes<T>& t)
+{
+    using V = lanes<T>;
+    const V zero = splat<V>(T(0)), one = splat<V>(T(1));
+    const V e1x = load<V>(s[3] + k), e1y = load<V>(s[4] + k), e1z = load<V>(s[5] + k);
+    const V e2x = load<V>(s[6] + k), e2y = load<V>(s[7] + k), e2z = load<V>(s[8] + k);
+    const V px = r.dy * e2z - r.dz * e2y, py = r.dz * e2x - r.dx * e2z, pz = r.dx * e2y - r.dy * e2x;
+    const V det = e1x * px + e1y * py + e1z * pz;
+    const V inv = one / det;
+    const V sx = r.ox - load<V>(s[0] + k), sy = r.oy - load<V>(s[1] + k), sz = r.oz - load<V>(s[2] + k);
+    const V u = (sx * px + sy * py + sz * pz) * inv;
+    const V qx = sy * e1z - sz * e1y, qy = sz * e1x - sx * e1z, qz = sx * e1y - sy * e1x;
+    const V v = (r.dx * qx + r.dy * qy + r.dz * qz) * inv;
+    t = (e2x * qx + e2y * qy + e2z * qz) * inv;
+    return (det != zero) & (u >= zero) & (u <= one) & (v >= zero) & (u + v <= one) & (t >= r.tmin) & (t <= r.tmax);
+}
+
+template <typename V>
+inline void slab(V lo, V hi, V o, V inv, V& t0, V& t1)
+{
+    const V a = (lo - o) * inv;
+    const V b = (hi - o) * inv;
+    const auto lt = a < b;
+    t0 = select((a > t0) & (b > t0), select(lt, a, b), t0);
+    t1 = select((a < t1) & (b < t1), select(lt, b, a), t1);
+}
+
+template <typename T>
+inline lane_mask<T> box(const ray_lanes<T>& r, const T* const* s, std::size_t k)
+{
+    using V = lanes<T>;
+    V n = r.tmin, f = r.tmax;
+    slab(load<V>(s[0] + k), load<V>(s[3] + k), r.ox, r.ix, n, f);
+    slab(load<V>(s[1] + k), load<V>(s[4] + k), r.oy, r.iy, n, f);
+    slab(load<V>(s[2] + k), load<V>(s[5] + k), r.oz, r.iz, n, f);
+    return n <= f;
+}
+
+template <typename T>
+inline lane_mask<T> sphere(const ray_lanes<T>& r, const T* const* s, const T* radius, std::size_t k)
+{
+    using V = lanes<T>;
+    const V ocx = r.ox - load<V>(s[0] + k), ocy = r.oy - load<V>(s[1] + k), ocz = r.oz - load<V>(s[2] + k);
+    const V b = ocx * r.dx + ocy * r.dy + ocz * r.dz;
+    const V q = b / r.dd;
+    const V lx = ocx - r.dx * q, ly = ocy - r.dy * q, lz = ocz - r.dz * q;
+    const V rad = load<V>(radius + k);
+    const V disc = r.dd * (rad * rad - (lx * lx + ly * ly + lz * lz));
+    const V sq = vsqrt(disc);       // NaN lanes fail the disc test below
+    const V n = (-b - sq) / r.dd;
+    const V t = select(n >= r.tmin, n, (-b + sq) / r.dd);
+    return (disc >= splat<V>(T(0))) & (t >= r.tmin) & (t <= r.tmax);
+}
+
+/* Kernels, with the signatures of vector_ray_scalar */
+
+template <typename T>
+void triangles(const ray<T>& r, const T* const* s, std::size_t n, std::uint64_t* hit)
+{
+    const ray_lanes<T> rl(r);
+    const std::size_t m = n / width<T> * width<T>;
+    for (std::size_t k = 0; k < m; k += width<T>)
+    {
+        lanes<T> t;
+        hit[k / 64] |= bits(triangle(rl, s, k, t)) << (k % 64);      // Widths divide 64, a group never straddles two words
+    }
+    for (std::size_t i = m; i < n; ++i)
+    {
+        T t;
+        hit[i / 64] |= std::uint64_t(vector_ray_detail::triangle(r, s, i, t)) << (i % 64);
+    }
+}
+
+template <typename T>
+void closest(const ray<T>& r, const T* const* s, std::size_t n, ray_hit<T>* out)
+{
+    using V = lanes<T>;
+    using M = lane_mask<T>;
+    constexpr std::size_t w = width<T>;
+    const ray_lanes<T> rl(r);
+    const std::size_t m = n / w * w;
+
+    V best = splat<V>(out->t);
+    M index = splat<M>(-1), lane, step;
+    for (std::size_t j = 0; j < w; ++j)
+    {
+        lane[j] = j;        // Element index in each lane
+        step[j] = w;
+    }
+    for (std::size_t k = 0; k < m; k += w, lane += step)
+    {
+        V t;
+        const M h = triangle(rl, s, k, t) & (t < best);     // Strictly closer, so each lane keeps its first index on ties
+        best = select(h, t, best);
+        index = select(h, lane, index);
+    }
+    for (std::size_t j = 0; j < w; ++j)     // Closest lane, lowest index on ties
+        if (index[j] != -1 && (best[j] < out->t || (best[j] == out->t && std::uint32_t(index[j]) < out->index)))
+        {
+            out->t = best[j];
+            out->index = std::uint32_t(index[j]);
+        }
+    for (std::size_t i = m; i < n; ++i)
+    {
+        T t;
+        if (vector_ray_detail::triangle(r, s, i, t) && t < out->t)
+        {
+            out->index = std::uint32_t(i);
+            out->t = t;
+        }
+    }
+}
+
+template <typename T>
+void any(const ray<T>& r, const T* const* s, std::size_t n, bool* out)
+{
+    const ray_lanes<T> rl(r);
+    const std::size_t m = n / width<T> * width<T>;
+    for (std::size_t k = 0; k < m; k += width<T>)
+    {
+        lanes<T> t;
+        if (any_lane(triangle(rl, s, k, t)))
+        {
+            *out = true;
+            return;
+        }
+    }
+    for (std::size_t i = m; i < n; ++i)
+    {
+        T t;
+        if (vector_ray_detail::triangle(r, s, i, t))
+        {
+            *out = true;
+            return;
+        }
+    }
+}
+
+template <typename T>
+void boxes(const ray<T>& r, const T* const* s, std::size_t n, std::uint64_t* hit)
+{
+    const ray_lanes<T> rl(r);
+    const std::size_t m = n / width<T> * width<T>;
+    for (std::size_t k = 0; k < m; k += width<T>)
+        hit[k / 64] |= bits(box(rl, s, k)) << (k % 64);
+    for (std::size_t i = m; i < n; ++i)
+    {
+        T t0, t1;
+        hit[i / 64] |= std::uint64_t(vector_ray_detail::box(r, vector_ray_detail::at(s, i), vector_ray_detail::at(s + 3, i), t0, t1)) << (i % 64);
+    }
+}
+
+template <typename T>
+void spheres(const ray<T>& r, const T* const* s, const T* radius, std::size_t n, std::uint64_t* hit)
+{
+    const ray_lanes<T> rl(r);
+    const std::size_t m = n / width<T> * width<T>;
+    for (std::size_t k = 0; k < m; k += width<T>)
+        hit[k / 64] |= bits(sphere(rl, s, radius, k)) << (k % 64);
+    for (std::size_t i = m; i < n; ++i)
+    {
+        T t;
+        hit[i / 64] |= std::uint64_t(vector_ray_detail::sphere(r, vector_ray_detail::at(s, i), radius[i], t)) << (i % 64);
+    }
+}
@@ -0,0 +1,268 @@
+#ifndef VECTOR_RAY_PACKET_H
+#define VECTOR_RAY_PACKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "vector3_packet.hpp"
+#include "vector_ray.hpp"
+
+// Packets of W rays, for coherent rays (a camera tile, a shadow ray bundle) that
+// traverse the same primitives. Each primitive is broadcast and tested against all
+// lanes at once with the operations of the single ray tests in vector_ray.hpp, and
+// both are built without FMA contraction, so the lanes agree bit for bit with them,
+// -mfma or not. Like vector3_packet the instruction set is the one the translation
+// unit is compiled for.
+//
+// The tests take the mask of the lanes still in play and return the mask of the
+// lanes that hit; t, u, v are written for those lanes only. A test returns as soon as
+// its mask empties, so traversal code can drop finished lanes and skip whole nodes.
+
+template <typename T, int W>
+struct ray_packet
+{
+    using lane_type = typename vector3_packet<T, W>::lane_type;
+    using int_lane_type = typename vector3_packet<T, W>::int_lane_type;
+
+    static constexpr packet_mask all = W == 32 ? ~packet_mask(0) : (packet_mask(1) << W) - 1;     // Every lane
+
+    vector3_packet<T, W> origin;
+    vector3_packet<T, W> dir;
+    vector3_packet<T, W> inv_dir;
+    lane_type            tmin;
+    lane_type            tmax;
+
+    /* ctors */
+    ray_packet() = default;
+    explicit ray_packet(const ray<T>* r);       // W rays
+
+    ray<T> get(int i) const;
+};
+
+template <typename T, int W>
+inline ray_packet<T, W>::ray_packet(const ray<T>* r)
+{
+    for (int i = 0; i < W; ++i)
+    {
+        origin.set(i, r[i].origin);
+        dir.set(i, r[i].dir);
+        inv_dir.set(i, r[i].inv_dir);
+        tmin[i] = r[i].tmin;
+        tmax[i] = r[i].tmax;
+    }
+}
+
+template <typename T, int W>
+inline ray<T> ray_packet<T, W>::get(int i) const
+{
+    ray<T> r;
+    r.origin = origin.get(i);
+    r.dir = dir.get(i);
+    r.inv_dir = inv_dir.get(i);
+    r.tmin = tmin[i];
+    r.tmax = tmax[i];
+    return r;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")     // As the single ray tests, so the lanes agree with them
+#endif
+
+namespace vector_ray_packet_detail
+{
+
+template <typename T, int W>
+inline typename packet_lanes<T, W>::type lane_select(typename packet_int_lanes<T, W>::type m, typename packet_lanes<T, W>::type a, typename packet_lanes<T, W>::type b)
+{
+    using int_lane_type = typename packet_int_lanes<T, W>::type;
+    using lane_type = typename packet_lanes<T, W>::type;
+    return lane_type((int_lane_type(a) & m) | (int_lane_type(b) & ~m));
+}
+
+template <typename T, int W>
+inline typename packet_lanes<T, W>::type lane_select(packet_mask m, typename packet_lanes<T, W>::type a, typename packet_lanes<T, W>::type b)
+{
+    typename packet_int_lanes<T, W>::type sel{};
+    for (int i = 0; i < W; ++i)
+        sel[i] = (m >> i) & 1 ? -1 : 0;
+    return lane_select<T, W>(sel, a, b);
+}
+
+template <typename T, int W>
+inline void slab(typename packet_lanes<T, W>::type lo, typename packet_lanes<T, W>::type hi, typename packet_lanes<T, W>::type o,
+                 typename packet_lanes<T, W>::type inv, typename packet_lanes<T, W>::type& t0, typename packet_lanes<T, W>::type& t1)
+{
+    const auto a = (lo - o) * inv;
+    const auto b = (hi - o) * inv;
+    const auto lt = a < b;
+    t0 = lane_select<T, W>((a > t0) & (b > t0), lane_select<T, W>(lt, a, b), t0);
+    t1 = lane_select<T, W>((a < t1) & (b < t1), lane_select<T, W>(lt, b, a), t1);
+}
+
+// Moller-Trumbore on the triangle v0, e1, e2 in every lane of active, the hit lanes are returned
+template <typename T, int W>
+inline packet_mask triangle(const ray_packet<T, W>& r, const vector3<T>& v0, const vector3<T>& e1, const vector3<T>& e2,
+                            typename packet_lanes<T, W>::type& t, typename packet_lanes<T, W>::type& u, typename packet_lanes<T, W>::type& v, packet_mask active)
+{
+    using lane_type = typename packet_lanes<T, W>::type;
+    const lane_type zero = lane_type{} + T(0), one = lane_type{} + T(1);
+    const vector3_packet<T, W> pe1(e1), pe2(e2);
+    const vector3_packet<T, W> p = r.dir.cross(pe2);
+    const lane_type det = pe1.dot(p);
+    const lane_type inv = one / det;
+    const vector3_packet<T, W> s = r.origin - vector3_packet<T, W>(v0);
+    u = s.dot(p) * inv;
+    active &= to_mask<T, W>((det != zero) & (u >= zero) & (u <= one));
+    if (!active)
+        return 0;
+    const vector3_packet<T, W> q = s.cross(pe1);
+    v = r.dir.dot(q) * inv;
+    t = pe2.dot(q) * inv;
+    return active & to_mask<T, W>((v >= zero) & (u + v <= one) & (t >= r.tmin) & (t <= r.tmax));
+}
+
+} // namespace vector_ray_packet_detail
+
+/* One primitive against every active lane */
+
+template <typename T, int W>
+inline packet_mask intersect_triangle(const ray_packet<T, W>& r, const vector3<T>& a, const vector3<T>& b, const vector3<T>& c,
+                                      typename ray_packet<T, W>::lane_type& t, typename ray_packet<T, W>::lane_type& u, typename ray_packet<T, W>::lane_type& v,
+                                      packet_mask active = ray_packet<T, W>::all)
+{
+    using lane_type = typename ray_packet<T, W>::lane_type;
+    using vector_ray_packet_detail::lane_select;
+    if (!active)
+        return 0;
+
+    lane_type lt, lu, lv;
+    active = vector_ray_packet_detail::triangle(r, a, b - a, c - a, lt, lu, lv, active);
+    if (active)
+    {
+        t = lane_select<T, W>(active, lt, t);
+        u = lane_select<T, W>(active, lu, u);
+        v = lane_select<T, W>(active, lv, v);
+    }
+    return active;
+}
+
+template <typename T, int W>
+inline packet_mask intersect_box(const ray_packet<T, W>& r, const vector3<T>& lo, const vector3<T>& hi,
+                                 typename ray_packet<T, W>::lane_type& t0, typename ray_packet<T, W>::lane_type& t1,
+                                 packet_mask active = ray_packet<T, W>::all)
+{
+    using lane_type = typename ray_packet<T, W>::lane_type;
+    using vector_ray_packet_detail::lane_select;
+    using vector_ray_packet_detail::slab;
+    if (!active)
+        return 0;
+
+    lane_type n = r.tmin, f = r.tmax;
+    slab<T, W>(lane_type{} + lo.x, lane_type{} + hi.x, r.origin.x, r.inv_dir.x, n, f);
+    slab<T, W>(lane_type{} + lo.y, lane_type{} + hi.y, r.origin.y, r.inv_dir.y, n, f);
+    slab<T, W>(lane_type{} + lo.z, lane_type{} + hi.z, r.origin.z, r.inv_dir.z, n, f);
+    active &= to_mask<T, W>(n <= f);
+    if (active)
+    {
+        t0 = lane_select<T, W>(active, n, t0);
+        t1 = lane_select<T, W>(active, f, t1);
+    }
+    return active;
+}
+
+template <typename T, int W>
+inline packet_mask intersect_sphere(const ray_packet<T, W>& r, const vector3<T>& center, T radius,
+                                    typename ray_packet<T, W>::lane_type& t, packet_mask active = ray_packet<T, W>::all)
+{
+    using lane_type = typename ray_packet<T, W>::lane_type;
+    using vector_ray_packet_detail::lane_select;
+    if (!active)
+        return 0;
+
+    const vector3_packet<T, W> oc = r.origin - vector3_packet<T, W>(center);
+    const lane_type a = r.dir.dot(r.dir);
+    const lane_type b = oc.dot(r.dir);
+    const vector3_packet<T, W> l = oc - r.dir * (b / a);
+    const lane_type disc = a * (radius * radius - l.dot(l));
+    active &= to_mask<T, W>(disc >= lane_type{});
+    if (!active)
+        return 0;
+    const lane_type s = packet_sqrt<T, W>(disc);
+    const lane_type n = (-b - s) / a;
+    const lane_type d = lane_select<T, W>(n >= r.tmin, n, (-b + s) / a);
+    active &= to_mask<T, W>((d >= r.tmin) & (d <= r.tmax));
+    if (active)
+        t = lane_select<T, W>(active, d, t);
+    return active;
+}
+
+/* Packet traversal of a triangle_soa */
+
+// Closest hit of every active lane, hits[i] for lane i (ray_miss when none); ties in t
+// go to the lower index, as in closest_hit. Returns the lanes that hit something.
+template <typename T, int W>
+inline packet_mask closest_hit(const ray_packet<T, W>& r, const triangle_soa<T>& tris, ray_hit<T>* hits, packet_mask active = ray_packet<T, W>::all)
+{
+    using lane_type = typename ray_packet<T, W>::lane_type;
+    using vector_ray_packet_detail::lane_select;
+
+    lane_type best = lane_type{} + std::numeric_limits<T>::infinity(), u = lane_type{}, v = lane_type{};
+    std::uint32_t index[W];
+    for (int i = 0; i < W; ++i)
+        index[i] = ray_miss;
+
+    packet_mask found = 0;
+    for (std::size_t k = 0; k < tris.size() && active; ++k)
+    {
+        lane_type lt, lu, lv;
+        packet_mask h = vector_ray_packet_detail::triangle(r, tris.vertex(k), tris.edge1(k), tris.edge2(k), lt, lu, lv, active);
+        if (h)
+            h &= to_mask<T, W>(lt < best);
+        if (!h)
+            continue;
+        best = lane_select<T, W>(h, lt, best);
+        u = lane_select<T, W>(h, lu, u);
+        v = lane_select<T, W>(h, lv, v);
+        for (int i = 0; i < W; ++i)
+            if ((h >> i) & 1)
+                index[i] = std::uint32_t(k);
+        found |= h;
+    }
+    for (int i = 0; i < W; ++i)
+        hits[i] = ray_hit<T>{ index[i], best[i], u[i], v[i] };
+    return found;
+}
+
+// Lanes of active that hit any triangle; a lane stops testing at its first hit and the
+// traversal ends once every lane has one
+template <typename T, int W>
+inline packet_mask any_hit(const ray_packet<T, W>& r, const triangle_soa<T>& tris, packet_mask active = ray_packet<T, W>::all)
+{
+    using lane_type = typename ray_packet<T, W>::lane_type;
+    packet_mask found = 0;
+    for (std::size_t k = 0; k < tris.size() && active; ++k)
+    {
+        lane_type t, u, v;
+        const packet_mask h = vector_ray_packet_detail::triangle(r, tris.vertex(k), tris.edge1(k), tris.edge2(k), t, u, v, active);
+        found |= h;
+        active &= ~h;
+    }
+    return found;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+/* Common packet widths */
+
+using ray_packet4f  = ray_packet<float, 4>;
+using ray_packet8f  = ray_packet<float, 8>;
+using ray_packet16f = ray_packet<float, 16>;
+using ray_packet2d  = ray_packet<double, 2>;
+using ray_packet4d  = ray_packet<double, 4>;
+using ray_packet8d  = ray_packet<double, 8>;
+
+#endif
@@ -0,0 +1,256 @@
+#ifndef VECTOR_REDUCE_H
+#define VECTOR_REDUCE_H
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <ranges>
+#include <type_traits>
+#include <vector>
+
+#include "vector.hpp"
+#include "vector_thread_pool.hpp"
+
+// Accurate, reproducible reductions over contiguous ranges of vectors (std::vector,
+// std::span, std::array ... of vector2, vector3 or vector4).
+//
+// The range is cut into fixed blocks of reduce_block elements, each block sums with
+// reduce_lanes interleaved accumulators, and the block results are combined in block
+// order with compensated additions (TwoSum, so the rounding error of every addition
+// is carried along). The lanes inside a block are compensated the same way, and
+// float, half and bfloat16 input accumulates in double, so large terms cancelling
+// each other do not swallow the small ones between them. None of this depends
+// on the thread count or on the SIMD width the compiler picks, so passing a pool only
+// changes the speed: the result is bitwise identical with and without one, on any
+// machine that rounds IEEE arithmetic the same way. FMA contraction is switched off
+// for the whole header, so -mfma or -march=native builds give the same bits as plain
+// ones. Builds with -ffast-math void the guarantee.
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")     // Products are rounded before they are summed, with or without FMA
+#endif
+
+constexpr std::size_t reduce_block = 4096;     // Elements per block
+constexpr std::size_t reduce_lanes = 4;        // Interleaved accumulators per block
+
+template <typename T>
+using reduce_accumulator = std::conditional_t<std::numeric_limits<T>::is_specialized && !std::numeric_limits<T>::is_integer &&
+                                              std::numeric_limits<T>::digits <= std::numeric_limits<float>::digits, double, T>;
+
+template <typename A>
+struct compensated          // Running sum and the rounding error it has dropped so far
+{
+    A sum;
+    A err;
+
+    constexpr void add(A v) noexcept
+    {
+        const A t = sum + v;
+        const A bp = t - sum;
+        err += (sum - (t - bp)) + (v - bp);
+        sum = t;
+    }
+
+    constexpr void add(const compensated<A>& c) noexcept
+    {
+        add(c.sum);
+        err += c.err;
+    }
+
+    constexpr A value() const noexcept { return sum + err; }
+};
+
+/* Block engine. term(i, v) writes the K addends of element i to v */
+
+template <std::size_t K, typename A, typename F>
+std::array<compensated<A>, K> reduce_block_sum(std::size_t first, std::size_t count, F& term)
+{
+    compensated<A> lane[reduce_lanes][K] = {};
+    A v[reduce_lanes][K];
+
+    std::size_t i = 0;
+    for (; i + reduce_lanes <= count; i += reduce_lanes)
+    {
+        for (std::size_t l = 0; l < reduce_lanes; ++l)
+            term(first + i + l, v[l]);
+        for (std::size_t l = 0; l < reduce_lanes; ++l)
+            for (std::size_t k = 0; k < K; ++k)
+                lane[l][k].add(v[l][k]);
+    }
+    for (; i < count; ++i)
+    {
+        term(first + i, v[0]);
+        for (std::size_t k = 0; k < K; ++k)
+            lane[0][k].add(v[0][k]);
+    }
+
+    std::array<compensated<A>, K> r;
+    for (std::size_t k = 0; k < K; ++k)
+    {
+        compensated<A> lo = lane[0][k];
+        compensated<A> hi = lane[2][k];
+        lo.add(lane[1][k]);
+        hi.add(lane[3][k]);
+        lo.add(hi);
+        r[k] = lo;
+    }
+    return r;
+}
+
+template <std::size_t K, typename T, typename F, typename A = reduce_accumulator<T>>
+std::array<A, K> reduce_terms(std::size_t n, F term, vector_thread_pool* pool)
+{
+    static_assert(reduce_lanes == 4, "the lane combine in reduce_block_sum assumes four lanes");
+    const std::size_t blocks = (n + reduce_block - 1) / reduce_block;
+    std::array<compensated<A>, K> total = {};
+
+    auto block = [&](std::size_t b)
+    {
+        const std::size_t first = b * reduce_block;
+        return reduce_block_sum<K, A>(first, n - first < reduce_block ? n - first : reduce_block, term);
+    };
+    auto combine = [&](const std::array<compensated<A>, K>& p)
+    {
+        for (std::size_t k = 0; k < K; ++k)
+            total[k].add(p[k]);
+    };
+
+    if (pool && blocks > 1)
+    {
+        std::vector<std::array<compensated<A>, K>> partial(blocks);
+        pool->parallel_for(blocks, [&](std::size_t b) { partial[b] = block(b); });
+        for (const std::array<compensated<A>, K>& p : partial)
+            combine(p);
+    }
+    else
+    {
+        for (std::size_t b = 0; b < blocks; ++b)
+            combine(block(b));
+    }
+
+    std::array<A, K> r;
+    for (std::size_t k = 0; k < K; ++k)
+        r[k] = total[k].value();
+    return r;
+}
+
+/* Reductions. pool = nullptr runs on the calling thread, with the same result */
+
+template <vector_range R>
+auto reduce_sum(const R& a, vector_thread_pool* pool = nullptr)
+{
+    using V = std::ranges::range_value_t<R>;
+    using T = typename V::value_type;
+    using A = reduce_accumulator<T>;
+    constexpr std::size_t N = V::dimension;
+    const V* p = std::ranges::data(a);
+
+    const std::array<A, N> s = reduce_terms<N, T>(std::ranges::size(a), [p](std::size_t i, A* v)
+    {
+        vector_detail::for_each<N>([&](auto c) { v[c] = A(get<c>(p[i])); });
+    }, pool);
+    return V(vector_detail::generate<N, T>([&](auto c) { return s[c]; }));
+}
+
+template <vector_range R>
+auto reduce_mean(const R& a, vector_thread_pool* pool = nullptr)       // Centroid, zero when empty
+{
+    using V = std::ranges::range_value_t<R>;
+    using T = typename V::value_type;
+    using A = reduce_accumulator<T>;
+    constexpr std::size_t N = V::dimension;
+    const V* p = std::ranges::data(a);
+    const std::size_t n = std::ranges::size(a);
+
+    const std::array<A, N> s = reduce_terms<N, T>(n, [p](std::size_t i, A* v)
+    {
+        vector_detail::for_each<N>([&](auto c) { v[c] = A(get<c>(p[i])); });
+    }, pool);
+    return V(vector_detail::generate<N, T>([&](auto c) { return n ? s[c] / A(n) : A(0); }));
+}
+
+template <vector_range R, std::ranges::contiguous_range W>
+auto reduce_weighted_sum(const R& a, const W& w, vector_thread_pool* pool = nullptr)     // Sum of w[i] * a[i]
+{
+    using V = std::ranges::range_value_t<R>;
+    using T = typename V::value_type;
+    using A = reduce_accumulator<T>;
+    constexpr std::size_t N = V::dimension;
+    const V* p = std::ranges::data(a);
+    const auto* q = std::ranges::data(w);
+    assert(std::ranges::size(a) == std::ranges::size(w));
+
+    const std::array<A, N> s = reduce_terms<N, T>(std::ranges::size(a), [p, q](std::size_t i, A* v)
+    {
+        vector_detail::for_each<N>([&](auto c) { v[c] = A(q[i]) * A(get<c>(p[i])); });
+    }, pool);
+    return V(vector_detail::generate<N, T>([&](auto c) { return s[c]; }));
+}
+
+template <vector_range R>
+auto reduce_dot(const R& a, const R& b, vector_thread_pool* pool = nullptr)        // Sum of a[i] . b[i]
+{
+    using V = std::ranges::range_value_t<R>;
+    using T = typename V::value_type;
+    using A = reduce_accumulator<T>;
+    constexpr std::size_t N = V::dimension;
+    const V* p = std::ranges::data(a);
+    const V* q = std::ranges::data(b);
+    assert(std::ranges::size(a) == std::ranges::size(b));
+
+    const std::array<A, 1> s = reduce_terms<1, T>(std::ranges::size(a), [p, q](std::size_t i, A* v)
+    {
+        A d[N];
+        vector_detail::for_each<N>([&](auto c) { d[c] = A(get<c>(p[i])) * A(get<c>(q[i])); });
+        A t = d[0];                             // Summed here, under the pragma, so no product fuses into it
+        for (std::size_t c = 1; c < N; ++c)
+            t += d[c];
+        v[0] = t;
+    }, pool);
+    return T(s[0]);
+}
+
+template <vector_range R>
+auto reduce_covariance(const R& a, vector_thread_pool* pool = nullptr)     // Population covariance, sum of (a[i] - mean)(a[i] - mean)^T / n
+{
+    using V = std::ranges::range_value_t<R>;
+    using T = typename V::value_type;
+    using A = reduce_accumulator<T>;
+    constexpr std::size_t N = V::dimension;
+    constexpr std::size_t K = N * (N + 1) / 2;      // Upper triangle, row by row
+    const V* p = std::ranges::data(a);
+    const std::size_t n = std::ranges::size(a);
+
+    const std::array<A, N> s = reduce_terms<N, T>(n, [p](std::size_t i, A* v)
+    {
+        vector_detail::for_each<N>([&](auto c) { v[c] = A(get<c>(p[i])); });
+    }, pool);
+    std::array<A, N> m;
+    for (std::size_t c = 0; c < N; ++c)
+        m[c] = n ? s[c] / A(n) : A(0);
+
+    const std::array<A, K> t = reduce_terms<K, T>(n, [p, &m](std::size_t i, A* v)
+    {
+        A d[N];
+        vector_detail::for_each<N>([&](auto c) { d[c] = A(get<c>(p[i])) - m[c]; });
+        std::size_t k = 0;
+        for (std::size_t r = 0; r < N; ++r)
+            for (std::size_t c = r; c < N; ++c)
+                v[k++] = d[r] * d[c];
+    }, pool);
+
+    std::array<std::array<T, N>, N> cov;
+    std::size_t k = 0;
+    for (std::size_t r = 0; r < N; ++r)
+        for (std::size_t c = r; c < N; ++c, ++k)
+            cov[r][c] = cov[c][r] = T(n ? t[k] / A(n) : A(0));
+    return cov;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+#endif
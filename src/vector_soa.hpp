@@ -0,0 +1,793 @@
+#ifndef VECTOR_SOA_H
+#define VECTOR_SOA_H
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "vector2.hpp"
+#include "vector3.hpp"
+
+// Structure-of-arrays containers. Every component lives in its own contiguous,
+// 64 byte aligned stream so batch kernels read x[], y[] and z[] with unit stride.
+
+constexpr std::size_t soa_alignment = 64;
+
+/* Aligned storage shared by the SoA containers, S streams of capacity elements each */
+
+template <typename T, std::size_t S>
+struct soa_buffer
+{
+    T*          data;
+    std::size_t count;
+    std::size_t capacity;   // Elements per stream, always a multiple of the alignment
+
+    /* ctors */
+    soa_buffer();
+    explicit soa_buffer(std::size_t n);
+    soa_buffer(const soa_buffer<T, S>& b);
+    soa_buffer(soa_buffer<T, S>&& b) noexcept;
+    ~soa_buffer();
+
+    soa_buffer<T, S>& operator=(const soa_buffer<T, S>& b);
+    soa_buffer<T, S>& operator=(soa_buffer<T, S>&& b) noexcept;
+
+    T*   stream(std::size_t s) const;
+    void reserve(std::size_t n);
+    void resize(std::size_t n);
+    void swap(soa_buffer<T, S>& b) noexcept;
+
+    static std::size_t round_capacity(std::size_t n);
+};
+
+template <typename T, std::size_t S>
+inline soa_buffer<T, S>::soa_buffer() : data(nullptr), count(0), capacity(0) {}
+
+template <typename T, std::size_t S>
+inline soa_buffer<T, S>::soa_buffer(std::size_t n) : data(nullptr), count(0), capacity(0)
+{
+    resize(n);
+}
+
+template <typename T, std::size_t S>
+inline soa_buffer<T, S>::soa_buffer(const soa_buffer<T, S>& b) : data(nullptr), count(0), capacity(0)
+{
+    reserve(b.count);
+    for (std::size_t s = 0; s < S && b.count; ++s)
+        std::memcpy(stream(s), b.stream(s), b.count * sizeof(T));
+    count = b.count;
+}
+
+template <typename T, std::size_t S>
+inline soa_buffer<T, S>::soa_buffer(soa_buffer<T, S>&& b) noexcept : data(b.data), count(b.count), capacity(b.capacity)
+{
+    b.data = nullptr;
+    b.count = 0;
+    b.capacity = 0;
+}
+
+template <typename T, std::size_t S>
+inline soa_buffer<T, S>::~soa_buffer()
+{
+    if (data)
+        ::operator delete(data, std::align_val_t(soa_alignment));
+}
+
+template <typename T, std::size_t S>
+inline soa_buffer<T, S>& soa_buffer<T, S>::operator=(const soa_buffer<T, S>& b)
+{
+    if (this != &b)
+    {
+        soa_buffer<T, S> tmp(b);
+        swap(tmp);
+    }
+    return *this;
+}
+
+template <typename T, std::size_t S>
+inline soa_buffer<T, S>& soa_buffer<T, S>::operator=(soa_buffer<T, S>&& b) noexcept
+{
+    soa_buffer<T, S> tmp(std::move(b));
+    swap(tmp);
+    return *this;
+}
+
+template <typename T, std::size_t S>
+inline T* soa_buffer<T, S>::stream(std::size_t s) const
+{
+    return data + s * capacity;
+}
+
+template <typename T, std::size_t S>
+inline std::size_t soa_buffer<T, S>::round_capacity(std::size_t n)     // Keeps every stream start aligned
+{
+    const std::size_t lanes = soa_alignment / sizeof(T);
+    return (n + lanes - 1) / lanes * lanes;
+}
+
+template <typename T, std::size_t S>
+inline void soa_buffer<T, S>::reserve(std::size_t n)
+{
+    if (n <= capacity)
+        return;
+
+    const std::size_t cap = round_capacity(n);
+    T* p = static_cast<T*>(::operator new(S * cap * sizeof(T), std::align_val_t(soa_alignment)));
+    for (std::size_t s = 0; s < S && count; ++s)
+        std::memcpy(p + s * cap, stream(s), count * sizeof(T));
+
+    if (data)
+        ::operator delete(data, std::align_val_t(soa_alignment));
+    data = p;
+    capacity = cap;
+}
+
+template <typename T, std::size_t S>
+inline void soa_buffer<T, S>::resize(std::size_t n)       // New elements are left uninitialized, as vector3<T>()
+{
+    reserve(n);
+    count = n;
+}
+
+template <typename T, std::size_t S>
+inline void soa_buffer<T, S>::swap(soa_buffer<T, S>& b) noexcept
+{
+    std::swap(data, b.data);
+    std::swap(count, b.count);
+    std::swap(capacity, b.capacity);
+}
+
+/* Proxy references, convertible to and from the AoS types */
+
+template <typename T>
+struct vector2_soa_ref
+{
+    T& x;
+    T& y;
+
+    operator vector2<T>() const { return vector2<T>(x, y); }
+
+    vector2_soa_ref<T>& operator=(const vector2<T>& v)       { x = v.x; y = v.y; return *this; }
+    vector2_soa_ref<T>& operator=(const vector2_soa_ref<T>& r) { x = r.x; y = r.y; return *this; }
+    vector2_soa_ref<T>& operator+=(const vector2<T>& v)      { x += v.x; y += v.y; return *this; }
+    vector2_soa_ref<T>& operator-=(const vector2<T>& v)      { x -= v.x; y -= v.y; return *this; }
+    vector2_soa_ref<T>& operator*=(T a)                      { x *= a; y *= a; return *this; }
+};
+
+template <typename T>
+struct vector3_soa_ref
+{
+    T& x;
+    T& y;
+    T& z;
+
+    operator vector3<T>() const { return vector3<T>(x, y, z); }
+
+    vector3_soa_ref<T>& operator=(const vector3<T>& v)       { x = v.x; y = v.y; z = v.z; return *this; }
+    vector3_soa_ref<T>& operator=(const vector3_soa_ref<T>& r) { x = r.x; y = r.y; z = r.z; return *this; }
+    vector3_soa_ref<T>& operator+=(const vector3<T>& v)      { x += v.x; y += v.y; z += v.z; return *this; }
+    vector3_soa_ref<T>& operator-=(const vector3<T>& v)      { x -= v.x; y -= v.y; z -= v.z; return *this; }
+    vector3_soa_ref<T>& operator*=(T a)                      { x *= a; y *= a; z *= a; return *this; }
+};
+
+// vector2 SoA container
+
+template <typename T>
+struct vector2_soa
+{
+    soa_buffer<T, 2> buf;
+
+    /* ctors */
+    vector2_soa();
+    explicit vector2_soa(std::size_t n);
+    vector2_soa(const vector2<T>* v, std::size_t n);        // Gather from an AoS array
+
+    /* Element access */
+    vector2_soa_ref<T> operator[](std::size_t i);
+    vector2<T>         operator[](std::size_t i) const;
+
+    T* x_ptr() const;       // Base pointers to the component streams
+    T* y_ptr() const;
+
+    std::size_t size() const;
+    bool        empty() const;
+    void        reserve(std::size_t n);
+    void        resize(std::size_t n);
+    void        clear();
+    void        push_back(const vector2<T>& v);
+    void        store(vector2<T>* v) const;                 // Scatter to an AoS array
+
+    /* Compound arithmetic operators */
+
+    vector2_soa<T>& operator+=(const vector2_soa<T>& v);
+    vector2_soa<T>& operator+=(const vector2<T>& v);
+    vector2_soa<T>& operator-=(const vector2_soa<T>& v);
+    vector2_soa<T>& operator-=(const vector2<T>& v);
+    vector2_soa<T>& operator*=(const vector2_soa<T>& v);
+    vector2_soa<T>& operator*=(T a);
+
+    /* Other operations */
+
+    void lengthsqr(T* out) const;       // Squared Magnitude of every vector
+    void length(T* out) const;          // Magnitude of every vector
+    void normalize_this();              // Unit Vectors
+    vector2_soa<T> normalize() const;
+};
+
+template <typename T>
+inline vector2_soa<T>::vector2_soa() {}
+
+template <typename T>
+inline vector2_soa<T>::vector2_soa(std::size_t n) : buf(n) {}
+
+template <typename T>
+inline vector2_soa<T>::vector2_soa(const vector2<T>* v, std::size_t n) : buf(n)
+{
+    T* __restrict x = x_ptr();
+    T* __restrict y = y_ptr();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        x[i] = v[i].x;
+        y[i] = v[i].y;
+    }
+}
+
+template <typename T>
+inline vector2_soa_ref<T> vector2_soa<T>::operator[](std::size_t i)
+{
+    return vector2_soa_ref<T>{ x_ptr()[i], y_ptr()[i] };
+}
+
+template <typename T>
+inline vector2<T> vector2_soa<T>::operator[](std::size_t i) const
+{
+    return vector2<T>(x_ptr()[i], y_ptr()[i]);
+}
+
+template <typename T>
+inline T* vector2_soa<T>::x_ptr() const { return buf.stream(0); }
+
+template <typename T>
+inline T* vector2_soa<T>::y_ptr() const { return buf.stream(1); }
+
+template <typename T>
+inline std::size_t vector2_soa<T>::size() const { return buf.count; }
+
+template <typename T>
+inline bool vector2_soa<T>::empty() const { return buf.count == 0; }
+
+template <typename T>
+inline void vector2_soa<T>::reserve(std::size_t n) { buf.reserve(n); }
+
+template <typename T>
+inline void vector2_soa<T>::resize(std::size_t n) { buf.resize(n); }
+
+template <typename T>
+inline void vector2_soa<T>::clear() { buf.count = 0; }
+
+template <typename T>
+inline void vector2_soa<T>::push_back(const vector2<T>& v)
+{
+    if (buf.count == buf.capacity)
+        buf.reserve(buf.capacity ? buf.capacity * 2 : 1);
+    x_ptr()[buf.count] = v.x;
+    y_ptr()[buf.count] = v.y;
+    ++buf.count;
+}
+
+template <typename T>
+inline void vector2_soa<T>::store(vector2<T>* v) const
+{
+    const T* __restrict x = x_ptr();
+    const T* __restrict y = y_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        v[i].x = x[i];
+        v[i].y = y[i];
+    }
+}
+
+/* Compound arithmetic operators. For a += a, a -= a and a *= a the v streams are taken from
+   x and y themselves, so every access stays based on the __restrict pointers */
+template <typename T>
+inline vector2_soa<T>& vector2_soa<T>::operator+=(const vector2_soa<T>& v)
+{
+    assert(size() == v.size());
+    T* __restrict x = x_ptr();        T* __restrict y = y_ptr();
+    const T* vx = &v == this ? x : v.x_ptr(); const T* vy = &v == this ? y : v.y_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        x[i] += vx[i]; y[i] += vy[i];
+    }
+    return *this;
+}
+
+template <typename T>
+inline vector2_soa<T>& vector2_soa<T>::operator+=(const vector2<T>& v)
+{
+    T* __restrict x = x_ptr(); T* __restrict y = y_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        x[i] += v.x; y[i] += v.y;
+    }
+    return *this;
+}
+
+template <typename T>
+inline vector2_soa<T>& vector2_soa<T>::operator-=(const vector2_soa<T>& v)
+{
+    assert(size() == v.size());
+    T* __restrict x = x_ptr();        T* __restrict y = y_ptr();
+    const T* vx = &v == this ? x : v.x_ptr(); const T* vy = &v == this ? y : v.y_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        x[i] -= vx[i]; y[i] -= vy[i];
+    }
+    return *this;
+}
+
+template <typename T>
+inline vector2_soa<T>& vector2_soa<T>::operator-=(const vector2<T>& v)
+{
+    T* __restrict x = x_ptr(); T* __restrict y = y_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        x[i] -= v.x; y[i] -= v.y;
+    }
+    return *this;
+}
+
+template <typename T>
+inline vector2_soa<T>& vector2_soa<T>::operator*=(const vector2_soa<T>& v)     // Element wise multiplication
+{
+    assert(size() == v.size());
+    T* __restrict x = x_ptr();        T* __restrict y = y_ptr();
+    const T* vx = &v == this ? x : v.x_ptr(); const T* vy = &v == this ? y : v.y_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        x[i] *= vx[i]; y[i] *= vy[i];
+    }
+    return *this;
+}
+
+template <typename T>
+inline vector2_soa<T>& vector2_soa<T>::operator*=(T a)
+{
+    T* __restrict x = x_ptr(); T* __restrict y = y_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        x[i] *= a; y[i] *= a;
+    }
+    return *this;
+}
+
+/* Other operations */
+template <typename T>
+inline void vector2_soa<T>::lengthsqr(T* out) const
+{
+    const T* x = x_ptr(); const T* y = y_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+        out[i] = x[i] * x[i] + y[i] * y[i];
+}
+
+template <typename T>
+inline void vector2_soa<T>::length(T* out) const
+{
+    const T* x = x_ptr(); const T* y = y_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+        out[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+}
+
+template <typename T>
+inline void vector2_soa<T>::normalize_this()
+{
+    T* __restrict x = x_ptr(); T* __restrict y = y_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        const T l = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+        x[i] /= l; y[i] /= l;
+    }
+}
+
+template <typename T>
+inline vector2_soa<T> vector2_soa<T>::normalize() const
+{
+    vector2_soa<T> v(*this);
+    v.normalize_this();
+    return v;
+}
+
+/* Batch canonical implementations, out must hold size() elements and may be one of the input streams */
+
+template <typename T>
+inline void dot(const vector2_soa<T>& lv, const vector2_soa<T>& rv, T* out)
+{
+    assert(lv.size() == rv.size());
+    const T* lx = lv.x_ptr(); const T* ly = lv.y_ptr();
+    const T* rx = rv.x_ptr(); const T* ry = rv.y_ptr();
+    for (std::size_t i = 0; i < lv.size(); ++i)
+        out[i] = lx[i] * rx[i] + ly[i] * ry[i];
+}
+
+template <typename T>
+inline void distance(const vector2_soa<T>& lv, const vector2_soa<T>& rv, T* out)
+{
+    assert(lv.size() == rv.size());
+    const T* lx = lv.x_ptr(); const T* ly = lv.y_ptr();
+    const T* rx = rv.x_ptr(); const T* ry = rv.y_ptr();
+    for (std::size_t i = 0; i < lv.size(); ++i)
+    {
+        const T dx = lx[i] - rx[i];
+        const T dy = ly[i] - ry[i];
+        out[i] = std::sqrt(dx * dx + dy * dy);
+    }
+}
+
+template <typename T>
+inline vector2_soa<T> operator+(const vector2_soa<T>& lv, const vector2_soa<T>& rv)
+{
+    vector2_soa<T> v(lv);
+    v += rv;
+    return v;
+}
+
+template <typename T>
+inline vector2_soa<T> operator-(const vector2_soa<T>& lv, const vector2_soa<T>& rv)
+{
+    vector2_soa<T> v(lv);
+    v -= rv;
+    return v;
+}
+
+template <typename T>
+inline vector2_soa<T> operator*(const vector2_soa<T>& lv, const vector2_soa<T>& rv)     // Element wise multiplication
+{
+    vector2_soa<T> v(lv);
+    v *= rv;
+    return v;
+}
+
+template <typename T>
+inline vector2_soa<T> operator*(const vector2_soa<T>& lv, T a)
+{
+    vector2_soa<T> v(lv);
+    v *= a;
+    return v;
+}
+
+template <typename T>
+inline vector2_soa<T> operator*(T a, const vector2_soa<T>& rv)      // Symmetric multiplication by scalar
+{
+    return rv * a;
+}
+
+// vector3 SoA container
+
+template <typename T>
+struct vector3_soa
+{
+    soa_buffer<T, 3> buf;
+
+    /* ctors */
+    vector3_soa();
+    explicit vector3_soa(std::size_t n);
+    vector3_soa(const vector3<T>* v, std::size_t n);        // Gather from an AoS array
+
+    /* Element access */
+    vector3_soa_ref<T> operator[](std::size_t i);
+    vector3<T>         operator[](std::size_t i) const;
+
+    T* x_ptr() const;       // Base pointers to the component streams
+    T* y_ptr() const;
+    T* z_ptr() const;
+
+    std::size_t size() const;
+    bool        empty() const;
+    void        reserve(std::size_t n);
+    void        resize(std::size_t n);
+    void        clear();
+    void        push_back(const vector3<T>& v);
+    void        store(vector3<T>* v) const;                 // Scatter to an AoS array
+
+    /* Compound arithmetic operators */
+
+    vector3_soa<T>& operator+=(const vector3_soa<T>& v);
+    vector3_soa<T>& operator+=(const vector3<T>& v);
+    vector3_soa<T>& operator-=(const vector3_soa<T>& v);
+    vector3_soa<T>& operator-=(const vector3<T>& v);
+    vector3_soa<T>& operator*=(const vector3_soa<T>& v);
+    vector3_soa<T>& operator*=(T a);
+
+    /* Other operations */
+
+    void lengthsqr(T* out) const;       // Squared Magnitude of every vector
+    void length(T* out) const;          // Magnitude of every vector
+    void normalize_this();              // Unit Vectors
+    vector3_soa<T> normalize() const;
+};
+
+template <typename T>
+inline vector3_soa<T>::vector3_soa() {}
+
+template <typename T>
+inline vector3_soa<T>::vector3_soa(std::size_t n) : buf(n) {}
+
+template <typename T>
+inline vector3_soa<T>::vector3_soa(const vector3<T>* v, std::size_t n) : buf(n)
+{
+    T* __restrict x = x_ptr();
+    T* __restrict y = y_ptr();
+    T* __restrict z = z_ptr();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        x[i] = v[i].x;
+        y[i] = v[i].y;
+        z[i] = v[i].z;
+    }
+}
+
+template <typename T>
+inline vector3_soa_ref<T> vector3_soa<T>::operator[](std::size_t i)
+{
+    return vector3_soa_ref<T>{ x_ptr()[i], y_ptr()[i], z_ptr()[i] };
+}
+
+template <typename T>
+inline vector3<T> vector3_soa<T>::operator[](std::size_t i) const
+{
+    return vector3<T>(x_ptr()[i], y_ptr()[i], z_ptr()[i]);
+}
+
+template <typename T>
+inline T* vector3_soa<T>::x_ptr() const { return buf.stream(0); }
+
+template <typename T>
+inline T* vector3_soa<T>::y_ptr() const { return buf.stream(1); }
+
+template <typename T>
+inline T* vector3_soa<T>::z_ptr() const { return buf.stream(2); }
+
+template <typename T>
+inline std::size_t vector3_soa<T>::size() const { return buf.count; }
+
+template <typename T>
+inline bool vector3_soa<T>::empty() const { return buf.count == 0; }
+
+template <typename T>
+inline void vector3_soa<T>::reserve(std::size_t n) { buf.reserve(n); }
+
+template <typename T>
+inline void vector3_soa<T>::resize(std::size_t n) { buf.resize(n); }
+
+template <typename T>
+inline void vector3_soa<T>::clear() { buf.count = 0; }
+
+template <typename T>
+inline void vector3_soa<T>::push_back(const vector3<T>& v)
+{
+    if (buf.count == buf.capacity)
+        buf.reserve(buf.capacity ? buf.capacity * 2 : 1);
+    x_ptr()[buf.count] = v.x;
+    y_ptr()[buf.count] = v.y;
+    z_ptr()[buf.count] = v.z;
+    ++buf.count;
+}
+
+template <typename T>
+inline void vector3_soa<T>::store(vector3<T>* v) const
+{
+    const T* __restrict x = x_ptr();
+    const T* __restrict y = y_ptr();
+    const T* __restrict z = z_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        v[i].x = x[i];
+        v[i].y = y[i];
+        v[i].z = z[i];
+    }
+}
+
+/* Compound arithmetic operators, with the v streams of a += a taken from x, y and z as in vector2_soa */
+template <typename T>
+inline vector3_soa<T>& vector3_soa<T>::operator+=(const vector3_soa<T>& v)
+{
+    assert(size() == v.size());
+    T* __restrict x = x_ptr();          T* __restrict y = y_ptr();          T* __restrict z = z_ptr();
+    const T* vx = &v == this ? x : v.x_ptr(); const T* vy = &v == this ? y : v.y_ptr(); const T* vz = &v == this ? z : v.z_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        x[i] += vx[i]; y[i] += vy[i]; z[i] += vz[i];
+    }
+    return *this;
+}
+
+template <typename T>
+inline vector3_soa<T>& vector3_soa<T>::operator+=(const vector3<T>& v)
+{
+    T* __restrict x = x_ptr(); T* __restrict y = y_ptr(); T* __restrict z = z_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        x[i] += v.x; y[i] += v.y; z[i] += v.z;
+    }
+    return *this;
+}
+
+template <typename T>
+inline vector3_soa<T>& vector3_soa<T>::operator-=(const vector3_soa<T>& v)
+{
+    assert(size() == v.size());
+    T* __restrict x = x_ptr();          T* __restrict y = y_ptr();          T* __restrict z = z_ptr();
+    const T* vx = &v == this ? x : v.x_ptr(); const T* vy = &v == this ? y : v.y_ptr(); const T* vz = &v == this ? z : v.z_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        x[i] -= vx[i]; y[i] -= vy[i]; z[i] -= vz[i];
+    }
+    return *this;
+}
+
+template <typename T>
+inline vector3_soa<T>& vector3_soa<T>::operator-=(const vector3<T>& v)
+{
+    T* __restrict x = x_ptr(); T* __restrict y = y_ptr(); T* __restrict z = z_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        x[i] -= v.x; y[i] -= v.y; z[i] -= v.z;
+    }
+    return *this;
+}
+
+template <typename T>
+inline vector3_soa<T>& vector3_soa<T>::operator*=(const vector3_soa<T>& v)     // Element wise multiplication
+{
+    assert(size() == v.size());
+    T* __restrict x = x_ptr();          T* __restrict y = y_ptr();          T* __restrict z = z_ptr();
+    const T* vx = &v == this ? x : v.x_ptr(); const T* vy = &v == this ? y : v.y_ptr(); const T* vz = &v == this ? z : v.z_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        x[i] *= vx[i]; y[i] *= vy[i]; z[i] *= vz[i];
+    }
+    return *this;
+}
+
+template <typename T>
+inline vector3_soa<T>& vector3_soa<T>::operator*=(T a)
+{
+    T* __restrict x = x_ptr(); T* __restrict y = y_ptr(); T* __restrict z = z_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        x[i] *= a; y[i] *= a; z[i] *= a;
+    }
+    return *this;
+}
+
+/* Other operations */
+template <typename T>
+inline void vector3_soa<T>::lengthsqr(T* out) const
+{
+    const T* x = x_ptr(); const T* y = y_ptr(); const T* z = z_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+        out[i] = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+}
+
+template <typename T>
+inline void vector3_soa<T>::length(T* out) const
+{
+    const T* x = x_ptr(); const T* y = y_ptr(); const T* z = z_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+        out[i] = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+}
+
+template <typename T>
+inline void vector3_soa<T>::normalize_this()
+{
+    T* __restrict x = x_ptr(); T* __restrict y = y_ptr(); T* __restrict z = z_ptr();
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        const T l = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+        x[i] /= l; y[i] /= l; z[i] /= l;
+    }
+}
+
+template <typename T>
+inline vector3_soa<T> vector3_soa<T>::normalize() const
+{
+    vector3_soa<T> v(*this);
+    v.normalize_this();
+    return v;
+}
+
+/* Batch canonical implementations, out must hold size() elements and may be one of the input streams */
+
+template <typename T>
+inline void dot(const vector3_soa<T>& lv, const vector3_soa<T>& rv, T* out)
+{
+    assert(lv.size() == rv.size());
+    const T* lx = lv.x_ptr(); const T* ly = lv.y_ptr(); const T* lz = lv.z_ptr();
+    const T* rx = rv.x_ptr(); const T* ry = rv.y_ptr(); const T* rz = rv.z_ptr();
+    for (std::size_t i = 0; i < lv.size(); ++i)
+        out[i] = lx[i] * rx[i] + ly[i] * ry[i] + lz[i] * rz[i];
+}
+
+template <typename T>
+inline void cross(const vector3_soa<T>& lv, const vector3_soa<T>& rv, vector3_soa<T>& out)
+{
+    assert(lv.size() == rv.size());
+    out.resize(lv.size());
+    const T* lx = lv.x_ptr(); const T* ly = lv.y_ptr(); const T* lz = lv.z_ptr();
+    const T* rx = rv.x_ptr(); const T* ry = rv.y_ptr(); const T* rz = rv.z_ptr();
+    T* ox = out.x_ptr(); T* oy = out.y_ptr(); T* oz = out.z_ptr();
+    for (std::size_t i = 0; i < lv.size(); ++i)     // Loads first so out may alias lv or rv
+    {
+        const T ax = lx[i], ay = ly[i], az = lz[i];
+        const T bx = rx[i], by = ry[i], bz = rz[i];
+        ox[i] = ay * bz - az * by;
+        oy[i] = az * bx - ax * bz;
+        oz[i] = ax * by - ay * bx;
+    }
+}
+
+template <typename T>
+inline vector3_soa<T> cross(const vector3_soa<T>& lv, const vector3_soa<T>& rv)
+{
+    vector3_soa<T> v;
+    cross(lv, rv, v);
+    return v;
+}
+
+template <typename T>
+inline void distance(const vector3_soa<T>& lv, const vector3_soa<T>& rv, T* out)
+{
+    assert(lv.size() == rv.size());
+    const T* lx = lv.x_ptr(); const T* ly = lv.y_ptr(); const T* lz = lv.z_ptr();
+    const T* rx = rv.x_ptr(); const T* ry = rv.y_ptr(); const T* rz = rv.z_ptr();
+    for (std::size_t i = 0; i < lv.size(); ++i)
+    {
+        const T dx = lx[i] - rx[i];
+        const T dy = ly[i] - ry[i];
+        const T dz = lz[i] - rz[i];
+        out[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+}
+
+template <typename T>
+inline vector3_soa<T> operator+(const vector3_soa<T>& lv, const vector3_soa<T>& rv)
+{
+    vector3_soa<T> v(lv);
+    v += rv;
+    return v;
+}
+
+template <typename T>
+inline vector3_soa<T> operator-(const vector3_soa<T>& lv, const vector3_soa<T>& rv)
+{
+    vector3_soa<T> v(lv);
+    v -= rv;
+    return v;
+}
+
+template <typename T>
+inline vector3_soa<T> operator*(const vector3_soa<T>& lv, const vector3_soa<T>& rv)     // Element wise multiplication
+{
+    vector3_soa<T> v(lv);
+    v *= rv;
+    return v;
+}
+
+template <typename T>
+inline vector3_soa<T> operator*(const vector3_soa<T>& lv, T a)
+{
+    vector3_soa<T> v(lv);
+    v *= a;
+    return v;
+}
+
+template <typename T>
+inline vector3_soa<T> operator*(T a, const vector3_soa<T>& rv)      // Symmetric multiplication by scalar
+{
+    return rv * a;
+}
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef VECTOR_SPATIAL_H
+#define VECTOR_SPATIAL_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "vector3.hpp"
+#include "vector_thread_pool.hpp"
+
+// Shared parts of the spatial indexes over vector3 point sets (vector_kdtree.hpp,
+// vector_bvh.hpp): the query result type and the tree builder.
+//
+// Both trees are binary trees over a copy of the points in tree order, stored in one
+// flat node array in depth first order: the left child of node i is node i + 1, the
+// right child is stored, and every node covers a contiguous range of the points. A
+// node is split at the median along the longest axis of the bounding box of its
+// points, until at most leaf_size points are left. With a thread pool the top of the
+// tree is split on the calling thread down to subtrees of spatial_build_grain points,
+// the subtrees are built in parallel and spliced in; the nodes come out the same as
+// on one thread.
+
+constexpr std::size_t   spatial_leaf_size = 8;                 // Default points per leaf
+constexpr std::size_t   spatial_build_grain = 1 << 16;         // Points per subtree built in parallel
+constexpr std::size_t   spatial_query_block = 256;             // Queries per block of the batched queries
+constexpr std::uint32_t spatial_none = 0xffffffff;             // Index of a missing neighbour
+
+template <typename T>
+struct vector_neighbor
+{
+    std::uint32_t index;        // Into the span the tree was built from
+    T             distsqr;      // Squared distance to the query point
+
+    constexpr bool operator==(const vector_neighbor<T>& o) const noexcept = default;
+    constexpr bool operator<(const vector_neighbor<T>& o) const noexcept    // Closer first, ties by index
+    {
+        return distsqr < o.distsqr || (distsqr == o.distsqr && index < o.index);
+    }
+};
+
+namespace spatial_detail
+{
+
+template <typename T>
+struct item                     // A point and its original index, sorted together while building
+{
+    vector3<T>    p;
+    std::uint32_t index;
+};
+
+template <typename T>
+void bounds(const item<T>* a, std::uint32_t count, vector3<T>& lo, vector3<T>& hi)
+{
+    lo = hi = a[0].p;
+    for (std::uint32_t i = 1; i < count; ++i)
+    {
+        vector_detail::for_each<3>([&](auto c)
+        {
+            get<c>(lo) = get<c>(a[i].p) < get<c>(lo) ? get<c>(a[i].p) : get<c>(lo);
+            get<c>(hi) = get<c>(a[i].p) > get<c>(hi) ? get<c>(a[i].p) : get<c>(hi);
+        });
+    }
+}
+
+template <typename T>
+constexpr T box_distsqr(const vector3<T>& lo, const vector3<T>& hi, const vector3<T>& q) noexcept     // 0 inside the box
+{
+    return vector_detail::sum<3>([&](auto c)
+    {
+        const T d = get<c>(q) < get<c>(lo) ? get<c>(lo) - get<c>(q) : (get<c>(q) > get<c>(hi) ? get<c>(q) - get<c>(hi) : T(0));
+        return d * d;
+    });
+}
+
+template <typename T>
+constexpr bool inside(const vector3<T>& lo, const vector3<T>& hi, const vector3<T>& p) noexcept
+{
+    return vector_detail::all<3>([&](auto c) { return get<c>(p) >= get<c>(lo) && get<c>(p) <= get<c>(hi); });
+}
+
+// k nearest candidates as a max heap on vector_neighbor::operator<, so the worst is in front.
+
+template <typename T>
+void heap_offer(vector_neighbor<T>* heap, std::size_t& found, std::size_t k, const vector_neighbor<T>& n)
+{
+    if (found < k)
+    {
+        heap[found++] = n;
+        std::push_heap(heap, heap + found);
+    }
+    else if (n < heap[0])
+    {
+        std::pop_heap(heap, heap + k);
+        heap[k - 1] = n;
+        std::push_heap(heap, heap + k);
+    }
+}
+
+template <typename T>
+T heap_bound(const vector_neighbor<T>* heap, std::size_t found, std::size_t k)     // Squared distance a candidate must not exceed
+{
+    return found < k ? std::numeric_limits<T>::infinity() : heap[0].distsqr;
+}
+
+// Builds the tree of the items into nodes, sorting them into tree order. Node needs
+// members first, count and right and functions split(lo, hi, axis, value) and
+// leaf(lo, hi) that store what the tree keeps of an inner node and of a leaf.
+
+template <typename Node, typename T>
+struct builder
+{
+    item<T>*    items;
+    std::size_t leaf_size;
+
+    void build(std::uint32_t first, std::uint32_t count, std::vector<Node>& nodes, std::size_t grain, std::vector<std::uint32_t>* tasks) const
+    {
+        const std::uint32_t me = std::uint32_t(nodes.size());
+        nodes.emplace_back();
+        nodes[me].first = first;
+        nodes[me].count = count;
+        nodes[me].right = 0;
+        if (tasks && count <= grain)            // Subtree left to a parallel task
+        {
+            tasks->push_back(me);
+            return;
+        }
+
+        vector3<T> lo, hi;
+        bounds(items + first, count, lo, hi);
+        if (count <= leaf_size)
+        {
+            nodes[me].leaf(lo, hi);
+            return;
+        }
+
+        const vector3<T> extent = hi - lo;
+        const std::uint32_t axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        const std::uint32_t half = count / 2;
+        std::nth_element(items + first, items + first + half, items + first + count, [axis](const item<T>& a, const item<T>& b)
+        {
+            const T ca = a.p.ptr()[axis], cb = b.p.ptr()[axis];
+            return ca < cb || (ca == cb && a.index < b.index);
+        });
+        nodes[me].split(lo, hi, axis, items[first + half].p.ptr()[axis]);
+
+        build(first, half, nodes, grain, tasks);
+        nodes[me].right = std::uint32_t(nodes.size());
+        build(first + half, count - half, nodes, grain, tasks);
+    }
+
+    void splice(const std::vector<Node>& top, std::uint32_t i, const std::vector<std::uint32_t>& task_of, const std::vector<std::vector<Node>>& sub, std::vector<Node>& out) const
+    {
+        if (task_of[i] != spatial_none)
+        {
+            const std::uint32_t base = std::uint32_t(out.size());
+            for (Node n : sub[task_of[i]])
+            {
+                if (n.right)
+                    n.right += base;
+                out.push_back(n);
+            }
+            return;
+        }
+        const std::size_t me = out.size();
+        out.push_back(top[i]);
+        if (!top[i].right)
+            return;
+        splice(top, i + 1, task_of, sub, out);
+        out[me].right = std::uint32_t(out.size());
+        splice(top, top[i].right, task_of, sub, out);
+    }
+};
+
+template <typename Node, typename T>
+void build_tree(std::span<const vector3<T>> points, std::size_t leaf_size, vector_thread_pool* pool,
+                std::vector<Node>& nodes, std::vector<vector3<T>>& tree_points, std::vector<std::uint32_t>& index)
+{
+    assert(points.size() < spatial_none && leaf_size > 0);
+    nodes.clear();
+    tree_points.clear();
+    index.clear();
+    if (points.empty())
+        return;
+
+    std::vector<item<T>> items(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+        items[i] = item<T>{ points[i], std::uint32_t(i) };
+
+    const builder<Node, T> b{ items.data(), leaf_size };
+    const std::uint32_t n = std::uint32_t(points.size());
+    if (!pool || points.size() <= spatial_build_grain)
+    {
+        nodes.reserve(2 * (points.size() / leaf_size + 1));
+        b.build(0, n, nodes, 0, nullptr);
+    }
+    else
+    {
+        std::vector<Node> top;
+        std::vector<std::uint32_t> tasks;
+        b.build(0, n, top, spatial_build_grain, &tasks);
+
+        std::vector<std::vector<Node>> sub(tasks.size());
+        pool->parallel_for(tasks.size(), [&](std::size_t t)
+        {
+            const Node& r = top[tasks[t]];
+            b.build(r.first, r.count, sub[t], 0, nullptr);
+        });
+
+        std::vector<std::uint32_t> task_of(top.size(), spatial_none);
+        std::size_t total = top.size();
+        for (std::size_t t = 0; t < tasks.size(); ++t)
+        {
+            task_of[tasks[t]] = std::uint32_t(t);
+            total += sub[t].size();
+        }
+        nodes.reserve(total);
+        b.splice(top, 0, task_of, sub, nodes);
+    }
+
+    tree_points.resize(points.size());
+    index.resize(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        tree_points[i] = items[i].p;
+        index[i] = items[i].index;
+    }
+}
+
+// Batched queries: blocks of spatial_query_block queries on the pool, each query
+// writing its own rows, or its own list joined in query order afterwards.
+
+template <typename T, typename Tree>
+void batch_knn(const Tree& tree, std::span<const vector3<T>> q, std::size_t k, std::span<vector_neighbor<T>> out, vector_thread_pool* pool)
+{
+    assert(out.size() >= q.size() * k);
+    const auto rows = [&](std::size_t first, std::size_t count)
+    {
+        for (std::size_t i = first; i < first + count; ++i)
+        {
+            const std::span<vector_neighbor<T>> row = out.subspan(i * k, k);
+            std::fill(row.begin() + std::ptrdiff_t(tree.knn(q[i], k, row)), row.end(), vector_neighbor<T>{ spatial_none, std::numeric_limits<T>::infinity() });
+        }
+    };
+    if (!pool || q.size() <= spatial_query_block)
+        return rows(0, q.size());
+    const std::size_t blocks = (q.size() + spatial_query_block - 1) / spatial_query_block;
+    pool->parallel_for(blocks, [&](std::size_t b)
+    {
+        const std::size_t first = b * spatial_query_block;
+        rows(first, std::min(spatial_query_block, q.size() - first));
+    });
+}
+
+template <typename T, typename Tree>
+void batch_radius(const Tree& tree, std::span<const vector3<T>> q, T r, std::vector<std::size_t>& offsets, std::vector<vector_neighbor<T>>& out, vector_thread_pool* pool)
+{
+    offsets.assign(q.size() + 1, 0);
+    out.clear();
+    const std::size_t blocks = (q.size() + spatial_query_block - 1) / spatial_query_block;
+    std::vector<std::vector<vector_neighbor<T>>> part(blocks);
+    const auto block = [&](std::size_t b)
+    {
+        const std::size_t first = b * spatial_query_block;
+        const std::size_t last = std::min(first + spatial_query_block, q.size());
+        for (std::size_t i = first; i < last; ++i)
+        {
+            const std::size_t before = part[b].size();
+            tree.radius(q[i], r, part[b]);
+            offsets[i + 1] = part[b].size() - before;
+        }
+    };
+    if (!pool || blocks <= 1)
+    {
+        for (std::size_t b = 0; b < blocks; ++b)
+            block(b);
+    }
+    else
+    {
+        pool->parallel_for(blocks, block);
+    }
+
+    for (std::size_t i = 0; i < q.size(); ++i)
+        offsets[i + 1] += offsets[i];
+    out.reserve(offsets.back());
+    for (const std::vector<vector_neighbor<T>>& p : part)
+        out.insert(out.end(), p.begin(), p.end());
+}
+
+} // namespace spatial_detail
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef VECTOR_TEXT_H
+#define VECTOR_TEXT_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "vector.hpp"
+#include "vector_thread_pool.hpp"
+
+// Bulk text import and export of vector arrays: one vector per line, components
+// separated by a delimiter, as in CSV, XYZ or the body of an ASCII PLY file.
+//
+// Numbers go through std::from_chars and std::to_chars, so there is no locale, no
+// stream state and no allocation per value, and formatted output is the shortest
+// string that parses back to the same value. Parsing accepts blanks around every
+// field, \n or \r\n line ends, blank lines and comment lines. Fields must be apart:
+// the delimiter, or with ' ' at least one blank, so "1-2-3" is an error rather than
+// (1, -2, -3). With a thread pool the text is cut into chunks of about
+// vector_text_chunk bytes on line boundaries, the chunks are parsed or formatted
+// independently, and the pieces are joined in order, so the result is the same as on
+// one thread.
+
+constexpr std::size_t vector_text_chunk = std::size_t(1) << 20;    // Bytes (or about that many bytes of output) per parallel chunk
+
+struct vector_text_format
+{
+    char        delimiter = ' ';        // ' ' also matches tabs and runs of blanks; '\t' matches exactly one tab, for TSV
+    char        comment = '#';          // Lines starting with it are skipped, 0 = none
+    std::size_t skip_lines = 0;         // Header lines to skip, e.g. the CSV column names
+    bool        extra_fields = false;   // Ignore fields after the Nth, e.g. normals or colors in a PLY body
+};
+
+struct vector_text_result
+{
+    std::errc   ec;         // std::errc() on success, invalid_argument or result_out_of_range
+    std::size_t line;       // 1-based line of the error
+    std::size_t count;      // Vectors appended, those before the error included
+};
+
+/* Parsing */
+
+namespace vector_text_detail
+{
+
+inline const char* skip_blanks(const char* p, const char* end, char delimiter = ' ')     // A '\t' delimiter is not a blank
+{
+    while (p != end && (*p == ' ' || *p == '\t' || *p == '\r') && (*p != delimiter || delimiter == ' '))
+        ++p;
+    return p;
+}
+
+inline const char* next_line(const char* p, const char* end)
+{
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', std::size_t(end - p)));
+    return nl ? nl + 1 : end;
+}
+
+inline std::size_t count_lines(const char* first, const char* last)
+{
+    std::size_t n = 0;
+    for (const char* p = first; (p = static_cast<const char*>(std::memchr(p, '\n', std::size_t(last - p)))); ++p)
+        ++n;
+    return n;
+}
+
+template <std::size_t N, typename T>
+const char* parse(const char* p, const char* end, std::vector<vector<N, T>>& out, const vector_text_format& fmt, std::errc& ec)    // Returns where it stopped
+{
+    ec = std::errc();
+    while (p != end)
+    {
+        const char* q = skip_blanks(p, end);
+        if (q == end)
+            return end;
+        if (*q == '\n' || (fmt.comment && *q == fmt.comment))
+        {
+            p = next_line(q, end);
+            continue;
+        }
+
+        vector<N, T> v;
+        bool ok = vector_detail::all<N>([&](auto c)
+        {
+            if constexpr (decltype(c)::value > 0)
+            {
+                const char* f = skip_blanks(q, end, fmt.delimiter);
+                if (fmt.delimiter != ' ')
+                {
+                    if (f == end || *f != fmt.delimiter)
+                        return false;
+                    f = skip_blanks(f + 1, end, fmt.delimiter);
+                }
+                else if (f == q)        // "1-2-3" or "1.5.5" is a corrupt row, not three numbers
+                    return false;
+                q = f;
+            }
+            const std::from_chars_result r = std::from_chars(q, end, get<c>(v));
+            if (r.ec != std::errc())
+                ec = r.ec;
+            q = r.ptr;
+            return r.ec == std::errc();
+        });
+        if (ok)
+        {
+            const char* f = skip_blanks(q, end, fmt.delimiter);
+            ok = f == end || *f == '\n' || (fmt.extra_fields && (f != q || *f == fmt.delimiter));
+            q = f;
+        }
+        if (!ok)
+        {
+            if (ec == std::errc())
+                ec = std::errc::invalid_argument;
+            return p;
+        }
+
+        out.push_back(v);
+        p = next_line(q, end);
+    }
+    return end;
+}
+
+} // namespace vector_text_detail
+
+template <std::size_t N, typename T>
+vector_text_result parse_vectors(std::string_view text, std::vector<vector<N, T>>& out, const vector_text_format& fmt = {}, vector_thread_pool* pool = nullptr)
+{
+    using namespace vector_text_detail;
+    const char* const begin = text.data();
+    const char* const end = begin + text.size();
+    const std::size_t before = out.size();
+
+    const char* p = begin;
+    for (std::size_t l = 0; l < fmt.skip_lines && p != end; ++l)
+        p = next_line(p, end);
+
+    std::errc ec;
+    const char* stop;
+    if (!pool || std::size_t(end - p) <= vector_text_chunk)
+    {
+        stop = parse<N, T>(p, end, out, fmt, ec);
+    }
+    else
+    {
+        std::vector<const char*> cut(1, p);         // Chunk starts, each at a line start
+        while (cut.back() != end)
+        {
+            const char* c = std::size_t(end - cut.back()) <= vector_text_chunk ? end : next_line(cut.back() + vector_text_chunk, end);
+            cut.push_back(c);
+        }
+        const std::size_t chunks = cut.size() - 1;
+
+        std::vector<std::vector<vector<N, T>>> part(chunks);
+        std::vector<const char*> stops(chunks);
+        std::vector<std::errc> errs(chunks);
+        pool->parallel_for(chunks, [&](std::size_t k)
+        {
+            part[k].reserve(std::size_t(cut[k + 1] - cut[k]) / (N * 4));
+            stops[k] = parse<N, T>(cut[k], cut[k + 1], part[k], fmt, errs[k]);
+        });
+
+        std::size_t k = 0;
+        while (k + 1 < chunks && errs[k] == std::errc())
+            ++k;
+        std::size_t total = 0;
+        for (std::size_t i = 0; i <= k; ++i)
+            total += part[i].size();
+        out.reserve(before + total);
+        for (std::size_t i = 0; i <= k; ++i)
+            out.insert(out.end(), part[i].begin(), part[i].end());
+        ec = errs[k];
+        stop = stops[k];
+    }
+
+    const std::size_t line = ec == std::errc() ? 0 : count_lines(begin, stop) + 1;
+    return vector_text_result{ ec, line, out.size() - before };
+}
+
+/* Formatting */
+
+namespace vector_text_detail
+{
+
+template <std::size_t N, typename T>
+void format(std::span<const vector<N, T>> v, std::string& out, char delimiter)
+{
+    constexpr std::size_t width = 32;                // Longest shortest-form double, sign and exponent included, plus the separator
+    const std::size_t start = out.size();
+    out.resize(start + v.size() * N * width);
+    char* p = out.data() + start;
+    char* const end = out.data() + out.size();
+
+    for (const vector<N, T>& e : v)
+    {
+        vector_detail::for_each<N>([&](auto c)
+        {
+            p = std::to_chars(p, end, get<c>(e)).ptr;
+            *p++ = c + 1 < N ? delimiter : '\n';
+        });
+    }
+    out.resize(std::size_t(p - out.data()));
+}
+
+} // namespace vector_text_detail
+
+template <vector_range R>
+void format_vectors(const R& v, std::string& out, const vector_text_format& fmt = {}, vector_thread_pool* pool = nullptr)     // Appends to out
+{
+    using V = std::ranges::range_value_t<R>;
+    constexpr std::size_t N = V::dimension;
+    using T = typename V::value_type;
+    const std::span<const V> a(std::ranges::data(v), std::ranges::size(v));
+    const std::size_t per_chunk = vector_text_chunk / (N * 12);
+
+    if (!pool || a.size() <= per_chunk)
+    {
+        vector_text_detail::format<N, T>(a, out, fmt.delimiter);
+        return;
+    }
+
+    const std::size_t chunks = (a.size() + per_chunk - 1) / per_chunk;
+    std::vector<std::string> part(chunks);
+    pool->parallel_for(chunks, [&](std::size_t k)
+    {
+        vector_text_detail::format<N, T>(a.subspan(k * per_chunk, std::min(per_chunk, a.size() - k * per_chunk)), part[k], fmt.delimiter);
+    });
+
+    std::size_t total = out.size();
+    for (const std::string& s : part)
+        total += s.size();
+    out.reserve(total);
+    for (const std::string& s : part)
+        out += s;
+}
+
+template <vector_range R>
+void format_vectors(const R& v, std::ostream& out, const vector_text_format& fmt = {})      // Streams in chunks, bounded memory
+{
+    using V = std::ranges::range_value_t<R>;
+    constexpr std::size_t N = V::dimension;
+    using T = typename V::value_type;
+    const std::span<const V> a(std::ranges::data(v), std::ranges::size(v));
+    const std::size_t per_chunk = vector_text_chunk / (N * 12);
+
+    std::string buf;
+    for (std::size_t i = 0; i < a.size(); i += per_chunk)
+    {
+        buf.clear();
+        vector_text_detail::format<N, T>(a.subspan(i, std::min(per_chunk, a.size() - i)), buf, fmt.delimiter);
+        out.write(buf.data(), std::streamsize(buf.size()));
+    }
+}
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef VECTOR_THREAD_POOL_H
+#define VECTOR_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Work-stealing thread pool behind the parallel batch operations.
+//
+// parallel_for(blocks, f) calls f(b) once for every block index b in [0, blocks). The
+// blocks are first dealt out as one contiguous run per thread, always the same run
+// for the same block count, so a thread keeps walking the stretch of an array whose
+// pages it touched first (and which the kernel therefore placed on its NUMA node).
+// A thread that finishes its run steals the far half of another thread's run. Which
+// thread executes a block never changes what the block computes, so callers that
+// combine per-block results in block order get the same answer for any thread count.
+//
+// The calling thread works as thread 0. Calls from inside a block, and calls on a
+// pool of one thread, run inline in block order. If a block throws, no further blocks
+// are started; parallel_for waits for the ones already running and rethrows the first
+// exception on the calling thread.
+
+struct vector_thread_pool
+{
+    explicit vector_thread_pool(std::size_t threads = 0);      // 0 = std::thread::hardware_concurrency()
+    ~vector_thread_pool();
+
+    vector_thread_pool(const vector_thread_pool&) = delete;
+    vector_thread_pool& operator=(const vector_thread_pool&) = delete;
+
+    std::size_t size() const;       // Threads taking part in a parallel_for, the caller included
+
+    template <typename F>
+    void parallel_for(std::size_t blocks, F&& f);
+
+    /* Internals */
+
+    struct alignas(64) run          // Unclaimed blocks [begin, end) packed as begin | end << 32
+    {
+        std::atomic<std::uint64_t> range;
+    };
+
+    static std::uint64_t pack(std::uint64_t begin, std::uint64_t end) { return begin | end << 32; }
+    static bool& inside_block();    // Set on pool threads and on the caller while it works
+
+    void work(std::size_t id);      // Drain the own run, then steal until every run is empty
+    void run_block(std::size_t b);  // job(b), keeping the first exception
+    void worker_main(std::size_t id);
+
+    std::size_t              nthreads;
+    std::unique_ptr<run[]>   runs;
+    std::vector<std::thread> workers;
+
+    std::mutex               call;          // One parallel_for at a time
+    std::mutex               mutex;         // Guards everything below
+    std::condition_variable  wake;
+    std::condition_variable  done;
+    std::uint64_t            generation;
+    std::size_t              busy;          // Workers still inside the current job
+    bool                     stop;
+    void                     (*job)(void* ctx, std::size_t block);
+    void*                    job_ctx;
+    std::exception_ptr       error;         // First exception of the current job
+    std::atomic<bool>        failed;        // error is set, stop handing out blocks
+};
+
+/* ctors */
+
+inline vector_thread_pool::vector_thread_pool(std::size_t threads)
+    : nthreads(threads ? threads : std::max<std::size_t>(1, std::thread::hardware_concurrency())),
+      runs(new run[nthreads]), generation(0), busy(0), stop(false), job(nullptr), job_ctx(nullptr), failed(false)
+{
+    for (std::size_t t = 0; t < nthreads; ++t)
+        runs[t].range.store(0, std::memory_order_relaxed);
+    workers.reserve(nthreads - 1);
+    for (std::size_t t = 1; t < nthreads; ++t)
+        workers.emplace_back(&vector_thread_pool::worker_main, this, t);
+}
+
+inline vector_thread_pool::~vector_thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for (std::thread& w : workers)
+        w.join();
+}
+
+inline std::size_t vector_thread_pool::size() const
+{
+    return nthreads;
+}
+
+inline bool& vector_thread_pool::inside_block()
+{
+    static thread_local bool flag = false;
+    return flag;
+}
+
+template <typename F>
+void vector_thread_pool::parallel_for(std::size_t blocks, F&& f)
+{
+    if (blocks == 0)
+        return;
+    if (nthreads == 1 || blocks == 1 || inside_block())
+    {
+        for (std::size_t b = 0; b < blocks; ++b)
+            f(b);
+        return;
+    }
+    assert(blocks < (std::uint64_t(1) << 32));
+
+    std::lock_guard<std::mutex> serial(call);
+    for (std::size_t t = 0; t < nthreads; ++t)
+        runs[t].range.store(pack(blocks * t / nthreads, blocks * (t + 1) / nthreads), std::memory_order_relaxed);
+
+    using G = std::remove_reference_t<F>;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = [](void* ctx, std::size_t b) { (*static_cast<G*>(ctx))(b); };
+        job_ctx = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+        busy = nthreads - 1;
+        error = nullptr;
+        failed.store(false, std::memory_order_relaxed);
+        ++generation;
+    }
+    wake.notify_all();
+
+    inside_block() = true;
+    work(0);                // Never throws, the blocks' exceptions land in error
+    inside_block() = false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busy == 0; });
+    if (error)
+    {
+        const std::exception_ptr e = std::exchange(error, nullptr);
+        lock.unlock();
+        std::rethrow_exception(e);
+    }
+}
+
+inline void vector_thread_pool::run_block(std::size_t b)
+{
+    try
+    {
+        job(job_ctx, b);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error)
+            error = std::current_exception();
+        failed.store(true, std::memory_order_relaxed);
+    }
+}
+
+inline void vector_thread_pool::work(std::size_t id)
+{
+    std::atomic<std::uint64_t>& own = runs[id].range;
+    for (;;)
+    {
+        std::uint64_t r = own.load(std::memory_order_acquire);
+        for (;;)        // Own run, from the front
+        {
+            const std::uint64_t begin = r & 0xffffffffu;
+            const std::uint64_t end = r >> 32;
+            if (begin >= end || failed.load(std::memory_order_relaxed))
+                break;
+            if (own.compare_exchange_weak(r, pack(begin + 1, end), std::memory_order_acq_rel))
+            {
+                run_block(std::size_t(begin));
+                r = own.load(std::memory_order_acquire);
+            }
+        }
+
+        bool stole = false;
+        for (std::size_t k = 1; k < nthreads && !stole; ++k)    // Far half of the next non empty run
+        {
+            std::atomic<std::uint64_t>& victim = runs[(id + k) % nthreads].range;
+            std::uint64_t v = victim.load(std::memory_order_acquire);
+            for (;;)
+            {
+                const std::uint64_t begin = v & 0xffffffffu;
+                const std::uint64_t end = v >> 32;
+                if (begin >= end)
+                    break;
+                const std::uint64_t mid = begin + (end - begin) / 2;
+                if (victim.compare_exchange_weak(v, pack(begin, mid), std::memory_order_acq_rel))
+                {
+                    own.store(pack(mid, end), std::memory_order_release);
+                    stole = true;
+                    break;
+                }
+            }
+        }
+        if (!stole || failed.load(std::memory_order_relaxed))
+            return;
+    }
+}
+
+inline void vector_thread_pool::worker_main(std::size_t id)
+{
+    inside_block() = true;
+    std::uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stop || generation != seen; });
+            if (stop)
+                return;
+            seen = generation;
+        }
+
+        work(id);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0)
+            done.notify_one();
+    }
+}
+
+#endif
@@ -0,0 +1,402 @@
+#ifndef VECTOR_TRANSFORM_H
+#define VECTOR_TRANSFORM_H
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#include "matrix3.hpp"
+#include "matrix4.hpp"
+#include "quaternion.hpp"
+#include "vector3.hpp"
+#include "vector3_simd.hpp"
+#include "vector_soa.hpp"
+#include "vector_thread_pool.hpp"
+
+// Batch transforms of vector3 arrays by matrix3, matrix4, quaternion and
+// dual_quaternion.
+//
+//     batch_transform_points      m.transform_point(a[i]), per element or for one m
+//     batch_transform_vectors     m.transform_vector(a[i]), no translation
+//     batch_transform             matrix3 * a[i]
+//     batch_transform_normals     (n * a[i]).normalize_safe(), n = normal_matrix(model)
+//     batch_rotate                q.rotate(a[i]) per element, q.to_matrix3() * a[i] for one q
+//     batch_transform_instances   out[k * a.size() + i] = m[k].transform_point(a[i])
+//
+// The kernels follow the vector3_simd dispatch (set_simd_level applies), except for a
+// matrix4 per element, which is bandwidth bound and runs the scalar loop. A single
+// quaternion or dual quaternion is converted to its matrix once and applied as one, so
+// the result matches to_matrix3() * v and to_matrix4().transform_point(v), which can
+// differ from rotate and transform_point in the last bit. Otherwise every backend
+// returns the same bits as the scalar member functions, as long as those are not
+// contracted into FMAs: with -mfma or -march=native that needs -ffp-contract=off for
+// the whole translation unit, the backends agree with each other either way. Fused
+// normalization has the normalize_safe error bound. With a pool the array is split into
+// transform_block sized blocks, which changes nothing in the results. out must be at
+// least as long as the input and must not overlap it, except out == a which is allowed.
+
+constexpr std::size_t transform_block = 16384;      // vector3 per parallel block
+
+namespace vector_transform_detail
+{
+
+template <typename F>
+void blocks(std::size_t n, vector_thread_pool* pool, F&& f)        // f(first, count) per block
+{
+    const std::size_t count = (n + transform_block - 1) / transform_block;
+    const auto block = [&](std::size_t b)
+    {
+        const std::size_t first = b * transform_block;
+        f(first, n - first < transform_block ? n - first : transform_block);
+    };
+    if (pool && count > 1)
+        pool->parallel_for(count, block);
+    else
+        for (std::size_t b = 0; b < count; ++b)
+            block(b);
+}
+
+} // namespace vector_transform_detail
+
+/* Scalar backend */
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_transform_scalar
+{
+
+template <typename T>
+using pack = vector3_simd_scalar::pack<T>;
+
+#include "vector_transform_kernels.hpp"
+
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+#if VECTOR3_SIMD_X86
+
+/* SSE4.1 backend, 4 floats or 2 doubles */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_transform_sse41
+{
+
+template <typename T>
+using pack = std::conditional_t<std::is_same_v<T, float>, vector3_simd_sse41::pack_f, vector3_simd_sse41::pack_d>;
+
+#include "vector_transform_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX2 backend, 8 floats or 4 doubles */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace vector_transform_avx2
+{
+
+template <typename T>
+using pack = std::conditional_t<std::is_same_v<T, float>, vector3_simd_avx2::pack_f, vector3_simd_avx2::pack_d>;
+
+#include "vector_transform_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/* AVX-512 backend, 16 floats or 8 doubles */
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"  // False positives inside GCC's own avx512fintrin.h
+#endif
+
+namespace vector_transform_avx512
+{
+
+template <typename T>
+using pack = std::conditional_t<std::is_same_v<T, float>, vector3_simd_avx512::pack_f, vector3_simd_avx512::pack_d>;
+
+#include "vector_transform_kernels.hpp"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+#endif // VECTOR3_SIMD_X86
+
+/* Dispatch on the active simd_level, over blocks */
+
+#if VECTOR3_SIMD_X86
+#define VECTOR_TRANSFORM_DISPATCH(...)                                      \
+    switch (active_simd_level())                                            \
+    {                                                                       \
+    case simd_level::avx512: vector_transform_avx512::__VA_ARGS__; return;  \
+    case simd_level::avx2:   vector_transform_avx2::__VA_ARGS__;   return;  \
+    case simd_level::sse41:  vector_transform_sse41::__VA_ARGS__;  return;  \
+    case simd_level::scalar: vector_transform_scalar::__VA_ARGS__; return;  \
+    }
+#else
+#define VECTOR_TRANSFORM_DISPATCH(...) vector_transform_scalar::__VA_ARGS__;
+#endif
+
+namespace vector_transform_detail
+{
+
+template <typename T, bool Translate, bool Normalize>
+void affine(const matrix4<T>& m, std::span<const vector3<T>> a, std::span<vector3<T>> out, vector_thread_pool* pool)
+{
+    assert(out.size() >= a.size());
+    blocks(a.size(), pool, [&](std::size_t i, std::size_t n)
+    {
+        VECTOR_TRANSFORM_DISPATCH(affine<T, Translate, Normalize>(m, a.data() + i, out.data() + i, n))
+    });
+}
+
+template <typename T, bool Translate, bool Normalize>
+void affine_soa(const matrix4<T>& m, const vector3_soa<T>& a, vector3_soa<T>& out, vector_thread_pool* pool)
+{
+    if (&out != &a)
+        out.resize(a.size());
+    const T* ax = a.x_ptr();
+    const T* ay = a.y_ptr();
+    const T* az = a.z_ptr();
+    T* ox = out.x_ptr();
+    T* oy = out.y_ptr();
+    T* oz = out.z_ptr();
+    blocks(a.size(), pool, [&](std::size_t i, std::size_t n)
+    {
+        VECTOR_TRANSFORM_DISPATCH(affine_soa<T, Translate, Normalize>(m, ax + i, ay + i, az + i, ox + i, oy + i, oz + i, n))
+    });
+}
+
+template <typename T>
+void affine_each(std::span<const matrix4<T>> m, std::span<const vector3<T>> a, std::span<vector3<T>> out, vector_thread_pool* pool)
+{
+    assert(m.size() == a.size() && out.size() >= a.size());
+    blocks(a.size(), pool, [&](std::size_t i, std::size_t n)     // Scalar: transposing 12 elements per matrix into lanes costs more than it saves
+    {
+        for (const std::size_t end = i + n; i < end; ++i)
+            out[i] = m[i].transform_point(a[i]);
+    });
+}
+
+template <typename T>
+void rotate_each(std::span<const quaternion<T>> q, std::span<const vector3<T>> a, std::span<vector3<T>> out, vector_thread_pool* pool)
+{
+    assert(q.size() == a.size() && out.size() >= a.size());
+    blocks(a.size(), pool, [&](std::size_t i, std::size_t n)
+    {
+        VECTOR_TRANSFORM_DISPATCH(rotate_each(q.data() + i, a.data() + i, out.data() + i, n))
+    });
+}
+
+template <typename T>
+void dual_each(std::span<const dual_quaternion<T>> d, std::span<const vector3<T>> a, std::span<vector3<T>> out, vector_thread_pool* pool)
+{
+    assert(d.size() == a.size() && out.size() >= a.size());
+    blocks(a.size(), pool, [&](std::size_t i, std::size_t n)
+    {
+        VECTOR_TRANSFORM_DISPATCH(dual_each(d.data() + i, a.data() + i, out.data() + i, n))
+    });
+}
+
+template <typename T>
+void instances(std::span<const matrix4<T>> m, std::span<const vector3<T>> a, std::span<vector3<T>> out, vector_thread_pool* pool)
+{
+    assert(out.size() >= m.size() * a.size());
+    const auto instance = [&](std::size_t k)
+    {
+        vector_transform_detail::affine<T, true, false>(m[k], a, out.subspan(k * a.size(), a.size()), nullptr);
+    };
+    if (pool && m.size() > 1 && a.size() < transform_block)     // Small meshes: one instance per task
+        pool->parallel_for(m.size(), instance);
+    else
+        for (std::size_t k = 0; k < m.size(); ++k)
+            vector_transform_detail::affine<T, true, false>(m[k], a, out.subspan(k * a.size(), a.size()), pool);
+}
+
+} // namespace vector_transform_detail
+
+#undef VECTOR_TRANSFORM_DISPATCH
+
+/* One transform for the whole array */
+
+inline void batch_transform_points(const matrix4<float>& m, std::span<const vector3<float>> a, std::span<vector3<float>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine<float, true, false>(m, a, out, pool);
+}
+
+inline void batch_transform_vectors(const matrix4<float>& m, std::span<const vector3<float>> a, std::span<vector3<float>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine<float, false, false>(m, a, out, pool);
+}
+
+inline void batch_transform(const matrix3<float>& m, std::span<const vector3<float>> a, std::span<vector3<float>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine<float, false, false>(matrix4<float>(m, vector3<float>(0.0f)), a, out, pool);
+}
+
+inline void batch_transform_normals(const matrix3<float>& n, std::span<const vector3<float>> a, std::span<vector3<float>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine<float, false, true>(matrix4<float>(n, vector3<float>(0.0f)), a, out, pool);
+}
+
+inline void batch_rotate(const quaternion<float>& q, std::span<const vector3<float>> a, std::span<vector3<float>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine<float, false, false>(q.to_matrix4(), a, out, pool);
+}
+
+inline void batch_transform_points(const dual_quaternion<float>& d, std::span<const vector3<float>> a, std::span<vector3<float>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine<float, true, false>(d.to_matrix4(), a, out, pool);
+}
+
+inline void batch_transform_points(const matrix4<double>& m, std::span<const vector3<double>> a, std::span<vector3<double>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine<double, true, false>(m, a, out, pool);
+}
+
+inline void batch_transform_vectors(const matrix4<double>& m, std::span<const vector3<double>> a, std::span<vector3<double>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine<double, false, false>(m, a, out, pool);
+}
+
+inline void batch_transform(const matrix3<double>& m, std::span<const vector3<double>> a, std::span<vector3<double>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine<double, false, false>(matrix4<double>(m, vector3<double>(0.0)), a, out, pool);
+}
+
+inline void batch_transform_normals(const matrix3<double>& n, std::span<const vector3<double>> a, std::span<vector3<double>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine<double, false, true>(matrix4<double>(n, vector3<double>(0.0)), a, out, pool);
+}
+
+inline void batch_rotate(const quaternion<double>& q, std::span<const vector3<double>> a, std::span<vector3<double>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine<double, false, false>(q.to_matrix4(), a, out, pool);
+}
+
+inline void batch_transform_points(const dual_quaternion<double>& d, std::span<const vector3<double>> a, std::span<vector3<double>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine<double, true, false>(d.to_matrix4(), a, out, pool);
+}
+
+/* SoA arrays, out is resized to a.size() */
+
+inline void batch_transform_points(const matrix4<float>& m, const vector3_soa<float>& a, vector3_soa<float>& out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine_soa<float, true, false>(m, a, out, pool);
+}
+
+inline void batch_transform_vectors(const matrix4<float>& m, const vector3_soa<float>& a, vector3_soa<float>& out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine_soa<float, false, false>(m, a, out, pool);
+}
+
+inline void batch_transform_normals(const matrix3<float>& n, const vector3_soa<float>& a, vector3_soa<float>& out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine_soa<float, false, true>(matrix4<float>(n, vector3<float>(0.0f)), a, out, pool);
+}
+
+inline void batch_transform_points(const matrix4<double>& m, const vector3_soa<double>& a, vector3_soa<double>& out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine_soa<double, true, false>(m, a, out, pool);
+}
+
+inline void batch_transform_vectors(const matrix4<double>& m, const vector3_soa<double>& a, vector3_soa<double>& out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine_soa<double, false, false>(m, a, out, pool);
+}
+
+inline void batch_transform_normals(const matrix3<double>& n, const vector3_soa<double>& a, vector3_soa<double>& out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine_soa<double, false, true>(matrix4<double>(n, vector3<double>(0.0)), a, out, pool);
+}
+
+/* One transform per element, m[i] applies to a[i] */
+
+inline void batch_transform_points(std::span<const matrix4<float>> m, std::span<const vector3<float>> a, std::span<vector3<float>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine_each(m, a, out, pool);
+}
+
+inline void batch_rotate(std::span<const quaternion<float>> q, std::span<const vector3<float>> a, std::span<vector3<float>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::rotate_each(q, a, out, pool);
+}
+
+inline void batch_transform_points(std::span<const dual_quaternion<float>> d, std::span<const vector3<float>> a, std::span<vector3<float>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::dual_each(d, a, out, pool);
+}
+
+inline void batch_transform_points(std::span<const matrix4<double>> m, std::span<const vector3<double>> a, std::span<vector3<double>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::affine_each(m, a, out, pool);
+}
+
+inline void batch_rotate(std::span<const quaternion<double>> q, std::span<const vector3<double>> a, std::span<vector3<double>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::rotate_each(q, a, out, pool);
+}
+
+inline void batch_transform_points(std::span<const dual_quaternion<double>> d, std::span<const vector3<double>> a, std::span<vector3<double>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::dual_each(d, a, out, pool);
+}
+
+/* Instancing, every transform applied to the whole array */
+
+inline void batch_transform_instances(std::span<const matrix4<float>> m, std::span<const vector3<float>> a, std::span<vector3<float>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::instances(m, a, out, pool);
+}
+
+inline void batch_transform_instances(std::span<const matrix4<double>> m, std::span<const vector3<double>> a, std::span<vector3<double>> out, vector_thread_pool* pool = nullptr)
+{
+    vector_transform_detail::instances(m, a, out, pool);
+}
+
+#endif
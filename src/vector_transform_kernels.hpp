@@ -0,0 +1,186 @@
+// Batch transform kernels shared by every backend. This file is included once per
+// instruction set from vector_transform.hpp, inside a namespace that defines
+// pack<T>, the vector3_simd pack of that instruction set, so it intentionally has no
+// include guard.
+//
+// A transform is applied in registers: the 3 x 4 affine part of a matrix4 is
+// broadcast once, or per element quaternions are transposed into lanes, and each
+// block of width vectors is deinterleaved with load3, transformed and written back
+// with store3. The arithmetic is the scalar code's, in the same order, so every
+// backend returns the same bits as matrix4::transform_point, quaternion::rotate and
+// dual_quaternion::transform_point; the exception is the fused normalization, which
+// is normalize_safe with its documented error bound. Remainders go through the scalar
+// backend, one lane at a time, as it is compiled without FMA contraction like the
+// others and the member functions may not be.
+
+// Transposes K consecutive scalars of width structures, stride scalars apart, into K
+// registers: r[k] lane l = p[l * stride + k]. Every scalar is staged before the first
+// load, so the loads do not each wait on a store they only partly overlap.
+template <typename P, std::size_t K>
+inline void lanes(const typename P::scalar* p, std::size_t stride, typename P::reg* r)
+{
+    alignas(64) typename P::scalar t[K][P::width];
+    for (std::size_t l = 0; l < P::width; ++l)
+        for (std::size_t k = 0; k < K; ++k)
+            t[k][l] = p[l * stride + k];
+    for (std::size_t k = 0; k < K; ++k)
+        r[k] = P::load(t[k]);
+}
+
+template <typename P>
+struct affine_rows              // m[4 * i + j] holds element (i, j) of the matrix, i < 3
+{
+    typename P::reg m[12];
+
+    static affine_rows<P> broadcast(const matrix4<typename P::scalar>& a)
+    {
+        affine_rows<P> r;
+        for (std::size_t i = 0; i < 3; ++i)
+            for (std::size_t j = 0; j < 4; ++j)
+                r.m[4 * i + j] = P::set1(a(i, j));
+        return r;
+    }
+};
+
+template <typename P, bool Translate>
+inline void apply(const affine_rows<P>& r, typename P::reg& x, typename P::reg& y, typename P::reg& z)
+{
+    typename P::reg o[3];
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        o[i] = P::add(P::add(P::mul(r.m[4 * i], x), P::mul(r.m[4 * i + 1], y)), P::mul(r.m[4 * i + 2], z));
+        if constexpr (Translate)
+            o[i] = P::add(o[i], r.m[4 * i + 3]);
+    }
+    x = o[0];
+    y = o[1];
+    z = o[2];
+}
+
+template <typename P>
+inline void normalize_safe(typename P::reg& x, typename P::reg& y, typename P::reg& z)
+{
+    const typename P::reg l = P::add(P::add(P::mul(x, x), P::mul(y, y)), P::mul(z, z));
+    const typename P::reg r = P::keep_gt(P::rsqrt(l), l, P::set1(std::numeric_limits<typename P::scalar>::min()));
+    x = P::mul(x, r);
+    y = P::mul(y, r);
+    z = P::mul(z, r);
+}
+
+template <typename P>
+inline void cross(typename P::reg ax, typename P::reg ay, typename P::reg az, typename P::reg bx, typename P::reg by, typename P::reg bz,
+                  typename P::reg& x, typename P::reg& y, typename P::reg& z)
+{
+    x = P::sub(P::mul(ay, bz), P::mul(az, by));
+    y = P::sub(P::mul(az, bx), P::mul(ax, bz));
+    z = P::sub(P::mul(ax, by), P::mul(ay, bx));
+}
+
+template <typename P>
+inline void rotate(const typename P::reg* q, typename P::reg& x, typename P::reg& y, typename P::reg& z)     // q = x, y, z, w lanes
+{
+    const typename P::reg two = P::set1(typename P::scalar(2));
+    typename P::reg tx, ty, tz, cx, cy, cz;
+    cross<P>(q[0], q[1], q[2], x, y, z, tx, ty, tz);
+    tx = P::mul(tx, two);
+    ty = P::mul(ty, two);
+    tz = P::mul(tz, two);
+    cross<P>(q[0], q[1], q[2], tx, ty, tz, cx, cy, cz);
+    x = P::add(P::add(x, P::mul(tx, q[3])), cx);
+    y = P::add(P::add(y, P::mul(ty, q[3])), cy);
+    z = P::add(P::add(z, P::mul(tz, q[3])), cz);
+}
+
+/* One transform for every element */
+
+template <typename T, bool Translate, bool Normalize>
+void affine(const matrix4<T>& m, const vector3<T>* a, vector3<T>* out, std::size_t n)
+{
+    using P = pack<T>;
+    const affine_rows<P> r = affine_rows<P>::broadcast(m);
+    const T* pa = reinterpret_cast<const T*>(a);
+    T* po = reinterpret_cast<T*>(out);
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width)
+    {
+        typename P::reg x, y, z;
+        P::load3(pa + 3 * i, x, y, z);
+        apply<P, Translate>(r, x, y, z);
+        if constexpr (Normalize)
+            normalize_safe<P>(x, y, z);
+        P::store3(po + 3 * i, x, y, z);
+    }
+    if (i < n)
+        vector_transform_scalar::affine<T, Translate, Normalize>(m, a + i, out + i, n - i);
+}
+
+template <typename T, bool Translate, bool Normalize>
+void affine_soa(const matrix4<T>& m, const T* ax, const T* ay, const T* az, T* ox, T* oy, T* oz, std::size_t n)
+{
+    using P = pack<T>;
+    const affine_rows<P> r = affine_rows<P>::broadcast(m);
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width)
+    {
+        typename P::reg x = P::load(ax + i), y = P::load(ay + i), z = P::load(az + i);
+        apply<P, Translate>(r, x, y, z);
+        if constexpr (Normalize)
+            normalize_safe<P>(x, y, z);
+        P::store(ox + i, x);
+        P::store(oy + i, y);
+        P::store(oz + i, z);
+    }
+    if (i < n)
+        vector_transform_scalar::affine_soa<T, Translate, Normalize>(m, ax + i, ay + i, az + i, ox + i, oy + i, oz + i, n - i);
+}
+
+/* One quaternion or dual quaternion per element, transposed into lanes */
+
+template <typename T>
+void rotate_each(const quaternion<T>* q, const vector3<T>* a, vector3<T>* out, std::size_t n)
+{
+    using P = pack<T>;
+    const T* pa = reinterpret_cast<const T*>(a);
+    T* po = reinterpret_cast<T*>(out);
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width)
+    {
+        typename P::reg r[4], x, y, z;
+        lanes<P, 4>(q[i].ptr(), 4, r);
+        P::load3(pa + 3 * i, x, y, z);
+        rotate<P>(r, x, y, z);
+        P::store3(po + 3 * i, x, y, z);
+    }
+    if (i < n)
+        vector_transform_scalar::rotate_each<T>(q + i, a + i, out + i, n - i);
+}
+
+template <typename T>
+void dual_each(const dual_quaternion<T>* d, const vector3<T>* a, vector3<T>* out, std::size_t n)
+{
+    using P = pack<T>;
+    const T* pa = reinterpret_cast<const T*>(a);
+    T* po = reinterpret_cast<T*>(out);
+    const typename P::reg two = P::set1(T(2));
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width)
+    {
+        typename P::reg q[8], x, y, z, cx, cy, cz;
+        lanes<P, 8>(d[i].real.ptr(), 8, q);
+        const typename P::reg* r = q;          // real
+        const typename P::reg* e = q + 4;      // dual
+        cross<P>(r[0], r[1], r[2], e[0], e[1], e[2], cx, cy, cz);      // translation() = ((d w_r - r w_d) + r x d) 2
+        const typename P::reg tx = P::mul(P::add(P::sub(P::mul(e[0], r[3]), P::mul(r[0], e[3])), cx), two);
+        const typename P::reg ty = P::mul(P::add(P::sub(P::mul(e[1], r[3]), P::mul(r[1], e[3])), cy), two);
+        const typename P::reg tz = P::mul(P::add(P::sub(P::mul(e[2], r[3]), P::mul(r[2], e[3])), cz), two);
+        P::load3(pa + 3 * i, x, y, z);
+        rotate<P>(r, x, y, z);
+        P::store3(po + 3 * i, P::add(x, tx), P::add(y, ty), P::add(z, tz));
+    }
+    if (i < n)
+        vector_transform_scalar::dual_each<T>(d + i, a + i, out + i, n - i);
+}
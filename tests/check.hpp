@@ -0,0 +1,33 @@
+#ifndef VECTOR_TESTS_CHECK_H
+#define VECTOR_TESTS_CHECK_H
+
+#include <cstdio>
+
+// What every test shares: CHECK prints a printf style message for a failed condition
+// and counts it in failures, which main() turns into the exit code after running on.
+
+inline int failures = 0;
+
+#define CHECK(cond, ...)                                                    \
+    do                                                                      \
+    {                                                                       \
+        if (!(cond))                                                        \
+        {                                                                   \
+            std::printf("%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond); \
+            std::printf(__VA_ARGS__);                                       \
+            std::printf("\n");                                              \
+            ++failures;                                                     \
+        }                                                                   \
+    } while (0)
+
+// True for the -mfma builds on a CPU without FMA, which exit with 77 so CTest skips them
+inline bool fma_unavailable()
+{
+#if defined(__FMA__) && (defined(__GNUC__) || defined(__clang__))
+    return !__builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+#endif
@@ -0,0 +1,171 @@
+#include "vector_codec.hpp"
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Checks the documented bounds of vector_codec.hpp on every simd_level the CPU supports:
+// the octahedral angular errors, vector3_quantizer::max_error() and the delta stream round
+// trip, plus bit equality of the batch functions with the scalar codecs. Exits nonzero on
+// the first failing level.
+
+static const char* level_name(simd_level l)
+{
+    switch (l)
+    {
+    case simd_level::avx512: return "avx512";
+    case simd_level::avx2:   return "avx2";
+    case simd_level::sse41:  return "sse41";
+    case simd_level::scalar: return "scalar";
+    }
+    return "?";
+}
+
+static double angle(const vector3<float>& a, const vector3<float>& b)     // Radians, accurate for tiny angles too
+{
+    const double ax = a.x, ay = a.y, az = a.z;
+    const double bx = b.x, by = b.y, bz = b.z;
+    const double cx = ay * bz - az * by;
+    const double cy = az * bx - ax * bz;
+    const double cz = ax * by - ay * bx;
+    return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), ax * bx + ay * by + az * bz);
+}
+
+static std::vector<vector3<float>> directions(std::size_t n)     // Random unit vectors plus the awkward ones
+{
+    std::vector<vector3<float>> d;
+    for (int x = -1; x <= 1; ++x)                                   // Axes, face and corner diagonals
+        for (int y = -1; y <= 1; ++y)
+            for (int z = -1; z <= 1; ++z)
+                if (x || y || z)
+                    d.push_back({float(x), float(y), float(z)});
+    d.push_back({1.0f, 0.0f, -1e-7f});                               // Just below the equator
+    d.push_back({0.0f, -1.0f, -1e-7f});
+    d.push_back({1e-7f, 1e-7f, -1.0f});                              // Near the folded pole
+
+    std::mt19937 rng(12345);
+    std::normal_distribution<double> g;
+    while (d.size() < n)
+    {
+        const double x = g(rng), y = g(rng), z = g(rng);
+        const double l = std::sqrt(x * x + y * y + z * z);
+        if (l > 1e-6)
+            d.push_back({float(x / l), float(y / l), float(z / l)});
+    }
+    for (vector3<float>& v : d)
+    {
+        const double l = std::sqrt(double(v.x) * v.x + double(v.y) * v.y + double(v.z) * v.z);
+        v = {float(v.x / l), float(v.y / l), float(v.z / l)};
+    }
+    return d;
+}
+
+template <typename O>
+static void test_oct(const std::vector<vector3<float>>& d, float bound, const char* name)
+{
+    std::vector<O> enc(d.size());
+    std::vector<vector3<float>> dec(d.size());
+    batch_oct_encode(d, enc);
+    batch_oct_decode(enc, dec);
+
+    double worst = 0.0;
+    for (std::size_t i = 0; i < d.size(); ++i)
+    {
+        const O s = O::encode(d[i]);
+        const vector3<float> r = s.decode();
+        CHECK(enc[i] == s, "%s batch encode differs from scalar at %zu", name, i);
+        CHECK(dec[i].x == r.x && dec[i].y == r.y && dec[i].z == r.z, "%s batch decode differs from scalar at %zu", name, i);
+        worst = std::max(worst, angle(d[i], dec[i]));
+        if (failures > 20)
+            return;
+    }
+    CHECK(worst <= bound, "%s worst angular error %.3g above %.3g", name, worst, double(bound));
+}
+
+static void test_quantizer()
+{
+    const vector3_quantizer boxes[] = {
+        {{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}},
+        {{-512.5f, 0.25f, 1000.0f}, {250.0f, 7.0f, 1.0e5f}},
+        {{3.0f, -2.0f, 5.0f}, {3.0f, 2.0f, 5.0f}},                  // Flat axes
+    };
+
+    std::mt19937 rng(678);
+    for (const vector3_quantizer& q : boxes)
+    {
+        std::vector<vector3<float>> p;
+        for (int c = 0; c < 8; ++c)                                  // Corners first
+            p.push_back({c & 1 ? q.hi.x : q.lo.x, c & 2 ? q.hi.y : q.lo.y, c & 4 ? q.hi.z : q.lo.z});
+        std::uniform_real_distribution<float> ux(q.lo.x, std::nextafter(q.hi.x, q.hi.x + 1.0f));
+        std::uniform_real_distribution<float> uy(q.lo.y, std::nextafter(q.hi.y, q.hi.y + 1.0f));
+        std::uniform_real_distribution<float> uz(q.lo.z, std::nextafter(q.hi.z, q.hi.z + 1.0f));
+        while (p.size() < 100000)
+            p.push_back({std::clamp(ux(rng), q.lo.x, q.hi.x), std::clamp(uy(rng), q.lo.y, q.hi.y), std::clamp(uz(rng), q.lo.z, q.hi.z)});
+
+        std::vector<vector3_q16> enc(p.size());
+        std::vector<vector3<float>> dec(p.size());
+        batch_quantize(q, p, enc);
+        batch_dequantize(q, enc, dec);
+
+        const vector3<float> e = q.max_error();
+        for (std::size_t i = 0; i < p.size() && failures <= 20; ++i)
+        {
+            const vector3_q16 s = q.encode(p[i]);
+            const vector3<float> r = q.decode(s);
+            CHECK(enc[i] == s, "batch_quantize differs from scalar at %zu", i);
+            CHECK(dec[i].x == r.x && dec[i].y == r.y && dec[i].z == r.z, "batch_dequantize differs from scalar at %zu", i);
+            CHECK(std::fabs(dec[i].x - p[i].x) <= e.x && std::fabs(dec[i].y - p[i].y) <= e.y && std::fabs(dec[i].z - p[i].z) <= e.z,
+                  "quantizer error above max_error() at (%g, %g, %g)", double(p[i].x), double(p[i].y), double(p[i].z));
+        }
+    }
+}
+
+static void test_delta()
+{
+    std::vector<vector3_q16> q = {{0, 0, 0}, {65535, 65535, 65535}, {0, 65535, 0}, {32768, 32767, 1}, {32768, 32767, 1}};
+    std::mt19937 rng(91011);
+    for (int i = 0; i < 10000; ++i)
+        q.push_back({std::uint16_t(rng()), std::uint16_t(q.back().y + rng() % 7 - 3), std::uint16_t(rng() % 3)});
+
+    std::vector<std::uint8_t> bytes = {0xAB};                           // delta_encode appends
+    delta_encode(q, bytes);
+    CHECK(bytes.size() <= 1 + 9 * q.size(), "delta stream of %zu bytes is above 9 per vector", bytes.size() - 1);
+
+    std::vector<vector3_q16> out(q.size());
+    const std::span<const std::uint8_t> in(bytes.data() + 1, bytes.size() - 1);
+    CHECK(delta_decode(in, out) == in.size(), "delta_decode did not read the whole stream");
+    CHECK(out == q, "delta round trip is not exact");
+    CHECK(!delta_decode(in.first(in.size() - 1), out), "delta_decode accepted a truncated stream");
+    CHECK(!delta_decode(std::span<const std::uint8_t>(), out), "delta_decode accepted an empty stream");
+    CHECK(delta_decode(in, std::span<vector3_q16>()) == 0u, "delta_decode failed on an empty out");
+
+    const std::uint8_t overlong[] = {0xff, 0xff, 0x7f, 0, 0};         // A varint above 0xffff
+    CHECK(!delta_decode(overlong, std::span<vector3_q16>(out.data(), 1)), "delta_decode accepted an out of range varint");
+}
+
+int main()
+{
+    const std::vector<vector3<float>> d = directions(1 << 20);
+
+    const simd_level levels[] = {simd_level::scalar, simd_level::sse41, simd_level::avx2, simd_level::avx512};
+    for (simd_level l : levels)
+    {
+        if (l > detect_simd_level())
+            continue;
+        set_simd_level(l);
+        std::printf("simd_level %s\n", level_name(active_simd_level()));
+
+        test_oct<vector_oct16>(d, vector_oct16_max_error, "vector_oct16");
+        test_oct<vector_oct32>(d, vector_oct32_max_error, "vector_oct32");
+        test_quantizer();
+        test_delta();
+
+        if (failures)
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "vector_ray_packet.hpp"
+
+#include "check.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Checks that every lane of a ray packet agrees bit for bit with the single ray tests
+// of vector_ray.hpp: closest_hit and any_hit over a triangle_soa, and the box and
+// sphere masks with their distances. CMake builds this file twice, plainly and with
+// -mfma, as both sides must stay free of FMA contraction for the lanes to agree.
+
+static std::uint64_t state = 7;
+
+static double next()        // Uniform in [-1, 1)
+{
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return double(std::int64_t(state) >> 11) * 0x1p-52;
+}
+
+template <typename T>
+static vector3<T> point(double scale)
+{
+    return vector3<T>(T(scale * next()), T(scale * next()), T(scale * next()));
+}
+
+template <typename T>
+static bool same(T a, T b)
+{
+    return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+template <typename T, int W>
+static void test(const char* name)
+{
+    triangle_soa<T> tris;
+    for (int i = 0; i < 300; ++i)
+    {
+        const vector3<T> a = point<T>(1.0);
+        tris.push_back(a, a + point<T>(0.3), a + point<T>(0.3));
+    }
+
+    for (int p = 0; p < 200; ++p)
+    {
+        ray<T> rays[W];
+        const vector3<T> o = point<T>(3.0);
+        for (int i = 0; i < W; ++i)                                 // A coherent bundle towards the scene
+            rays[i] = ray<T>(o, point<T>(0.8) - o, T(0), T(1.5) + T(next()));
+        const ray_packet<T, W> r(rays);
+
+        ray_hit<T> hits[W];
+        const packet_mask found = closest_hit(r, tris, hits);
+        const packet_mask any = any_hit(r, tris);
+
+        const vector3<T> lo = point<T>(0.5), hi = lo + vector3<T>(T(0.4) + T(next()));
+        const vector3<T> center = point<T>(0.7);
+        const T radius = T(0.2) + T(0.3 * next());
+        typename ray_packet<T, W>::lane_type t0{}, t1{}, ts{};
+        const packet_mask box = intersect_box(r, lo, hi, t0, t1);
+        const packet_mask sphere = intersect_sphere(r, center, radius, ts);
+
+        for (int i = 0; i < W; ++i)
+        {
+            const ray_hit<T> h = closest_hit(rays[i], tris);
+            T u = T(0), v = T(0), t = T(0);
+            if (h.index != ray_miss)
+                intersect_triangle(rays[i], tris.vertex(h.index), tris.vertex(h.index) + tris.edge1(h.index), tris.vertex(h.index) + tris.edge2(h.index), t, u, v);
+            const bool lane = (found >> i) & 1;
+            CHECK(lane == (h.index != ray_miss) && hits[i].index == h.index, "%s closest_hit lane %d: %u, single ray %u", name, i, hits[i].index, h.index);
+            if (lane && hits[i].index == h.index)
+                CHECK(same(hits[i].t, h.t) && same(hits[i].u, u) && same(hits[i].v, v), "%s closest_hit lane %d: t, u, v differ", name, i);
+            CHECK(bool((any >> i) & 1) == any_hit(rays[i], tris), "%s any_hit lane %d", name, i);
+
+            T b0, b1, s;
+            const bool hb = intersect_box(rays[i], lo, hi, b0, b1);
+            CHECK(bool((box >> i) & 1) == hb && (!hb || (same(t0[i], b0) && same(t1[i], b1))), "%s intersect_box lane %d", name, i);
+            const bool hs = intersect_sphere(rays[i], center, radius, s);
+            CHECK(bool((sphere >> i) & 1) == hs && (!hs || same(ts[i], s)), "%s intersect_sphere lane %d", name, i);
+            if (failures > 20)
+                return;
+        }
+    }
+}
+
+int main()
+{
+    if (fma_unavailable())
+        return 77;
+    test<float, 4>("ray_packet4f");
+    test<float, 8>("ray_packet8f");
+    test<float, 16>("ray_packet16f");
+    test<double, 2>("ray_packet2d");
+    test<double, 4>("ray_packet4d");
+    test<double, 8>("ray_packet8d");
+    return failures ? 1 : 0;
+}
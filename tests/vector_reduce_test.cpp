@@ -0,0 +1,136 @@
+#include "vector2.hpp"
+#include "vector3.hpp"
+#include "vector4.hpp"
+#include "vector_reduce.hpp"
+
+#include "check.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Checks that the reductions of vector_reduce.hpp return fixed bits: the same with and
+// without a thread pool, and the same as the constants below, which were taken from a
+// build without FMA. CMake builds this file twice, plainly and with -mfma, so the two
+// builds are held to the same bits. The input comes from a fixed LCG, as the std
+// distributions differ between standard libraries.
+
+static std::uint64_t state = 1;
+
+static double next()        // Uniform in [-1, 1), 52 random bits
+{
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return double(std::int64_t(state) >> 11) * 0x1p-52;
+}
+
+static bool same(double a, double b)
+{
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+template <typename V>
+static std::vector<V> random_vectors(std::size_t n)
+{
+    std::vector<V> v(n);
+    for (V& e : v)
+        vector_detail::for_each<V::dimension>([&](auto c) { get<c>(e) = typename V::value_type(next()); });
+    return v;
+}
+
+// Every reduction of a and b, flattened to doubles
+template <typename V>
+static std::vector<double> reduce_all(const std::vector<V>& a, const std::vector<V>& b, const std::vector<typename V::value_type>& w, vector_thread_pool* pool)
+{
+    std::vector<double> r;
+    const V s = reduce_sum(a, pool);
+    const V m = reduce_mean(a, pool);
+    const V ws = reduce_weighted_sum(a, w, pool);
+    vector_detail::for_each<V::dimension>([&](auto c) { r.push_back(get<c>(s)); r.push_back(get<c>(m)); r.push_back(get<c>(ws)); });
+    r.push_back(reduce_dot(a, b, pool));
+    for (const auto& row : reduce_covariance(a, pool))
+        for (auto e : row)
+            r.push_back(e);
+    return r;
+}
+
+template <typename V>
+static void test(const char* name, const std::vector<double>& expected, vector_thread_pool& pool)
+{
+    const std::size_t n = 100003;                                   // Several blocks and a ragged tail
+    const std::vector<V> a = random_vectors<V>(n);
+    const std::vector<V> b = random_vectors<V>(n);
+    std::vector<typename V::value_type> w(n);
+    for (auto& e : w)
+        e = typename V::value_type(next());
+
+    const std::vector<double> r = reduce_all(a, b, w, nullptr);
+    const std::vector<double> rp = reduce_all(a, b, w, &pool);
+    CHECK(r.size() == expected.size(), "%s: %zu results, %zu expected", name, r.size(), expected.size());
+    for (std::size_t i = 0; i < r.size() && i < expected.size(); ++i)
+    {
+        CHECK(same(r[i], expected[i]), "%s: result %zu is %a, expected %a", name, i, r[i], expected[i]);
+        CHECK(same(r[i], rp[i]), "%s: result %zu is %a with a pool, %a without", name, i, rp[i], r[i]);
+    }
+}
+
+// 1e30, 1 and -1e30 in the same lane of a block (elements 0, 4 and 8) in every block: the
+// 1 must survive inside the block, not only in the combine
+template <typename V>
+static void test_cancellation(const char* name, vector_thread_pool& pool)
+{
+    using T = typename V::value_type;
+    const std::size_t blocks = 3;
+    std::vector<V> a(blocks * reduce_block + 5, V(T(0)));
+    for (std::size_t b = 0; b < blocks; ++b)
+    {
+        a[b * reduce_block] = V(T(1e30));
+        a[b * reduce_block + 4] = V(T(1));
+        a[b * reduce_block + 8] = V(T(-1e30));
+    }
+    const V s = reduce_sum(a, nullptr), sp = reduce_sum(a, &pool);
+    CHECK(s == V(T(blocks)) && sp == s, "%s: cancelling sum is %g with a pool, %g without", name, double(sp.x), double(s.x));
+}
+
+int main()
+{
+    if (fma_unavailable())
+        return 77;
+    vector_thread_pool pool(4);
+
+    test<vector3<double>>("vector3<double>", {
+        -0x1.7d71a241cf015p+6, -0x1.f3f37d0889911p-11, -0x1.fa37c74a043a2p+5, -0x1.025009b2bd50ep+7,
+        -0x1.5290bddba156bp-10, 0x1.db1b9fb0735dp+5, -0x1.536d9d25bd81p+5, -0x1.bce1c7e688063p-12,
+        0x1.a2f98a0773b27p+4, 0x1.540c9c3eef60bp+7, 0x1.56d85c41465e1p-2, -0x1.555b7384d61fcp-15,
+        -0x1.3d6f144c659b4p-10, -0x1.555b7384d61fcp-15, 0x1.5379c14126ac9p-2, 0x1.4f6e4e126b188p-10,
+        -0x1.3d6f144c659b4p-10, 0x1.4f6e4e126b188p-10, 0x1.55e3c1648cc9dp-2
+    }, pool);
+    test<vector4<double>>("vector4<double>", {
+        0x1.61d4f111f25efp+7, 0x1.cfc2b0b0d4c68p-10, 0x1.8758f3c56c20bp+5, 0x1.40a395c41bbf8p+7,
+        0x1.a4415e76db1f3p-10, -0x1.3fb6a355f46e9p+5, 0x1.25089d9882e9ep+8, 0x1.8012d4275877cp-9,
+        -0x1.754072870b6cep+6, 0x1.a7d8f8d0a7c44p+6, 0x1.15c3af67b1b7ep-10, 0x1.b0cf9771c69b7p+5,
+        -0x1.a4d6d4cd8ab28p+6, 0x1.55c4f0215535ep-2, -0x1.153bf60dd5ae6p-10, -0x1.23a566c342662p-17,
+        0x1.436a66ce201b4p-9, -0x1.153bf60dd5ae6p-10, 0x1.55018608efb3cp-2, 0x1.426517bc1d2d8p-15,
+        0x1.1a3ccec63356ap-11, -0x1.23a566c342662p-17, 0x1.426517bc1d2d8p-15, 0x1.5582990677633p-2,
+        -0x1.3225a50081a2ap-10, 0x1.436a66ce201b4p-9, 0x1.1a3ccec63356ap-11, -0x1.3225a50081a2ap-10,
+        0x1.5658ed8bb721p-2
+    }, pool);
+    test<vector3<float>>("vector3<float>", {
+        0x1.efe8b4p+6, 0x1.44fd3ap-10, 0x1.0a626ap+0, 0x1.134598p+5,
+        0x1.68cb22p-12, -0x1.a7e6dp+6, -0x1.45f0f2p+5, -0x1.ab347p-12,
+        0x1.0354eep+6, 0x1.076088p+5, 0x1.56916cp-2, 0x1.c522b8p-12,
+        -0x1.693cb6p-11, 0x1.c522b8p-12, 0x1.5448cp-2, 0x1.6573a2p-10,
+        -0x1.693cb6p-11, 0x1.6573a2p-10, 0x1.56f7b4p-2
+    }, pool);
+    test<vector2<float>>("vector2<float>", {
+        -0x1.e96a44p+7, -0x1.40bbc4p-9, 0x1.f020fp+5, -0x1.ca78aap+6,
+        -0x1.2c746cp-10, 0x1.c9345ep+5, 0x1.dd1112p+6, 0x1.56adccp-2,
+        0x1.0dc9aap-9, 0x1.0dc9aap-9, 0x1.5592c6p-2
+    }, pool);
+
+    test_cancellation<vector3<float>>("vector3<float>", pool);
+    test_cancellation<vector2<float>>("vector2<float>", pool);
+    test_cancellation<vector3<double>>("vector3<double>", pool);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+#include "vector3.hpp"
+#include "vector_text.hpp"
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Checks that parse_vectors accepts well formed rows and rejects corrupt ones with the
+// right line, on one thread and with a pool, and that format_vectors round-trips.
+
+static void expect(std::string_view text, std::errc ec, std::size_t line, std::size_t count, const vector_text_format& fmt = {})
+{
+    std::vector<vector3<double>> v;
+    const vector_text_result r = parse_vectors(text, v, fmt);
+    CHECK(r.ec == ec && r.line == line && r.count == count && v.size() == count,
+          "\"%.*s\": ec %d line %zu count %zu", int(text.size()), text.data(), int(r.ec), r.line, r.count);
+}
+
+int main()
+{
+    constexpr std::errc ok{};
+    constexpr std::errc bad = std::errc::invalid_argument;
+    vector_text_format csv;
+    csv.delimiter = ',';
+    vector_text_format extra;
+    extra.extra_fields = true;
+
+    expect("1 2 3\n", ok, 0, 1);
+    expect("  1\t2   -3\r\n\n# comment\n4 5 6", ok, 0, 2);
+    expect("1,2,3\n4 , 5 ,6\n", ok, 0, 2, csv);
+    expect("1 2 3 0.5 0.5\n", ok, 0, 1, extra);
+    expect("1,2,3,0.5\n", ok, 0, 1, [&] { vector_text_format f = csv; f.extra_fields = true; return f; }());
+
+    expect("1-2-3\n", bad, 1, 0);                               // No separator, from_chars would read on
+    expect("1.5.5.5\n", bad, 1, 0);
+    expect("1 2 3\n4-5 6\n", bad, 2, 1);
+    expect("1 2 3x\n", bad, 1, 0);
+    expect("1 2 3-4\n", bad, 1, 0, extra);
+    expect("1,2-3\n", bad, 1, 0, csv);
+    expect("1 2\n", bad, 1, 0);
+
+    // A corrupt row deep in a pooled parse reports the same line as on one thread
+    std::vector<vector3<double>> v(200000);
+    for (std::size_t i = 0; i < v.size(); ++i)
+        v[i] = vector3<double>(double(i), 0.1 * double(i), -1.0 / double(i + 1));
+    std::string text;
+    format_vectors(v, text);
+    vector_thread_pool pool(4);
+    std::vector<vector3<double>> back;
+    vector_text_result r = parse_vectors(text, back, {}, &pool);
+    CHECK(r.ec == std::errc() && back == v, "round trip through format_vectors and a pooled parse");
+
+    vector_text_format tsv;
+    tsv.delimiter = '\t';
+    std::string tab_text;
+    format_vectors(std::span<const vector3<double>>(v.data(), 1000), tab_text, tsv);
+    back.clear();
+    r = parse_vectors(tab_text, back, tsv);
+    CHECK(r.ec == std::errc() && r.count == 1000 && std::equal(back.begin(), back.end(), v.begin()),
+          "round trip with a tab delimiter: ec %d line %zu count %zu", int(r.ec), r.line, r.count);
+
+    const std::size_t at = text.find('\n', text.size() / 2) + 1;      // Line 100001 or so
+    text[text.find(' ', at)] = '-';
+    back.clear();
+    r = parse_vectors(text, back, {}, &pool);
+    std::vector<vector3<double>> one;
+    const vector_text_result r1 = parse_vectors(text, one);
+    CHECK(r.ec == bad && r.line == r1.line && r.count == r1.count && r.line == r.count + 1,
+          "pooled error at line %zu after %zu vectors, one thread at line %zu", r.line, r.count, r1.line);
+
+    return failures ? 1 : 0;
+}
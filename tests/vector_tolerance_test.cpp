@@ -0,0 +1,52 @@
+#include "vector2.hpp"
+#include "vector3.hpp"
+#include "vector3_packet.hpp"
+
+#include "check.hpp"
+
+#include <cstdint>
+#include <initializer_list>
+
+// Checks the eps forms of is_perpendicular, is_opposite and is_collinear at magnitudes
+// where the squared lengths overflow or underflow float, for vectors and packets alike.
+
+template <typename T, int W>
+static void check(const vector3<T>& a, const vector3<T>& b, T eps, bool perpendicular, bool opposite, bool collinear, double scale)
+{
+    const vector3_packet<T, W> pa(a), pb(b);
+    const packet_mask all = packet_mask((std::uint64_t(1) << W) - 1);
+    CHECK(a.is_perpendicular(b, eps) == perpendicular, "is_perpendicular at %g", scale);
+    CHECK(a.is_opposite(b, eps) == opposite, "is_opposite at %g", scale);
+    CHECK(a.is_collinear(b, eps) == collinear, "is_collinear at %g", scale);
+    CHECK(pa.is_perpendicular(pb, eps) == (perpendicular ? all : 0), "packet is_perpendicular at %g", scale);
+    CHECK(pa.is_opposite(pb, eps) == (opposite ? all : 0), "packet is_opposite at %g", scale);
+    CHECK(pa.is_collinear(pb, eps) == (collinear ? all : 0), "packet is_collinear at %g", scale);
+}
+
+template <typename T, int W>
+static void test(std::initializer_list<double> scales)
+{
+    const T eps = T(0.1);
+    for (double scale : scales)
+    {
+        const T s = T(scale);
+        check<T, W>(vector3<T>(s, 0, 0), vector3<T>(s, s * T(0.01), 0), eps, false, false, true, scale);   // Nearly parallel
+        check<T, W>(vector3<T>(s, 0, 0), vector3<T>(0, s, 0), eps, true, false, false, scale);             // Orthogonal
+        check<T, W>(vector3<T>(s, s, 0), vector3<T>(-s, -s, s * T(0.01)), eps, false, true, true, scale);  // Nearly opposite
+        if (scale >= 1e11)
+            check<T, W>(vector3<T>(s, 0, 0), vector3<T>(s, 1, 0), eps, false, false, true, scale);         // 1 is lost next to s
+        check<T, W>(vector3<T>(0, 0, 0), vector3<T>(s, s, s), eps, true, false, true, scale);              // Zero vector
+    }
+}
+
+int main()
+{
+    test<float, 4>({1.0, 1e11, 1e19, 1e30, 3e38, 1e-11, 1e-19, 1e-30, 1e-38});
+    test<float, 8>({1e11, 1e-30});
+    test<double, 2>({1.0, 1e100, 1e160, 1e300, 1e-100, 1e-160, 1e-300});
+
+    const vector2<float> a(1e20f, 1e20f), b(-1e20f, 1e20f);
+    CHECK(a.is_perpendicular(b, 0.1f) && !a.is_collinear(b, 0.1f), "vector2 at 1e20");
+
+    return failures ? 1 : 0;
+}